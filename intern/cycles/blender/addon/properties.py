@@ -1054,6 +1054,20 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=8, max=8192,
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Read image textures from disk while rendering, only loading the parts and "
+        "resolutions that are needed, instead of loading all images into memory upfront. Works "
+        "best with tiled and mipmapped image files. Only available for CPU rendering",
+        default=False,
+    )
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum memory used by the texture cache, in megabytes",
+        default=4096,
+        min=64, soft_max=65536,
+    )
+
     # Various fine-tuning debug flags
 
     def _devices_update_callback(self, context):
@@ -1063,6 +1077,11 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
 
     debug_use_cpu_avx2: BoolProperty(name="AVX2", default=True)
     debug_use_cpu_sse42: BoolProperty(name="SSE42", default=True)
+    debug_use_cpu_wavefront: BoolProperty(
+        name="Wavefront",
+        description="Render batches of paths together on the CPU, sorted by the kernel and shader to execute next",
+        default=False,
+    )
     debug_bvh_layout: EnumProperty(
         name="BVH Layout",
         items=enum_bvh_layouts,
@@ -28,9 +28,16 @@ class CPUKernels {
                                                             KernelWorkTile *tile,
                                                             ccl_global float *render_buffer)>;
 
+  using IntegratorWavefrontFunction =
+      CPUKernelFunction<void (*)(const ThreadKernelGlobalsCPU *kg,
+                                 IntegratorStateCPU *const *states,
+                                 const int num_states,
+                                 ccl_global float *render_buffer)>;
+
   IntegratorInitFunction integrator_init_from_camera;
   IntegratorInitFunction integrator_init_from_bake;
   IntegratorShadeFunction integrator_megakernel;
+  IntegratorWavefrontFunction integrator_wavefront_step;
 
   /* Shader evaluation. */
 
@@ -1004,34 +1004,40 @@ bool PathTrace::copy_render_tile_from_device()
   return success;
 }
 
-static string get_layer_view_name(const RenderBuffers &buffers)
+static string get_layer_view_name(const BufferParams &params)
 {
   string result;
 
-  if (!buffers.params.layer.empty()) {
-    result += string(buffers.params.layer);
+  if (!params.layer.empty()) {
+    result += string(params.layer);
   }
 
-  if (!buffers.params.view.empty()) {
+  if (!params.view.empty()) {
     if (!result.empty()) {
       result += ", ";
     }
-    result += string(buffers.params.view);
+    result += string(params.view);
   }
 
   return result;
 }
 
+/* Height of the bands of rows in which the full frame buffer is read from disk, denoised and
+ * written to the output driver. Only a single band is held in memory at a time, which keeps the
+ * peak memory low for large frames. */
+static const int FULL_BUFFER_BAND_HEIGHT = 1024;
+
+/* Number of rows above and below a band which are denoised along with it, so that the denoiser
+ * sees enough of the neighborhood of the band to not leave seams between the bands. */
+static const int FULL_BUFFER_BAND_OVERLAP = 128;
+
 void PathTrace::process_full_buffer_from_disk(string_view filename)
 {
   VLOG_WORK << "Processing full frame buffer file " << filename;
 
   progress_set_status("Reading full buffer from disk");
 
-  RenderBuffers full_frame_buffers(cpu_device_.get());
-
-  DenoiseParams denoise_params;
-  if (!tile_manager_.read_full_buffer_from_disk(filename, &full_frame_buffers, &denoise_params)) {
+  const auto report_read_error = [&]() {
     const string error_message = "Error reading tiles from file";
     if (progress_) {
       progress_->set_error(error_message);
@@ -1040,16 +1046,21 @@ void PathTrace::process_full_buffer_from_disk(string_view filename)
     else {
       LOG(ERROR) << error_message;
     }
+  };
+
+  BufferParams full_frame_params;
+  DenoiseParams denoise_params;
+  if (!tile_manager_.open_full_buffer_from_disk(filename, &full_frame_params, &denoise_params)) {
+    tile_manager_.close_full_buffer_from_disk();
+    report_read_error();
     return;
   }
 
-  const string layer_view_name = get_layer_view_name(full_frame_buffers);
-
-  render_state_.has_denoised_result = false;
+  const string layer_view_name = get_layer_view_name(full_frame_params);
 
-  if (denoise_params.use && denoiser_ && !progress_->get_cancel()) {
-    progress_set_status(layer_view_name, "Denoising");
+  const bool use_denoise = denoise_params.use && denoiser_;
 
+  if (use_denoise) {
     /* If GPU should be used is not based on file metadata. */
     denoise_params.use_gpu = render_scheduler_.is_denoiser_gpu_used();
 
@@ -1060,22 +1071,66 @@ void PathTrace::process_full_buffer_from_disk(string_view filename)
      *  - The next rendering will go via Session's `run_update_for_next_iteration` which will
      *    ensure proper denoiser is used. */
     set_denoiser_params(denoise_params);
+  }
 
-    /* Number of samples doesn't matter too much, since the samples count pass will be used. */
-    denoiser_->denoise_buffer(full_frame_buffers.params, &full_frame_buffers, 0, false);
+  /* Process the frame band by band. Every band is read with the rows around it which the denoiser
+   * needs, and its window is written to the output driver pretending that it is a tile. Frames
+   * which fit into a single band are processed as a whole, as before. */
+  const int alignment = tile_manager_.get_full_buffer_band_alignment();
+  const int overlap = use_denoise ? FULL_BUFFER_BAND_OVERLAP : 0;
+  const int window_end = full_frame_params.window_y + full_frame_params.window_height;
 
-    render_state_.has_denoised_result = true;
-  }
+  RenderBuffers band_buffers(cpu_device_.get());
+
+  for (int band_y = full_frame_params.window_y; band_y < window_end;
+       band_y += FULL_BUFFER_BAND_HEIGHT)
+  {
+    const int band_end = min(band_y + FULL_BUFFER_BAND_HEIGHT, window_end);
+
+    /* Rows which are read from the file, aligned to what the file can read. */
+    const int read_y = (max(band_y - overlap, 0) / alignment) * alignment;
+    const int read_end = min(int(align_up(band_end + overlap, alignment)),
+                             full_frame_params.height);
 
-  full_frame_state_.render_buffers = &full_frame_buffers;
+    BufferParams band_params = full_frame_params;
+    band_params.height = read_end - read_y;
+    band_params.full_y = full_frame_params.full_y + read_y;
+    band_params.window_y = band_y - read_y;
+    band_params.window_height = band_end - band_y;
+    band_params.update_offset_stride();
 
-  progress_set_status(layer_view_name, "Finishing");
+    band_buffers.reset(band_params);
 
-  /* Write the full result pretending that there is a single tile.
-   * Requires some state change, but allows to use same communication API with the software. */
-  tile_buffer_write();
+    if (!tile_manager_.read_full_buffer_band_from_disk(read_y, &band_buffers)) {
+      tile_manager_.close_full_buffer_from_disk();
+      report_read_error();
+      return;
+    }
+
+    render_state_.has_denoised_result = false;
+
+    if (use_denoise && !progress_->get_cancel()) {
+      progress_set_status(layer_view_name, "Denoising");
+
+      /* Number of samples doesn't matter too much, since the samples count pass will be used. */
+      denoiser_->denoise_buffer(band_buffers.params, &band_buffers, 0, false);
+
+      render_state_.has_denoised_result = true;
+    }
+
+    full_frame_state_.render_buffers = &band_buffers;
+    full_frame_state_.offset = make_int2(0, band_y - full_frame_params.window_y);
+
+    progress_set_status(layer_view_name, "Finishing");
+
+    /* Write the band pretending that it is a tile.
+     * Requires some state change, but allows to use same communication API with the software. */
+    tile_buffer_write();
+
+    full_frame_state_.render_buffers = nullptr;
+  }
 
-  full_frame_state_.render_buffers = nullptr;
+  tile_manager_.close_full_buffer_from_disk();
 }
 
 int PathTrace::get_num_render_tile_samples() const
@@ -1148,7 +1203,7 @@ int2 PathTrace::get_render_tile_size() const
 int2 PathTrace::get_render_tile_offset() const
 {
   if (full_frame_state_.render_buffers) {
-    return make_int2(0, 0);
+    return full_frame_state_.offset;
   }
 
   const Tile &tile = tile_manager_.get_current_tile();
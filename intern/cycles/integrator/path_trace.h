@@ -355,6 +355,8 @@ class PathTrace {
   /* State of the full frame processing and writing to the software. */
   struct {
     RenderBuffers *render_buffers = nullptr;
+    /* Offset of the window of the render buffers in the full frame. */
+    int2 offset = make_int2(0, 0);
   } full_frame_state_;
 };
 
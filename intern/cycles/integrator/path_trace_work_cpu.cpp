@@ -19,10 +19,16 @@
 #include "scene/scene.h"
 #include "session/buffers.h"
 
+#include "util/algorithm.h"
+#include "util/debug.h"
 #include "util/tbb.h"
 
 CCL_NAMESPACE_BEGIN
 
+/* Number of pixels rendered together in the wavefront mode. Large enough for many paths to share
+ * the same kernel and shader, small enough for the path states to stay in the CPU caches. */
+static const int64_t WAVEFRONT_BATCH_SIZE = 256;
+
 /* Create TBB arena for execution of path tracing and rendering tasks. */
 static inline tbb::task_arena local_tbb_arena_create(const Device *device)
 {
@@ -74,32 +80,64 @@ void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
     }
   }
 
+  /* Path guiding records the segments of one path at a time per thread, so paths can't be
+   * interleaved. */
+  const bool use_wavefront = DebugFlags().cpu.wavefront &&
+                             !device_scene_->data.integrator.use_guiding;
+
   tbb::task_arena local_arena = local_tbb_arena_create(device_);
-  local_arena.execute([&]() {
-    parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
-      if (is_cancel_requested()) {
-        return;
-      }
+  if (use_wavefront) {
+    const int64_t batches_num = divide_up(total_pixels_num, WAVEFRONT_BATCH_SIZE);
+    local_arena.execute([&]() {
+      parallel_for(int64_t(0), batches_num, [&](int64_t batch_index) {
+        if (is_cancel_requested()) {
+          return;
+        }
 
-      const int y = work_index / image_width;
-      const int x = work_index - y * image_width;
+        const int64_t first_pixel_index = batch_index * WAVEFRONT_BATCH_SIZE;
+        const int64_t pixels_num = std::min(WAVEFRONT_BATCH_SIZE,
+                                            total_pixels_num - first_pixel_index);
 
-      KernelWorkTile work_tile;
-      work_tile.x = effective_buffer_params_.full_x + x;
-      work_tile.y = effective_buffer_params_.full_y + y;
-      work_tile.w = 1;
-      work_tile.h = 1;
-      work_tile.start_sample = start_sample;
-      work_tile.sample_offset = sample_offset;
-      work_tile.num_samples = 1;
-      work_tile.offset = effective_buffer_params_.offset;
-      work_tile.stride = effective_buffer_params_.stride;
+        ThreadKernelGlobalsCPU *kernel_globals = kernel_thread_globals_get(
+            kernel_thread_globals_);
+
+        render_samples_wavefront(kernel_globals,
+                                 first_pixel_index,
+                                 pixels_num,
+                                 start_sample,
+                                 samples_num,
+                                 sample_offset);
+      });
+    });
+  }
+  else {
+    local_arena.execute([&]() {
+      parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
+        if (is_cancel_requested()) {
+          return;
+        }
+
+        const int y = work_index / image_width;
+        const int x = work_index - y * image_width;
 
-      ThreadKernelGlobalsCPU *kernel_globals = kernel_thread_globals_get(kernel_thread_globals_);
+        KernelWorkTile work_tile;
+        work_tile.x = effective_buffer_params_.full_x + x;
+        work_tile.y = effective_buffer_params_.full_y + y;
+        work_tile.w = 1;
+        work_tile.h = 1;
+        work_tile.start_sample = start_sample;
+        work_tile.sample_offset = sample_offset;
+        work_tile.num_samples = 1;
+        work_tile.offset = effective_buffer_params_.offset;
+        work_tile.stride = effective_buffer_params_.stride;
 
-      render_samples_full_pipeline(kernel_globals, work_tile, samples_num);
+        ThreadKernelGlobalsCPU *kernel_globals = kernel_thread_globals_get(
+            kernel_thread_globals_);
+
+        render_samples_full_pipeline(kernel_globals, work_tile, samples_num);
+      });
     });
-  });
+  }
   if (device_->profiler.active()) {
     for (ThreadKernelGlobalsCPU &kernel_globals : kernel_thread_globals_) {
       kernel_globals.stop_profiling();
@@ -165,6 +203,125 @@ void PathTraceWorkCPU::render_samples_full_pipeline(ThreadKernelGlobalsCPU *kern
   }
 }
 
+/* Key to order the paths of a wavefront step by, zero if the path is terminated. This matches the
+ * kernel that #integrator_megakernel_step executes next for the path. */
+static uint64_t wavefront_sort_key(const IntegratorStateCPU &state)
+{
+  /* Shadow paths are handled before the main path continues. */
+  if (state.shadow.shadow_path.queued_kernel) {
+    return uint64_t(state.shadow.shadow_path.queued_kernel) << 32;
+  }
+  if (state.ao.shadow_path.queued_kernel) {
+    return uint64_t(state.ao.shadow_path.queued_kernel) << 32;
+  }
+
+  const uint64_t queued_kernel = state.path.queued_kernel;
+  switch (queued_kernel) {
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE:
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_RAYTRACE:
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_MNEE:
+      /* Evaluate the same shader for consecutive paths. */
+      return (queued_kernel << 32) | state.path.shader_sort_key;
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_CLOSEST: {
+      /* Trace rays with similar directions together, as they tend to visit the same BVH nodes. */
+      const packed_float3 D = state.ray.D;
+      const uint octant = uint(D.x < 0.0f) | (uint(D.y < 0.0f) << 1) | (uint(D.z < 0.0f) << 2);
+      return (queued_kernel << 32) | octant;
+    }
+    default:
+      return queued_kernel << 32;
+  }
+}
+
+void PathTraceWorkCPU::render_samples_wavefront(ThreadKernelGlobalsCPU *kernel_globals,
+                                                const int64_t first_pixel_index,
+                                                const int64_t pixels_num,
+                                                const int start_sample,
+                                                const int samples_num,
+                                                const int sample_offset)
+{
+  const bool has_bake = device_scene_->data.bake.use;
+  const int64_t image_width = effective_buffer_params_.width;
+
+  /* The shadow catcher splits paths into the state following the main path state. */
+  const int states_per_pixel = (device_scene_->data.integrator.has_shadow_catcher) ? 2 : 1;
+  vector<IntegratorStateCPU> states(pixels_num * states_per_pixel);
+  for (IntegratorStateCPU &state : states) {
+    path_state_init_queues(&state);
+  }
+
+  /* Pixels that don't need more samples, due to adaptive sampling. */
+  vector<bool> pixel_finished(pixels_num, false);
+
+  vector<std::pair<uint64_t, IntegratorStateCPU *>> sorted_states;
+  vector<IntegratorStateCPU *> step_states;
+  sorted_states.reserve(states.size());
+  step_states.reserve(states.size());
+
+  float *render_buffer = buffers_->buffer.data();
+
+  for (int sample = 0; sample < samples_num; ++sample) {
+    if (is_cancel_requested()) {
+      break;
+    }
+
+    for (int64_t i = 0; i < pixels_num; i++) {
+      if (pixel_finished[i]) {
+        continue;
+      }
+
+      const int64_t pixel_index = first_pixel_index + i;
+      const int y = pixel_index / image_width;
+      const int x = pixel_index - y * image_width;
+
+      KernelWorkTile work_tile;
+      work_tile.x = effective_buffer_params_.full_x + x;
+      work_tile.y = effective_buffer_params_.full_y + y;
+      work_tile.w = 1;
+      work_tile.h = 1;
+      work_tile.start_sample = start_sample + sample;
+      work_tile.sample_offset = sample_offset;
+      work_tile.num_samples = 1;
+      work_tile.offset = effective_buffer_params_.offset;
+      work_tile.stride = effective_buffer_params_.stride;
+
+      IntegratorStateCPU *state = &states[i * states_per_pixel];
+      const bool path_started = (has_bake) ?
+                                    kernels_.integrator_init_from_bake(
+                                        kernel_globals, state, &work_tile, render_buffer) :
+                                    kernels_.integrator_init_from_camera(
+                                        kernel_globals, state, &work_tile, render_buffer);
+      if (!path_started) {
+        pixel_finished[i] = true;
+      }
+    }
+
+    /* Execute one kernel for every path per step, until all paths are terminated. */
+    while (true) {
+      sorted_states.clear();
+      for (IntegratorStateCPU &state : states) {
+        const uint64_t key = wavefront_sort_key(state);
+        if (key != 0) {
+          sorted_states.emplace_back(key, &state);
+        }
+      }
+      if (sorted_states.empty()) {
+        break;
+      }
+
+      /* Sorting by state pointer second keeps paths of nearby pixels together. */
+      sort(sorted_states.begin(), sorted_states.end());
+
+      step_states.clear();
+      for (const std::pair<uint64_t, IntegratorStateCPU *> &item : sorted_states) {
+        step_states.push_back(item.second);
+      }
+      kernels_.integrator_wavefront_step(
+          kernel_globals, step_states.data(), int(step_states.size()), render_buffer);
+    }
+  }
+}
+
 void PathTraceWorkCPU::copy_to_display(PathTraceDisplay *display,
                                        PassMode pass_mode,
                                        const int num_samples)
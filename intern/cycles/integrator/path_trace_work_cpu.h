@@ -74,6 +74,17 @@ class PathTraceWorkCPU : public PathTraceWork {
                                     const KernelWorkTile &work_tile,
                                     const int samples_num);
 
+  /* Wavefront alternative to the routine above. Renders a batch of pixels at once, executing the
+   * same kernel for all paths that need it before moving on to the next kernel. Paths waiting
+   * for surface shading are sorted by shader, for better instruction and data cache coherence
+   * when the scene has many different shaders. */
+  void render_samples_wavefront(ThreadKernelGlobalsCPU *kernel_globals,
+                                const int64_t first_pixel_index,
+                                const int64_t pixels_num,
+                                const int start_sample,
+                                const int samples_num,
+                                const int sample_offset);
+
   /* CPU kernels. */
   const CPUKernels &kernels_;
 
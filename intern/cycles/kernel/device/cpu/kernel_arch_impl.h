@@ -96,6 +96,22 @@ DEFINE_INTEGRATOR_INIT_KERNEL(init_from_camera)
 DEFINE_INTEGRATOR_INIT_KERNEL(init_from_bake)
 DEFINE_INTEGRATOR_SHADE_KERNEL(megakernel)
 
+/* Execute the next queued kernel of every state. The caller orders the states so that the same
+ * kernels and shaders are executed together. */
+void KERNEL_FUNCTION_FULL_NAME(integrator_wavefront_step)(const ThreadKernelGlobalsCPU *kg,
+                                                          IntegratorStateCPU *const *states,
+                                                          const int num_states,
+                                                          ccl_global float *render_buffer)
+{
+#ifdef KERNEL_STUB
+  STUB_ASSERT(KERNEL_ARCH, integrator_wavefront_step);
+#else
+  for (int i = 0; i < num_states; i++) {
+    integrator_megakernel_step(kg, states[i], render_buffer);
+  }
+#endif
+}
+
 /* --------------------------------------------------------------------
  * Shader evaluation.
  */
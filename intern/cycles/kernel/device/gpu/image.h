@@ -293,6 +293,17 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, const int id, const
   }
 }
 
+/* Derivatives are only used for cached textures, which are not supported on the GPU. */
+ccl_device float4 kernel_tex_image_interp(KernelGlobals kg,
+                                          const int id,
+                                          const float x,
+                                          float y,
+                                          const float2 /*dx*/,
+                                          const float2 /*dy*/)
+{
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals kg,
                                              const int id,
                                              float3 P,
@@ -161,13 +161,14 @@ ccl_device_forceinline void integrator_path_init(KernelGlobals kg,
   INTEGRATOR_STATE_WRITE(state, path, queued_kernel) = next_kernel;
 }
 
+/* The key is only used when sorting paths in the CPU wavefront mode, see #PathTraceWorkCPU. */
 ccl_device_forceinline void integrator_path_init_sorted(KernelGlobals kg,
                                                         IntegratorState state,
                                                         const DeviceKernel next_kernel,
                                                         const uint32_t key)
 {
   INTEGRATOR_STATE_WRITE(state, path, queued_kernel) = next_kernel;
-  (void)key;
+  INTEGRATOR_STATE_WRITE(state, path, shader_sort_key) = key;
 }
 
 ccl_device_forceinline void integrator_path_next(KernelGlobals kg,
@@ -194,7 +195,7 @@ ccl_device_forceinline void integrator_path_next_sorted(KernelGlobals kg,
                                                         const uint32_t key)
 {
   INTEGRATOR_STATE_WRITE(state, path, queued_kernel) = next_kernel;
-  (void)key;
+  INTEGRATOR_STATE_WRITE(state, path, shader_sort_key) = key;
   (void)current_kernel;
 }
 
@@ -9,7 +9,9 @@
 
 #include "kernel/camera/projection.h"
 
+#include "kernel/geom/attribute.h"
 #include "kernel/geom/object.h"
+#include "kernel/geom/primitive.h"
 
 #include "kernel/svm/util.h"
 
@@ -17,15 +19,20 @@
 
 CCL_NAMESPACE_BEGIN
 
-ccl_device float4
-svm_image_texture(KernelGlobals kg, const int id, const float x, float y, const uint flags)
+ccl_device float4 svm_image_texture(KernelGlobals kg,
+                                    const int id,
+                                    const float x,
+                                    float y,
+                                    const float2 dx,
+                                    const float2 dy,
+                                    const uint flags)
 {
   if (id == -1) {
     return make_float4(
         TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
   }
 
-  float4 r = kernel_tex_image_interp(kg, id, x, y);
+  float4 r = kernel_tex_image_interp(kg, id, x, y, dx, dy);
   const float alpha = r.w;
 
   if ((flags & NODE_IMAGE_ALPHA_UNASSOCIATE) && alpha != 1.0f && alpha != 0.0f) {
@@ -40,6 +47,12 @@ svm_image_texture(KernelGlobals kg, const int id, const float x, float y, const
   return r;
 }
 
+ccl_device float4
+svm_image_texture(KernelGlobals kg, const int id, const float x, float y, const uint flags)
+{
+  return svm_image_texture(kg, id, x, y, zero_float2(), zero_float2(), flags);
+}
+
 /* Remap coordinate from 0..1 box to -1..-1 */
 ccl_device_inline float3 texco_remap_square(const float3 co)
 {
@@ -47,7 +60,7 @@ ccl_device_inline float3 texco_remap_square(const float3 co)
 }
 
 ccl_device_noinline int svm_node_tex_image(KernelGlobals kg,
-                                           ccl_private ShaderData * /*sd*/,
+                                           ccl_private ShaderData *sd,
                                            ccl_private float *stack,
                                            const uint4 node,
                                            int offset)
@@ -116,7 +129,16 @@ ccl_device_noinline int svm_node_tex_image(KernelGlobals kg,
     id = -num_nodes;
   }
 
-  const float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, flags);
+  float2 dx = zero_float2();
+  float2 dy = zero_float2();
+  if (flags & NODE_IMAGE_UV_DIFFERENTIALS) {
+    const AttributeDescriptor desc = find_attribute(kg, sd, ATTR_STD_UV);
+    if (desc.offset != ATTR_STD_NOT_FOUND) {
+      primitive_surface_attribute<float2>(kg, sd, desc, &dx, &dy);
+    }
+  }
+
+  const float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, dx, dy, flags);
 
   if (stack_valid(out_offset)) {
     stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
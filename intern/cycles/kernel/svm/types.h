@@ -356,6 +356,8 @@ enum NodeImageProjection {
 enum NodeImageFlags {
   NODE_IMAGE_COMPRESS_AS_SRGB = 1,
   NODE_IMAGE_ALPHA_UNASSOCIATE = 2,
+  /* The texture coordinates are the default UV map, use its differentials for mipmapping. */
+  NODE_IMAGE_UV_DIFFERENTIALS = 4,
 };
 
 enum NodeEnvironmentProjection {
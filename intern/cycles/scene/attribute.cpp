@@ -20,7 +20,13 @@ Attribute::Attribute(ustring name,
                      AttributeElement element,
                      Geometry *geom,
                      AttributePrimitive prim)
-    : name(name), std(ATTR_STD_NONE), type(type), element(element), flags(0), modified(true)
+    : name(name),
+      std(ATTR_STD_NONE),
+      type(type),
+      element(element),
+      flags(0),
+      modified(true),
+      packed_offset(0)
 {
   /* string and matrix not supported! */
   assert(type == TypeFloat || type == TypeColor || type == TypePoint || type == TypeVector ||
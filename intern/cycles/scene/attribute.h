@@ -52,6 +52,8 @@ class Attribute {
   uint flags; /* enum AttributeFlag */
 
   bool modified;
+  /* Offset of the data in the packed device attribute array it was last copied to. */
+  size_t packed_offset;
 
   Attribute(ustring name,
             const TypeDesc type,
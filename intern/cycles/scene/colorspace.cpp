@@ -29,7 +29,7 @@ ustring u_colorspace_srgb("__builtin_srgb");
 static thread_mutex cache_colorspaces_mutex;
 static thread_mutex cache_processors_mutex;
 static unordered_map<ustring, ustring> cached_colorspaces;
-static unordered_map<ustring, OCIO::ConstProcessorRcPtr> cached_processors;
+static unordered_map<ustring, OCIO::ConstCPUProcessorRcPtr> cached_processors;
 #endif
 
 ColorSpaceProcessor *ColorSpaceManager::get_processor(ustring colorspace)
@@ -56,20 +56,22 @@ ColorSpaceProcessor *ColorSpaceManager::get_processor(ustring colorspace)
   }
 
   /* Cache processor until free_memory(), memory overhead is expected to be
-   * small and the processor is likely to be reused. */
+   * small and the processor is likely to be reused. Only the CPU processor is
+   * kept, so that converting single pixels does not have to look it up again. */
   const thread_scoped_lock cache_processors_lock(cache_processors_mutex);
   if (cached_processors.find(colorspace) == cached_processors.end()) {
     try {
-      cached_processors[colorspace] = config->getProcessor(colorspace.c_str(), "scene_linear");
+      cached_processors[colorspace] =
+          config->getProcessor(colorspace.c_str(), "scene_linear")->getDefaultCPUProcessor();
     }
     catch (const OCIO::Exception &exception) {
-      cached_processors[colorspace] = OCIO::ConstProcessorRcPtr();
+      cached_processors[colorspace] = OCIO::ConstCPUProcessorRcPtr();
       VLOG_WARNING << "Colorspace " << colorspace.c_str()
                    << " can't be converted to scene_linear: " << exception.what();
     }
   }
 
-  const OCIO::Processor *processor = cached_processors[colorspace].get();
+  const OCIO::CPUProcessor *processor = cached_processors[colorspace].get();
   return (ColorSpaceProcessor *)processor;
 #else
   /* No OpenColorIO. */
@@ -201,14 +203,14 @@ void ColorSpaceManager::is_builtin_colorspace(ustring colorspace,
                                               bool &is_srgb)
 {
 #ifdef WITH_OCIO
-  const OCIO::Processor *processor = (const OCIO::Processor *)get_processor(colorspace);
-  if (!processor) {
+  const OCIO::CPUProcessor *device_processor = (const OCIO::CPUProcessor *)get_processor(
+      colorspace);
+  if (!device_processor) {
     is_scene_linear = false;
     is_srgb = false;
     return;
   }
 
-  const OCIO::ConstCPUProcessorRcPtr device_processor = processor->getDefaultCPUProcessor();
   is_scene_linear = true;
   is_srgb = true;
   for (int i = 0; i < 256; i++) {
@@ -281,14 +283,13 @@ template<typename T> inline void cast_from_float4(T *data, const float4 value)
 
 /* Slower versions for other all data types, which needs to convert to float and back. */
 template<typename T, bool compress_as_srgb = false>
-inline void processor_apply_pixels_rgba(const OCIO::Processor *processor,
+inline void processor_apply_pixels_rgba(const OCIO::CPUProcessor *device_processor,
                                         T *pixels,
                                         const size_t num_pixels)
 {
   /* TODO: implement faster version for when we know the conversion
    * is a simple matrix transform between linear spaces. In that case
    * un-premultiply is not needed. */
-  const OCIO::ConstCPUProcessorRcPtr device_processor = processor->getDefaultCPUProcessor();
 
   /* Process large images in chunks to keep temporary memory requirement down. */
   const size_t chunk_size = std::min((size_t)(16 * 1024 * 1024), num_pixels);
@@ -332,12 +333,10 @@ inline void processor_apply_pixels_rgba(const OCIO::Processor *processor,
 }
 
 template<typename T, bool compress_as_srgb = false>
-inline void processor_apply_pixels_grayscale(const OCIO::Processor *processor,
+inline void processor_apply_pixels_grayscale(const OCIO::CPUProcessor *device_processor,
                                              T *pixels,
                                              const size_t num_pixels)
 {
-  const OCIO::ConstCPUProcessorRcPtr device_processor = processor->getDefaultCPUProcessor();
-
   /* Process large images in chunks to keep temporary memory requirement down. */
   const size_t chunk_size = std::min((size_t)(16 * 1024 * 1024), num_pixels);
   vector<float> float_pixels(chunk_size * 3);
@@ -381,7 +380,7 @@ void ColorSpaceManager::to_scene_linear(
     ustring colorspace, T *pixels, const size_t num_pixels, bool is_rgba, bool compress_as_srgb)
 {
 #ifdef WITH_OCIO
-  const OCIO::Processor *processor = (const OCIO::Processor *)get_processor(colorspace);
+  const OCIO::CPUProcessor *processor = (const OCIO::CPUProcessor *)get_processor(colorspace);
 
   if (processor) {
     if (is_rgba) {
@@ -419,10 +418,9 @@ void ColorSpaceManager::to_scene_linear(ColorSpaceProcessor *processor_,
                                         const int channels)
 {
 #ifdef WITH_OCIO
-  const OCIO::Processor *processor = (const OCIO::Processor *)processor_;
+  const OCIO::CPUProcessor *device_processor = (const OCIO::CPUProcessor *)processor_;
 
-  if (processor) {
-    const OCIO::ConstCPUProcessorRcPtr device_processor = processor->getDefaultCPUProcessor();
+  if (device_processor) {
     if (channels == 1) {
       float3 rgb = make_float3(pixel[0], pixel[0], pixel[0]);
       device_processor->applyRGB(&rgb.x);
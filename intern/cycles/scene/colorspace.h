@@ -34,8 +34,9 @@ class ColorSpaceManager {
       ustring colorspace, T *pixels, const size_t num_pixels, bool is_rgba, bool compress_as_srgb);
 
   /* Efficiently convert pixels to scene linear colorspace at render time,
-   * for OSL where the image texture cache contains original pixels. The
-   * handle is valid for the lifetime of the application. */
+   * for OSL and the image texture cache, which contain original pixels. The
+   * handle refers to the CPU processor, so converting a pixel does not look
+   * it up again. It is valid for the lifetime of the application. */
   static ColorSpaceProcessor *get_processor(ustring colorspace);
   static void to_scene_linear(ColorSpaceProcessor *processor, float *pixel, const int channels);
 
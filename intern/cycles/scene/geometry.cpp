@@ -52,6 +52,7 @@ Geometry::Geometry(const NodeType *node_type, const Type type)
 {
   need_update_rebuild = false;
   need_update_bvh_for_offset = false;
+  packed_offsets_modified = false;
 
   transform_applied = false;
   transform_negative_scaled = false;
@@ -274,11 +275,15 @@ void GeometryManager::geom_calc_offset(Scene *scene, BVHLayout bvh_layout)
 
   for (Geometry *geom : scene->geometry) {
     bool prim_offset_changed = false;
+    bool offsets_changed = false;
 
     if (geom->is_mesh() || geom->is_volume()) {
       Mesh *mesh = static_cast<Mesh *>(geom);
 
       prim_offset_changed = (mesh->prim_offset != tri_size);
+      offsets_changed = prim_offset_changed || (mesh->vert_offset != vert_size) ||
+                        (mesh->patch_offset != patch_size) || (mesh->face_offset != face_size) ||
+                        (mesh->corner_offset != corner_size);
 
       mesh->vert_offset = vert_size;
       mesh->prim_offset = tri_size;
@@ -296,6 +301,7 @@ void GeometryManager::geom_calc_offset(Scene *scene, BVHLayout bvh_layout)
 
         /* patch tables are stored in same array so include them in patch_size */
         if (mesh->patch_table) {
+          offsets_changed |= (mesh->patch_table_offset != patch_size);
           mesh->patch_table_offset = patch_size;
           patch_size += mesh->patch_table->total_size();
         }
@@ -308,6 +314,9 @@ void GeometryManager::geom_calc_offset(Scene *scene, BVHLayout bvh_layout)
       Hair *hair = static_cast<Hair *>(geom);
 
       prim_offset_changed = (hair->curve_segment_offset != curve_segment_size);
+      offsets_changed = prim_offset_changed || (hair->curve_key_offset != curve_key_size) ||
+                        (hair->prim_offset != curve_size);
+
       hair->curve_key_offset = curve_key_size;
       hair->curve_segment_offset = curve_segment_size;
       hair->prim_offset = curve_size;
@@ -320,6 +329,7 @@ void GeometryManager::geom_calc_offset(Scene *scene, BVHLayout bvh_layout)
       PointCloud *pointcloud = static_cast<PointCloud *>(geom);
 
       prim_offset_changed = (pointcloud->prim_offset != point_size);
+      offsets_changed = prim_offset_changed;
 
       pointcloud->prim_offset = point_size;
       point_size += pointcloud->num_points();
@@ -338,6 +348,10 @@ void GeometryManager::geom_calc_offset(Scene *scene, BVHLayout bvh_layout)
       geom->need_update_rebuild |= need_update_rebuild;
       geom->need_update_bvh_for_offset = true;
     }
+
+    /* Geometry that keeps its offsets keeps its slice of the packed device arrays, which then
+     * only needs to be rewritten when the geometry itself was modified. */
+    geom->packed_offsets_modified |= offsets_changed;
   }
 }
 
@@ -1031,6 +1045,7 @@ void GeometryManager::device_update(Device *device,
   for (Geometry *geom : scene->geometry) {
     geom->clear_modified();
     geom->attributes.clear_modified();
+    geom->packed_offsets_modified = false;
 
     if (geom->is_mesh()) {
       Mesh *mesh = static_cast<Mesh *>(geom);
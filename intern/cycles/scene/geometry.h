@@ -111,6 +111,9 @@ class Geometry : public Node {
   /* Update Flags */
   bool need_update_rebuild;
   bool need_update_bvh_for_offset;
+  /* Offsets into the packed device arrays changed, so the data needs to be packed again even if
+   * it was not modified. Set in geom_calc_offset(). */
+  bool packed_offsets_modified;
 
   /* Index into scene->geometry (only valid during update) */
   size_t index;
@@ -281,15 +281,18 @@ template<typename T> struct AttributeTableEntry {
   }
 
   /* Templated on U since we'll want to assign float3 values to a packed_float3 device_vector. */
-  template<typename U> size_t add(const U *attr_data, const size_t attr_size, const bool modified)
+  template<typename U> size_t add(const U *attr_data, const size_t attr_size, Attribute &attr)
   {
     assert(data.size() >= offset + attr_size);
     size_t start_offset = offset;
-    if (modified) {
+    /* Attributes that moved inside the array have to be copied again, even if their data did not
+     * change. */
+    if (attr.modified || attr.packed_offset != start_offset) {
       for (size_t k = 0; k < attr_size; k++) {
         data[offset + k] = attr_data[k];
       }
       data.tag_modified();
+      attr.packed_offset = start_offset;
     }
     offset += attr_size;
     return start_offset;
@@ -348,22 +351,22 @@ class AttributeTableBuilder {
       offset = handle.svm_slot();
     }
     else if (mattr->element == ATTR_ELEMENT_CORNER_BYTE) {
-      offset = attr_uchar4.add(mattr->data_uchar4(), size, mattr->modified);
+      offset = attr_uchar4.add(mattr->data_uchar4(), size, *mattr);
     }
     else if (mattr->type == TypeFloat) {
-      offset = attr_float.add(mattr->data_float(), size, mattr->modified);
+      offset = attr_float.add(mattr->data_float(), size, *mattr);
     }
     else if (mattr->type == TypeFloat2) {
-      offset = attr_float2.add(mattr->data_float2(), size, mattr->modified);
+      offset = attr_float2.add(mattr->data_float2(), size, *mattr);
     }
     else if (mattr->type == TypeMatrix) {
-      offset = attr_float4.add((float4 *)mattr->data_transform(), size * 3, mattr->modified);
+      offset = attr_float4.add((float4 *)mattr->data_transform(), size * 3, *mattr);
     }
     else if (mattr->type == TypeFloat4 || mattr->type == TypeRGBA) {
-      offset = attr_float4.add(mattr->data_float4(), size, mattr->modified);
+      offset = attr_float4.add(mattr->data_float4(), size, *mattr);
     }
     else {
-      offset = attr_float3.add(mattr->data_float3(), size, mattr->modified);
+      offset = attr_float3.add(mattr->data_float3(), size, *mattr);
     }
 
     /* mesh vertex/curve index is global, not per object, so we sneak
@@ -18,14 +18,30 @@
 #include "scene/scene.h"
 #include "scene/shader.h"
 #include "scene/shader_nodes.h"
+#include "scene/stats.h"
 
 #include "subd/patch_table.h"
 #include "subd/split.h"
 
 #include "util/progress.h"
+#include "util/tbb.h"
+#include "util/time.h"
 
 CCL_NAMESPACE_BEGIN
 
+/* Pack the data of every geometry in parallel. Each geometry only writes to its own slice of the
+ * device arrays, so no synchronization is needed. */
+template<typename Func> static void parallel_for_geometry(Scene *scene, const Func &func)
+{
+  static const int GEOMETRY_PER_TASK = 4;
+  parallel_for(blocked_range<size_t>(0, scene->geometry.size(), GEOMETRY_PER_TASK),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   func(scene->geometry[i]);
+                 }
+               });
+}
+
 void GeometryManager::device_update_mesh(Device * /*unused*/,
                                          DeviceScene *dscene,
                                          Scene *scene,
@@ -43,6 +59,12 @@ void GeometryManager::device_update_mesh(Device * /*unused*/,
 
   size_t patch_size = 0;
 
+  /* Geometry that moved inside the device arrays has to be packed again, even if its data did
+   * not change. */
+  bool mesh_offsets_modified = false;
+  bool curve_offsets_modified = false;
+  bool point_offsets_modified = false;
+
   for (Geometry *geom : scene->geometry) {
     if (geom->is_mesh() || geom->is_volume()) {
       Mesh *mesh = static_cast<Mesh *>(geom);
@@ -60,6 +82,8 @@ void GeometryManager::device_update_mesh(Device * /*unused*/,
           patch_size += mesh->patch_table->total_size();
         }
       }
+
+      mesh_offsets_modified |= mesh->packed_offsets_modified;
     }
     else if (geom->is_hair()) {
       Hair *hair = static_cast<Hair *>(geom);
@@ -67,15 +91,25 @@ void GeometryManager::device_update_mesh(Device * /*unused*/,
       curve_key_size += hair->get_curve_keys().size();
       curve_size += hair->num_curves();
       curve_segment_size += hair->num_segments();
+
+      curve_offsets_modified |= hair->packed_offsets_modified;
     }
     else if (geom->is_pointcloud()) {
       PointCloud *pointcloud = static_cast<PointCloud *>(geom);
       point_size += pointcloud->num_points();
+
+      point_offsets_modified |= pointcloud->packed_offsets_modified;
     }
   }
 
   /* Fill in all the arrays. */
   if (tri_size != 0) {
+    const scoped_callback_timer timer([scene](double time) {
+      if (scene->update_stats) {
+        scene->update_stats->geometry.times.add_entry({"device_update_mesh (triangles)", time});
+      }
+    });
+
     /* normals */
     progress.set_status("Updating Mesh", "Computing normals");
 
@@ -92,38 +126,52 @@ void GeometryManager::device_update_mesh(Device * /*unused*/,
                                dscene->tri_patch.need_realloc() ||
                                dscene->tri_patch_uv.need_realloc();
 
-    for (Geometry *geom : scene->geometry) {
-      if (geom->is_mesh() || geom->is_volume()) {
-        Mesh *mesh = static_cast<Mesh *>(geom);
+    if (mesh_offsets_modified) {
+      dscene->tri_verts.tag_modified();
+      dscene->tri_shader.tag_modified();
+      dscene->tri_vnormal.tag_modified();
+      dscene->tri_vindex.tag_modified();
+      dscene->tri_patch.tag_modified();
+      dscene->tri_patch_uv.tag_modified();
+    }
 
-        if (mesh->shader_is_modified() || mesh->smooth_is_modified() ||
-            mesh->triangles_is_modified() || copy_all_data)
-        {
-          mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
-        }
+    parallel_for_geometry(scene, [&](Geometry *geom) {
+      if (!(geom->is_mesh() || geom->is_volume())) {
+        return;
+      }
 
-        if (mesh->verts_is_modified() || copy_all_data) {
-          mesh->pack_normals(&vnormal[mesh->vert_offset]);
-        }
+      Mesh *mesh = static_cast<Mesh *>(geom);
+      const bool copy_mesh_data = copy_all_data || mesh->packed_offsets_modified;
 
-        if (mesh->verts_is_modified() || mesh->triangles_is_modified() ||
-            mesh->vert_patch_uv_is_modified() || copy_all_data)
-        {
-          mesh->pack_verts(&tri_verts[mesh->vert_offset],
-                           &tri_vindex[mesh->prim_offset],
-                           &tri_patch[mesh->prim_offset],
-                           &tri_patch_uv[mesh->vert_offset]);
-        }
+      if (mesh->shader_is_modified() || mesh->smooth_is_modified() ||
+          mesh->triangles_is_modified() || copy_mesh_data)
+      {
+        mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
+      }
 
-        if (progress.get_cancel()) {
-          return;
-        }
+      if (mesh->verts_is_modified() || copy_mesh_data) {
+        mesh->pack_normals(&vnormal[mesh->vert_offset]);
+      }
+
+      if (mesh->verts_is_modified() || mesh->triangles_is_modified() ||
+          mesh->vert_patch_uv_is_modified() || copy_mesh_data)
+      {
+        mesh->pack_verts(&tri_verts[mesh->vert_offset],
+                         &tri_vindex[mesh->prim_offset],
+                         &tri_patch[mesh->prim_offset],
+                         &tri_patch_uv[mesh->vert_offset]);
       }
+    });
+
+    if (progress.get_cancel()) {
+      return;
     }
 
     /* vertex coordinates */
     progress.set_status("Updating Mesh", "Copying Mesh to device");
 
+    /* Only the host side packing is incremental. The device API has no way to copy part of an
+     * array, so a modified array is still copied to the device as a whole. */
     dscene->tri_verts.copy_to_device_if_modified();
     dscene->tri_shader.copy_to_device_if_modified();
     dscene->tri_vnormal.copy_to_device_if_modified();
@@ -133,6 +181,12 @@ void GeometryManager::device_update_mesh(Device * /*unused*/,
   }
 
   if (curve_segment_size != 0) {
+    const scoped_callback_timer timer([scene](double time) {
+      if (scene->update_stats) {
+        scene->update_stats->geometry.times.add_entry({"device_update_mesh (curves)", time});
+      }
+    });
+
     progress.set_status("Updating Mesh", "Copying Curves to device");
 
     float4 *curve_keys = dscene->curve_keys.alloc(curve_key_size);
@@ -143,27 +197,38 @@ void GeometryManager::device_update_mesh(Device * /*unused*/,
                                dscene->curves.need_realloc() ||
                                dscene->curve_segments.need_realloc();
 
-    for (Geometry *geom : scene->geometry) {
-      if (geom->is_hair()) {
-        Hair *hair = static_cast<Hair *>(geom);
+    if (curve_offsets_modified) {
+      dscene->curve_keys.tag_modified();
+      dscene->curves.tag_modified();
+      dscene->curve_segments.tag_modified();
+    }
 
-        const bool curve_keys_co_modified = hair->curve_radius_is_modified() ||
-                                            hair->curve_keys_is_modified();
-        const bool curve_data_modified = hair->curve_shader_is_modified() ||
-                                         hair->curve_first_key_is_modified();
+    parallel_for_geometry(scene, [&](Geometry *geom) {
+      if (!geom->is_hair()) {
+        return;
+      }
 
-        if (!curve_keys_co_modified && !curve_data_modified && !copy_all_data) {
-          continue;
-        }
+      Hair *hair = static_cast<Hair *>(geom);
 
-        hair->pack_curves(scene,
-                          &curve_keys[hair->curve_key_offset],
-                          &curves[hair->prim_offset],
-                          &curve_segments[hair->curve_segment_offset]);
-        if (progress.get_cancel()) {
-          return;
-        }
+      const bool curve_keys_co_modified = hair->curve_radius_is_modified() ||
+                                          hair->curve_keys_is_modified();
+      const bool curve_data_modified = hair->curve_shader_is_modified() ||
+                                       hair->curve_first_key_is_modified();
+
+      if (!curve_keys_co_modified && !curve_data_modified && !copy_all_data &&
+          !hair->packed_offsets_modified)
+      {
+        return;
       }
+
+      hair->pack_curves(scene,
+                        &curve_keys[hair->curve_key_offset],
+                        &curves[hair->prim_offset],
+                        &curve_segments[hair->curve_segment_offset]);
+    });
+
+    if (progress.get_cancel()) {
+      return;
     }
 
     dscene->curve_keys.copy_to_device_if_modified();
@@ -172,45 +237,75 @@ void GeometryManager::device_update_mesh(Device * /*unused*/,
   }
 
   if (point_size != 0) {
+    const scoped_callback_timer timer([scene](double time) {
+      if (scene->update_stats) {
+        scene->update_stats->geometry.times.add_entry({"device_update_mesh (points)", time});
+      }
+    });
+
     progress.set_status("Updating Mesh", "Copying Point clouds to device");
 
     float4 *points = dscene->points.alloc(point_size);
     uint *points_shader = dscene->points_shader.alloc(point_size);
 
-    for (Geometry *geom : scene->geometry) {
-      if (geom->is_pointcloud()) {
-        PointCloud *pointcloud = static_cast<PointCloud *>(geom);
-        pointcloud->pack(
-            scene, &points[pointcloud->prim_offset], &points_shader[pointcloud->prim_offset]);
-        if (progress.get_cancel()) {
-          return;
-        }
+    const bool copy_all_data = dscene->points.need_realloc() ||
+                               dscene->points_shader.need_realloc();
+
+    if (point_offsets_modified) {
+      dscene->points.tag_modified();
+      dscene->points_shader.tag_modified();
+    }
+
+    parallel_for_geometry(scene, [&](Geometry *geom) {
+      if (!geom->is_pointcloud()) {
+        return;
       }
+
+      PointCloud *pointcloud = static_cast<PointCloud *>(geom);
+
+      if (!pointcloud->is_modified() && !copy_all_data && !pointcloud->packed_offsets_modified) {
+        return;
+      }
+
+      pointcloud->pack(
+          scene, &points[pointcloud->prim_offset], &points_shader[pointcloud->prim_offset]);
+    });
+
+    if (progress.get_cancel()) {
+      return;
     }
 
-    dscene->points.copy_to_device();
-    dscene->points_shader.copy_to_device();
+    dscene->points.copy_to_device_if_modified();
+    dscene->points_shader.copy_to_device_if_modified();
   }
 
-  if (patch_size != 0 && dscene->patches.need_realloc()) {
+  if (patch_size != 0 && (dscene->patches.need_realloc() || mesh_offsets_modified)) {
+    const scoped_callback_timer timer([scene](double time) {
+      if (scene->update_stats) {
+        scene->update_stats->geometry.times.add_entry({"device_update_mesh (patches)", time});
+      }
+    });
+
     progress.set_status("Updating Mesh", "Copying Patches to device");
 
     uint *patch_data = dscene->patches.alloc(patch_size);
 
-    for (Geometry *geom : scene->geometry) {
-      if (geom->is_mesh()) {
-        Mesh *mesh = static_cast<Mesh *>(geom);
-        mesh->pack_patches(&patch_data[mesh->patch_offset]);
+    parallel_for_geometry(scene, [&](Geometry *geom) {
+      if (!geom->is_mesh()) {
+        return;
+      }
 
-        if (mesh->patch_table) {
-          mesh->patch_table->copy_adjusting_offsets(&patch_data[mesh->patch_table_offset],
-                                                    mesh->patch_table_offset);
-        }
+      Mesh *mesh = static_cast<Mesh *>(geom);
+      mesh->pack_patches(&patch_data[mesh->patch_offset]);
 
-        if (progress.get_cancel()) {
-          return;
-        }
+      if (mesh->patch_table) {
+        mesh->patch_table->copy_adjusting_offsets(&patch_data[mesh->patch_table_offset],
+                                                  mesh->patch_table_offset);
       }
+    });
+
+    if (progress.get_cancel()) {
+      return;
     }
 
     dscene->patches.copy_to_device();
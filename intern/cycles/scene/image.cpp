@@ -5,6 +5,7 @@
 #include "scene/image.h"
 #include "device/device.h"
 #include "scene/colorspace.h"
+#include "scene/image_cache.h"
 #include "scene/image_oiio.h"
 #include "scene/image_vdb.h"
 #include "scene/scene.h"
@@ -52,6 +53,8 @@ const char *name_from_type(ImageDataType type)
       return "nanovdb_fpn";
     case IMAGE_DATA_TYPE_NANOVDB_FP16:
       return "nanovdb_fp16";
+    case IMAGE_DATA_TYPE_CACHED:
+      return "cached";
     case IMAGE_DATA_NUM_TYPES:
       assert(!"System enumerator type, should never be used");
       return "";
@@ -305,7 +308,7 @@ bool ImageLoader::is_vdb_loader() const
 
 /* Image Manager */
 
-ImageManager::ImageManager(const DeviceInfo &info)
+ImageManager::ImageManager(const DeviceInfo &info, const SceneParams &params)
 {
   need_update_ = true;
   osl_texture_system = nullptr;
@@ -313,6 +316,11 @@ ImageManager::ImageManager(const DeviceInfo &info)
 
   /* Set image limits */
   features.has_nanovdb = info.has_nanovdb;
+
+  /* The kernel calls into the texture cache, which is only possible on the CPU. */
+  if (params.use_texture_cache && info.type == DEVICE_CPU) {
+    texture_cache = make_unique<ImageTextureCache>(params.texture_cache_size);
+  }
 }
 
 ImageManager::~ImageManager()
@@ -322,6 +330,11 @@ ImageManager::~ImageManager()
   }
 }
 
+bool ImageManager::use_texture_cache() const
+{
+  return texture_cache != nullptr;
+}
+
 void ImageManager::set_osl_texture_system(void *texture_system)
 {
   osl_texture_system = texture_system;
@@ -693,6 +706,33 @@ bool ImageManager::file_load_image(Image *img, const int texture_limit)
   return true;
 }
 
+unique_ptr<CachedTexture> ImageManager::create_cached_texture(Image *img)
+{
+  if (!texture_cache || img->builtin) {
+    return nullptr;
+  }
+
+  /* Only 2D images from files can be read on demand. */
+  const ustring filepath = img->loader->osl_filepath();
+  if (filepath.empty() || img->metadata.depth > 1) {
+    return nullptr;
+  }
+
+  if (img->cached_texture) {
+    /* Reloading, the file may have changed on disk. */
+    texture_cache->invalidate(filepath);
+  }
+
+  /* The texture cache always associates alpha, images where this is not wanted are loaded
+   * fully instead. */
+  const int channels = img->metadata.channels;
+  if ((channels == 2 || channels == 4) && !image_associate_alpha(img)) {
+    return nullptr;
+  }
+
+  return texture_cache->create_texture(filepath, img->params, img->metadata);
+}
+
 void ImageManager::device_load_image(Device *device,
                                      Scene *scene,
                                      const size_t slot,
@@ -711,22 +751,36 @@ void ImageManager::device_load_image(Device *device,
   load_image_metadata(img);
   const ImageDataType type = img->metadata.type;
 
+  /* Read the image on demand from the kernel if possible, otherwise load all pixels now. */
+  unique_ptr<CachedTexture> cached_texture = create_cached_texture(img);
+  const ImageDataType mem_type = (cached_texture) ? IMAGE_DATA_TYPE_CACHED : type;
+
   /* Name for debugging. */
-  img->mem_name = string_printf("tex_image_%s_%03d", name_from_type(type), (int)slot);
+  img->mem_name = string_printf("tex_image_%s_%03d", name_from_type(mem_type), (int)slot);
 
   /* Free previous texture in slot. */
   if (img->mem) {
     const thread_scoped_lock device_lock(device_mutex);
     img->mem.reset();
   }
-
-  img->mem = make_unique<device_texture>(
-      device, img->mem_name.c_str(), slot, type, img->params.interpolation, img->params.extension);
+  img->cached_texture = std::move(cached_texture);
+
+  img->mem = make_unique<device_texture>(device,
+                                         img->mem_name.c_str(),
+                                         slot,
+                                         mem_type,
+                                         img->params.interpolation,
+                                         img->params.extension);
   img->mem->info.use_transform_3d = img->metadata.use_transform_3d;
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (img->cached_texture) {
+    const thread_scoped_lock device_lock(device_mutex);
+    const CachedTexture **texture = (const CachedTexture **)img->mem->alloc(1, 1);
+    *texture = img->cached_texture.get();
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       const thread_scoped_lock device_lock(device_mutex);
@@ -849,10 +903,15 @@ void ImageManager::device_free_image(Device * /*unused*/, size_t slot)
 #endif
   }
 
+  if (texture_cache && img->cached_texture) {
+    texture_cache->invalidate(img->loader->osl_filepath());
+  }
+
   if (img->mem) {
     const thread_scoped_lock device_lock(device_mutex);
     img->mem.reset();
   }
+  img->cached_texture.reset();
 
   images[slot].reset();
 }
@@ -952,6 +1011,10 @@ void ImageManager::collect_statistics(RenderStats *stats)
     stats->image.textures.add_entry(
         NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
   }
+
+  if (texture_cache) {
+    texture_cache->collect_statistics(&stats->image);
+  }
 }
 
 void ImageManager::tag_update()
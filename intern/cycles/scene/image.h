@@ -21,10 +21,12 @@ class DeviceInfo;
 class ImageHandle;
 class ImageKey;
 class ImageMetaData;
+class ImageTextureCache;
 class ImageManager;
 class Progress;
 class RenderStats;
 class Scene;
+class SceneParams;
 class ColorSpaceProcessor;
 class VDBImageLoader;
 
@@ -162,7 +164,7 @@ class ImageHandle {
  * texture images and 3D volume images. */
 class ImageManager {
  public:
-  explicit ImageManager(const DeviceInfo &info);
+  ImageManager(const DeviceInfo &info, const SceneParams &params);
   ~ImageManager();
 
   ImageHandle add_image(const string &filename, const ImageParams &params);
@@ -186,6 +188,9 @@ class ImageManager {
 
   void collect_statistics(RenderStats *stats);
 
+  /* Whether file images are read on demand by the kernel, see #ImageTextureCache. */
+  bool use_texture_cache() const;
+
   void tag_update();
 
   bool need_update() const;
@@ -202,6 +207,8 @@ class ImageManager {
 
     string mem_name;
     unique_ptr<device_texture> mem;
+    /* Texture that #mem points to when the image is read on demand. */
+    unique_ptr<CachedTexture> cached_texture;
 
     int users;
     thread_mutex mutex;
@@ -218,6 +225,7 @@ class ImageManager {
 
   vector<unique_ptr<Image>> images;
   void *osl_texture_system;
+  unique_ptr<ImageTextureCache> texture_cache;
 
   size_t add_image_slot(unique_ptr<ImageLoader> &&loader,
                         const ImageParams &params,
@@ -230,6 +238,7 @@ class ImageManager {
 
   template<TypeDesc::BASETYPE FileFormat, typename StorageType>
   bool file_load_image(Image *img, const int texture_limit);
+  unique_ptr<CachedTexture> create_cached_texture(Image *img);
 
   void device_load_image(Device *device, Scene *scene, const size_t slot, Progress &progress);
   void device_free_image(Device *device, const size_t slot);
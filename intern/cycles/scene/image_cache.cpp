@@ -0,0 +1,164 @@
+/* SPDX-FileCopyrightText: 2026 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "scene/image_cache.h"
+#include "scene/colorspace.h"
+#include "scene/image.h"
+#include "scene/stats.h"
+
+#include "util/log.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+class OIIOCachedTexture : public CachedTexture {
+ public:
+  OIIOCachedTexture(OIIO::TextureSystem *texture_system,
+                    OIIO::TextureSystem::TextureHandle *handle,
+                    const ImageParams &params,
+                    const ImageMetaData &metadata)
+      : texture_system_(texture_system), handle_(handle)
+  {
+    switch (params.interpolation) {
+      case INTERPOLATION_CLOSEST:
+        options_.interpmode = OIIO::TextureOpt::InterpClosest;
+        break;
+      case INTERPOLATION_CUBIC:
+        options_.interpmode = OIIO::TextureOpt::InterpBicubic;
+        break;
+      case INTERPOLATION_SMART:
+        options_.interpmode = OIIO::TextureOpt::InterpSmartBicubic;
+        break;
+      default:
+        options_.interpmode = OIIO::TextureOpt::InterpBilinear;
+        break;
+    }
+
+    OIIO::TextureOpt::Wrap wrap;
+    switch (params.extension) {
+      case EXTENSION_EXTEND:
+        wrap = OIIO::TextureOpt::WrapClamp;
+        break;
+      case EXTENSION_CLIP:
+        wrap = OIIO::TextureOpt::WrapBlack;
+        break;
+      case EXTENSION_MIRROR:
+        wrap = OIIO::TextureOpt::WrapMirror;
+        break;
+      default:
+        wrap = OIIO::TextureOpt::WrapPeriodic;
+        break;
+    }
+    options_.swrap = wrap;
+    options_.twrap = wrap;
+
+    /* Missing alpha channels are opaque, like for fully loaded textures. Images with an alpha
+     * channel that is ignored are loaded fully instead, see
+     * #ImageManager::create_cached_texture. Gray images are expanded to RGB by the texture
+     * system. */
+    options_.fill = 1.0f;
+
+    /* Images in sRGB are converted in the kernel, see #ImageMetaData::compress_as_srgb. */
+    if (metadata.colorspace != u_colorspace_raw && metadata.colorspace != u_colorspace_srgb) {
+      processor_ = ColorSpaceManager::get_processor(metadata.colorspace);
+    }
+  }
+
+  float4 lookup(const float x, const float y, const float2 dx, const float2 dy) const override
+  {
+    OIIO::TextureOpt options = options_;
+    float result[4];
+    /* The texture system has the origin of images at the top instead of the bottom. */
+    if (!texture_system_->texture(
+            handle_, nullptr, options, x, 1.0f - y, dx.x, -dx.y, dy.x, -dy.y, 4, result))
+    {
+      /* Clear the error, to avoid accumulating them in the texture system. */
+      texture_system_->geterror();
+      return make_float4(
+          TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
+    }
+
+    if (processor_) {
+      ColorSpaceManager::to_scene_linear(processor_, result, 4);
+    }
+    return make_float4(result[0], result[1], result[2], result[3]);
+  }
+
+ private:
+  OIIO::TextureSystem *texture_system_;
+  OIIO::TextureSystem::TextureHandle *handle_;
+  OIIO::TextureOpt options_;
+  ColorSpaceProcessor *processor_ = nullptr;
+};
+
+}  // namespace
+
+ImageTextureCache::ImageTextureCache(const int max_memory_mb)
+{
+  /* Don't share the texture system with OSL, so that the memory budget only applies to the
+   * textures of this cache. */
+  texture_system_ = OIIO::TextureSystem::create(false);
+  texture_system_->attribute("automip", 1);
+  texture_system_->attribute("autotile", 64);
+  texture_system_->attribute("gray_to_rgb", 1);
+  texture_system_->attribute("max_memory_MB", max_memory_mb);
+}
+
+ImageTextureCache::~ImageTextureCache()
+{
+  texture_system_->invalidate_all(true);
+#if OIIO_VERSION_MAJOR >= 3
+  OIIO::TextureSystem::destroy(texture_system_);
+  texture_system_.reset();
+#else
+  OIIO::TextureSystem::destroy(texture_system_);
+  texture_system_ = nullptr;
+#endif
+}
+
+unique_ptr<CachedTexture> ImageTextureCache::create_texture(const ustring filepath,
+                                                            const ImageParams &params,
+                                                            const ImageMetaData &metadata)
+{
+  OIIO::TextureSystem::TextureHandle *handle = texture_system_->get_texture_handle(filepath);
+  if (handle == nullptr || !texture_system_->good(handle)) {
+    VLOG_WARNING << "Can't use texture cache for " << filepath.string() << ": "
+                 << texture_system_->geterror();
+    return nullptr;
+  }
+
+#if OIIO_VERSION_MAJOR >= 3
+  OIIO::TextureSystem *texture_system = texture_system_.get();
+#else
+  OIIO::TextureSystem *texture_system = texture_system_;
+#endif
+  return make_unique<OIIOCachedTexture>(texture_system, handle, params, metadata);
+}
+
+void ImageTextureCache::invalidate(const ustring filepath)
+{
+  texture_system_->invalidate(filepath);
+}
+
+void ImageTextureCache::collect_statistics(ImageStats *stats)
+{
+  int64_t tile_lookups = 0;
+  int tiles_created = 0;
+  int64_t bytes_read = 0;
+  int64_t memory_used = 0;
+  texture_system_->getattribute("stat:find_tile_calls", OIIO::TypeDesc::INT64, &tile_lookups);
+  texture_system_->getattribute("stat:tiles_created", OIIO::TypeDesc::INT, &tiles_created);
+  texture_system_->getattribute("stat:bytes_read", OIIO::TypeDesc::INT64, &bytes_read);
+  texture_system_->getattribute("stat:cache_memory_used", OIIO::TypeDesc::INT64, &memory_used);
+
+  stats->use_texture_cache = true;
+  stats->texture_cache_tile_lookups = tile_lookups;
+  /* Every tile that is not found in the cache is created, also when it was freed before. */
+  stats->texture_cache_tile_misses = tiles_created;
+  stats->texture_cache_bytes_read = bytes_read;
+  stats->texture_cache_memory = memory_used;
+}
+
+CCL_NAMESPACE_END
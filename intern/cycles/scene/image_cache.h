@@ -0,0 +1,50 @@
+/* SPDX-FileCopyrightText: 2026 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#pragma once
+
+#include <OpenImageIO/texture.h>
+
+#include "util/param.h"
+#include "util/texture.h"
+#include "util/unique_ptr.h"
+
+CCL_NAMESPACE_BEGIN
+
+class ImageMetaData;
+class ImageParams;
+class ImageStats;
+
+/* On-demand Texture Cache
+ *
+ * Image textures for CPU rendering that are not loaded into memory before rendering. Instead, the
+ * tiles of the required mipmap levels are read from the files on first access from the kernel,
+ * and the least recently used tiles are freed when the memory budget is exceeded. This works best
+ * with tiled and mipmapped files like `.tx` files or tiled OpenEXR files, other files are tiled
+ * and mipmapped when they are opened. */
+class ImageTextureCache {
+ public:
+  explicit ImageTextureCache(const int max_memory_mb);
+  ~ImageTextureCache();
+
+  /* Create a texture that reads its pixels from the file on demand, or return null if the file
+   * can't be opened. */
+  unique_ptr<CachedTexture> create_texture(const ustring filepath,
+                                           const ImageParams &params,
+                                           const ImageMetaData &metadata);
+
+  /* Free cached tiles of the file, in case it changed on disk. */
+  void invalidate(const ustring filepath);
+
+  void collect_statistics(ImageStats *stats);
+
+ private:
+#if OIIO_VERSION_MAJOR >= 3
+  std::shared_ptr<OIIO::TextureSystem> texture_system_;
+#else
+  OIIO::TextureSystem *texture_system_;
+#endif
+};
+
+CCL_NAMESPACE_END
@@ -23,6 +23,7 @@
 #include "util/log.h"
 #include "util/path.h"
 #include "util/progress.h"
+#include "util/time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -189,6 +190,8 @@ LightManager::LightManager()
   last_background_resolution = 0;
 }
 
+LightManager::~LightManager() = default;
+
 bool LightManager::has_background_light(Scene *scene)
 {
   for (Object *object : scene->objects) {
@@ -779,17 +782,45 @@ void LightManager::device_update_tree(Device * /*unused*/,
     return;
   }
 
+  if (light_tree_refit) {
+    const scoped_callback_timer timer([scene](double time) {
+      if (scene->update_stats) {
+        scene->update_stats->light.times.add_entry({"device_update_tree (refit)", time});
+      }
+    });
+
+    progress.set_status("Updating Lights", "Updating tree");
+    if (device_refit_tree(dscene, scene)) {
+      return;
+    }
+    light_tree_refit.reset();
+  }
+
   /* Update light tree. */
   progress.set_status("Updating Lights", "Computing tree");
 
   /* TODO: For now, we'll start with a smaller number of max lights in a node.
    * More benchmarking is needed to determine what number works best. */
   LightTree light_tree(scene, dscene, progress, 8);
-  LightTreeNode *root = light_tree.build(scene, dscene);
+  LightTreeNode *root;
+  {
+    const scoped_callback_timer timer([scene](double time) {
+      if (scene->update_stats) {
+        scene->update_stats->light.times.add_entry({"device_update_tree (build)", time});
+      }
+    });
+    root = light_tree.build(scene, dscene);
+  }
   if (progress.get_cancel()) {
     return;
   }
 
+  const scoped_callback_timer timer([scene](double time) {
+    if (scene->update_stats) {
+      scene->update_stats->light.times.add_entry({"device_update_tree (flatten)", time});
+    }
+  });
+
   /* Create arguments for recursive tree flatten. */
   LightTreeFlatten flatten;
   flatten.scene = scene;
@@ -870,6 +901,133 @@ void LightManager::device_update_tree(Device * /*unused*/,
   dscene->object_to_tree.copy_to_device();
   dscene->object_lookup_offset.copy_to_device();
   dscene->triangle_to_tree.copy_to_device();
+
+  /* Remember the lights, to refit the tree when only their strength changes. */
+  light_tree_refit = make_unique<LightTreeRefit>();
+  light_tree_refit->use_light_linking = use_light_linking;
+  light_tree_refit->light_link_receiver_used = light_tree.light_link_receiver_used;
+  light_tree_refit->lights.reserve(kintegrator->num_lights);
+  int device_light_index = 0;
+  for (Object *object : scene->objects) {
+    if (object->get_geometry()->is_light()) {
+      Light *light = static_cast<Light *>(object->get_geometry());
+      if (light->is_enabled) {
+        light_tree_refit->lights.emplace_back(scene, ~device_light_index, object->index);
+        device_light_index++;
+      }
+    }
+  }
+}
+
+/* Check whether a light only differs in energy from the light in the existing tree. Lights without
+ * energy are not added to the measure of nodes, so the tree must be rebuilt for them. */
+static bool light_tree_emitter_only_energy_changed(const LightTreeEmitter &a,
+                                                   const LightTreeEmitter &b)
+{
+  const LightTreeMeasure &measure_a = a.measure;
+  const LightTreeMeasure &measure_b = b.measure;
+  return a.object_id == b.object_id && a.light_set_membership == b.light_set_membership &&
+         a.centroid == b.centroid && measure_a.bbox.min == measure_b.bbox.min &&
+         measure_a.bbox.max == measure_b.bbox.max &&
+         measure_a.bcone.axis == measure_b.bcone.axis &&
+         measure_a.bcone.theta_o == measure_b.bcone.theta_o &&
+         measure_a.bcone.theta_e == measure_b.bcone.theta_e && !measure_a.is_zero() &&
+         !measure_b.is_zero();
+}
+
+/* Recompute the energy of a flattened node from its children or emitters. */
+static float light_tree_refit_node_energy(KernelLightTreeNode *knodes,
+                                          const KernelLightTreeEmitter *kemitters,
+                                          const int node_index,
+                                          vector<bool> &visited)
+{
+  KernelLightTreeNode &knode = knodes[node_index];
+  if (visited[node_index]) {
+    return knode.energy;
+  }
+  visited[node_index] = true;
+
+  if (knode.type == LIGHT_TREE_INSTANCE) {
+    /* Instances of mesh subtrees only contain triangles, their energy did not change. */
+    return knode.energy;
+  }
+
+  float energy = 0.0f;
+  if (knode.num_emitters == -1) {
+    energy = light_tree_refit_node_energy(knodes, kemitters, knode.inner.left_child, visited) +
+             light_tree_refit_node_energy(knodes, kemitters, knode.inner.right_child, visited);
+  }
+  else {
+    for (int i = 0; i < knode.num_emitters; i++) {
+      energy += kemitters[knode.leaf.first_emitter + i].energy;
+    }
+  }
+
+  knode.energy = energy;
+  return energy;
+}
+
+bool LightManager::device_refit_tree(DeviceScene *dscene, Scene *scene)
+{
+  const KernelIntegrator *kintegrator = &dscene->data.integrator;
+  const vector<LightTreeEmitter> &lights = light_tree_refit->lights;
+  if (lights.size() != kintegrator->num_lights) {
+    return false;
+  }
+
+  /* Compute the new energies, and check that nothing but the energies changed. */
+  vector<LightTreeEmitter> new_lights;
+  new_lights.reserve(lights.size());
+  int device_light_index = 0;
+  for (Object *object : scene->objects) {
+    if (object->get_geometry()->is_light()) {
+      Light *light = static_cast<Light *>(object->get_geometry());
+      if (light->is_enabled) {
+        new_lights.emplace_back(scene, ~device_light_index, object->index);
+        if (!light_tree_emitter_only_energy_changed(lights[device_light_index],
+                                                    new_lights[device_light_index]))
+        {
+          return false;
+        }
+        device_light_index++;
+      }
+    }
+  }
+
+  /* Update the energies of the emitters, and then of the nodes of all trees. */
+  KernelLightTreeEmitter *kemitters = dscene->light_tree_emitters.data();
+  const uint *light_to_tree = dscene->light_to_tree.data();
+  for (int i = 0; i < new_lights.size(); i++) {
+    kemitters[light_to_tree[i]].energy = new_lights[i].measure.energy;
+  }
+
+  KernelLightTreeNode *knodes = dscene->light_tree_nodes.data();
+  vector<bool> visited(dscene->light_tree_nodes.size(), false);
+  if (!light_tree_refit->use_light_linking) {
+    if (!visited.empty()) {
+      light_tree_refit_node_energy(knodes, kemitters, 0, visited);
+    }
+  }
+  else {
+    for (uint64_t tree_index = 0; tree_index < LIGHT_LINK_SET_MAX; tree_index++) {
+      const uint64_t tree_mask = uint64_t(1) << tree_index;
+      if (light_tree_refit->light_link_receiver_used & tree_mask) {
+        light_tree_refit_node_energy(knodes,
+                                     kemitters,
+                                     dscene->data.light_link_sets[tree_index].light_tree_root,
+                                     visited);
+      }
+    }
+  }
+
+  VLOG_INFO << "Refit light tree with " << new_lights.size() << " lights.";
+
+  light_tree_refit->lights = std::move(new_lights);
+
+  dscene->light_tree_nodes.copy_to_device();
+  dscene->light_tree_emitters.copy_to_device();
+
+  return true;
 }
 
 static void background_cdf(int start,
@@ -1379,7 +1537,9 @@ void LightManager::device_update(Device *device,
   /* Detect which lights are enabled, also determines if we need to update the background. */
   test_enabled_lights(scene);
 
-  device_free(device, dscene, need_update_background);
+  /* Keep the light tree when only lights were modified, it may only need new energies. */
+  const bool keep_light_tree = (update_flags == LIGHT_MODIFIED) && light_tree_refit;
+  device_free(device, dscene, need_update_background, !keep_light_tree);
 
   device_update_lights(dscene, scene);
   if (progress.get_cancel()) {
@@ -1414,14 +1574,18 @@ void LightManager::device_update(Device *device,
 
 void LightManager::device_free(Device * /*unused*/,
                                DeviceScene *dscene,
-                               const bool free_background)
+                               const bool free_background,
+                               const bool free_light_tree)
 {
-  dscene->light_tree_nodes.free();
-  dscene->light_tree_emitters.free();
-  dscene->light_to_tree.free();
-  dscene->object_to_tree.free();
-  dscene->object_lookup_offset.free();
-  dscene->triangle_to_tree.free();
+  if (free_light_tree) {
+    dscene->light_tree_nodes.free();
+    dscene->light_tree_emitters.free();
+    dscene->light_to_tree.free();
+    dscene->object_to_tree.free();
+    dscene->object_lookup_offset.free();
+    dscene->triangle_to_tree.free();
+    light_tree_refit.reset();
+  }
 
   dscene->light_distribution.free();
   dscene->lights.free();
@@ -20,6 +20,7 @@ CCL_NAMESPACE_BEGIN
 
 class Device;
 class DeviceScene;
+struct LightTreeRefit;
 class Progress;
 class Scene;
 class Shader;
@@ -101,6 +102,7 @@ class LightManager {
   bool need_update_background;
 
   LightManager();
+  ~LightManager();
 
   /* IES texture management */
   int add_ies(const string &content);
@@ -108,7 +110,10 @@ class LightManager {
   void remove_ies(const int slot);
 
   void device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
-  void device_free(Device *device, DeviceScene *dscene, const bool free_background = true);
+  void device_free(Device *device,
+                   DeviceScene *dscene,
+                   const bool free_background = true,
+                   const bool free_light_tree = true);
 
   void tag_update(Scene *scene, const uint32_t flag);
 
@@ -130,6 +135,8 @@ class LightManager {
                                   Scene *scene,
                                   Progress &progress);
   void device_update_tree(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
+  /* Update the energies of the existing light tree, returns false if the tree must be rebuilt. */
+  bool device_refit_tree(DeviceScene *dscene, Scene *scene);
   void device_update_background(Device *device,
                                 DeviceScene *dscene,
                                 Scene *scene,
@@ -148,6 +155,9 @@ class LightManager {
   bool last_background_enabled;
   int last_background_resolution;
 
+  /* Lights of the light tree on the device, to refit it when only light strengths changed. */
+  unique_ptr<LightTreeRefit> light_tree_refit;
+
   uint32_t update_flags;
 };
 
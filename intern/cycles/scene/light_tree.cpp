@@ -6,8 +6,11 @@
 #include "scene/mesh.h"
 #include "scene/object.h"
 
+#include "util/log.h"
 #include "util/math_fast.h"
 #include "util/progress.h"
+#include "util/tbb.h"
+#include "util/time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -267,14 +270,70 @@ bool LightTree::triangle_usable_as_light(Mesh *mesh, const int prim_id)
   return false;
 }
 
-void LightTree::add_mesh(Scene *scene, Mesh *mesh, const int object_id)
+void LightTree::add_meshes(Scene *scene,
+                           const vector<std::pair<Mesh *, int>> &meshes,
+                           vector<int> &offsets)
 {
-  const size_t mesh_num_triangles = mesh->num_triangles();
-  for (size_t i = 0; i < mesh_num_triangles; i++) {
-    if (triangle_usable_as_light(mesh, i)) {
-      emitters_.emplace_back(scene, i, object_id);
+  /* Split the triangles into chunks, so that a single mesh with many emissive triangles is
+   * processed in parallel too. */
+  struct TriangleChunk {
+    int mesh_index;
+    size_t start;
+    size_t end;
+    int num_emitters;
+  };
+  vector<TriangleChunk> chunks;
+  for (int i = 0; i < meshes.size(); i++) {
+    const size_t mesh_num_triangles = meshes[i].first->num_triangles();
+    for (size_t start = 0; start < mesh_num_triangles; start += MIN_EMITTERS_PER_THREAD) {
+      const size_t end = std::min(start + MIN_EMITTERS_PER_THREAD, mesh_num_triangles);
+      chunks.push_back({i, start, end, 0});
     }
   }
+
+  /* Count the emissive triangles of every chunk. */
+  parallel_for(blocked_range<size_t>(0, chunks.size(), 1), [&](const blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); i++) {
+      TriangleChunk &chunk = chunks[i];
+      Mesh *mesh = meshes[chunk.mesh_index].first;
+      for (size_t prim_id = chunk.start; prim_id < chunk.end; prim_id++) {
+        chunk.num_emitters += triangle_usable_as_light(mesh, prim_id);
+      }
+    }
+  });
+
+  /* Compute where the emitters of every chunk and mesh are stored, in the same order as when
+   * adding the triangles one after another. */
+  vector<int> chunk_offsets(chunks.size());
+  offsets.resize(meshes.size() + 1);
+  int num_emitters = emitters_.size();
+  int mesh_index = 0;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    while (mesh_index <= chunks[i].mesh_index) {
+      offsets[mesh_index++] = num_emitters;
+    }
+    chunk_offsets[i] = num_emitters;
+    num_emitters += chunks[i].num_emitters;
+  }
+  while (mesh_index <= meshes.size()) {
+    offsets[mesh_index++] = num_emitters;
+  }
+
+  /* Create the emitters. */
+  emitters_.resize(num_emitters);
+  parallel_for(blocked_range<size_t>(0, chunks.size(), 1), [&](const blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); i++) {
+      const TriangleChunk &chunk = chunks[i];
+      Mesh *mesh = meshes[chunk.mesh_index].first;
+      const int object_id = meshes[chunk.mesh_index].second;
+      int emitter_index = chunk_offsets[i];
+      for (size_t prim_id = chunk.start; prim_id < chunk.end; prim_id++) {
+        if (triangle_usable_as_light(mesh, prim_id)) {
+          emitters_[emitter_index++] = LightTreeEmitter(scene, prim_id, object_id);
+        }
+      }
+    }
+  });
 }
 
 LightTree::LightTree(Scene *scene,
@@ -342,8 +401,11 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
   int num_local_lights = local_lights_.size() + num_mesh_lights;
   const int num_distant_lights = distant_lights_.size();
 
+  const double start_time = time_dt();
+
   /* Create a node for each mesh light, and keep track of unique mesh lights. */
   std::unordered_map<Mesh *, std::tuple<LightTreeNode *, int, int>> unique_mesh;
+  vector<std::pair<Mesh *, int>> unique_mesh_objects;
   uint *object_offsets = dscene->object_lookup_offset.alloc(scene->objects.size());
   emitters_.reserve(num_triangles + num_local_lights + num_distant_lights);
   for (LightTreeEmitter &emitter : mesh_lights_) {
@@ -353,11 +415,8 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
 
     auto map_it = unique_mesh.find(mesh);
     if (map_it == unique_mesh.end()) {
-      const int start = emitters_.size();
-      add_mesh(scene, mesh, emitter.object_id);
-      const int end = emitters_.size();
-
-      unique_mesh[mesh] = std::make_tuple(emitter.root.get(), start, end);
+      unique_mesh[mesh] = std::make_tuple(emitter.root.get(), 0, 0);
+      unique_mesh_objects.emplace_back(mesh, emitter.object_id);
       emitter.root->object_id = emitter.object_id;
     }
     else {
@@ -366,6 +425,21 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
     object_offsets[emitter.object_id] = offset_map_[mesh];
   }
 
+  /* Gather the emissive triangles of all unique meshes. */
+  vector<int> mesh_offsets;
+  add_meshes(scene, unique_mesh_objects, mesh_offsets);
+  for (int i = 0; i < unique_mesh_objects.size(); i++) {
+    auto &[node, start, end] = unique_mesh[unique_mesh_objects[i].first];
+    start = mesh_offsets[i];
+    end = mesh_offsets[i + 1];
+  }
+
+  const double gather_time = time_dt() - start_time;
+
+  if (progress_.get_cancel()) {
+    return nullptr;
+  }
+
   /* Build a subtree for each unique mesh light. */
   parallel_for_each(unique_mesh, [this](auto &map_it) {
     LightTreeNode *node = std::get<0>(map_it.second);
@@ -446,6 +520,14 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
 
   std::move(distant_lights_.begin(), distant_lights_.end(), std::back_inserter(emitters_));
 
+  VLOG_WORK << "Light tree build statistics:\n"
+            << "  Emitters: " << emitters_.size() << "\n"
+            << "  Emissive triangles: " << num_emissive_triangles << " of "
+            << unique_mesh_objects.size() << " unique meshes\n"
+            << "  Nodes: " << num_nodes << "\n"
+            << "  Emissive triangles gather time: " << gather_time << "\n"
+            << "  Total build time: " << time_dt() - start_time;
+
   return root_.get();
 }
 
@@ -513,6 +595,30 @@ void LightTree::recursive_build(const Child child,
   }
 }
 
+using LightTreeBuckets = std::array<std::array<LightTreeBucket, LightTreeBucket::num_buckets>, 3>;
+
+/* Place the emitters into the buckets of all dimensions, where the centroid box is split into
+ * equal partitions. Along a dimension where the centroid box is 0, all emitters are placed in the
+ * first bucket. */
+static void fill_buckets(const LightTreeEmitter *emitters,
+                         const int start,
+                         const int end,
+                         const BoundBox &centroid_bbox,
+                         const float3 inv_extent,
+                         LightTreeBuckets &buckets)
+{
+  for (int i = start; i < end; i++) {
+    const LightTreeEmitter *emitter = emitters + i;
+    for (int dim = 0; dim < 3; dim++) {
+      int bucket_idx = LightTreeBucket::num_buckets *
+                       (emitter->centroid[dim] - centroid_bbox.min[dim]) * inv_extent[dim];
+      bucket_idx = clamp(bucket_idx, 0, LightTreeBucket::num_buckets - 1);
+
+      buckets[dim][bucket_idx].add(*emitter);
+    }
+  }
+}
+
 bool LightTree::should_split(LightTreeEmitter *emitters,
                              const int start,
                              int &middle,
@@ -533,69 +639,93 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
 
   middle = (start + end) / 2;
 
+  const bool use_parallel = num_emitters > MIN_EMITTERS_PER_THREAD;
+
   BoundBox centroid_bbox = BoundBox::empty;
-  for (int i = start; i < end; i++) {
-    centroid_bbox.grow((emitters + i)->centroid);
+  if (use_parallel) {
+    centroid_bbox = parallel_reduce(
+        blocked_range<int>(start, end, MIN_EMITTERS_PER_THREAD),
+        BoundBox(BoundBox::empty),
+        [emitters](const blocked_range<int> &r, BoundBox bbox) {
+          for (int i = r.begin(); i != r.end(); i++) {
+            bbox.grow(emitters[i].centroid);
+          }
+          return bbox;
+        },
+        [](BoundBox a, const BoundBox &b) {
+          a.grow(b);
+          return a;
+        });
+  }
+  else {
+    for (int i = start; i < end; i++) {
+      centroid_bbox.grow((emitters + i)->centroid);
+    }
   }
 
   const float3 extent = centroid_bbox.size();
   const float max_extent = max4(extent.x, extent.y, extent.z, 0.0f);
+  const float3 inv_extent = make_float3((extent.x == 0.0f) ? 0.0f : 1.0f / extent.x,
+                                        (extent.y == 0.0f) ? 0.0f : 1.0f / extent.y,
+                                        (extent.z == 0.0f) ? 0.0f : 1.0f / extent.z);
+
+  /* Fill in buckets with emitters. Large nodes are split into chunks that are filled in parallel,
+   * and then merged in a fixed order so that the result does not depend on the scheduling. */
+  LightTreeBuckets buckets;
+  if (use_parallel) {
+    const int num_chunks = divide_up(num_emitters, MIN_EMITTERS_PER_THREAD);
+    vector<LightTreeBuckets> chunk_buckets(num_chunks);
+    parallel_for(blocked_range<int>(0, num_chunks, 1), [&](const blocked_range<int> &r) {
+      for (int chunk = r.begin(); chunk != r.end(); chunk++) {
+        const int chunk_start = start + chunk * MIN_EMITTERS_PER_THREAD;
+        const int chunk_end = min(chunk_start + MIN_EMITTERS_PER_THREAD, end);
+        fill_buckets(
+            emitters, chunk_start, chunk_end, centroid_bbox, inv_extent, chunk_buckets[chunk]);
+      }
+    });
+    for (const LightTreeBuckets &chunk : chunk_buckets) {
+      for (int dim = 0; dim < 3; dim++) {
+        for (int i = 0; i < LightTreeBucket::num_buckets; i++) {
+          buckets[dim][i] = buckets[dim][i] + chunk[dim][i];
+        }
+      }
+    }
+  }
+  else {
+    fill_buckets(emitters, start, end, centroid_bbox, inv_extent, buckets);
+  }
 
   /* Check each dimension to find the minimum splitting cost. */
   float total_cost = 0.0f;
   float min_cost = FLT_MAX;
   for (int dim = 0; dim < 3; dim++) {
-    std::array<LightTreeBucket, LightTreeBucket::num_buckets> buckets;
-    float inv_extent;
-
-    if (centroid_bbox.size()[dim] == 0.0f) {
-      /* If the centroid bounding box is 0 along a given dimension and the node measure is
-       * already computed, skip it. */
-      if (dim != 0) {
-        continue;
-      }
-
-      /* Degenerate case, everything in the same bucket. */
-      inv_extent = FLT_MAX;
-      for (int i = start; i < end; i++) {
-        buckets[0].add(emitters[i]);
-      }
-    }
-    else {
-      /* Fill in buckets with emitters. */
-      inv_extent = 1 / (centroid_bbox.size()[dim]);
-      for (int i = start; i < end; i++) {
-        const LightTreeEmitter *emitter = emitters + i;
-
-        /* Place emitter into the appropriate bucket, where the centroid box is split into equal
-         * partitions. */
-        int bucket_idx = LightTreeBucket::num_buckets *
-                         (emitter->centroid[dim] - centroid_bbox.min[dim]) * inv_extent;
-        bucket_idx = clamp(bucket_idx, 0, LightTreeBucket::num_buckets - 1);
-
-        buckets[bucket_idx].add(*emitter);
-      }
+    /* If the centroid bounding box is 0 along a given dimension and the node measure is
+     * already computed, skip it. */
+    if (extent[dim] == 0.0f && dim != 0) {
+      continue;
     }
 
+    const std::array<LightTreeBucket, LightTreeBucket::num_buckets> &dim_buckets = buckets[dim];
+
     /* Precompute the left bucket measure cumulatively. */
     std::array<LightTreeBucket, LightTreeBucket::num_buckets - 1> left_buckets;
-    left_buckets.front() = buckets.front();
+    left_buckets.front() = dim_buckets.front();
     for (int i = 1; i < LightTreeBucket::num_buckets - 1; i++) {
-      left_buckets[i] = left_buckets[i - 1] + buckets[i];
+      left_buckets[i] = left_buckets[i - 1] + dim_buckets[i];
     }
 
     if (dim == 0) {
       /* Calculate node measure by summing up the bucket measure. */
-      measure = left_buckets.back().measure + buckets.back().measure;
-      light_link = left_buckets.back().light_link + buckets.back().light_link;
+      measure = left_buckets.back().measure + dim_buckets.back().measure;
+      light_link = left_buckets.back().light_link + dim_buckets.back().light_link;
 
       /* Degenerate case with co-located emitters. */
-      if (is_zero(centroid_bbox.size())) {
+      if (is_zero(extent)) {
         break;
       }
 
       /* If the centroid bounding box is 0 along a given dimension, skip it. */
-      if (centroid_bbox.size()[dim] == 0.0f) {
+      if (extent[dim] == 0.0f) {
         continue;
       }
 
@@ -607,13 +737,13 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
 
     /* Precompute the right bucket measure cumulatively. */
     std::array<LightTreeBucket, LightTreeBucket::num_buckets - 1> right_buckets;
-    right_buckets.back() = buckets.back();
+    right_buckets.back() = dim_buckets.back();
     for (int i = LightTreeBucket::num_buckets - 3; i >= 0; i--) {
-      right_buckets[i] = right_buckets[i + 1] + buckets[i + 1];
+      right_buckets[i] = right_buckets[i + 1] + dim_buckets[i + 1];
     }
 
     /* Calculate the cost of splitting at each point between partitions. */
-    const float regularization = max_extent * inv_extent;
+    const float regularization = max_extent * inv_extent[dim];
     for (int split = 0; split < LightTreeBucket::num_buckets - 1; split++) {
       const float left_cost = left_buckets[split].measure.calculate();
       const float right_cost = right_buckets[split].measure.calculate();
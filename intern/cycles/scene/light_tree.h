@@ -196,6 +196,8 @@ struct LightTreeEmitter {
 
   LightTreeMeasure measure;
 
+  /* Uninitialized emitter, to be assigned after allocating emitters for parallel construction. */
+  LightTreeEmitter() = default;
   LightTreeEmitter(Object *object, const int object_id); /* Mesh emitter. */
   LightTreeEmitter(Scene *scene,
                    const int prim_id,
@@ -459,8 +461,22 @@ class LightTree {
   /* Check whether the light tree can use this triangle as light-emissive. */
   bool triangle_usable_as_light(Mesh *mesh, const int prim_id);
 
-  /* Add all the emissive triangles of a mesh to the light tree. */
-  void add_mesh(Scene *scene, Mesh *mesh, const int object_id);
+  /* Add all the emissive triangles of the meshes to the light tree, gathered in parallel. The
+   * emitters of the i-th mesh are stored in the range `[offsets[i], offsets[i + 1])`. */
+  void add_meshes(Scene *scene,
+                  const vector<std::pair<Mesh *, int>> &meshes,
+                  vector<int> &offsets);
+};
+
+/* Light Tree Refit
+ *
+ * The enabled lights of the last light tree that was built, in device light order. When nothing
+ * but the strength of lights changed since, the energies of the flattened tree are updated instead
+ * of building a new tree. */
+struct LightTreeRefit {
+  vector<LightTreeEmitter> lights;
+  bool use_light_linking = false;
+  uint64_t light_link_receiver_used = 1;
 };
 
 CCL_NAMESPACE_END
@@ -72,6 +72,11 @@ class SceneParams {
   CurveShapeType hair_shape;
   int texture_limit;
 
+  /* Read image textures on demand during CPU rendering instead of loading them upfront, with
+   * the given memory budget in megabytes. */
+  bool use_texture_cache;
+  int texture_cache_size;
+
   bool background;
 
   SceneParams()
@@ -86,6 +91,8 @@ class SceneParams {
     hair_subdivisions = 3;
     hair_shape = CURVE_RIBBON;
     texture_limit = 0;
+    use_texture_cache = false;
+    texture_cache_size = 4096;
     background = true;
   }
 
@@ -98,7 +105,9 @@ class SceneParams {
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             texture_limit == params.texture_limit);
+             texture_limit == params.texture_limit &&
+             use_texture_cache == params.use_texture_cache &&
+             texture_cache_size == params.texture_cache_size);
   }
 
   int curve_subdivisions()
@@ -362,6 +362,26 @@ void ImageTextureNode::attributes(Shader *shader, AttributeRequestSet *attribute
   ShaderNode::attributes(shader, attributes);
 }
 
+/* Check if the texture coordinates are the default UV map without any transformation, so that
+ * the differentials of the UV map can be used for mipmapping. */
+static bool image_vector_is_default_uv(ShaderInput *vector_in, TextureMapping &tex_mapping)
+{
+  if (!vector_in->link || !tex_mapping.skip()) {
+    return false;
+  }
+
+  ShaderNode *node = vector_in->link->parent;
+  if (node->type == UVMapNode::get_node_type()) {
+    const UVMapNode *uvmap = (const UVMapNode *)node;
+    return uvmap->get_attribute().empty() && !uvmap->get_from_dupli();
+  }
+  if (node->type == TextureCoordinateNode::get_node_type()) {
+    const TextureCoordinateNode *texco = (const TextureCoordinateNode *)node;
+    return vector_in->link == node->output("UV") && !texco->get_from_dupli();
+  }
+  return false;
+}
+
 void ImageTextureNode::compile(SVMCompiler &compiler)
 {
   ShaderInput *vector_in = input("Vector");
@@ -393,6 +413,11 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
       flags |= NODE_IMAGE_ALPHA_UNASSOCIATE;
     }
   }
+  if (compiler.scene->image_manager->use_texture_cache() &&
+      projection == NODE_IMAGE_PROJ_FLAT && image_vector_is_default_uv(vector_in, tex_mapping))
+  {
+    flags |= NODE_IMAGE_UV_DIFFERENTIALS;
+  }
 
   if (projection != NODE_IMAGE_PROJ_BOX) {
     /* If there only is one image (a very common case), we encode it as a negative value. */
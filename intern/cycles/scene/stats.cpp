@@ -222,6 +222,26 @@ string ImageStats::full_report(const int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result;
   result += indent + "Textures:\n" + textures.full_report(indent_level + 1);
+  if (use_texture_cache) {
+    const string child_indent((indent_level + 1) * kIndentNumSpaces, ' ');
+    const double hit_rate = (texture_cache_tile_lookups > 0) ?
+                                1.0 - double(texture_cache_tile_misses) /
+                                          double(texture_cache_tile_lookups) :
+                                1.0;
+    result += indent + "Texture cache:\n";
+    result += string_printf("%sTile lookups: %s\n",
+                            child_indent.c_str(),
+                            string_human_readable_number(texture_cache_tile_lookups).c_str());
+    result += string_printf("%sHit rate: %.2f%%\n", child_indent.c_str(), hit_rate * 100.0);
+    result += string_printf("%sBytes read: %s (%s)\n",
+                            child_indent.c_str(),
+                            string_human_readable_size(texture_cache_bytes_read).c_str(),
+                            string_human_readable_number(texture_cache_bytes_read).c_str());
+    result += string_printf("%sMemory: %s (%s)\n",
+                            child_indent.c_str(),
+                            string_human_readable_size(texture_cache_memory).c_str(),
+                            string_human_readable_number(texture_cache_memory).c_str());
+  }
   return result;
 }
 
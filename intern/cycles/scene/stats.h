@@ -157,6 +157,13 @@ class ImageStats {
   string full_report(const int indent_level = 0);
 
   NamedSizeStats textures;
+
+  /* Statistics of the on-demand texture cache, for images that are not in #textures. */
+  bool use_texture_cache = false;
+  int64_t texture_cache_tile_lookups = 0;
+  int64_t texture_cache_tile_misses = 0;
+  int64_t texture_cache_bytes_read = 0;
+  int64_t texture_cache_memory = 0;
 };
 
 /* Render process statistics. */
@@ -319,7 +319,10 @@ TileManager::TileManager()
                            to_string(tile_manager_id);
 }
 
-TileManager::~TileManager() = default;
+TileManager::~TileManager()
+{
+  finish_queued_tile_writes();
+}
 
 int TileManager::compute_render_tile_size(const int suggested_tile_size) const
 {
@@ -467,6 +470,10 @@ bool TileManager::open_tile_output()
 
   write_state_.num_tiles_written = 0;
 
+  queued_write_state_.stop = false;
+  queued_write_state_.error = false;
+  queued_write_state_.write_thread = make_unique<thread>([this]() { tile_write_thread_run(); });
+
   VLOG_WORK << "Opened tile file " << write_state_.filename;
 
   return true;
@@ -478,6 +485,8 @@ bool TileManager::close_tile_output()
     return true;
   }
 
+  const bool write_success = finish_queued_tile_writes();
+
   const bool success = write_state_.tile_out->close();
   write_state_.tile_out = nullptr;
 
@@ -486,6 +495,10 @@ bool TileManager::close_tile_output()
     return false;
   }
 
+  if (!write_success) {
+    return false;
+  }
+
   VLOG_WORK << "Tile output is closed.";
 
   return true;
@@ -505,76 +518,143 @@ bool TileManager::write_tile(const RenderBuffers &tile_buffers)
 
   const BufferParams &tile_params = tile_buffers.params;
 
-  const int tile_x = tile_params.full_x - buffer_params_.full_x + tile_params.window_x;
-  const int tile_y = tile_params.full_y - buffer_params_.full_y + tile_params.window_y;
+  TileWrite tile_write;
+  tile_write.x = tile_params.full_x - buffer_params_.full_x + tile_params.window_x;
+  tile_write.y = tile_params.full_y - buffer_params_.full_y + tile_params.window_y;
+  tile_write.width = tile_params.window_width;
+  tile_write.height = tile_params.window_height;
+  tile_write.pass_stride = tile_params.pass_stride;
+
+  /* Reserve a place in the queue before copying the pixels, so that no more than
+   * MAX_QUEUED_TILE_WRITES copies of tiles exist at the same time. */
+  {
+    thread_scoped_lock lock(queued_write_state_.mutex);
+    queued_write_state_.cond.wait(lock, [this]() {
+      return queued_write_state_.queue.size() + queued_write_state_.num_reserved <
+                 MAX_QUEUED_TILE_WRITES ||
+             queued_write_state_.error;
+    });
+    if (queued_write_state_.error) {
+      LOG(ERROR) << "Error writing tile, not writing any more tiles.";
+      return false;
+    }
+    ++queued_write_state_.num_reserved;
+  }
 
   const int64_t pass_stride = tile_params.pass_stride;
   const int64_t tile_row_stride = tile_params.width * pass_stride;
 
-  vector<float> pixel_storage;
   const float *pixels = tile_buffers.buffer.data() + tile_params.window_x * pass_stride +
                         tile_params.window_y * tile_row_stride;
 
-  /* If there is an overscan used for the tile copy pixels into single continuous block of memory
-   * without any "gaps".
-   * This is a workaround for bug in OIIO (https://github.com/OpenImageIO/oiio/pull/3176).
-   * Our task reference: #93008. */
-  if (tile_params.window_x || tile_params.window_y ||
-      tile_params.window_width != tile_params.width ||
-      tile_params.window_height != tile_params.height)
-  {
-    pixel_storage.resize(pass_stride * tile_params.window_width * tile_params.window_height);
-    float *pixels_continuous = pixel_storage.data();
+  /* Copy pixels into single continuous block of memory, so that the render buffers can be re-used
+   * while the tile is written.
+   * Having no "gaps" from the overscan is also a workaround for bug in OIIO
+   * (https://github.com/OpenImageIO/oiio/pull/3176). Our task reference: #93008. */
+  tile_write.pixels.resize(pass_stride * tile_params.window_width * tile_params.window_height);
+  float *pixels_continuous = tile_write.pixels.data();
 
-    const int64_t pixels_row_stride = pass_stride * tile_params.width;
-    const int64_t pixels_continuous_row_stride = pass_stride * tile_params.window_width;
+  const int64_t pixels_continuous_row_stride = pass_stride * tile_params.window_width;
 
-    for (int i = 0; i < tile_params.window_height; ++i) {
-      memcpy(pixels_continuous, pixels, sizeof(float) * pixels_continuous_row_stride);
-      pixels += pixels_row_stride;
-      pixels_continuous += pixels_continuous_row_stride;
-    }
+  for (int i = 0; i < tile_params.window_height; ++i) {
+    memcpy(pixels_continuous, pixels, sizeof(float) * pixels_continuous_row_stride);
+    pixels += tile_row_stride;
+    pixels_continuous += pixels_continuous_row_stride;
+  }
+
+  VLOG_WORK << "Queue tile at " << tile_write.x << ", " << tile_write.y << " for writing";
 
-    pixels = pixel_storage.data();
-  }
-
-  VLOG_WORK << "Write tile at " << tile_x << ", " << tile_y;
-
-  /* The image tile sizes in the OpenEXR file are different from the size of our big tiles. The
-   * write_tiles() method expects a contiguous image region that will be split into tiles
-   * internally. OpenEXR expects the size of this region to be a multiple of the tile size,
-   * however OpenImageIO automatically adds the required padding.
-   *
-   * The only thing we have to ensure is that the tile_x and tile_y are a multiple of the
-   * image tile size, which happens in compute_render_tile_size. */
-
-  const int64_t xstride = pass_stride * sizeof(float);
-  const int64_t ystride = xstride * tile_params.window_width;
-  const int64_t zstride = ystride * tile_params.window_height;
-
-  if (!write_state_.tile_out->write_tiles(tile_x,
-                                          tile_x + tile_params.window_width,
-                                          tile_y,
-                                          tile_y + tile_params.window_height,
-                                          0,
-                                          1,
-                                          TypeDesc::FLOAT,
-                                          pixels,
-                                          xstride,
-                                          ystride,
-                                          zstride))
   {
-    LOG(ERROR) << "Error writing tile " << write_state_.tile_out->geterror();
-    return false;
+    thread_scoped_lock lock(queued_write_state_.mutex);
+    --queued_write_state_.num_reserved;
+    queued_write_state_.queue.push_back(std::move(tile_write));
   }
+  queued_write_state_.cond.notify_all();
 
   ++write_state_.num_tiles_written;
 
-  VLOG_WORK << "Tile written in " << time_dt() - time_start << " seconds.";
+  VLOG_WORK << "Tile queued in " << time_dt() - time_start << " seconds.";
 
   return true;
 }
 
+void TileManager::tile_write_thread_run()
+{
+  thread_scoped_lock lock(queued_write_state_.mutex);
+
+  while (true) {
+    queued_write_state_.cond.wait(lock, [this]() {
+      return queued_write_state_.stop || !queued_write_state_.queue.empty();
+    });
+    if (queued_write_state_.queue.empty()) {
+      /* Stop was requested and all tiles are written. */
+      return;
+    }
+
+    /* The tile stays in the queue while it is written, so that it is counted for the limit of
+     * queued tiles. References to it are not invalidated by adding more tiles. */
+    const TileWrite &tile_write = queued_write_state_.queue.front();
+    lock.unlock();
+
+    const double time_start = time_dt();
+
+    VLOG_WORK << "Write tile at " << tile_write.x << ", " << tile_write.y;
+
+    /* The image tile sizes in the OpenEXR file are different from the size of our big tiles. The
+     * write_tiles() method expects a contiguous image region that will be split into tiles
+     * internally. OpenEXR expects the size of this region to be a multiple of the tile size,
+     * however OpenImageIO automatically adds the required padding.
+     *
+     * The only thing we have to ensure is that the tile_x and tile_y are a multiple of the
+     * image tile size, which happens in compute_render_tile_size. */
+
+    const int64_t xstride = tile_write.pass_stride * sizeof(float);
+    const int64_t ystride = xstride * tile_write.width;
+    const int64_t zstride = ystride * tile_write.height;
+
+    const bool success = write_state_.tile_out->write_tiles(tile_write.x,
+                                                            tile_write.x + tile_write.width,
+                                                            tile_write.y,
+                                                            tile_write.y + tile_write.height,
+                                                            0,
+                                                            1,
+                                                            TypeDesc::FLOAT,
+                                                            tile_write.pixels.data(),
+                                                            xstride,
+                                                            ystride,
+                                                            zstride);
+    if (success) {
+      VLOG_WORK << "Tile written in " << time_dt() - time_start << " seconds.";
+    }
+    else {
+      LOG(ERROR) << "Error writing tile " << write_state_.tile_out->geterror();
+    }
+
+    lock.lock();
+    queued_write_state_.queue.pop_front();
+    queued_write_state_.error |= !success;
+    queued_write_state_.cond.notify_all();
+  }
+}
+
+bool TileManager::finish_queued_tile_writes()
+{
+  if (!queued_write_state_.write_thread) {
+    return true;
+  }
+
+  {
+    thread_scoped_lock lock(queued_write_state_.mutex);
+    queued_write_state_.stop = true;
+  }
+  queued_write_state_.cond.notify_all();
+
+  queued_write_state_.write_thread->join();
+  queued_write_state_.write_thread.reset();
+
+  return !queued_write_state_.error;
+}
+
 void TileManager::finish_write_tiles()
 {
   if (!write_state_.tile_out) {
@@ -583,6 +663,11 @@ void TileManager::finish_write_tiles()
     return;
   }
 
+  /* Wait for the queued tiles, the file handle is not shared with the tile writing thread. */
+  if (!finish_queued_tile_writes()) {
+    LOG(ERROR) << "Error writing tiles to file " << write_state_.filename;
+  }
+
   /* EXR expects all tiles to present in file. So explicitly write missing tiles as all-zero. */
   if (write_state_.num_tiles_written < tile_state_.num_tiles) {
     vector<float> pixel_storage(tile_size_.x * tile_size_.y * buffer_params_.pass_stride);
@@ -625,40 +710,91 @@ void TileManager::finish_write_tiles()
   write_state_.filename = "";
 }
 
-bool TileManager::read_full_buffer_from_disk(const string_view filename,
-                                             RenderBuffers *buffers,
+bool TileManager::open_full_buffer_from_disk(const string_view filename,
+                                             BufferParams *buffer_params,
                                              DenoiseParams *denoise_params)
 {
-  unique_ptr<ImageInput> in(ImageInput::open(filename));
-  if (!in) {
+  read_state_.tile_in = ImageInput::open(filename);
+  if (!read_state_.tile_in) {
     LOG(ERROR) << "Error opening tile file " << filename;
     return false;
   }
 
-  const ImageSpec &image_spec = in->spec();
+  const ImageSpec &image_spec = read_state_.tile_in->spec();
 
-  BufferParams buffer_params;
-  if (!buffer_params_from_image_spec_atttributes(&buffer_params, image_spec)) {
+  if (!buffer_params_from_image_spec_atttributes(buffer_params, image_spec)) {
     return false;
   }
-  buffers->reset(buffer_params);
 
   if (!node_from_image_spec_atttributes(denoise_params, image_spec, ATTR_DENOISE_SOCKET_PREFIX)) {
     return false;
   }
 
-  const int num_channels = in->spec().nchannels;
-  if (!in->read_image(0, 0, 0, num_channels, TypeDesc::FLOAT, buffers->buffer.data())) {
-    LOG(ERROR) << "Error reading pixels from the tile file " << in->geterror();
-    return false;
+  return true;
+}
+
+int TileManager::get_full_buffer_band_alignment() const
+{
+  DCHECK(read_state_.tile_in);
+
+  /* Tiles can only be read as a whole, scan-lines one by one. */
+  const ImageSpec &image_spec = read_state_.tile_in->spec();
+  return max(image_spec.tile_height, 1);
+}
+
+bool TileManager::read_full_buffer_band_from_disk(const int y, RenderBuffers *buffers)
+{
+  DCHECK(read_state_.tile_in);
+
+  ImageInput *in = read_state_.tile_in.get();
+  const ImageSpec &image_spec = in->spec();
+
+  DCHECK_EQ(buffers->params.width, image_spec.width);
+  DCHECK_LE(y + buffers->params.height, image_spec.height);
+
+  const int num_channels = image_spec.nchannels;
+  const int y_begin = image_spec.y + y;
+  const int y_end = y_begin + buffers->params.height;
+
+  bool success;
+  if (image_spec.tile_width != 0) {
+    success = in->read_tiles(0,
+                             0,
+                             image_spec.x,
+                             image_spec.x + image_spec.width,
+                             y_begin,
+                             y_end,
+                             0,
+                             1,
+                             0,
+                             num_channels,
+                             TypeDesc::FLOAT,
+                             buffers->buffer.data());
+  }
+  else {
+    success = in->read_scanlines(
+        0, 0, y_begin, y_end, 0, 0, num_channels, TypeDesc::FLOAT, buffers->buffer.data());
   }
 
-  if (!in->close()) {
-    LOG(ERROR) << "Error closing tile file " << in->geterror();
+  if (!success) {
+    LOG(ERROR) << "Error reading pixels from the tile file " << in->geterror();
     return false;
   }
 
   return true;
 }
 
+void TileManager::close_full_buffer_from_disk()
+{
+  if (!read_state_.tile_in) {
+    return;
+  }
+
+  if (!read_state_.tile_in->close()) {
+    LOG(ERROR) << "Error closing tile file " << read_state_.tile_in->geterror();
+  }
+
+  read_state_.tile_in.reset();
+}
+
 CCL_NAMESPACE_END
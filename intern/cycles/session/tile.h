@@ -8,9 +8,12 @@
 
 #include "session/buffers.h"
 
+#include "util/deque.h"
 #include "util/image.h"
 #include "util/string.h"
+#include "util/thread.h"
 #include "util/unique_ptr.h"
+#include "util/vector.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -85,9 +88,11 @@ class TileManager {
 
   /* Write render buffer of a tile to a file on disk.
    *
-   * Opens file for write when first tile is written.
+   * Opens file for write when first tile is written. The pixels are copied and written from a
+   * separate thread, so the tile buffers can be re-used as soon as this function returns. When
+   * too many tiles are waiting to be written, this function blocks until one of them is written.
    *
-   * Returns true on success. */
+   * Returns true on success. An error of writing a previous tile is reported by the next call. */
   bool write_tile(const RenderBuffers &tile_buffers);
 
   /* Inform the tile manager that no more tiles will be written to disk.
@@ -100,19 +105,38 @@ class TileManager {
     return write_state_.num_tiles_written != 0;
   }
 
-  /* Read full frame render buffer from tiles file on disk.
+  /* Open tiles file on disk for reading the full frame render buffer band by band.
    *
-   * Returns true on success. */
-  bool read_full_buffer_from_disk(string_view filename,
-                                  RenderBuffers *buffers,
+   * The parameters of the full frame buffer and of the denoiser are read from the file metadata,
+   * no pixels are read yet. Returns true on success. */
+  bool open_full_buffer_from_disk(string_view filename,
+                                  BufferParams *buffer_params,
                                   DenoiseParams *denoise_params);
 
+  /* Number of rows which the start of bands read by `read_full_buffer_band_from_disk()` is to be
+   * aligned to. Bands also need to end on a multiple of it, or at the end of the buffer. */
+  int get_full_buffer_band_alignment() const;
+
+  /* Read rows [y, y + height) of the full frame render buffer from the file opened by
+   * `open_full_buffer_from_disk()`, where height is the height of the given buffers. The buffers
+   * are to be allocated with the width and passes of the full frame buffer.
+   *
+   * Returns true on success. */
+  bool read_full_buffer_band_from_disk(int y, RenderBuffers *buffers);
+
+  /* Close the file opened by `open_full_buffer_from_disk()`. */
+  void close_full_buffer_from_disk();
+
   /* Compute valid tile size compatible with image saving. */
   int compute_render_tile_size(const int suggested_tile_size) const;
 
   /* Tile size in the image file. */
   static const int IMAGE_TILE_SIZE = 128;
 
+  /* Maximum number of tiles which are waiting to be written to disk. Limits the memory used for
+   * copies of tile pixels when writing is slower than rendering. */
+  static const int MAX_QUEUED_TILE_WRITES = 2;
+
   /* Maximum supported tile size.
    * Needs to be safe from allocation on a GPU point of view: the display driver needs to be able
    * to allocate texture with the side size of this value.
@@ -127,6 +151,11 @@ class TileManager {
   bool open_tile_output();
   bool close_tile_output();
 
+  /* Write all queued tiles and stop the tile writing thread.
+   * Returns false if writing of any of the tiles failed. */
+  bool finish_queued_tile_writes();
+  void tile_write_thread_run();
+
   string temp_dir_;
 
   /* Part of an on-disk tile file name which avoids conflicts between several Cycles instances or
@@ -176,6 +205,35 @@ class TileManager {
 
     int num_tiles_written = 0;
   } write_state_;
+
+  /* State of reading the full frame render buffer from a file on disk. */
+  struct {
+    unique_ptr<ImageInput> tile_in;
+  } read_state_;
+
+  /* Tile pixels which are waiting to be written to the file. */
+  struct TileWrite {
+    int x, y;
+    int width, height;
+    int pass_stride;
+    vector<float> pixels;
+  };
+
+  /* State of the thread which writes tiles to the file on disk. The output handle is only
+   * accessed by this thread while it is running. */
+  struct {
+    unique_ptr<thread> write_thread;
+    thread_mutex mutex;
+    thread_condition_variable cond;
+
+    /* The first tile in the queue is the one being written. */
+    deque<TileWrite> queue;
+    /* Places in the queue for tiles which are being copied and not queued yet. */
+    size_t num_reserved = 0;
+
+    bool stop = false;
+    bool error = false;
+  } queued_write_state_;
 };
 
 CCL_NAMESPACE_END
@@ -0,0 +1,139 @@
+/* SPDX-FileCopyrightText: 2026 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <sstream>
+
+#include <OpenImageIO/filesystem.h>
+#include <OpenImageIO/imageio.h>
+
+#ifdef WITH_OCIO
+#  include <OpenColorIO/OpenColorIO.h>
+#endif
+
+#include "scene/colorspace.h"
+#include "scene/image.h"
+#include "scene/image_cache.h"
+#include "scene/image_oiio.h"
+
+#include "util/path.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+static const int image_width = 7;
+static const int image_height = 5;
+
+/* Write an image with different values in every pixel and partially transparent pixels. */
+static string write_test_image()
+{
+  const string filepath = path_join(OIIO::Filesystem::temp_directory_path(),
+                                    "cycles-image-cache-test-" +
+                                        OIIO::Filesystem::unique_path() + ".tif");
+  vector<float> pixels(image_width * image_height * 4);
+  for (int y = 0; y < image_height; y++) {
+    for (int x = 0; x < image_width; x++) {
+      float *pixel = &pixels[(y * image_width + x) * 4];
+      pixel[3] = ((x + y) % 3 == 0) ? 0.5f : 1.0f;
+      pixel[0] = 0.1f * x * pixel[3];
+      pixel[1] = 0.2f * y * pixel[3];
+      pixel[2] = 0.05f * (x + y) * pixel[3];
+    }
+  }
+
+  unique_ptr<OIIO::ImageOutput> out = OIIO::ImageOutput::create(filepath);
+  EXPECT_TRUE(out != nullptr);
+  if (out) {
+    const OIIO::ImageSpec spec(image_width, image_height, 4, OIIO::TypeDesc::FLOAT);
+    EXPECT_TRUE(out->open(filepath, spec));
+    EXPECT_TRUE(out->write_image(OIIO::TypeDesc::FLOAT, pixels.data()));
+    out->close();
+  }
+  return filepath;
+}
+
+/* Compare lookups of the on-demand texture at the pixel centers with the pixels of the same image
+ * loaded fully, the way #ImageManager does it without texture cache. */
+static void test_cached_lookup_same_as_loaded(const ustring colorspace)
+{
+  const string filepath = write_test_image();
+
+  OIIOImageLoader loader(filepath);
+  ImageDeviceFeatures features;
+  features.has_nanovdb = false;
+  ImageMetaData metadata;
+  ASSERT_TRUE(loader.load_metadata(features, metadata));
+  metadata.colorspace = colorspace;
+  metadata.detect_colorspace();
+  EXPECT_EQ(metadata.colorspace, colorspace);
+  ASSERT_EQ(metadata.type, IMAGE_DATA_TYPE_FLOAT4);
+
+  const size_t num_pixels = image_width * image_height;
+  vector<float> pixels(num_pixels * 4);
+  ASSERT_TRUE(loader.load_pixels(metadata, pixels.data(), pixels.size(), true));
+  if (metadata.colorspace != u_colorspace_raw && metadata.colorspace != u_colorspace_srgb) {
+    ColorSpaceManager::to_scene_linear(
+        metadata.colorspace, pixels.data(), num_pixels, true, metadata.compress_as_srgb);
+  }
+
+  ImageParams params;
+  params.interpolation = INTERPOLATION_CLOSEST;
+  params.extension = EXTENSION_EXTEND;
+  params.colorspace = colorspace;
+  {
+    ImageTextureCache texture_cache(64);
+    const unique_ptr<CachedTexture> texture = texture_cache.create_texture(
+        ustring(filepath), params, metadata);
+    ASSERT_TRUE(texture != nullptr);
+
+    const float2 zero = make_float2(0.0f, 0.0f);
+    for (int y = 0; y < image_height; y++) {
+      for (int x = 0; x < image_width; x++) {
+        const float4 value = texture->lookup(
+            (x + 0.5f) / image_width, (y + 0.5f) / image_height, zero, zero);
+        const float *expected = &pixels[(y * image_width + x) * 4];
+        EXPECT_NEAR(value.x, expected[0], 1e-5f) << "x=" << x << " y=" << y;
+        EXPECT_NEAR(value.y, expected[1], 1e-5f) << "x=" << x << " y=" << y;
+        EXPECT_NEAR(value.z, expected[2], 1e-5f) << "x=" << x << " y=" << y;
+        EXPECT_NEAR(value.w, expected[3], 1e-5f) << "x=" << x << " y=" << y;
+      }
+    }
+  }
+
+  OIIO::Filesystem::remove(filepath);
+}
+
+TEST(scene_image_cache, lookup_same_as_loaded)
+{
+  ColorSpaceManager::init_fallback_config();
+  test_cached_lookup_same_as_loaded(u_colorspace_raw);
+}
+
+#ifdef WITH_OCIO
+TEST(scene_image_cache, lookup_same_as_loaded_colorspace)
+{
+  /* A color space that is neither linear nor sRGB, so that the texture cache has to convert the
+   * pixels with OpenColorIO. */
+  std::istringstream config_stream(
+      "ocio_profile_version: 1\n"
+      "roles:\n"
+      "  default: linear\n"
+      "  scene_linear: linear\n"
+      "colorspaces:\n"
+      "  - !<ColorSpace>\n"
+      "    name: linear\n"
+      "  - !<ColorSpace>\n"
+      "    name: cubic\n"
+      "    to_reference: !<ExponentTransform> {value: [3, 3, 3, 1]}\n");
+  OCIO_NAMESPACE::SetCurrentConfig(OCIO_NAMESPACE::Config::CreateFromStream(config_stream));
+
+  test_cached_lookup_same_as_loaded(ustring("cubic"));
+
+  ColorSpaceManager::free_memory();
+  ColorSpaceManager::init_fallback_config();
+}
+#endif
+
+CCL_NAMESPACE_END
@@ -32,6 +32,8 @@ void DebugFlags::CPU::reset()
 #undef CHECK_CPU_FLAGS
 
   bvh_layout = BVH_LAYOUT_AUTO;
+
+  wavefront = (getenv("CYCLES_CPU_WAVEFRONT") != nullptr);
 }
 
 DebugFlags::CUDA::CUDA()
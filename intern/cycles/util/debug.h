@@ -45,6 +45,10 @@ class DebugFlags {
      * CPUs and GPUs can be selected here instead.
      */
     BVHLayout bvh_layout = BVH_LAYOUT_AUTO;
+
+    /* Render batches of paths in lock-step and sort them by the next kernel and shader to
+     * execute, instead of rendering every path to completion one after another. */
+    bool wavefront = false;
   };
 
   /* Descriptor of CUDA feature-set to be used. */
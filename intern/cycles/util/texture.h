@@ -41,6 +41,8 @@ enum ImageDataType {
   IMAGE_DATA_TYPE_NANOVDB_FLOAT3 = 9,
   IMAGE_DATA_TYPE_NANOVDB_FPN = 10,
   IMAGE_DATA_TYPE_NANOVDB_FP16 = 11,
+  /* Pixels are loaded on demand by a #CachedTexture, only supported on the CPU. */
+  IMAGE_DATA_TYPE_CACHED = 12,
 
   IMAGE_DATA_NUM_TYPES
 };
@@ -90,4 +92,17 @@ struct TextureInfo {
   Transform transform_3d = transform_zero();
 };
 
+#ifndef __KERNEL_GPU__
+/* Image texture with pixels that are read from disk on first access, see #ImageTextureCache.
+ * The texture data of #IMAGE_DATA_TYPE_CACHED textures is a pointer to it. */
+class CachedTexture {
+ public:
+  virtual ~CachedTexture() = default;
+
+  /* Filtered lookup at the given texture coordinates. Their derivatives select the mipmap level,
+   * zero derivatives use the full resolution. */
+  virtual float4 lookup(const float x, const float y, const float2 dx, const float2 dy) const = 0;
+};
+#endif
+
 CCL_NAMESPACE_END
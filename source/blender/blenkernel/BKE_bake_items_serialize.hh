@@ -43,6 +43,29 @@ class BlobReader {
    */
   [[nodiscard]] virtual bool read_as_stream(const BlobSlice &slice,
                                             FunctionRef<bool(std::istream &)> fn) const;
+
+  /**
+   * Get the data of the given slice without copying it, if the reader supports that. The caller
+   * takes over a user of the returned sharing info. The data may be modified by its owner when
+   * the sharing info is mutable, which does not affect the stored blob.
+   * \return None if the data has to be read with #read instead.
+   */
+  [[nodiscard]] virtual std::optional<ImplicitSharingInfoAndData> read_shared(
+      const BlobSlice &slice) const;
+};
+
+/**
+ * How large arrays are stored in blobs. Compressed arrays are smaller but always have to be
+ * decompressed when they are read, while uncompressed blobs may be used directly from memory.
+ */
+enum class BlobCompression {
+  None,
+  /**
+   * Use zstd, after preparing the data in a type specific way. The bytes of floats are shuffled
+   * so that e.g. all exponents are stored next to each other. Integers like ids and offsets are
+   * stored as differences to the previous value.
+   */
+  Zstd,
 };
 
 /**
@@ -51,6 +74,7 @@ class BlobReader {
 class BlobWriter {
  protected:
   int64_t total_written_size_ = 0;
+  BlobCompression compression_ = BlobCompression::None;
 
  public:
   virtual ~BlobWriter() = default;
@@ -74,6 +98,16 @@ class BlobWriter {
   {
     return total_written_size_;
   }
+
+  BlobCompression compression() const
+  {
+    return compression_;
+  }
+
+  void set_compression(const BlobCompression compression)
+  {
+    compression_ = compression;
+  }
 };
 
 /**
@@ -164,10 +198,20 @@ class DiskBlobReader : public BlobReader {
   const std::string blobs_dir_;
   mutable std::mutex mutex_;
   mutable Map<std::string, std::unique_ptr<fstream>> open_input_streams_;
+  /**
+   * Memory-mapped blob files that large arrays are referenced from by #read_shared. Each owns a
+   * user of the sharing info, which keeps the mapping alive as long as any data uses it. Null if
+   * the file could not be mapped.
+   */
+  mutable Map<std::string, const ImplicitSharingInfo *> mapped_files_;
 
  public:
   DiskBlobReader(std::string blobs_dir);
+  ~DiskBlobReader() override;
+
   [[nodiscard]] bool read(const BlobSlice &slice, void *r_data) const override;
+  [[nodiscard]] std::optional<ImplicitSharingInfoAndData> read_shared(
+      const BlobSlice &slice) const override;
 };
 
 /**
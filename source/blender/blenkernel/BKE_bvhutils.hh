@@ -9,6 +9,8 @@
  * This header encapsulates necessary code to build a BVH.
  */
 
+#include <atomic>
+
 #include "BLI_index_mask_fwd.hh"
 #include "BLI_kdopbvh.hh"
 #include "BLI_math_vector_types.hh"
@@ -43,6 +45,69 @@ struct BVHTreeFromMesh {
   std::unique_ptr<BVHTree, BVHTreeDeleter> owned_tree;
 };
 
+/**
+ * Trees built for an earlier state of a mesh with the same topology. When only the positions of a
+ * mesh changed, these trees are refit to the new positions instead of building new trees from
+ * scratch. The cache is shared between copies of a mesh until their topology changes (see
+ * #MeshRuntime::bvh_refit_cache), so trees of a freed evaluated mesh can be reused by the mesh
+ * evaluated for the next frame.
+ */
+struct BVHRefitCache {
+  struct Entry {
+    /** Links in the list of all entries with a stored tree, least recently stored first. */
+    Entry *next = nullptr;
+    Entry *prev = nullptr;
+    std::unique_ptr<BVHTree, BVHTreeDeleter> tree;
+    /** #BLI_bvhtree_get_memory_size of #tree. */
+    size_t tree_size = 0;
+    /** #BLI_bvhtree_get_cost_estimate of the last tree built from scratch. */
+    float build_cost = 0.0f;
+    /** Value of #BVHRefitCache::generation when #tree was stored. */
+    uint64_t generation = 0;
+  };
+  /**
+   * Incremented whenever a tree is stored. Meshes remember the value from when they started using
+   * the cache, to know whether they could have reused a stored tree.
+   */
+  std::atomic<uint64_t> generation = 0;
+  Entry verts;
+  Entry edges;
+  Entry corner_tris;
+
+  ~BVHRefitCache();
+};
+
+/**
+ * Store a tree that is not used by its mesh anymore, so that it can be refit for a later state of
+ * the mesh. The memory of all stored trees is limited, the least recently stored trees are freed
+ * when the limit is exceeded.
+ */
+void bvhtree_refit_cache_store(BVHRefitCache &refit_cache,
+                               BVHRefitCache::Entry &entry,
+                               std::unique_ptr<BVHTree, BVHTreeDeleter> tree);
+/**
+ * Free the stored tree, unless it has been stored after #BVHRefitCache::generation had the value
+ * \a generation.
+ */
+void bvhtree_refit_cache_free_stored_before(BVHRefitCache::Entry &entry, uint64_t generation);
+
+/** Statistics of the cached mesh BVH trees, for debugging and benchmarking. */
+struct BVHCacheStats {
+  int64_t build_num = 0;
+  int64_t refit_num = 0;
+  /** Trees that were refit, but then rebuilt because the refit tree was too inefficient. */
+  int64_t degraded_num = 0;
+  /** Trees currently stored for refitting, and their memory size in bytes. */
+  int64_t stored_num = 0;
+  size_t stored_size = 0;
+};
+
+BVHCacheStats bvhtree_cache_stats_get();
+/** Reset the counts of created trees. */
+void bvhtree_cache_stats_reset();
+/** Print the statistics to the console, see #WM_OT_memory_statistics. */
+void bvhtree_cache_stats_print();
+
 /**
  * Builds a BVH-tree where nodes are the given vertices.
  */
@@ -80,6 +145,21 @@ BVHTreeFromMesh bvhtree_from_mesh_edges_init(const Mesh &mesh, const IndexMask &
  */
 BVHTreeFromMesh bvhtree_from_mesh_verts_init(const Mesh &mesh, const IndexMask &verts_mask);
 
+/**
+ * Cast the rays in the mask against the tree, using multiple threads. Rays with neighboring
+ * indices are cast together with #BLI_bvhtree_ray_cast_packet, so coherent rays should have
+ * neighboring indices.
+ *
+ * \param r_hits: The hit of every ray, which has to be initialized like for
+ * #BLI_bvhtree_ray_cast (with the index -1 and the maximum distance of the ray).
+ */
+void bvhtree_ray_cast_batch(const BVHTreeFromMesh &tree_data,
+                            const IndexMask &mask,
+                            Span<float3> origins,
+                            Span<float3> directions,
+                            float radius,
+                            MutableSpan<BVHTreeRayHit> r_hits);
+
 /**
  * Math functions used by callbacks
  */
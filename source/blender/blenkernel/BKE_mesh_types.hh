@@ -8,6 +8,7 @@
  * \ingroup bke
  */
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 
@@ -29,6 +30,7 @@ class ShrinkwrapBoundaryData;
 struct SubdivCCG;
 struct SubsurfRuntimeData;
 namespace blender::bke {
+struct BVHRefitCache;
 struct EditMeshData;
 }  // namespace blender::bke
 namespace blender::bke::bake {
@@ -168,6 +170,15 @@ struct MeshRuntime {
   SharedCache<std::unique_ptr<BVHTree, BVHTreeDeleter>> bvh_cache_loose_verts_no_hidden;
   SharedCache<std::unique_ptr<BVHTree, BVHTreeDeleter>> bvh_cache_loose_edges;
   SharedCache<std::unique_ptr<BVHTree, BVHTreeDeleter>> bvh_cache_loose_edges_no_hidden;
+  /**
+   * Old trees of the caches above that can be refit when only positions change. Shared with
+   * copies of the mesh and replaced when the topology changes.
+   */
+  std::shared_ptr<BVHRefitCache> bvh_refit_cache;
+  /** #BVHRefitCache::generation when this mesh started using #bvh_refit_cache. */
+  uint64_t bvh_refit_generation = 0;
+  /** The mesh was copied since, so the stored trees may still be used by the copies. */
+  std::atomic<bool> bvh_refit_cache_copied = false;
 
   SharedCache<std::optional<int>> max_material_index;
 
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include "BLI_compiler_compat.h"
 
 struct Mesh;
@@ -80,6 +82,7 @@ enum StatsValue {
   SUBDIV_STATS_SUBDIV_TO_CCG,
   SUBDIV_STATS_SUBDIV_TO_CCG_ELEMENTS,
   SUBDIV_STATS_TOPOLOGY_COMPARE,
+  SUBDIV_STATS_SUBDIV_TO_MESH_CACHED,
 
   NUM_SUBDIV_STATS_VALUES,
 };
@@ -105,10 +108,17 @@ struct SubdivStats {
       double subdiv_to_ccg_elements_time;
       /* Time spent on CCG elements evaluation/initialization. */
       double topology_compare_time;
+      /* Total time spent in blender::bke::subdiv::subdiv_to_mesh() when only the positions of the
+       * cached result mesh were updated. */
+      double subdiv_to_mesh_cached_time;
     };
     double values_[NUM_SUBDIV_STATS_VALUES];
   };
 
+  /* Memory used by the cache of the last blender::bke::subdiv::subdiv_to_mesh() result, in
+   * bytes. Not a timing value, so it is not part of the values above. */
+  int64_t mesh_cache_memory;
+
   /* Per-value timestamp on when corresponding stats_begin() was
    * called. */
   double begin_timestamp_[NUM_SUBDIV_STATS_VALUES];
@@ -33,6 +33,26 @@ struct ToMeshSettings {
 /** Create real hi-res mesh from subdivision, all geometry is "real". */
 Mesh *subdiv_to_mesh(Subdiv *subdiv, const ToMeshSettings *settings, const Mesh *coarse_mesh);
 
+/**
+ * Result of a previous #subdiv_to_mesh call, together with the limit surface coordinates of all
+ * its vertices. This allows to only evaluate the vertex positions again when the coarse mesh is
+ * deformed, which is common for animated characters.
+ */
+struct ToMeshCache;
+
+ToMeshCache *to_mesh_cache_new();
+void to_mesh_cache_free(ToMeshCache *cache);
+
+/**
+ * Same as above, but reuses the topology and the interpolated attributes of the result that is
+ * stored in the \a cache when only the positions of the coarse mesh changed since then. The
+ * cache is updated whenever the full subdivided mesh has to be created.
+ */
+Mesh *subdiv_to_mesh(Subdiv *subdiv,
+                     const ToMeshSettings *settings,
+                     const Mesh *coarse_mesh,
+                     ToMeshCache &cache);
+
 /**
  * Interpolate a position along the `coarse_edge` at the relative `u` coordinate.
  * If `is_simple` is false, this will perform a B-Spline interpolation using the edge neighbors,
@@ -22,6 +22,7 @@ struct SubsurfModifierData;
 namespace blender::bke::subdiv {
 struct Subdiv;
 struct Settings;
+struct ToMeshCache;
 }  // namespace blender::bke::subdiv
 
 /* Runtime subsurf modifier data, cached in modifier on evaluated meshes. */
@@ -33,6 +34,9 @@ struct SubsurfRuntimeData {
   blender::bke::subdiv::Subdiv *subdiv_cpu;
   blender::bke::subdiv::Subdiv *subdiv_gpu;
 
+  /* Cached result of the CPU evaluation, to only update positions when the input is deformed. */
+  blender::bke::subdiv::ToMeshCache *mesh_cache;
+
   /* Recent usage markers for UI diagnostics. To avoid UI flicker due to races
    * between evaluation and UI redraw, they are set to 2 when an evaluator is used,
    * and count down every frame. */
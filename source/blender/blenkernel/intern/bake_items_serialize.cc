@@ -18,8 +18,10 @@
 #include "BLI_endian_switch.h"
 #include "BLI_listbase.h"
 #include "BLI_math_matrix_types.hh"
+#include "BLI_mmap.h"
 #include "BLI_path_utils.hh"
 #include "BLI_string.h"
+#include "BLI_task.hh"
 
 #include "DNA_object_types.h"
 #include "DNA_volume_types.h"
@@ -27,9 +29,17 @@
 #include "RNA_access.hh"
 #include "RNA_enum_types.hh"
 
+#include "CLG_log.h"
+
+#include <fcntl.h>
 #include <fmt/format.h>
 #include <sstream>
 #include <xxhash.h>
+#include <zstd.h>
+
+#ifndef WIN32
+#  include <unistd.h>
+#endif
 
 #ifdef WITH_OPENVDB
 #  include <openvdb/io/Stream.h>
@@ -38,6 +48,8 @@
 #  include "BKE_volume_grid.hh"
 #endif
 
+static CLG_LogRef LOG = {"bke.bake"};
+
 namespace blender::bke::bake {
 
 using namespace io::serialize;
@@ -88,8 +100,79 @@ bool BlobReader::read_as_stream(const BlobSlice &slice, FunctionRef<bool(std::is
   return true;
 }
 
+std::optional<ImplicitSharingInfoAndData> BlobReader::read_shared(
+    const BlobSlice & /*slice*/) const
+{
+  return std::nullopt;
+}
+
+/** Smaller arrays are always copied, referencing them in a mapped file does not save much. */
+static constexpr int64_t mapped_blob_min_size = 1 << 16;
+/** Arrays are aligned in blob files, so that they can be used directly from a mapped file. */
+static constexpr int64_t blob_alignment = 16;
+
+/**
+ * Owns a memory-mapped blob file. It is freed when neither the reader nor loaded data use it.
+ *
+ * Baking again replaces blob files instead of writing into them, so loaded data is not affected.
+ * When another program truncates the file, the pages that can't be read anymore are replaced
+ * with zeros (see #BLI_mmap_has_io_error) instead of crashing.
+ */
+class MappedBlobFileSharingInfo : public ImplicitSharingInfo {
+ public:
+  BLI_mmap_file *mmap_file;
+  std::string path;
+
+  MappedBlobFileSharingInfo(BLI_mmap_file *mmap_file, std::string path)
+      : mmap_file(mmap_file), path(std::move(path))
+  {
+  }
+
+  MEM_CXX_CLASS_ALLOC_FUNCS("MappedBlobFileSharingInfo");
+
+ private:
+  void delete_self_with_data() override
+  {
+    if (BLI_mmap_has_io_error(mmap_file)) {
+      CLOG_ERROR(&LOG, "Baked data in '%s' was lost, the file was changed", path.c_str());
+    }
+    BLI_mmap_free(mmap_file);
+    delete this;
+  }
+};
+
+/** Owns a single array that is part of a memory-mapped blob file. */
+class MappedBlobDataSharingInfo : public ImplicitSharingInfo {
+ private:
+  const MappedBlobFileSharingInfo *file_info_;
+
+ public:
+  MappedBlobDataSharingInfo(const MappedBlobFileSharingInfo *file_info) : file_info_(file_info)
+  {
+    file_info_->add_user();
+  }
+
+  MEM_CXX_CLASS_ALLOC_FUNCS("MappedBlobDataSharingInfo");
+
+ private:
+  void delete_self_with_data() override
+  {
+    file_info_->remove_user_and_delete_if_last();
+    delete this;
+  }
+};
+
 DiskBlobReader::DiskBlobReader(std::string blobs_dir) : blobs_dir_(std::move(blobs_dir)) {}
 
+DiskBlobReader::~DiskBlobReader()
+{
+  for (const ImplicitSharingInfo *file_info : mapped_files_.values()) {
+    if (file_info) {
+      file_info->remove_user_and_delete_if_last();
+    }
+  }
+}
+
 [[nodiscard]] bool DiskBlobReader::read(const BlobSlice &slice, void *r_data) const
 {
   if (slice.range.is_empty()) {
@@ -111,6 +194,55 @@ DiskBlobReader::DiskBlobReader(std::string blobs_dir) : blobs_dir_(std::move(blo
   return true;
 }
 
+std::optional<ImplicitSharingInfoAndData> DiskBlobReader::read_shared(
+    const BlobSlice &slice) const
+{
+#ifdef WIN32
+  /* Files can't be deleted or overwritten while they are mapped on Windows. That would make it
+   * impossible to bake again while the baked data is still used. */
+  UNUSED_VARS(slice);
+  return std::nullopt;
+#else
+  if (slice.range.size() < mapped_blob_min_size) {
+    return std::nullopt;
+  }
+
+  char blob_path[FILE_MAX];
+  BLI_path_join(blob_path, sizeof(blob_path), blobs_dir_.c_str(), slice.name.c_str());
+
+  std::lock_guard lock{mutex_};
+  const ImplicitSharingInfo *file_info = mapped_files_.lookup_or_add_cb_as(
+      blob_path, [&]() -> const ImplicitSharingInfo * {
+        const int file = BLI_open(blob_path, O_BINARY | O_RDONLY, 0);
+        if (file == -1) {
+          return nullptr;
+        }
+        /* Map the file copy-on-write, so that owners of the data can still modify it in place.
+         * The mapping stays valid after the file is closed. */
+        BLI_mmap_file *mmap_file = BLI_mmap_open_private_writable(file);
+        close(file);
+        if (mmap_file == nullptr) {
+          return nullptr;
+        }
+        return new MappedBlobFileSharingInfo(mmap_file, blob_path);
+      });
+  if (file_info == nullptr) {
+    return std::nullopt;
+  }
+  const auto &mapped_file = *static_cast<const MappedBlobFileSharingInfo *>(file_info);
+  if (BLI_mmap_has_io_error(mapped_file.mmap_file)) {
+    /* The file has been changed since it was mapped, read it again instead. */
+    return std::nullopt;
+  }
+  if (size_t(slice.range.one_after_last()) > BLI_mmap_get_length(mapped_file.mmap_file)) {
+    return std::nullopt;
+  }
+  const char *file_data = static_cast<const char *>(BLI_mmap_get_pointer(mapped_file.mmap_file));
+  return ImplicitSharingInfoAndData{new MappedBlobDataSharingInfo(&mapped_file),
+                                    file_data + slice.range.start()};
+#endif
+}
+
 DiskBlobWriter::DiskBlobWriter(std::string blob_dir, std::string base_name)
     : blob_dir_(std::move(blob_dir)), base_name_(std::move(base_name))
 {
@@ -123,9 +255,22 @@ BlobSlice DiskBlobWriter::write(const void *data, const int64_t size)
     char blob_path[FILE_MAX];
     BLI_path_join(blob_path, sizeof(blob_path), blob_dir_.c_str(), blob_name_.c_str());
     BLI_file_ensure_parent_dir_exists(blob_path);
+    if (BLI_exists(blob_path)) {
+      /* Remove the old file instead of overwriting it, because its data may still be used from a
+       * memory-mapped file, see #DiskBlobReader::read_shared. */
+      BLI_delete(blob_path, false, false);
+    }
     blob_stream_.open(blob_path, std::ios::out | std::ios::binary);
   }
 
+  const int64_t padding = (blob_alignment - current_offset_ % blob_alignment) % blob_alignment;
+  if (padding > 0) {
+    const std::array<char, blob_alignment> zeros{};
+    blob_stream_.write(zeros.data(), padding);
+    current_offset_ += padding;
+    total_written_size_ += padding;
+  }
+
   const int64_t old_offset = current_offset_;
   blob_stream_.write(static_cast<const char *>(data), size);
   current_offset_ += size;
@@ -345,24 +490,14 @@ static std::shared_ptr<DictionaryValue> write_blob_raw_data_with_endian(
 }
 
 /**
- * Read data of an into an array and optionally perform an endian switch if necessary.
+ * Perform an endian switch on data that has been read, if it was written with a different
+ * endianness.
  */
-[[nodiscard]] static bool read_blob_raw_data_with_endian(const BlobReader &blob_reader,
-                                                         const DictionaryValue &io_data,
-                                                         const int64_t element_size,
-                                                         const int64_t elements_num,
-                                                         void *r_data)
+[[nodiscard]] static bool switch_endian_if_necessary(const DictionaryValue &io_data,
+                                                     const int64_t element_size,
+                                                     const int64_t elements_num,
+                                                     void *r_data)
 {
-  const std::optional<BlobSlice> slice = BlobSlice::deserialize(io_data);
-  if (!slice) {
-    return false;
-  }
-  if (slice->range.size() != element_size * elements_num) {
-    return false;
-  }
-  if (!blob_reader.read(*slice, r_data)) {
-    return false;
-  }
   const StringRefNull stored_endian = io_data.lookup_str("endian").value_or("little");
   const StringRefNull current_endian = get_endian_io_name(ENDIAN_ORDER);
   const bool need_endian_switch = stored_endian != current_endian;
@@ -386,6 +521,28 @@ static std::shared_ptr<DictionaryValue> write_blob_raw_data_with_endian(
   return true;
 }
 
+/**
+ * Read data of an into an array and optionally perform an endian switch if necessary.
+ */
+[[nodiscard]] static bool read_blob_raw_data_with_endian(const BlobReader &blob_reader,
+                                                         const DictionaryValue &io_data,
+                                                         const int64_t element_size,
+                                                         const int64_t elements_num,
+                                                         void *r_data)
+{
+  const std::optional<BlobSlice> slice = BlobSlice::deserialize(io_data);
+  if (!slice) {
+    return false;
+  }
+  if (slice->range.size() != element_size * elements_num) {
+    return false;
+  }
+  if (!blob_reader.read(*slice, r_data)) {
+    return false;
+  }
+  return switch_endian_if_necessary(io_data, element_size, elements_num, r_data);
+}
+
 /** Write bytes ignoring endianness. */
 static std::shared_ptr<DictionaryValue> write_blob_raw_bytes(BlobWriter &blob_writer,
                                                              BlobWriteSharing &blob_sharing,
@@ -411,12 +568,180 @@ static std::shared_ptr<DictionaryValue> write_blob_raw_bytes(BlobWriter &blob_wr
   return blob_reader.read(*slice, r_data);
 }
 
+/**
+ * Size of the values that are swapped when the endianness changes, e.g. the size of a float for
+ * #float3. One for data that is stored as plain bytes and zero for unsupported types.
+ */
+static int64_t get_endian_value_size(const CPPType &type)
+{
+  if (type.size() == 1 || type.is<ColorGeometry4b>()) {
+    return 1;
+  }
+  if (type.is_any<int16_t, uint16_t, int32_t, uint32_t, int64_t, uint64_t, float>()) {
+    return type.size();
+  }
+  if (type.is_any<float2, int2, float3, float4x4, ColorGeometry4f, math::Quaternion>()) {
+    return sizeof(float);
+  }
+  return 0;
+}
+
+/** Smaller arrays are not compressed, because it would hardly reduce the file size. */
+static constexpr int64_t compressed_blob_min_size = 1 << 12;
+static constexpr int zstd_compression_level = 3;
+
+/**
+ * Reorder the bytes so that the first bytes of all values come first, then all second bytes, etc.
+ * Similar bytes (e.g. the exponents of floats) are next to each other afterwards, which makes the
+ * data much easier to compress.
+ */
+static void shuffle_bytes(const Span<std::byte> src,
+                          const int64_t value_size,
+                          MutableSpan<std::byte> dst)
+{
+  const int64_t values_num = src.size() / value_size;
+  threading::parallel_for(IndexRange(values_num), 4096, [&](const IndexRange range) {
+    for (const int64_t byte : IndexRange(value_size)) {
+      MutableSpan<std::byte> dst_bytes = dst.slice(byte * values_num, values_num);
+      for (const int64_t i : range) {
+        dst_bytes[i] = src[i * value_size + byte];
+      }
+    }
+  });
+}
+
+static void unshuffle_bytes(const Span<std::byte> src,
+                            const int64_t value_size,
+                            MutableSpan<std::byte> dst)
+{
+  const int64_t values_num = src.size() / value_size;
+  threading::parallel_for(IndexRange(values_num), 4096, [&](const IndexRange range) {
+    for (const int64_t byte : IndexRange(value_size)) {
+      const Span<std::byte> src_bytes = src.slice(byte * values_num, values_num);
+      for (const int64_t i : range) {
+        dst[i * value_size + byte] = src_bytes[i];
+      }
+    }
+  });
+}
+
+/**
+ * Write a compressed version of the data. Integers are stored as differences to the previous
+ * value, because e.g. ids and offsets are often increasing.
+ * \return Null if compressing the data does not make it smaller.
+ */
+static std::shared_ptr<DictionaryValue> write_blob_compressed_gspan(
+    BlobWriter &blob_writer, BlobWriteSharing &blob_sharing, const GSpan data)
+{
+  const CPPType &type = data.type();
+  const int64_t value_size = get_endian_value_size(type);
+  const int64_t size = data.size_in_bytes();
+  const bool use_delta = type.is_any<int32_t, uint32_t>();
+
+  Span<std::byte> src{static_cast<const std::byte *>(data.data()), size};
+  Array<std::byte> shuffled(value_size > 1 ? size : 0, NoInitialization());
+  if (value_size > 1) {
+    if (use_delta) {
+      const Span<uint32_t> values{static_cast<const uint32_t *>(data.data()), data.size()};
+      Array<uint32_t> deltas(values.size(), NoInitialization());
+      threading::parallel_for(values.index_range(), 4096, [&](const IndexRange range) {
+        for (const int64_t i : range) {
+          deltas[i] = i == 0 ? values[i] : values[i] - values[i - 1];
+        }
+      });
+      shuffle_bytes(deltas.as_span().cast<std::byte>(), value_size, shuffled);
+    }
+    else {
+      shuffle_bytes(src, value_size, shuffled);
+    }
+    src = shuffled;
+  }
+
+  Array<std::byte> compressed(ZSTD_compressBound(size), NoInitialization());
+  const size_t compressed_size = ZSTD_compress(
+      compressed.data(), compressed.size(), src.data(), size, zstd_compression_level);
+  if (ZSTD_isError(compressed_size) || int64_t(compressed_size) >= size) {
+    return nullptr;
+  }
+
+  auto io_data = blob_sharing.write_deduplicated(blob_writer, compressed.data(), compressed_size);
+  io_data->append_str("compression", "zstd");
+  io_data->append_int("raw_size", size);
+  if (value_size > 1) {
+    io_data->append_str("filter", use_delta ? "delta_shuffle" : "shuffle");
+    if (ENDIAN_ORDER == B_ENDIAN) {
+      io_data->append_str("endian", get_endian_io_name(ENDIAN_ORDER));
+    }
+  }
+  return io_data;
+}
+
+[[nodiscard]] static bool read_blob_compressed_gspan(const BlobReader &blob_reader,
+                                                     const DictionaryValue &io_data,
+                                                     GMutableSpan r_data)
+{
+  const std::optional<BlobSlice> slice = BlobSlice::deserialize(io_data);
+  if (!slice) {
+    return false;
+  }
+  if (io_data.lookup_str("compression") != "zstd") {
+    return false;
+  }
+  const int64_t size = r_data.size_in_bytes();
+  if (io_data.lookup_int("raw_size") != size) {
+    return false;
+  }
+  const StringRefNull filter = io_data.lookup_str("filter").value_or("");
+  if (!ELEM(filter, "", "shuffle", "delta_shuffle")) {
+    return false;
+  }
+  const int64_t value_size = get_endian_value_size(r_data.type());
+
+  Array<std::byte> compressed(slice->range.size(), NoInitialization());
+  if (!blob_reader.read(*slice, compressed.data())) {
+    return false;
+  }
+  MutableSpan<std::byte> dst{static_cast<std::byte *>(r_data.data()), size};
+  Array<std::byte> shuffled(filter.is_empty() ? 0 : size, NoInitialization());
+  MutableSpan<std::byte> decompressed = filter.is_empty() ? dst : shuffled.as_mutable_span();
+  const size_t decompressed_size = ZSTD_decompress(
+      decompressed.data(), size, compressed.data(), compressed.size());
+  if (ZSTD_isError(decompressed_size) || int64_t(decompressed_size) != size) {
+    return false;
+  }
+  if (filter.is_empty()) {
+    return true;
+  }
+
+  unshuffle_bytes(shuffled, value_size, dst);
+  if (!switch_endian_if_necessary(io_data, value_size, size / value_size, dst.data())) {
+    return false;
+  }
+  if (filter == "delta_shuffle") {
+    if (value_size != sizeof(uint32_t)) {
+      return false;
+    }
+    MutableSpan<uint32_t> values = dst.cast<uint32_t>();
+    for (const int64_t i : values.index_range().drop_front(1)) {
+      values[i] += values[i - 1];
+    }
+  }
+  return true;
+}
+
 static std::shared_ptr<DictionaryValue> write_blob_simple_gspan(BlobWriter &blob_writer,
                                                                 BlobWriteSharing &blob_sharing,
                                                                 const GSpan data)
 {
   const CPPType &type = data.type();
   BLI_assert(type.is_trivial());
+  if (blob_writer.compression() == BlobCompression::Zstd &&
+      data.size_in_bytes() >= compressed_blob_min_size && get_endian_value_size(type) > 0)
+  {
+    if (auto io_data = write_blob_compressed_gspan(blob_writer, blob_sharing, data)) {
+      return io_data;
+    }
+  }
   if (type.size() == 1 || type.is<ColorGeometry4b>()) {
     return write_blob_raw_bytes(blob_writer, blob_sharing, data.data(), data.size_in_bytes());
   }
@@ -430,34 +755,49 @@ static std::shared_ptr<DictionaryValue> write_blob_simple_gspan(BlobWriter &blob
 {
   const CPPType &type = r_data.type();
   BLI_assert(type.is_trivial());
-  if (type.size() == 1 || type.is<ColorGeometry4b>()) {
-    return read_blob_raw_bytes(blob_reader, io_data, r_data.size_in_bytes(), r_data.data());
+  const int64_t value_size = get_endian_value_size(type);
+  if (value_size == 0) {
+    return false;
   }
-  if (type.is_any<int16_t, uint16_t, int32_t, uint32_t, int64_t, uint64_t, float>()) {
-    return read_blob_raw_data_with_endian(
-        blob_reader, io_data, type.size(), r_data.size(), r_data.data());
+  if (io_data.lookup_str("compression")) {
+    return read_blob_compressed_gspan(blob_reader, io_data, r_data);
+  }
+  if (value_size == 1) {
+    return read_blob_raw_bytes(blob_reader, io_data, r_data.size_in_bytes(), r_data.data());
   }
-  if (type.is_any<float2, int2>()) {
-    return read_blob_raw_data_with_endian(
-        blob_reader, io_data, sizeof(int32_t), r_data.size() * 2, r_data.data());
+  return read_blob_raw_data_with_endian(
+      blob_reader, io_data, value_size, r_data.size_in_bytes() / value_size, r_data.data());
+}
+
+/**
+ * Reference the stored data without copying it if it can be used as is, e.g. from a
+ * memory-mapped file.
+ */
+static std::optional<ImplicitSharingInfoAndData> read_blob_simple_gspan_without_copy(
+    const BlobReader &blob_reader,
+    const DictionaryValue &io_data,
+    const CPPType &cpp_type,
+    const int size)
+{
+  if (io_data.lookup_str("compression")) {
+    return std::nullopt;
   }
-  if (type.is<float3>()) {
-    return read_blob_raw_data_with_endian(
-        blob_reader, io_data, sizeof(float), r_data.size() * 3, r_data.data());
+  if (io_data.lookup_str("endian").value_or("little") != get_endian_io_name(ENDIAN_ORDER)) {
+    return std::nullopt;
   }
-  if (type.is<float4x4>()) {
-    return read_blob_raw_data_with_endian(
-        blob_reader, io_data, sizeof(float), r_data.size() * 16, r_data.data());
+  const std::optional<BlobSlice> slice = BlobSlice::deserialize(io_data);
+  if (!slice || slice->range.size() != cpp_type.size() * size) {
+    return std::nullopt;
   }
-  if (type.is<ColorGeometry4f>()) {
-    return read_blob_raw_data_with_endian(
-        blob_reader, io_data, sizeof(float), r_data.size() * 4, r_data.data());
+  const std::optional<ImplicitSharingInfoAndData> data = blob_reader.read_shared(*slice);
+  if (!data) {
+    return std::nullopt;
   }
-  if (type.is<math::Quaternion>()) {
-    return read_blob_raw_data_with_endian(
-        blob_reader, io_data, sizeof(float), r_data.size() * 4, r_data.data());
+  if (uintptr_t(data->data) % cpp_type.alignment() != 0) {
+    data->sharing_info->remove_user_and_delete_if_last();
+    return std::nullopt;
   }
-  return false;
+  return data;
 }
 
 static std::shared_ptr<DictionaryValue> write_blob_shared_simple_gspan(
@@ -481,6 +821,11 @@ static std::shared_ptr<DictionaryValue> write_blob_shared_simple_gspan(
   const char *func = __func__;
   const std::optional<ImplicitSharingInfoAndData> sharing_info_and_data = blob_sharing.read_shared(
       io_data, [&]() -> std::optional<ImplicitSharingInfoAndData> {
+        if (std::optional<ImplicitSharingInfoAndData> data = read_blob_simple_gspan_without_copy(
+                blob_reader, io_data, cpp_type, size))
+        {
+          return data;
+        }
         void *data_mem = MEM_mallocN_aligned(size * cpp_type.size(), cpp_type.alignment(), func);
         if (!read_blob_simple_gspan(blob_reader, io_data, {cpp_type, data_mem, size})) {
           MEM_freeN(data_mem);
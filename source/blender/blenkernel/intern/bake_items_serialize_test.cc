@@ -0,0 +1,127 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <filesystem>
+
+#include "testing/testing.h"
+
+#include "BKE_bake_items_serialize.hh"
+#include "BKE_pointcloud.hh"
+
+#include "bake_items_serialize_test_common.hh"
+
+namespace blender::bke::bake::tests {
+
+static void expect_equal_pointclouds(const PointCloud &a, const PointCloud &b)
+{
+  ASSERT_EQ(a.totpoint, b.totpoint);
+  EXPECT_EQ_ARRAY(a.positions().data(), b.positions().data(), a.totpoint);
+  const VArraySpan<int> a_ids = *a.attributes().lookup<int>("id");
+  const VArraySpan<int> b_ids = *b.attributes().lookup<int>("id");
+  ASSERT_EQ(a_ids.size(), b_ids.size());
+  EXPECT_EQ_ARRAY(a_ids.data(), b_ids.data(), a_ids.size());
+}
+
+TEST_F(BakeItemsSerializeTest, CompressedRoundtrip)
+{
+  const BakeState bake_state = create_pointcloud_bake_state(100'000);
+  const auto [raw_meta, raw_size] = write_bake(bake_state, blobs_dir, BlobCompression::None);
+  const auto [compressed_meta, compressed_size] = write_bake(
+      bake_state, blobs_dir, BlobCompression::Zstd);
+  EXPECT_LT(compressed_size, raw_size);
+
+  DiskBlobReader blob_reader{blobs_dir};
+  const std::optional<BakeState> result = read_bake(compressed_meta, blob_reader);
+  ASSERT_TRUE(result.has_value());
+  expect_equal_pointclouds(get_pointcloud(bake_state), get_pointcloud(*result));
+}
+
+TEST_F(BakeItemsSerializeTest, MappedRoundtrip)
+{
+  const BakeState bake_state = create_pointcloud_bake_state(100'000);
+  const std::string meta = write_bake(bake_state, blobs_dir, BlobCompression::None).first;
+
+  std::optional<BakeState> result;
+  {
+    DiskBlobReader blob_reader{blobs_dir};
+    result = read_bake(meta, blob_reader);
+  }
+  /* The data stays valid after the reader has been freed. */
+  ASSERT_TRUE(result.has_value());
+  expect_equal_pointclouds(get_pointcloud(bake_state), get_pointcloud(*result));
+
+  /* Baking again replaces the blob file, which must not change the loaded data. */
+  write_bake(create_pointcloud_bake_state(1'000), blobs_dir, BlobCompression::None);
+  expect_equal_pointclouds(get_pointcloud(bake_state), get_pointcloud(*result));
+
+  /* Modifying the loaded data does not change the file. */
+  write_bake(bake_state, blobs_dir, BlobCompression::None);
+  PointCloud &pointcloud = *static_cast<GeometryBakeItem &>(*result->items_by_id.lookup(0))
+                                .geometry.get_pointcloud_for_write();
+  pointcloud.positions_for_write().fill(float3(0));
+  DiskBlobReader blob_reader{blobs_dir};
+  const std::optional<BakeState> result_again = read_bake(meta, blob_reader);
+  ASSERT_TRUE(result_again.has_value());
+  expect_equal_pointclouds(get_pointcloud(bake_state), get_pointcloud(*result_again));
+}
+
+TEST_F(BakeItemsSerializeTest, TruncatedBlobFile)
+{
+  const BakeState bake_state = create_pointcloud_bake_state(100'000);
+  const std::string meta = write_bake(bake_state, blobs_dir, BlobCompression::None).first;
+  const std::optional<BakeState> result = read_bake(meta, DiskBlobReader{blobs_dir});
+  ASSERT_TRUE(result.has_value());
+
+  /* Truncating the blob files from outside loses the data that was not copied yet, but accessing
+   * it must not crash. */
+  for (const std::filesystem::directory_entry &entry :
+       std::filesystem::recursive_directory_iterator(blobs_dir))
+  {
+    if (entry.is_regular_file() && entry.path().extension() == ".blob") {
+      std::filesystem::resize_file(entry.path(), 0);
+    }
+  }
+  const PointCloud &pointcloud = get_pointcloud(*result);
+  EXPECT_EQ(pointcloud.totpoint, 100'000);
+  float3 sum(0);
+  for (const float3 &position : pointcloud.positions()) {
+    sum += position;
+  }
+  EXPECT_TRUE(std::isfinite(sum.x));
+
+  /* Loading again fails instead of returning the lost data. */
+  const std::optional<BakeState> result_again = read_bake(meta, DiskBlobReader{blobs_dir});
+  ASSERT_TRUE(result_again.has_value());
+  const auto &item = static_cast<const GeometryBakeItem &>(*result_again->items_by_id.lookup(0));
+  EXPECT_FALSE(item.geometry.has_pointcloud());
+}
+
+TEST_F(BakeItemsSerializeTest, DiskBlobReaderReadShared)
+{
+  Array<int> values(100'000);
+  for (const int i : values.index_range()) {
+    values[i] = i;
+  }
+  BlobSlice slice;
+  {
+    DiskBlobWriter blob_writer{blobs_dir, "frame"};
+    /* Write a few bytes first to make sure that arrays are aligned. */
+    blob_writer.write("abc", 3);
+    slice = blob_writer.write(values.data(), values.as_span().size_in_bytes());
+  }
+  EXPECT_EQ(slice.range.start() % 16, 0);
+
+  const DiskBlobReader blob_reader{blobs_dir};
+  const std::optional<ImplicitSharingInfoAndData> data = blob_reader.read_shared(slice);
+#ifdef WIN32
+  EXPECT_FALSE(data.has_value());
+#else
+  ASSERT_TRUE(data.has_value());
+  EXPECT_TRUE(data->sharing_info->is_mutable());
+  EXPECT_EQ_ARRAY(values.data(), static_cast<const int *>(data->data), values.size());
+  data->sharing_info->remove_user_and_delete_if_last();
+#endif
+}
+
+}  // namespace blender::bke::bake::tests
@@ -0,0 +1,113 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Bakes and temporary blob directories shared by the bake serialization tests.
+ */
+
+#include <cmath>
+#include <sstream>
+
+#include "testing/testing.h"
+
+#include "BLI_fileops.hh"
+#include "BLI_path_utils.hh"
+#include "BLI_system.h"
+#include "BLI_tempfile.h"
+
+#include "BKE_bake_items_serialize.hh"
+#include "BKE_idtype.hh"
+#include "BKE_pointcloud.hh"
+
+#include BLI_SYSTEM_PID_H
+
+namespace blender::bke::bake::tests {
+
+class BakeItemsSerializeTest : public ::testing::Test {
+ public:
+  std::string blobs_dir;
+
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    char temp_dir[FILE_MAX];
+    BLI_temp_directory_path_get(temp_dir, sizeof(temp_dir));
+    blobs_dir = std::string(temp_dir) + SEP_STR + "blender_bake_items_serialize_test_" +
+                std::to_string(getpid());
+    BLI_dir_create_recursive(blobs_dir.c_str());
+  }
+
+  void TearDown() override
+  {
+    if (BLI_exists(blobs_dir.c_str())) {
+      BLI_delete(blobs_dir.c_str(), true, true);
+    }
+  }
+};
+
+/** A #DiskBlobReader that always copies the data, like before blob files were memory-mapped. */
+class CopyingDiskBlobReader : public DiskBlobReader {
+ public:
+  using DiskBlobReader::DiskBlobReader;
+
+  std::optional<ImplicitSharingInfoAndData> read_shared(const BlobSlice & /*slice*/) const override
+  {
+    return std::nullopt;
+  }
+};
+
+inline BakeState create_pointcloud_bake_state(const int points_num)
+{
+  PointCloud *pointcloud = BKE_pointcloud_new_nomain(points_num);
+  MutableSpan<float3> positions = pointcloud->positions_for_write();
+  MutableAttributeAccessor attributes = pointcloud->attributes_for_write();
+  SpanAttributeWriter<int> ids = attributes.lookup_or_add_for_write_only_span<int>(
+      "id", AttrDomain::Point);
+  for (const int i : positions.index_range()) {
+    positions[i] = float3(std::sin(i * 0.001f), std::cos(i * 0.003f), i * 1e-4f);
+    ids.span[i] = i * 3 + 7;
+  }
+  ids.finish();
+
+  BakeState bake_state;
+  bake_state.items_by_id.add_new(
+      0, std::make_unique<GeometryBakeItem>(GeometrySet::from_pointcloud(pointcloud)));
+  return bake_state;
+}
+
+inline const PointCloud &get_pointcloud(const BakeState &bake_state)
+{
+  const auto &item = static_cast<const GeometryBakeItem &>(*bake_state.items_by_id.lookup(0));
+  return *item.geometry.get_pointcloud();
+}
+
+/** Write the bake to #blobs_dir and return the meta data and the size of the blob files. */
+inline std::pair<std::string, int64_t> write_bake(const BakeState &bake_state,
+                                                  const StringRefNull blobs_dir,
+                                                  const BlobCompression compression)
+{
+  DiskBlobWriter blob_writer{blobs_dir, "frame"};
+  blob_writer.set_compression(compression);
+  BlobWriteSharing blob_sharing;
+  std::ostringstream meta{std::ios::binary};
+  serialize_bake(bake_state, blob_writer, blob_sharing, meta);
+  return {meta.str(), blob_writer.written_size()};
+}
+
+inline std::optional<BakeState> read_bake(const StringRef meta, const BlobReader &blob_reader)
+{
+  BlobReadSharing blob_sharing;
+  std::istringstream stream{meta, std::ios::binary};
+  return deserialize_bake(stream, blob_reader, blob_sharing);
+}
+
+}  // namespace blender::bke::bake::tests
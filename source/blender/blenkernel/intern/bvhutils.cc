@@ -6,15 +6,25 @@
  * \ingroup bke
  */
 
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+
 #include "DNA_meshdata_types.h"
 #include "DNA_pointcloud_types.h"
 
+#include "BLI_index_mask.hh"
+#include "BLI_listbase.h"
 #include "BLI_math_geom.h"
+#include "BLI_task.hh"
 
 #include "BKE_attribute.hh"
 #include "BKE_bvhutils.hh"
 #include "BKE_editmesh.hh"
 #include "BKE_mesh.hh"
+#include "BKE_mesh_types.hh"
 #include "BKE_pointcloud.hh"
 
 namespace blender::bke {
@@ -426,12 +436,23 @@ static BVHTreeFromMesh create_tris_tree_data(std::unique_ptr<BVHTree, BVHTreeDel
   return data;
 }
 
-static std::unique_ptr<BVHTree, BVHTreeDeleter> bvhtree_new_common(int elems_num)
+static std::unique_ptr<BVHTree, BVHTreeDeleter> bvhtree_new_common(int elems_num, int flag = 0)
 {
   if (elems_num == 0) {
     return nullptr;
   }
-  return std::unique_ptr<BVHTree, BVHTreeDeleter>(BLI_bvhtree_new(elems_num, 0.0f, 2, 6));
+  return std::unique_ptr<BVHTree, BVHTreeDeleter>(
+      BLI_bvhtree_new_ex(elems_num, 0.0f, 2, 6, flag));
+}
+
+/**
+ * Triangle trees are mostly used for ray-casts and nearest queries (e.g. snapping, shrinkwrap and
+ * raycast nodes), which are faster with wide nodes. That costs some memory, so the trees of other
+ * elements don't use them.
+ */
+static std::unique_ptr<BVHTree, BVHTreeDeleter> bvhtree_new_tris(int tris_num)
+{
+  return bvhtree_new_common(tris_num, BVH_TREE_WIDE_NODES);
 }
 
 static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_verts(
@@ -505,7 +526,7 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_tris(const Span
                                                                       const Span<int> corner_verts,
                                                                       const Span<int3> corner_tris)
 {
-  std::unique_ptr<BVHTree, BVHTreeDeleter> tree = bvhtree_new_common(corner_tris.size());
+  std::unique_ptr<BVHTree, BVHTreeDeleter> tree = bvhtree_new_tris(corner_tris.size());
   if (!tree) {
     return {};
   }
@@ -536,7 +557,7 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_tris(
   faces_mask.foreach_index_optimized<int>(
       [&](const int i) { tris_num += mesh::face_triangles_num(faces[i].size()); });
 
-  std::unique_ptr<BVHTree, BVHTreeDeleter> tree = bvhtree_new_common(tris_num);
+  std::unique_ptr<BVHTree, BVHTreeDeleter> tree = bvhtree_new_tris(tris_num);
   if (!tree) {
     return {};
   }
@@ -566,6 +587,196 @@ BVHTreeFromMesh bvhtree_from_mesh_corner_tris_ex(const Span<float3> vert_positio
       corner_tris);
 }
 
+/**
+ * Refit trees are rebuilt when their cost estimate grows beyond this factor of the estimate of a
+ * newly built tree. Deformations like character animation usually stay well below it, while
+ * simulations that scramble the elements quickly degrade the tree.
+ */
+static constexpr float BVH_REFIT_MAX_COST_FACTOR = 2.0f;
+
+/**
+ * Maximum memory of all trees stored for refitting. Stored trees are only useful when their mesh
+ * is evaluated again, which is not known in advance, e.g. when an object is not animated anymore.
+ */
+static constexpr size_t BVH_REFIT_CACHE_MAX_SIZE = size_t(256) << 20;
+
+static std::atomic<int64_t> g_bvh_build_num = 0;
+static std::atomic<int64_t> g_bvh_refit_num = 0;
+static std::atomic<int64_t> g_bvh_degraded_num = 0;
+
+/** Protects the data of all #BVHRefitCache. */
+static std::mutex g_refit_mutex;
+/** All #BVHRefitCache::Entry that have a stored tree, least recently stored first. */
+static ListBase g_refit_stored_entries = {nullptr, nullptr};
+static int64_t g_refit_stored_num = 0;
+static size_t g_refit_stored_size = 0;
+
+BVHCacheStats bvhtree_cache_stats_get()
+{
+  BVHCacheStats stats;
+  stats.build_num = g_bvh_build_num;
+  stats.refit_num = g_bvh_refit_num;
+  stats.degraded_num = g_bvh_degraded_num;
+  std::lock_guard lock{g_refit_mutex};
+  stats.stored_num = g_refit_stored_num;
+  stats.stored_size = g_refit_stored_size;
+  return stats;
+}
+
+void bvhtree_cache_stats_reset()
+{
+  g_bvh_build_num = 0;
+  g_bvh_refit_num = 0;
+  g_bvh_degraded_num = 0;
+}
+
+void bvhtree_cache_stats_print()
+{
+  const BVHCacheStats stats = bvhtree_cache_stats_get();
+  printf("\nmesh BVH trees: %" PRId64 " built, %" PRId64 " refit, %" PRId64
+         " rebuilt after refit\n",
+         stats.build_num,
+         stats.refit_num,
+         stats.degraded_num);
+  printf("mesh BVH trees stored for refit: %" PRId64 " (%.3f MB)\n",
+         stats.stored_num,
+         double(stats.stored_size) / 1024.0 / 1024.0);
+}
+
+/** Take the stored tree out of the entry. The refit mutex has to be locked. */
+static std::unique_ptr<BVHTree, BVHTreeDeleter> refit_cache_entry_take(
+    BVHRefitCache::Entry &entry)
+{
+  if (!entry.tree) {
+    return nullptr;
+  }
+  BLI_remlink(&g_refit_stored_entries, &entry);
+  entry.next = entry.prev = nullptr;
+  g_refit_stored_num--;
+  g_refit_stored_size -= entry.tree_size;
+  entry.tree_size = 0;
+  return std::move(entry.tree);
+}
+
+BVHRefitCache::~BVHRefitCache()
+{
+  std::lock_guard lock{g_refit_mutex};
+  refit_cache_entry_take(this->verts);
+  refit_cache_entry_take(this->edges);
+  refit_cache_entry_take(this->corner_tris);
+}
+
+void bvhtree_refit_cache_store(BVHRefitCache &refit_cache,
+                               BVHRefitCache::Entry &entry,
+                               std::unique_ptr<BVHTree, BVHTreeDeleter> tree)
+{
+  const size_t tree_size = BLI_bvhtree_get_memory_size(tree.get());
+  /* Freed after unlocking. */
+  Vector<std::unique_ptr<BVHTree, BVHTreeDeleter>> freed_trees;
+
+  std::lock_guard lock{g_refit_mutex};
+  freed_trees.append(refit_cache_entry_take(entry));
+  entry.tree = std::move(tree);
+  entry.tree_size = tree_size;
+  entry.generation = ++refit_cache.generation;
+  BLI_addtail(&g_refit_stored_entries, &entry);
+  g_refit_stored_num++;
+  g_refit_stored_size += tree_size;
+
+  while (g_refit_stored_size > BVH_REFIT_CACHE_MAX_SIZE) {
+    BVHRefitCache::Entry *oldest = static_cast<BVHRefitCache::Entry *>(
+        g_refit_stored_entries.first);
+    freed_trees.append(refit_cache_entry_take(*oldest));
+  }
+}
+
+void bvhtree_refit_cache_free_stored_before(BVHRefitCache::Entry &entry, const uint64_t generation)
+{
+  std::unique_ptr<BVHTree, BVHTreeDeleter> tree;
+  std::lock_guard lock{g_refit_mutex};
+  if (entry.generation <= generation) {
+    tree = refit_cache_entry_take(entry);
+  }
+}
+
+static void refit_tree_from_verts(BVHTree &tree, const Span<float3> positions)
+{
+  threading::parallel_for(positions.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      BLI_bvhtree_update_node(&tree, i, positions[i], nullptr, 1);
+    }
+  });
+}
+
+static void refit_tree_from_edges(BVHTree &tree,
+                                  const Span<float3> positions,
+                                  const Span<int2> edges)
+{
+  threading::parallel_for(edges.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      float co[2][3];
+      copy_v3_v3(co[0], positions[edges[i][0]]);
+      copy_v3_v3(co[1], positions[edges[i][1]]);
+      BLI_bvhtree_update_node(&tree, i, co[0], nullptr, 2);
+    }
+  });
+}
+
+static void refit_tree_from_tris(BVHTree &tree,
+                                 const Span<float3> positions,
+                                 const Span<int> corner_verts,
+                                 const Span<int3> corner_tris)
+{
+  threading::parallel_for(corner_tris.index_range(), 4096, [&](const IndexRange range) {
+    for (const int tri : range) {
+      float co[3][3];
+      copy_v3_v3(co[0], positions[corner_verts[corner_tris[tri][0]]]);
+      copy_v3_v3(co[1], positions[corner_verts[corner_tris[tri][1]]]);
+      copy_v3_v3(co[2], positions[corner_verts[corner_tris[tri][2]]]);
+      BLI_bvhtree_update_node(&tree, tri, co[0], nullptr, 3);
+    }
+  });
+}
+
+/**
+ * Refit the tree stored in \a entry from an earlier state of the mesh if there is one, and
+ * otherwise build a new tree. The leaves of the stored tree must correspond to the same elements,
+ * which is guaranteed by the refit cache being replaced when the topology changes.
+ */
+static std::unique_ptr<BVHTree, BVHTreeDeleter> refit_or_build_tree(
+    BVHRefitCache::Entry &entry,
+    const int leaf_num,
+    const FunctionRef<void(BVHTree &tree)> refit_fn,
+    const FunctionRef<std::unique_ptr<BVHTree, BVHTreeDeleter>()> build_fn)
+{
+  std::unique_ptr<BVHTree, BVHTreeDeleter> tree;
+  float build_cost;
+  {
+    std::lock_guard lock{g_refit_mutex};
+    tree = refit_cache_entry_take(entry);
+    build_cost = entry.build_cost;
+  }
+
+  if (tree && BLI_bvhtree_get_len(tree.get()) == leaf_num) {
+    refit_fn(*tree);
+    BLI_bvhtree_update_tree(tree.get());
+    if (BLI_bvhtree_get_cost_estimate(tree.get()) <= build_cost * BVH_REFIT_MAX_COST_FACTOR) {
+      g_bvh_refit_num++;
+      return tree;
+    }
+    g_bvh_degraded_num++;
+  }
+
+  tree = build_fn();
+  g_bvh_build_num++;
+  if (tree) {
+    const float cost = BLI_bvhtree_get_cost_estimate(tree.get());
+    std::lock_guard lock{g_refit_mutex};
+    entry.build_cost = cost;
+  }
+  return tree;
+}
+
 static BitVector<> loose_verts_no_hidden_mask_get(const Mesh &mesh)
 {
   int count = mesh.verts_num;
@@ -674,7 +885,11 @@ blender::bke::BVHTreeFromMesh Mesh::bvh_verts() const
   using namespace blender::bke;
   const Span<float3> positions = this->vert_positions();
   this->runtime->bvh_cache_verts.ensure([&](std::unique_ptr<BVHTree, BVHTreeDeleter> &data) {
-    data = create_tree_from_verts(positions, positions.index_range());
+    data = refit_or_build_tree(
+        this->runtime->bvh_refit_cache->verts,
+        this->verts_num,
+        [&](BVHTree &tree) { refit_tree_from_verts(tree, positions); },
+        [&]() { return create_tree_from_verts(positions, positions.index_range()); });
   });
   return create_verts_tree_data(this->runtime->bvh_cache_verts.data().get(), positions);
 }
@@ -718,7 +933,11 @@ blender::bke::BVHTreeFromMesh Mesh::bvh_edges() const
   const Span<float3> positions = this->vert_positions();
   const Span<int2> edges = this->edges();
   this->runtime->bvh_cache_edges.ensure([&](std::unique_ptr<BVHTree, BVHTreeDeleter> &data) {
-    data = create_tree_from_edges(positions, edges, edges.index_range());
+    data = refit_or_build_tree(
+        this->runtime->bvh_refit_cache->edges,
+        this->edges_num,
+        [&](BVHTree &tree) { refit_tree_from_edges(tree, positions, edges); },
+        [&]() { return create_tree_from_edges(positions, edges, edges.index_range()); });
   });
   return create_edges_tree_data(this->runtime->bvh_cache_edges.data().get(), positions, edges);
 }
@@ -773,7 +992,11 @@ blender::bke::BVHTreeFromMesh Mesh::bvh_corner_tris() const
   const Span<int> corner_verts = this->corner_verts();
   const Span<int3> corner_tris = this->corner_tris();
   this->runtime->bvh_cache_corner_tris.ensure([&](std::unique_ptr<BVHTree, BVHTreeDeleter> &data) {
-    data = create_tree_from_tris(positions, corner_verts, corner_tris);
+    data = refit_or_build_tree(
+        this->runtime->bvh_refit_cache->corner_tris,
+        int(corner_tris.size()),
+        [&](BVHTree &tree) { refit_tree_from_tris(tree, positions, corner_verts, corner_tris); },
+        [&]() { return create_tree_from_tris(positions, corner_verts, corner_tris); });
   });
   return create_tris_tree_data(
       this->runtime->bvh_cache_corner_tris.data().get(), positions, corner_verts, corner_tris);
@@ -808,6 +1031,52 @@ BVHTreeFromMesh bvhtree_from_mesh_verts_init(const Mesh &mesh, const IndexMask &
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Ray-Cast
+ * \{ */
+
+/** Number of rays that are cast together. */
+static constexpr int64_t RAYCAST_PACKET_SIZE = 16;
+
+void bvhtree_ray_cast_batch(const BVHTreeFromMesh &tree_data,
+                            const IndexMask &mask,
+                            const Span<float3> origins,
+                            const Span<float3> directions,
+                            const float radius,
+                            MutableSpan<BVHTreeRayHit> r_hits)
+{
+  if (tree_data.tree == nullptr) {
+    return;
+  }
+  mask.foreach_segment(GrainSize(1024), [&](const IndexMaskSegment segment) {
+    std::array<float3, RAYCAST_PACKET_SIZE> packet_origins;
+    std::array<float3, RAYCAST_PACKET_SIZE> packet_directions;
+    std::array<BVHTreeRayHit, RAYCAST_PACKET_SIZE> packet_hits;
+    for (int64_t start = 0; start < segment.size(); start += RAYCAST_PACKET_SIZE) {
+      const IndexMaskSegment packet = segment.slice(
+          start, std::min(RAYCAST_PACKET_SIZE, segment.size() - start));
+      for (const int64_t i : packet.index_range()) {
+        packet_origins[i] = origins[packet[i]];
+        packet_directions[i] = directions[packet[i]];
+        packet_hits[i] = r_hits[packet[i]];
+      }
+      BLI_bvhtree_ray_cast_packet(tree_data.tree,
+                                  Span(packet_origins).take_front(packet.size()),
+                                  Span(packet_directions).take_front(packet.size()),
+                                  radius,
+                                  MutableSpan(packet_hits).take_front(packet.size()),
+                                  tree_data.raycast_callback,
+                                  const_cast<BVHTreeFromMesh *>(&tree_data),
+                                  BVH_RAYCAST_DEFAULT);
+      for (const int64_t i : packet.index_range()) {
+        r_hits[packet[i]] = packet_hits[i];
+      }
+    }
+  });
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Point Cloud BVH Building
  * \{ */
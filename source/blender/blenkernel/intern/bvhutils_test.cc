@@ -0,0 +1,257 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <cmath>
+
+#include "testing/testing.h"
+
+#include "BLI_index_mask.hh"
+#include "BLI_rand.hh"
+
+#include "BKE_bvhutils.hh"
+#include "BKE_idtype.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.hh"
+#include "BKE_mesh_types.hh"
+
+namespace blender::bke::tests {
+
+class BVHUtilsTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    bvhtree_cache_stats_reset();
+  }
+};
+
+/** Create a flat grid of quads in the XY plane, with faces from 0 to \a size on both axes. */
+static Mesh *create_grid_mesh(const int size)
+{
+  const int verts_size = size + 1;
+  Mesh *mesh = BKE_mesh_new_nomain(verts_size * verts_size, 0, size * size, size * size * 4);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  for (const int y : IndexRange(verts_size)) {
+    for (const int x : IndexRange(verts_size)) {
+      positions[y * verts_size + x] = float3(float(x), float(y), 0.0f);
+    }
+  }
+  MutableSpan<int> face_offsets = mesh->face_offsets_for_write();
+  MutableSpan<int> corner_verts = mesh->corner_verts_for_write();
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      const int face = y * size + x;
+      face_offsets[face] = face * 4;
+      corner_verts[face * 4 + 0] = y * verts_size + x;
+      corner_verts[face * 4 + 1] = y * verts_size + x + 1;
+      corner_verts[face * 4 + 2] = (y + 1) * verts_size + x + 1;
+      corner_verts[face * 4 + 3] = (y + 1) * verts_size + x;
+    }
+  }
+  face_offsets.last() = size * size * 4;
+  return mesh;
+}
+
+static void deform_mesh(Mesh &mesh, const float time)
+{
+  MutableSpan<float3> positions = mesh.vert_positions_for_write();
+  for (float3 &position : positions) {
+    position.z = std::sin(position.x * 0.3f + time) * std::cos(position.y * 0.2f + time);
+  }
+  mesh.tag_positions_changed();
+}
+
+/** Cast rays down onto the grid, and compare the hits with those of a newly built tree. */
+static void expect_same_raycast_as_new_tree(const Mesh &mesh, const int size)
+{
+  const BVHTreeFromMesh cached = mesh.bvh_corner_tris();
+  const BVHTreeFromMesh built = bvhtree_from_mesh_corner_tris_ex(mesh.vert_positions(),
+                                                                 mesh.faces(),
+                                                                 mesh.corner_verts(),
+                                                                 mesh.corner_tris(),
+                                                                 mesh.faces().index_range());
+  ASSERT_NE(cached.tree, nullptr);
+  ASSERT_NE(built.tree, nullptr);
+  const float3 dir(0.0f, 0.0f, -1.0f);
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      /* Avoid edges of the triangles where multiple hits have the same distance. */
+      const float3 co(float(x) + 0.3f, float(y) + 0.6f, 10.0f);
+      BVHTreeRayHit hit_cached{};
+      hit_cached.index = -1;
+      hit_cached.dist = BVH_RAYCAST_DIST_MAX;
+      BLI_bvhtree_ray_cast(cached.tree,
+                           co,
+                           dir,
+                           0.0f,
+                           &hit_cached,
+                           cached.raycast_callback,
+                           const_cast<BVHTreeFromMesh *>(&cached));
+      BVHTreeRayHit hit_built{};
+      hit_built.index = -1;
+      hit_built.dist = BVH_RAYCAST_DIST_MAX;
+      BLI_bvhtree_ray_cast(built.tree,
+                           co,
+                           dir,
+                           0.0f,
+                           &hit_built,
+                           built.raycast_callback,
+                           const_cast<BVHTreeFromMesh *>(&built));
+      EXPECT_NE(hit_cached.index, -1);
+      EXPECT_EQ(hit_cached.index, hit_built.index);
+      EXPECT_FLOAT_EQ(hit_cached.dist, hit_built.dist);
+    }
+  }
+}
+
+TEST_F(BVHUtilsTest, RefitDeformedCopies)
+{
+  const int size = 32;
+  Mesh *mesh = create_grid_mesh(size);
+
+  /* Like the evaluated mesh of every frame, which is freed before evaluating the next frame. */
+  for (const int frame : IndexRange(4)) {
+    Mesh *mesh_eval = BKE_mesh_copy_for_eval(*mesh);
+    deform_mesh(*mesh_eval, float(frame) * 0.1f);
+    expect_same_raycast_as_new_tree(*mesh_eval, size);
+    BKE_id_free(nullptr, mesh_eval);
+  }
+
+  const BVHCacheStats stats = bvhtree_cache_stats_get();
+  EXPECT_EQ(stats.build_num, 1);
+  EXPECT_EQ(stats.refit_num, 3);
+  EXPECT_EQ(stats.degraded_num, 0);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(BVHUtilsTest, RefitThroughIntermediateCopy)
+{
+  const int size = 16;
+  Mesh *mesh = create_grid_mesh(size);
+
+  Mesh *mesh_eval = BKE_mesh_copy_for_eval(*mesh);
+  mesh_eval->bvh_corner_tris();
+  BKE_id_free(nullptr, mesh_eval);
+
+  /* The input of a modifier is freed before the tree is requested from its result. */
+  Mesh *mesh_input = BKE_mesh_copy_for_eval(*mesh);
+  deform_mesh(*mesh_input, 0.5f);
+  mesh_eval = BKE_mesh_copy_for_eval(*mesh_input);
+  BKE_id_free(nullptr, mesh_input);
+  expect_same_raycast_as_new_tree(*mesh_eval, size);
+  BKE_id_free(nullptr, mesh_eval);
+
+  const BVHCacheStats stats = bvhtree_cache_stats_get();
+  EXPECT_EQ(stats.build_num, 1);
+  EXPECT_EQ(stats.refit_num, 1);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(BVHUtilsTest, FreeUnusedStoredTrees)
+{
+  const int size = 8;
+  Mesh *mesh = create_grid_mesh(size);
+
+  Mesh *mesh_eval = BKE_mesh_copy_for_eval(*mesh);
+  mesh_eval->bvh_corner_tris();
+  BKE_id_free(nullptr, mesh_eval);
+  EXPECT_EQ(bvhtree_cache_stats_get().stored_num, 1);
+
+  /* An evaluation that does not use the tree frees it. */
+  mesh_eval = BKE_mesh_copy_for_eval(*mesh);
+  deform_mesh(*mesh_eval, 0.5f);
+  BKE_id_free(nullptr, mesh_eval);
+  EXPECT_EQ(bvhtree_cache_stats_get().stored_num, 0);
+
+  mesh_eval = BKE_mesh_copy_for_eval(*mesh);
+  mesh_eval->bvh_corner_tris();
+  BKE_id_free(nullptr, mesh_eval);
+
+  const BVHCacheStats stats = bvhtree_cache_stats_get();
+  EXPECT_EQ(stats.build_num, 2);
+  EXPECT_EQ(stats.refit_num, 0);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(BVHUtilsTest, FreeStoredTreesWithMesh)
+{
+  const int size = 8;
+  Mesh *mesh = create_grid_mesh(size);
+
+  Mesh *mesh_eval = BKE_mesh_copy_for_eval(*mesh);
+  mesh_eval->bvh_verts();
+  mesh_eval->bvh_corner_tris();
+  BKE_id_free(nullptr, mesh_eval);
+
+  BVHCacheStats stats = bvhtree_cache_stats_get();
+  EXPECT_EQ(stats.stored_num, 2);
+  EXPECT_GT(stats.stored_size, size_t(0));
+
+  BKE_id_free(nullptr, mesh);
+  stats = bvhtree_cache_stats_get();
+  EXPECT_EQ(stats.stored_num, 0);
+  EXPECT_EQ(stats.stored_size, size_t(0));
+}
+
+TEST_F(BVHUtilsTest, RefitInPlace)
+{
+  const int size = 16;
+  Mesh *mesh = create_grid_mesh(size);
+  expect_same_raycast_as_new_tree(*mesh, size);
+  deform_mesh(*mesh, 0.5f);
+  expect_same_raycast_as_new_tree(*mesh, size);
+
+  const BVHCacheStats stats = bvhtree_cache_stats_get();
+  EXPECT_EQ(stats.build_num, 1);
+  EXPECT_EQ(stats.refit_num, 1);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(BVHUtilsTest, RebuildDegraded)
+{
+  const int size = 16;
+  Mesh *mesh = create_grid_mesh(size);
+  mesh->bvh_corner_tris();
+
+  /* Scrambling the vertices makes all triangles overlap, so refitting is not worth it. */
+  RandomNumberGenerator rng(0);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  for (float3 &position : positions) {
+    position = float3(rng.get_float(), rng.get_float(), rng.get_float()) * float(size);
+  }
+  mesh->tag_positions_changed();
+  mesh->bvh_corner_tris();
+
+  const BVHCacheStats stats = bvhtree_cache_stats_get();
+  EXPECT_EQ(stats.build_num, 2);
+  EXPECT_EQ(stats.refit_num, 0);
+  EXPECT_EQ(stats.degraded_num, 1);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(BVHUtilsTest, NoRefitAfterTopologyChange)
+{
+  const int size = 8;
+  Mesh *mesh = create_grid_mesh(size);
+  mesh->bvh_corner_tris();
+  mesh->tag_topology_changed();
+  mesh->bvh_corner_tris();
+
+  const BVHCacheStats stats = bvhtree_cache_stats_get();
+  EXPECT_EQ(stats.build_num, 2);
+  EXPECT_EQ(stats.refit_num, 0);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
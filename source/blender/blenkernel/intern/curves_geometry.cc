@@ -1619,7 +1619,15 @@ void CurvesGeometry::blend_read(BlendDataReader &reader)
 
   if (this->curve_offsets) {
     this->runtime->curve_offsets_sharing_info = BLO_read_shared(
-        &reader, &this->curve_offsets, [&]() {
+        &reader, &this->curve_offsets, [&]() -> const ImplicitSharingInfo * {
+          if (const ImplicitSharingInfo *sharing_info = BLO_read_mapped_array(
+                  &reader,
+                  sizeof(int) * (this->curve_num + 1),
+                  alignof(int),
+                  reinterpret_cast<void **>(&this->curve_offsets)))
+          {
+            return sharing_info;
+          }
           BLO_read_int32_array(&reader, this->curve_num + 1, &this->curve_offsets);
           return implicit_sharing::info_for_mem_free(this->curve_offsets);
         });
@@ -5356,6 +5356,28 @@ static void blend_read_layer_data(BlendDataReader *reader, CustomDataLayer &laye
   }
 }
 
+/**
+ * Reference the layer data in the memory-mapped file directly if possible. This only works for
+ * types that don't own any other data and don't need processing after reading.
+ */
+static const ImplicitSharingInfo *blend_read_layer_data_mapped(BlendDataReader *reader,
+                                                               CustomDataLayer &layer,
+                                                               const int count)
+{
+  const LayerTypeInfo *typeInfo = layerType_getInfo(eCustomDataType(layer.type));
+  if (typeInfo->free != nullptr || typeInfo->copy != nullptr) {
+    return nullptr;
+  }
+  const char *structname;
+  int structnum;
+  CustomData_file_write_info(eCustomDataType(layer.type), &structname, &structnum);
+  if (structnum == 0) {
+    return nullptr;
+  }
+  return BLO_read_mapped_array(
+      reader, int64_t(typeInfo->size) * count, typeInfo->alignment, &layer.data);
+}
+
 void CustomData_blend_read(BlendDataReader *reader, CustomData *data, const int count)
 {
   BLO_read_struct_array(reader, CustomDataLayer, data->totlayer, &data->layers);
@@ -5381,6 +5403,11 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, const int
     if (CustomData_verify_versions(data, i)) {
       layer->sharing_info = BLO_read_shared(
           reader, &layer->data, [&]() -> const ImplicitSharingInfo * {
+            if (const ImplicitSharingInfo *sharing_info = blend_read_layer_data_mapped(
+                    reader, *layer, count))
+            {
+              return sharing_info;
+            }
             blend_read_layer_data(reader, *layer, count);
             if (layer->data == nullptr) {
               return nullptr;
@@ -45,6 +45,7 @@
 #include "BKE_attribute.hh"
 #include "BKE_bake_data_block_id.hh"
 #include "BKE_bpath.hh"
+#include "BKE_bvhutils.hh"
 #include "BKE_deform.hh"
 #include "BKE_editmesh.hh"
 #include "BKE_editmesh_cache.hh"
@@ -161,6 +162,9 @@ static void mesh_copy_data(Main *bmain,
   mesh_dst->runtime->bvh_cache_loose_edges = mesh_src->runtime->bvh_cache_loose_edges;
   mesh_dst->runtime->bvh_cache_loose_edges_no_hidden =
       mesh_src->runtime->bvh_cache_loose_edges_no_hidden;
+  mesh_dst->runtime->bvh_refit_cache = mesh_src->runtime->bvh_refit_cache;
+  mesh_dst->runtime->bvh_refit_generation = mesh_src->runtime->bvh_refit_cache->generation;
+  mesh_src->runtime->bvh_refit_cache_copied = true;
   mesh_dst->runtime->max_material_index = mesh_src->runtime->max_material_index;
   if (mesh_src->runtime->bake_materials) {
     mesh_dst->runtime->bake_materials = std::make_unique<blender::bke::bake::BakeMaterialsList>(
@@ -430,7 +434,15 @@ static void mesh_blend_read_data(BlendDataReader *reader, ID *id)
 
   if (mesh->face_offset_indices) {
     mesh->runtime->face_offsets_sharing_info = BLO_read_shared(
-        reader, &mesh->face_offset_indices, [&]() {
+        reader, &mesh->face_offset_indices, [&]() -> const blender::ImplicitSharingInfo * {
+          if (const blender::ImplicitSharingInfo *sharing_info = BLO_read_mapped_array(
+                  reader,
+                  sizeof(int) * (mesh->faces_num + 1),
+                  alignof(int),
+                  reinterpret_cast<void **>(&mesh->face_offset_indices)))
+          {
+            return sharing_info;
+          }
           BLO_read_int32_array(reader, mesh->faces_num + 1, &mesh->face_offset_indices);
           return blender::implicit_sharing::info_for_mem_free(mesh->face_offset_indices);
         });
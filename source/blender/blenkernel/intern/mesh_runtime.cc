@@ -46,12 +46,10 @@ static void free_batch_cache(MeshRuntime &mesh_runtime)
   }
 }
 
-static void free_bvh_caches(MeshRuntime &mesh_runtime)
+/** Free the trees that are not stored for refitting, see #store_bvh_caches_for_refit. */
+static void free_non_refit_bvh_caches(MeshRuntime &mesh_runtime)
 {
-  mesh_runtime.bvh_cache_verts.tag_dirty();
-  mesh_runtime.bvh_cache_edges.tag_dirty();
   mesh_runtime.bvh_cache_faces.tag_dirty();
-  mesh_runtime.bvh_cache_corner_tris.tag_dirty();
   mesh_runtime.bvh_cache_corner_tris_no_hidden.tag_dirty();
   mesh_runtime.bvh_cache_loose_verts.tag_dirty();
   mesh_runtime.bvh_cache_loose_verts_no_hidden.tag_dirty();
@@ -59,10 +57,72 @@ static void free_bvh_caches(MeshRuntime &mesh_runtime)
   mesh_runtime.bvh_cache_loose_edges_no_hidden.tag_dirty();
 }
 
-MeshRuntime::MeshRuntime() = default;
+static void free_bvh_caches(MeshRuntime &mesh_runtime)
+{
+  mesh_runtime.bvh_cache_verts.tag_dirty();
+  mesh_runtime.bvh_cache_edges.tag_dirty();
+  mesh_runtime.bvh_cache_corner_tris.tag_dirty();
+  free_non_refit_bvh_caches(mesh_runtime);
+}
+
+static void reset_bvh_refit_cache(MeshRuntime &mesh_runtime)
+{
+  mesh_runtime.bvh_refit_cache = std::make_shared<BVHRefitCache>();
+  mesh_runtime.bvh_refit_generation = 0;
+  mesh_runtime.bvh_refit_cache_copied = false;
+}
+
+static void store_bvh_cache_for_refit(BVHRefitCache &refit_cache,
+                                      BVHRefitCache::Entry &entry,
+                                      std::optional<std::unique_ptr<BVHTree, BVHTreeDeleter>> tree,
+                                      const uint64_t mesh_generation,
+                                      const bool free_unused)
+{
+  if (tree && *tree) {
+    bvhtree_refit_cache_store(refit_cache, entry, std::move(*tree));
+  }
+  else if (free_unused) {
+    /* The tree was stored before the mesh was created, and the mesh did not reuse it. */
+    bvhtree_refit_cache_free_stored_before(entry, mesh_generation);
+  }
+}
+
+/**
+ * Move the trees that are not used by other meshes to the refit cache, so that they can be refit
+ * to new positions instead of being freed and built again. The cached trees are tagged dirty.
+ *
+ * \param free_unused: Free stored trees that this mesh could have reused but did not, so that
+ * trees are not kept indefinitely when they are not needed anymore.
+ */
+static void store_bvh_caches_for_refit(MeshRuntime &mesh_runtime, const bool free_unused)
+{
+  std::optional<std::unique_ptr<BVHTree, BVHTreeDeleter>> verts =
+      mesh_runtime.bvh_cache_verts.release();
+  std::optional<std::unique_ptr<BVHTree, BVHTreeDeleter>> edges =
+      mesh_runtime.bvh_cache_edges.release();
+  std::optional<std::unique_ptr<BVHTree, BVHTreeDeleter>> corner_tris =
+      mesh_runtime.bvh_cache_corner_tris.release();
+  BVHRefitCache &refit_cache = *mesh_runtime.bvh_refit_cache;
+  const uint64_t generation = mesh_runtime.bvh_refit_generation;
+  store_bvh_cache_for_refit(
+      refit_cache, refit_cache.verts, std::move(verts), generation, free_unused);
+  store_bvh_cache_for_refit(
+      refit_cache, refit_cache.edges, std::move(edges), generation, free_unused);
+  store_bvh_cache_for_refit(
+      refit_cache, refit_cache.corner_tris, std::move(corner_tris), generation, free_unused);
+}
+
+MeshRuntime::MeshRuntime() : bvh_refit_cache(std::make_shared<BVHRefitCache>()) {}
 
 MeshRuntime::~MeshRuntime()
 {
+  if (bvh_refit_cache.use_count() > 1) {
+    /* Another mesh with the same topology may be evaluated again, e.g. on the next frame. When
+     * this mesh is the last of its evaluation and did not use a stored tree, the tree is not
+     * needed anymore. Copies of the mesh may still use it, e.g. when this mesh was the input of
+     * a modifier. */
+    store_bvh_caches_for_refit(*this, !bvh_refit_cache_copied);
+  }
   free_mesh_eval(*this);
   free_batch_cache(*this);
 }
@@ -314,6 +374,7 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
 {
   /* Tagging shared caches dirty will free the allocated data if there is only one user. */
   free_bvh_caches(*mesh->runtime);
+  reset_bvh_refit_cache(*mesh->runtime);
   mesh->runtime->subdiv_ccg.reset();
   mesh->runtime->bounds_cache.tag_dirty();
   mesh->runtime->vert_to_face_offset_cache.tag_dirty();
@@ -339,6 +400,7 @@ void Mesh::tag_edges_split()
 {
   /* Triangulation didn't change because vertex positions and loop vertex indices didn't change. */
   free_bvh_caches(*this->runtime);
+  reset_bvh_refit_cache(*this->runtime);
   this->runtime->vert_normals_cache.tag_dirty();
   this->runtime->subdiv_ccg.reset();
   this->runtime->vert_to_face_offset_cache.tag_dirty();
@@ -394,7 +456,8 @@ void Mesh::tag_positions_changed()
 
 void Mesh::tag_positions_changed_no_normals()
 {
-  free_bvh_caches(*this->runtime);
+  store_bvh_caches_for_refit(*this->runtime, false);
+  free_non_refit_bvh_caches(*this->runtime);
   this->runtime->corner_tris_cache.tag_dirty();
   this->runtime->bounds_cache.tag_dirty();
   this->runtime->shrinkwrap_boundary_cache.tag_dirty();
@@ -403,7 +466,8 @@ void Mesh::tag_positions_changed_no_normals()
 void Mesh::tag_positions_changed_uniformly()
 {
   /* The normals and triangulation didn't change, since all verts moved by the same amount. */
-  free_bvh_caches(*this->runtime);
+  store_bvh_caches_for_refit(*this->runtime, false);
+  free_non_refit_bvh_caches(*this->runtime);
   this->runtime->bounds_cache.tag_dirty();
 }
 
@@ -19,11 +19,13 @@
 #include "DNA_modifier_types.h"
 #include "DNA_object_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_math_geom.h"
 #include "BLI_math_matrix.h"
 #include "BLI_math_solvers.h"
 #include "BLI_math_vector.h"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #include "BKE_attribute.hh"
@@ -79,10 +81,6 @@ struct ShrinkwrapCalcCBData {
   ShrinkwrapCalcData *calc;
 
   ShrinkwrapTreeData *tree;
-  ShrinkwrapTreeData *aux_tree;
-
-  float *proj_axis;
-  SpaceTransform *local2aux;
 };
 
 bool BKE_shrinkwrap_needs_normals(int shrinkType, int shrinkMode)
@@ -382,6 +380,57 @@ static void shrinkwrap_calc_nearest_vertex(ShrinkwrapCalcData *calc)
       0, calc->numVerts, &data, shrinkwrap_calc_nearest_vertex_cb_ex, &settings);
 }
 
+/* don't use this because this dist value could be incompatible
+ * this value used by the callback for comparing previous/new dist values.
+ * also, at the moment there is no need to have a corrected 'dist' value */
+// #define USE_DIST_CORRECT
+
+/**
+ * Move the ray-cast hit in \a hit_tmp back to local space and copy it to \a hit,
+ * unless it is culled by \a options.
+ */
+static bool shrinkwrap_project_normal_accept(const char options,
+                                             const float vert[3],
+                                             const float dir[3],
+                                             const SpaceTransform *transf,
+                                             BVHTreeRayHit *hit_tmp,
+                                             BVHTreeRayHit *hit)
+{
+#ifndef USE_DIST_CORRECT
+  UNUSED_VARS(vert);
+#endif
+  if (hit_tmp->index != -1) {
+    /* invert the normal first so face culling works on rotated objects */
+    if (transf) {
+      BLI_space_transform_invert_normal(transf, hit_tmp->no);
+    }
+
+    if (options & MOD_SHRINKWRAP_CULL_TARGET_MASK) {
+      /* Apply back-face. */
+      const float dot = dot_v3v3(dir, hit_tmp->no);
+      if (((options & MOD_SHRINKWRAP_CULL_TARGET_FRONTFACE) && dot <= 0.0f) ||
+          ((options & MOD_SHRINKWRAP_CULL_TARGET_BACKFACE) && dot >= 0.0f))
+      {
+        return false; /* Ignore hit */
+      }
+    }
+
+    if (transf) {
+      /* Inverting space transform (TODO: make coherent with the initial dist readjust). */
+      BLI_space_transform_invert(transf, hit_tmp->co);
+#ifdef USE_DIST_CORRECT
+      hit_tmp->dist = len_v3v3(vert, hit_tmp->co);
+#endif
+    }
+
+    BLI_assert(hit_tmp->dist <= hit->dist);
+
+    memcpy(hit, hit_tmp, sizeof(*hit_tmp));
+    return true;
+  }
+  return false;
+}
+
 bool BKE_shrinkwrap_project_normal(char options,
                                    const float vert[3],
                                    const float dir[3],
@@ -390,11 +439,6 @@ bool BKE_shrinkwrap_project_normal(char options,
                                    ShrinkwrapTreeData *tree,
                                    BVHTreeRayHit *hit)
 {
-  /* don't use this because this dist value could be incompatible
-   * this value used by the callback for comparing previous/new dist values.
-   * also, at the moment there is no need to have a corrected 'dist' value */
-  // #define USE_DIST_CORRECT
-
   float tmp_co[3], tmp_no[3];
   const float *co, *no;
   BVHTreeRayHit hit_tmp;
@@ -426,173 +470,69 @@ bool BKE_shrinkwrap_project_normal(char options,
   BLI_bvhtree_ray_cast(
       tree->bvh, co, no, ray_radius, &hit_tmp, tree->treeData.raycast_callback, &tree->treeData);
 
-  if (hit_tmp.index != -1) {
-    /* invert the normal first so face culling works on rotated objects */
-    if (transf) {
-      BLI_space_transform_invert_normal(transf, hit_tmp.no);
-    }
-
-    if (options & MOD_SHRINKWRAP_CULL_TARGET_MASK) {
-      /* Apply back-face. */
-      const float dot = dot_v3v3(dir, hit_tmp.no);
-      if (((options & MOD_SHRINKWRAP_CULL_TARGET_FRONTFACE) && dot <= 0.0f) ||
-          ((options & MOD_SHRINKWRAP_CULL_TARGET_BACKFACE) && dot >= 0.0f))
-      {
-        return false; /* Ignore hit */
-      }
-    }
-
-    if (transf) {
-      /* Inverting space transform (TODO: make coherent with the initial dist readjust). */
-      BLI_space_transform_invert(transf, hit_tmp.co);
-#ifdef USE_DIST_CORRECT
-      hit_tmp.dist = len_v3v3(vert, hit_tmp.co);
-#endif
-    }
-
-    BLI_assert(hit_tmp.dist <= hit->dist);
-
-    memcpy(hit, &hit_tmp, sizeof(hit_tmp));
-    return true;
-  }
-  return false;
+  return shrinkwrap_project_normal_accept(options, vert, dir, transf, &hit_tmp, hit);
 }
 
-static void shrinkwrap_calc_normal_projection_cb_ex(void *__restrict userdata,
-                                                    const int i,
-                                                    const TaskParallelTLS *__restrict tls)
-{
-  ShrinkwrapCalcCBData *data = static_cast<ShrinkwrapCalcCBData *>(userdata);
-
-  ShrinkwrapCalcData *calc = data->calc;
-  ShrinkwrapTreeData *tree = data->tree;
-  ShrinkwrapTreeData *aux_tree = data->aux_tree;
-
-  float *proj_axis = data->proj_axis;
-  SpaceTransform *local2aux = data->local2aux;
-
-  BVHTreeRayHit *hit = static_cast<BVHTreeRayHit *>(tls->userdata_chunk);
-
-  const float proj_limit_squared = calc->smd->projLimit * calc->smd->projLimit;
-  float *co = calc->vertexCos[i];
-  const float *tmp_co, *tmp_no;
-  float weight = BKE_defvert_array_find_weight_safe(
-      calc->dvert, i, calc->vgroup, calc->invert_vgroup);
-
-  if (weight == 0.0f) {
-    return;
-  }
-
-  if (calc->vert_positions != nullptr && calc->smd->projAxis == MOD_SHRINKWRAP_PROJECT_OVER_NORMAL)
-  {
-    /* calc->vert_positions contains verts from evaluated mesh. */
-    /* These coordinates are deformed by vertexCos only for normal projection
-     * (to get correct normals) for other cases calc->verts contains undeformed coordinates and
-     * vertexCos should be used */
-    tmp_co = calc->vert_positions[i];
-    tmp_no = calc->vert_normals[i];
-  }
-  else {
-    tmp_co = co;
-    tmp_no = proj_axis;
-  }
-
-  hit->index = -1;
-
-  /* TODO: we should use FLT_MAX here, but sweep-sphere code isn't prepared for that. */
-  hit->dist = BVH_RAYCAST_DIST_MAX;
-
-  bool is_aux = false;
-
-  /* Project over positive direction of axis. */
-  if (calc->smd->shrinkOpts & MOD_SHRINKWRAP_PROJECT_ALLOW_POS_DIR) {
-    if (aux_tree) {
-      if (BKE_shrinkwrap_project_normal(0, tmp_co, tmp_no, 0.0, local2aux, aux_tree, hit)) {
-        is_aux = true;
-      }
-    }
-
-    if (BKE_shrinkwrap_project_normal(
-            calc->smd->shrinkOpts, tmp_co, tmp_no, 0.0, &calc->local2target, tree, hit))
-    {
-      is_aux = false;
-    }
-  }
-
-  /* Project over negative direction of axis */
-  if (calc->smd->shrinkOpts & MOD_SHRINKWRAP_PROJECT_ALLOW_NEG_DIR) {
-    float inv_no[3];
-    negate_v3_v3(inv_no, tmp_no);
-
-    char options = calc->smd->shrinkOpts;
-
-    if ((options & MOD_SHRINKWRAP_INVERT_CULL_TARGET) &&
-        (options & MOD_SHRINKWRAP_CULL_TARGET_MASK))
-    {
-      options ^= MOD_SHRINKWRAP_CULL_TARGET_MASK;
-    }
+/** Number of neighboring vertices whose rays are cast together. */
+static constexpr int64_t SHRINKWRAP_RAY_PACKET_SIZE = 16;
 
-    if (aux_tree) {
-      if (BKE_shrinkwrap_project_normal(0, tmp_co, inv_no, 0.0, local2aux, aux_tree, hit)) {
-        is_aux = true;
-      }
+/**
+ * Same as #BKE_shrinkwrap_project_normal for a packet of at most #SHRINKWRAP_RAY_PACKET_SIZE
+ * vertices, the rays are cast together with #BLI_bvhtree_ray_cast_packet.
+ *
+ * \param r_is_aux: Set to \a is_aux for the vertices whose hit has been replaced.
+ */
+static void shrinkwrap_project_normal_packet(const char options,
+                                             const blender::Span<blender::float3> verts,
+                                             const blender::Span<blender::float3> dirs,
+                                             const SpaceTransform *transf,
+                                             ShrinkwrapTreeData *tree,
+                                             const bool is_aux,
+                                             blender::MutableSpan<BVHTreeRayHit> hits,
+                                             blender::MutableSpan<bool> r_is_aux)
+{
+  using namespace blender;
+  BLI_assert(verts.size() <= SHRINKWRAP_RAY_PACKET_SIZE);
+  Array<float3, SHRINKWRAP_RAY_PACKET_SIZE> tree_verts(verts.size());
+  Array<float3, SHRINKWRAP_RAY_PACKET_SIZE> tree_dirs(verts.size());
+  Array<BVHTreeRayHit, SHRINKWRAP_RAY_PACKET_SIZE> tree_hits(verts.size());
+
+  /* Apply space transform (TODO readjust dist). */
+  for (const int64_t i : verts.index_range()) {
+    tree_verts[i] = verts[i];
+    tree_dirs[i] = dirs[i];
+    if (transf) {
+      BLI_space_transform_apply(transf, tree_verts[i]);
+      BLI_space_transform_apply_normal(transf, tree_dirs[i]);
     }
-
-    if (BKE_shrinkwrap_project_normal(
-            options, tmp_co, inv_no, 0.0, &calc->local2target, tree, hit))
+    tree_hits[i] = hits[i];
+    tree_hits[i].index = -1;
+  }
+
+  BLI_bvhtree_ray_cast_packet(tree->bvh,
+                              tree_verts,
+                              tree_dirs,
+                              0.0f,
+                              tree_hits,
+                              tree->treeData.raycast_callback,
+                              &tree->treeData,
+                              BVH_RAYCAST_DEFAULT);
+
+  for (const int64_t i : verts.index_range()) {
+    if (shrinkwrap_project_normal_accept(
+            options, verts[i], dirs[i], transf, &tree_hits[i], &hits[i]))
     {
-      is_aux = false;
-    }
-  }
-
-  /* don't set the initial dist (which is more efficient),
-   * because its calculated in the targets space, we want the dist in our own space */
-  if (proj_limit_squared != 0.0f) {
-    if (hit->index != -1 && len_squared_v3v3(hit->co, co) > proj_limit_squared) {
-      hit->index = -1;
+      r_is_aux[i] = is_aux;
     }
   }
-
-  if (hit->index != -1) {
-    if (is_aux) {
-      BKE_shrinkwrap_snap_point_to_surface(aux_tree,
-                                           local2aux,
-                                           calc->smd->shrinkMode,
-                                           hit->index,
-                                           hit->co,
-                                           hit->no,
-                                           calc->keepDist,
-                                           tmp_co,
-                                           hit->co);
-    }
-    else {
-      BKE_shrinkwrap_snap_point_to_surface(tree,
-                                           &calc->local2target,
-                                           calc->smd->shrinkMode,
-                                           hit->index,
-                                           hit->co,
-                                           hit->no,
-                                           calc->keepDist,
-                                           tmp_co,
-                                           hit->co);
-    }
-
-    interp_v3_v3v3(co, co, hit->co, weight);
-  }
 }
 
 static void shrinkwrap_calc_normal_projection(ShrinkwrapCalcData *calc)
 {
+  using namespace blender;
   /* Options about projection direction */
   float proj_axis[3] = {0.0f, 0.0f, 0.0f};
 
-  /* Ray-cast and tree stuff. */
-
-  /** \note 'hit.dist' is kept in the targets space, this is only used
-   * for finding the best hit, to get the real dist,
-   * measure the len_v3v3() from the input coord to hit.co */
-  BVHTreeRayHit hit;
-
   /* auxiliary target */
   Mesh *auxMesh = nullptr;
   ShrinkwrapTreeData *aux_tree = nullptr;
@@ -648,20 +588,166 @@ static void shrinkwrap_calc_normal_projection(ShrinkwrapCalcData *calc)
     aux_tree = &aux_tree_stack;
   }
 
-  /* After successfully build the trees, start projection vertices. */
-  ShrinkwrapCalcCBData data{};
-  data.calc = calc;
-  data.tree = calc->tree;
-  data.aux_tree = aux_tree;
-  data.proj_axis = proj_axis;
-  data.local2aux = &local2aux;
-  TaskParallelSettings settings;
-  BLI_parallel_range_settings_defaults(&settings);
-  settings.use_threading = (calc->numVerts > 10000);
-  settings.userdata_chunk = &hit;
-  settings.userdata_chunk_size = sizeof(hit);
-  BLI_task_parallel_range(
-      0, calc->numVerts, &data, shrinkwrap_calc_normal_projection_cb_ex, &settings);
+  /* After successfully build the trees, start projection vertices. Neighboring vertices are
+   * projected in packets, so that they can share the BVH traversal. */
+  const bool use_vert_normals = calc->vert_positions != nullptr &&
+                                calc->smd->projAxis == MOD_SHRINKWRAP_PROJECT_OVER_NORMAL;
+
+  char inv_options = calc->smd->shrinkOpts;
+  if ((inv_options & MOD_SHRINKWRAP_INVERT_CULL_TARGET) &&
+      (inv_options & MOD_SHRINKWRAP_CULL_TARGET_MASK))
+  {
+    inv_options ^= MOD_SHRINKWRAP_CULL_TARGET_MASK;
+  }
+
+  const float proj_limit_squared = calc->smd->projLimit * calc->smd->projLimit;
+
+  threading::parallel_for(IndexRange(calc->numVerts), 1024, [&](const IndexRange range) {
+    Array<int, SHRINKWRAP_RAY_PACKET_SIZE> indices(SHRINKWRAP_RAY_PACKET_SIZE);
+    Array<float, SHRINKWRAP_RAY_PACKET_SIZE> weights(SHRINKWRAP_RAY_PACKET_SIZE);
+    Array<float3, SHRINKWRAP_RAY_PACKET_SIZE> verts(SHRINKWRAP_RAY_PACKET_SIZE);
+    Array<float3, SHRINKWRAP_RAY_PACKET_SIZE> dirs(SHRINKWRAP_RAY_PACKET_SIZE);
+    Array<BVHTreeRayHit, SHRINKWRAP_RAY_PACKET_SIZE> hits(SHRINKWRAP_RAY_PACKET_SIZE);
+    Array<bool, SHRINKWRAP_RAY_PACKET_SIZE> is_aux(SHRINKWRAP_RAY_PACKET_SIZE);
+    int64_t packet_size = 0;
+
+    const auto project_packet = [&]() {
+      const Span<float3> packet_verts = verts.as_span().take_front(packet_size);
+      const MutableSpan<BVHTreeRayHit> packet_hits = hits.as_mutable_span().take_front(
+          packet_size);
+      const MutableSpan<bool> packet_is_aux = is_aux.as_mutable_span().take_front(packet_size);
+
+      /** \note 'hit.dist' is kept in the targets space, this is only used
+       * for finding the best hit, to get the real dist,
+       * measure the len_v3v3() from the input coord to hit.co */
+      for (const int64_t i : IndexRange(packet_size)) {
+        hits[i].index = -1;
+        /* TODO: we should use FLT_MAX here, but sweep-sphere code isn't prepared for that. */
+        hits[i].dist = BVH_RAYCAST_DIST_MAX;
+        is_aux[i] = false;
+      }
+
+      /* Project over positive direction of axis. */
+      if (calc->smd->shrinkOpts & MOD_SHRINKWRAP_PROJECT_ALLOW_POS_DIR) {
+        const Span<float3> packet_dirs = dirs.as_span().take_front(packet_size);
+        if (aux_tree) {
+          shrinkwrap_project_normal_packet(0,
+                                           packet_verts,
+                                           packet_dirs,
+                                           &local2aux,
+                                           aux_tree,
+                                           true,
+                                           packet_hits,
+                                           packet_is_aux);
+        }
+        shrinkwrap_project_normal_packet(calc->smd->shrinkOpts,
+                                         packet_verts,
+                                         packet_dirs,
+                                         &calc->local2target,
+                                         calc->tree,
+                                         false,
+                                         packet_hits,
+                                         packet_is_aux);
+      }
+
+      /* Project over negative direction of axis */
+      if (calc->smd->shrinkOpts & MOD_SHRINKWRAP_PROJECT_ALLOW_NEG_DIR) {
+        Array<float3, SHRINKWRAP_RAY_PACKET_SIZE> inv_dirs(packet_size);
+        for (const int64_t i : IndexRange(packet_size)) {
+          inv_dirs[i] = -dirs[i];
+        }
+        const Span<float3> packet_inv_dirs = inv_dirs;
+        if (aux_tree) {
+          shrinkwrap_project_normal_packet(0,
+                                           packet_verts,
+                                           packet_inv_dirs,
+                                           &local2aux,
+                                           aux_tree,
+                                           true,
+                                           packet_hits,
+                                           packet_is_aux);
+        }
+        shrinkwrap_project_normal_packet(inv_options,
+                                         packet_verts,
+                                         packet_inv_dirs,
+                                         &calc->local2target,
+                                         calc->tree,
+                                         false,
+                                         packet_hits,
+                                         packet_is_aux);
+      }
+
+      for (const int64_t i : IndexRange(packet_size)) {
+        BVHTreeRayHit *hit = &hits[i];
+        float *co = calc->vertexCos[indices[i]];
+
+        /* don't set the initial dist (which is more efficient),
+         * because its calculated in the targets space, we want the dist in our own space */
+        if (proj_limit_squared != 0.0f) {
+          if (hit->index != -1 && len_squared_v3v3(hit->co, co) > proj_limit_squared) {
+            hit->index = -1;
+          }
+        }
+
+        if (hit->index != -1) {
+          if (is_aux[i]) {
+            BKE_shrinkwrap_snap_point_to_surface(aux_tree,
+                                                 &local2aux,
+                                                 calc->smd->shrinkMode,
+                                                 hit->index,
+                                                 hit->co,
+                                                 hit->no,
+                                                 calc->keepDist,
+                                                 verts[i],
+                                                 hit->co);
+          }
+          else {
+            BKE_shrinkwrap_snap_point_to_surface(calc->tree,
+                                                 &calc->local2target,
+                                                 calc->smd->shrinkMode,
+                                                 hit->index,
+                                                 hit->co,
+                                                 hit->no,
+                                                 calc->keepDist,
+                                                 verts[i],
+                                                 hit->co);
+          }
+
+          interp_v3_v3v3(co, co, hit->co, weights[i]);
+        }
+      }
+      packet_size = 0;
+    };
+
+    for (const int64_t i : range) {
+      const float weight = BKE_defvert_array_find_weight_safe(
+          calc->dvert, int(i), calc->vgroup, calc->invert_vgroup);
+      if (weight == 0.0f) {
+        continue;
+      }
+      indices[packet_size] = int(i);
+      weights[packet_size] = weight;
+      if (use_vert_normals) {
+        /* calc->vert_positions contains verts from evaluated mesh. */
+        /* These coordinates are deformed by vertexCos only for normal projection
+         * (to get correct normals) for other cases calc->verts contains undeformed coordinates
+         * and vertexCos should be used */
+        verts[packet_size] = calc->vert_positions[i];
+        dirs[packet_size] = calc->vert_normals[i];
+      }
+      else {
+        verts[packet_size] = calc->vertexCos[i];
+        dirs[packet_size] = proj_axis;
+      }
+      packet_size++;
+      if (packet_size == SHRINKWRAP_RAY_PACKET_SIZE) {
+        project_packet();
+      }
+    }
+    if (packet_size > 0) {
+      project_packet();
+    }
+  });
 
   /* free data structures */
   if (aux_tree) {
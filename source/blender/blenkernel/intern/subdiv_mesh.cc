@@ -10,13 +10,20 @@
 #include "DNA_mesh_types.h"
 
 #include "BLI_array.hh"
+#include "BLI_implicit_sharing_ptr.hh"
+#include "BLI_listbase.h"
 #include "BLI_math_vector.h"
 #include "BLI_math_vector.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_memory_counter.hh"
+#include "BLI_struct_equality_utils.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
 
 #include "BKE_attribute_math.hh"
 #include "BKE_customdata.hh"
 #include "BKE_key.hh"
+#include "BKE_lib_id.hh"
 #include "BKE_mesh.hh"
 #include "BKE_mesh_mapping.hh"
 #include "BKE_subdiv.hh"
@@ -32,6 +39,22 @@ namespace blender::bke::subdiv {
 /** \name Subdivision Context
  * \{ */
 
+/** Describes how the position of a subdivided vertex is computed from the coarse mesh. */
+struct VertexSource {
+  enum class Type : int8_t {
+    /** Limit surface point at #u, #v of the ptex face #index. */
+    Surface,
+    /** Position of the coarse loose vertex #index. */
+    LooseVertex,
+    /** Interpolated at #u along the coarse loose edge #index. */
+    LooseEdge,
+  };
+  Type type;
+  int index;
+  float u;
+  float v;
+};
+
 struct SubdivMeshContext {
   const ToMeshSettings *settings;
   const Mesh *coarse_mesh;
@@ -84,6 +107,11 @@ struct SubdivMeshContext {
   Array<int> vert_to_edge_offsets;
   Array<int> vert_to_edge_indices;
   GroupedSpan<int> vert_to_edge_map;
+
+  /* Optionally record how every vertex position is computed, to update them without the rest of
+   * the mesh later on. Allocated when the number of vertices is known. */
+  Array<VertexSource> *r_vertex_sources;
+  MutableSpan<VertexSource> vertex_sources;
 };
 
 static void subdiv_mesh_ctx_cache_uv_layers(SubdivMeshContext *ctx)
@@ -519,6 +547,18 @@ static void subdiv_accumulate_vertex_displacement(SubdivMeshContext *ctx,
   }
 }
 
+static void subdiv_mesh_record_vertex_source(const SubdivMeshContext *ctx,
+                                             const int subdiv_vertex_index,
+                                             const VertexSource::Type type,
+                                             const int index,
+                                             const float u,
+                                             const float v)
+{
+  if (!ctx->vertex_sources.is_empty()) {
+    ctx->vertex_sources[subdiv_vertex_index] = {type, index, u, v};
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -557,6 +597,10 @@ static bool subdiv_mesh_topology_info(const ForeachContext *foreach_context,
   if (num_faces != 0) {
     subdiv_mesh.face_offsets_for_write().last() = num_loops;
   }
+  if (subdiv_context->r_vertex_sources != nullptr) {
+    subdiv_context->r_vertex_sources->reinitialize(num_vertices);
+    subdiv_context->vertex_sources = *subdiv_context->r_vertex_sources;
+  }
 
   /* Create corner data for interpolation without topology attributes. */
   CustomData_init_from(&coarse_mesh.corner_data,
@@ -644,6 +688,8 @@ static void evaluate_vertex_and_apply_displacement_copy(const SubdivMeshContext
   /* Copy custom data and evaluate position. */
   subdiv_vertex_data_copy(ctx, coarse_vertex_index, subdiv_vertex_index);
   eval_limit_point(ctx->subdiv, ptex_face_index, u, v, subdiv_position);
+  subdiv_mesh_record_vertex_source(
+      ctx, subdiv_vertex_index, VertexSource::Type::Surface, ptex_face_index, u, v);
   /* Apply displacement. */
   subdiv_position += D;
   /* Evaluate undeformed texture coordinate. */
@@ -672,6 +718,8 @@ static void evaluate_vertex_and_apply_displacement_interpolate(
   /* Interpolate custom data and evaluate position. */
   subdiv_vertex_data_interpolate(ctx, subdiv_vertex_index, vertex_interpolation, u, v);
   eval_limit_point(ctx->subdiv, ptex_face_index, u, v, subdiv_position);
+  subdiv_mesh_record_vertex_source(
+      ctx, subdiv_vertex_index, VertexSource::Type::Surface, ptex_face_index, u, v);
   /* Apply displacement. */
   add_v3_v3(subdiv_position, D);
   /* Evaluate undeformed texture coordinate. */
@@ -828,6 +876,8 @@ static void subdiv_mesh_vertex_inner(const ForeachContext *foreach_context,
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_face_index, coarse_corner);
   subdiv_vertex_data_interpolate(ctx, subdiv_vertex_index, &tls->vertex_interpolation, u, v);
   eval_final_point(subdiv, ptex_face_index, u, v, subdiv_position);
+  subdiv_mesh_record_vertex_source(
+      ctx, subdiv_vertex_index, VertexSource::Type::Surface, ptex_face_index, u, v);
   subdiv_mesh_tag_center_vertex(coarse_face, subdiv_vertex_index, u, v, subdiv_mesh);
   subdiv_vertex_orco_evaluate(ctx, ptex_face_index, u, v, subdiv_vertex_index);
 }
@@ -999,6 +1049,8 @@ static void subdiv_mesh_vertex_loose(const ForeachContext *foreach_context,
 {
   SubdivMeshContext *ctx = static_cast<SubdivMeshContext *>(foreach_context->user_data);
   subdiv_vertex_data_copy(ctx, coarse_vertex_index, subdiv_vertex_index);
+  subdiv_mesh_record_vertex_source(
+      ctx, subdiv_vertex_index, VertexSource::Type::LooseVertex, coarse_vertex_index, 0.0f, 0.0f);
 }
 
 /* Get neighbor edges of the given one.
@@ -1115,6 +1167,22 @@ static void subdiv_mesh_vertex_of_loose_edge(const ForeachContext *foreach_conte
       coarse_edge_index,
       is_simple,
       u);
+  /* End points are shared by all loose edges of a vertex, which are handled in parallel. They all
+   * compute the same position, so only record the first of them to avoid a data race. */
+  if (ELEM(u, 0.0, 1.0)) {
+    const int coarse_vert = coarse_edge[u == 0.0f ? 0 : 1];
+    const BitSpan loose_edges = ctx->coarse_mesh->loose_edges().is_loose_bits;
+    for (const int edge : ctx->vert_to_edge_map[coarse_vert]) {
+      if (loose_edges[edge]) {
+        if (edge != coarse_edge_index) {
+          return;
+        }
+        break;
+      }
+    }
+  }
+  subdiv_mesh_record_vertex_source(
+      ctx, subdiv_vertex_index, VertexSource::Type::LooseEdge, coarse_edge_index, u, 0.0f);
 }
 
 /** \} */
@@ -1151,9 +1219,11 @@ static void setup_foreach_callbacks(const SubdivMeshContext *subdiv_context,
 /** \name Public entry point
  * \{ */
 
-Mesh *subdiv_to_mesh(Subdiv *subdiv, const ToMeshSettings *settings, const Mesh *coarse_mesh)
+static Mesh *subdiv_to_mesh_impl(Subdiv *subdiv,
+                                 const ToMeshSettings *settings,
+                                 const Mesh *coarse_mesh,
+                                 Array<VertexSource> *r_vertex_sources)
 {
-
   stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
   /* Make sure evaluator is up to date with possible new topology, and that
    * it is refined for the new positions of coarse vertices. */
@@ -1187,6 +1257,7 @@ Mesh *subdiv_to_mesh(Subdiv *subdiv, const ToMeshSettings *settings, const Mesh
 
   subdiv_context.subdiv = subdiv;
   subdiv_context.have_displacement = (subdiv->displacement_evaluator != nullptr);
+  subdiv_context.r_vertex_sources = r_vertex_sources;
   /* Multi-threaded traversal/evaluation. */
   stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
   ForeachContext foreach_context;
@@ -1244,6 +1315,236 @@ Mesh *subdiv_to_mesh(Subdiv *subdiv, const ToMeshSettings *settings, const Mesh
   return result;
 }
 
+Mesh *subdiv_to_mesh(Subdiv *subdiv, const ToMeshSettings *settings, const Mesh *coarse_mesh)
+{
+  return subdiv_to_mesh_impl(subdiv, settings, coarse_mesh, nullptr);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Result Cache
+ * \{ */
+
+/** A coarse mesh array that the cached result was created from. */
+struct CoarseLayer {
+  const void *data;
+  /** Keeps the data alive, so that its address can't be reused for different data. */
+  ImplicitSharingPtr<> sharing_info;
+  int type;
+  std::string name;
+
+  BLI_STRUCT_EQUALITY_OPERATORS_3(CoarseLayer, data, type, name)
+};
+
+struct ToMeshCache {
+  /** Result of the last full evaluation, shares its data with the returned meshes. */
+  Mesh *mesh = nullptr;
+  Array<VertexSource> vertex_sources;
+
+  Settings subdiv_settings;
+  ToMeshSettings settings;
+  int4 coarse_sizes;
+  Vector<CoarseLayer> coarse_layers;
+
+  ~ToMeshCache()
+  {
+    this->clear();
+  }
+
+  void clear()
+  {
+    if (this->mesh != nullptr) {
+      BKE_id_free(nullptr, this->mesh);
+      this->mesh = nullptr;
+    }
+    this->vertex_sources = {};
+    this->coarse_layers.clear();
+  }
+};
+
+ToMeshCache *to_mesh_cache_new()
+{
+  return MEM_new<ToMeshCache>(__func__);
+}
+
+void to_mesh_cache_free(ToMeshCache *cache)
+{
+  MEM_delete(cache);
+}
+
+static int4 coarse_mesh_sizes(const Mesh &coarse_mesh)
+{
+  return {coarse_mesh.verts_num,
+          coarse_mesh.edges_num,
+          coarse_mesh.faces_num,
+          coarse_mesh.corners_num};
+}
+
+/**
+ * Gather all arrays of the coarse mesh that the subdivided mesh depends on, except for the
+ * positions. Returns false when an array can't be identified reliably.
+ */
+static bool gather_coarse_layers(const Mesh &coarse_mesh, Vector<CoarseLayer> &r_layers)
+{
+  const auto add_layer = [&](const void *data,
+                             const ImplicitSharingInfo *sharing_info,
+                             const int type,
+                             const StringRef name) {
+    if (data != nullptr && sharing_info == nullptr) {
+      return false;
+    }
+    if (sharing_info != nullptr) {
+      sharing_info->add_user();
+    }
+    r_layers.append({data, ImplicitSharingPtr<>(sharing_info), type, name});
+    return true;
+  };
+  if (!add_layer(coarse_mesh.face_offset_indices,
+                 coarse_mesh.runtime->face_offsets_sharing_info,
+                 -1,
+                 ""))
+  {
+    return false;
+  }
+  for (const CustomData *data : {&coarse_mesh.vert_data,
+                                 &coarse_mesh.edge_data,
+                                 &coarse_mesh.face_data,
+                                 &coarse_mesh.corner_data})
+  {
+    for (const CustomDataLayer &layer : Span(data->layers, data->totlayer)) {
+      if (data == &coarse_mesh.vert_data && STREQ(layer.name, "position")) {
+        continue;
+      }
+      if (!add_layer(layer.data, layer.sharing_info, layer.type, layer.name)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static bool cache_is_valid(const ToMeshCache &cache,
+                           const Subdiv &subdiv,
+                           const ToMeshSettings &settings,
+                           const Mesh &coarse_mesh)
+{
+  if (cache.mesh == nullptr) {
+    return false;
+  }
+  if (!settings_equal(&cache.subdiv_settings, &subdiv.settings)) {
+    return false;
+  }
+  if (cache.settings.resolution != settings.resolution ||
+      cache.settings.use_optimal_display != settings.use_optimal_display)
+  {
+    return false;
+  }
+  if (cache.coarse_sizes != coarse_mesh_sizes(coarse_mesh)) {
+    return false;
+  }
+  Vector<CoarseLayer> coarse_layers;
+  if (!gather_coarse_layers(coarse_mesh, coarse_layers)) {
+    return false;
+  }
+  return coarse_layers.as_span() == cache.coarse_layers.as_span();
+}
+
+static void cache_memory_update(const ToMeshCache &cache, Subdiv &subdiv)
+{
+  memory_counter::MemoryCount memory;
+  MemoryCounter memory_counter{memory};
+  cache.mesh->count_memory(memory_counter);
+  memory_counter.add(cache.vertex_sources.as_span().size_in_bytes());
+  subdiv.stats.mesh_cache_memory = memory.total_bytes;
+}
+
+/** Evaluate the positions of all subdivided vertices again, after the coarse mesh deformed. */
+static void update_positions_from_cache(const ToMeshCache &cache,
+                                        const Subdiv &subdiv,
+                                        const Mesh &coarse_mesh,
+                                        MutableSpan<float3> positions)
+{
+  const Span<float3> coarse_positions = coarse_mesh.vert_positions();
+  const Span<int2> coarse_edges = coarse_mesh.edges();
+  Array<int> vert_to_edge_offsets;
+  Array<int> vert_to_edge_indices;
+  GroupedSpan<int> vert_to_edge_map;
+  if (coarse_mesh.loose_edges().count > 0) {
+    vert_to_edge_map = mesh::build_vert_to_edge_map(
+        coarse_edges, coarse_mesh.verts_num, vert_to_edge_offsets, vert_to_edge_indices);
+  }
+  Subdiv *subdiv_for_eval = const_cast<Subdiv *>(&subdiv);
+  threading::parallel_for(positions.index_range(), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      const VertexSource &source = cache.vertex_sources[i];
+      switch (source.type) {
+        case VertexSource::Type::Surface:
+          eval_limit_point(subdiv_for_eval, source.index, source.u, source.v, positions[i]);
+          break;
+        case VertexSource::Type::LooseVertex:
+          positions[i] = coarse_positions[source.index];
+          break;
+        case VertexSource::Type::LooseEdge:
+          positions[i] = mesh_interpolate_position_on_edge(coarse_positions,
+                                                           coarse_edges,
+                                                           vert_to_edge_map,
+                                                           source.index,
+                                                           subdiv.settings.is_simple,
+                                                           source.u);
+          break;
+      }
+    }
+  });
+}
+
+Mesh *subdiv_to_mesh(Subdiv *subdiv,
+                     const ToMeshSettings *settings,
+                     const Mesh *coarse_mesh,
+                     ToMeshCache &cache)
+{
+  if (!cache_is_valid(cache, *subdiv, *settings, *coarse_mesh)) {
+    cache.clear();
+    /* Displacement depends on more than the position of the coarse vertices. */
+    const bool use_cache = subdiv->displacement_evaluator == nullptr &&
+                           gather_coarse_layers(*coarse_mesh, cache.coarse_layers);
+    Mesh *result = subdiv_to_mesh_impl(
+        subdiv, settings, coarse_mesh, use_cache ? &cache.vertex_sources : nullptr);
+    if (result == nullptr || !use_cache) {
+      cache.clear();
+      subdiv->stats.mesh_cache_memory = 0;
+      return result;
+    }
+    cache.mesh = BKE_mesh_copy_for_eval(*result);
+    cache.subdiv_settings = subdiv->settings;
+    cache.settings = *settings;
+    cache.coarse_sizes = coarse_mesh_sizes(*coarse_mesh);
+    cache_memory_update(cache, *subdiv);
+    return result;
+  }
+
+  stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_CACHED);
+  /* Refine the evaluator for the new positions of the coarse vertices. */
+  if (!eval_begin_from_mesh(subdiv, coarse_mesh, {}, SUBDIV_EVALUATOR_TYPE_CPU, nullptr)) {
+    if (coarse_mesh->faces_num) {
+      stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_CACHED);
+      return nullptr;
+    }
+  }
+  Mesh *result = BKE_mesh_copy_for_eval(*cache.mesh);
+  /* Take the non-geometry data like materials and vertex group names from the new coarse mesh. */
+  BLI_freelistN(&result->vertex_group_names);
+  BKE_mesh_copy_parameters_for_eval(result, coarse_mesh);
+  update_positions_from_cache(cache, *subdiv, *coarse_mesh, result->vert_positions_for_write());
+  result->tag_positions_changed();
+  if (subdiv->settings.is_simple) {
+    result->runtime->bounds_cache = coarse_mesh->runtime->bounds_cache;
+  }
+  cache_memory_update(cache, *subdiv);
+  stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_CACHED);
+  return result;
+}
+
 /** \} */
 
 }  // namespace blender::bke::subdiv
@@ -0,0 +1,177 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BKE_attribute.hh"
+#include "BKE_customdata.hh"
+#include "BKE_idtype.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.hh"
+#include "BKE_subdiv.hh"
+#include "BKE_subdiv_mesh.hh"
+
+#ifdef WITH_OPENSUBDIV
+
+namespace blender::bke::subdiv::tests {
+
+class SubdivMeshCacheTest : public testing::Test {
+ protected:
+  Mesh *coarse_mesh = nullptr;
+  Subdiv *subdiv = nullptr;
+  ToMeshCache *cache = nullptr;
+  ToMeshSettings mesh_settings = {};
+
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+
+  /**
+   * A grid of 3x3 quads with an attribute on the vertices, and a loose edge next to it, which
+   * uses a separate code path for its subdivided vertices.
+   */
+  void SetUp() override
+  {
+    const int grid_size = 4;
+    coarse_mesh = BKE_mesh_new_nomain(grid_size * grid_size + 2, 1, 9, 36);
+    MutableSpan<float3> positions = coarse_mesh->vert_positions_for_write();
+    for (const int y : IndexRange(grid_size)) {
+      for (const int x : IndexRange(grid_size)) {
+        positions[y * grid_size + x] = float3(x, y, (x * y) % 2);
+      }
+    }
+    positions[grid_size * grid_size] = float3(5.0f, 0.0f, 0.0f);
+    positions[grid_size * grid_size + 1] = float3(6.0f, 1.0f, 0.0f);
+    coarse_mesh->edges_for_write().first() = int2(grid_size * grid_size,
+                                                  grid_size * grid_size + 1);
+    offset_indices::fill_constant_group_size(4, 0, coarse_mesh->face_offsets_for_write());
+    MutableSpan<int> corner_verts = coarse_mesh->corner_verts_for_write();
+    for (const int y : IndexRange(grid_size - 1)) {
+      for (const int x : IndexRange(grid_size - 1)) {
+        const int face = y * (grid_size - 1) + x;
+        corner_verts[face * 4 + 0] = y * grid_size + x;
+        corner_verts[face * 4 + 1] = y * grid_size + x + 1;
+        corner_verts[face * 4 + 2] = (y + 1) * grid_size + x + 1;
+        corner_verts[face * 4 + 3] = (y + 1) * grid_size + x;
+      }
+    }
+    mesh_calc_edges(*coarse_mesh, true, false);
+
+    MutableAttributeAccessor attributes = coarse_mesh->attributes_for_write();
+    SpanAttributeWriter<float> values = attributes.lookup_or_add_for_write_only_span<float>(
+        "value", AttrDomain::Point);
+    for (const int i : values.span.index_range()) {
+      values.span[i] = float(i);
+    }
+    values.finish();
+
+    Settings settings = {};
+    settings.is_simple = false;
+    settings.is_adaptive = false;
+    settings.level = 2;
+    settings.use_creases = true;
+    settings.vtx_boundary_interpolation = SUBDIV_VTX_BOUNDARY_EDGE_ONLY;
+    settings.fvar_linear_interpolation = SUBDIV_FVAR_LINEAR_INTERPOLATION_BOUNDARIES;
+    subdiv = new_from_mesh(&settings, coarse_mesh);
+    ASSERT_NE(subdiv, nullptr);
+
+    mesh_settings.resolution = (1 << 2) + 1;
+    mesh_settings.use_optimal_display = false;
+    cache = to_mesh_cache_new();
+  }
+
+  void TearDown() override
+  {
+    to_mesh_cache_free(cache);
+    if (subdiv != nullptr) {
+      free(subdiv);
+    }
+    BKE_id_free(nullptr, coarse_mesh);
+  }
+
+  void deform_coarse_mesh(const float factor)
+  {
+    for (float3 &position : coarse_mesh->vert_positions_for_write()) {
+      position += float3(0.1f * position.y, 0.0f, factor * position.x);
+    }
+    coarse_mesh->tag_positions_changed();
+  }
+};
+
+static void expect_same_meshes(const Mesh &expected, const Mesh &actual)
+{
+  ASSERT_EQ(expected.verts_num, actual.verts_num);
+  ASSERT_EQ(expected.edges_num, actual.edges_num);
+  ASSERT_EQ(expected.faces_num, actual.faces_num);
+  ASSERT_EQ(expected.corners_num, actual.corners_num);
+  for (const int i : expected.vert_positions().index_range()) {
+    EXPECT_V3_NEAR(expected.vert_positions()[i], actual.vert_positions()[i], 1e-5f);
+  }
+  EXPECT_EQ_ARRAY(expected.edges().data(), actual.edges().data(), expected.edges_num);
+  EXPECT_EQ_ARRAY(
+      expected.corner_verts().data(), actual.corner_verts().data(), expected.corners_num);
+
+  const VArraySpan<float> expected_values = *expected.attributes().lookup<float>("value");
+  const VArraySpan<float> actual_values = *actual.attributes().lookup<float>("value");
+  ASSERT_FALSE(actual_values.is_empty());
+  for (const int i : expected_values.index_range()) {
+    EXPECT_NEAR(expected_values[i], actual_values[i], 1e-5f);
+  }
+}
+
+TEST_F(SubdivMeshCacheTest, DeformedSameAsFull)
+{
+  Mesh *first = subdiv_to_mesh(subdiv, &mesh_settings, coarse_mesh, *cache);
+  ASSERT_NE(first, nullptr);
+
+  this->deform_coarse_mesh(0.5f);
+  Mesh *cached = subdiv_to_mesh(subdiv, &mesh_settings, coarse_mesh, *cache);
+  ASSERT_NE(cached, nullptr);
+  /* Only the positions were evaluated again, the rest is shared with the first result. */
+  EXPECT_EQ(cached->corner_verts().data(), first->corner_verts().data());
+  EXPECT_NE(cached->vert_positions().data(), first->vert_positions().data());
+
+  Mesh *full = subdiv_to_mesh(subdiv, &mesh_settings, coarse_mesh);
+  ASSERT_NE(full, nullptr);
+  expect_same_meshes(*full, *cached);
+
+  BKE_id_free(nullptr, full);
+  BKE_id_free(nullptr, cached);
+  BKE_id_free(nullptr, first);
+}
+
+TEST_F(SubdivMeshCacheTest, InvalidateOnChangedLayer)
+{
+  Mesh *first = subdiv_to_mesh(subdiv, &mesh_settings, coarse_mesh, *cache);
+  ASSERT_NE(first, nullptr);
+
+  /* The cache shares the attribute, so writing to it replaces the array and its sharing info. */
+  const void *old_values = CustomData_get_layer_named(
+      &coarse_mesh->vert_data, CD_PROP_FLOAT, "value");
+  SpanAttributeWriter<float> values =
+      coarse_mesh->attributes_for_write().lookup_for_write_span<float>("value");
+  values.span.fill(2.0f);
+  values.finish();
+  EXPECT_NE(values.span.data(), old_values);
+  this->deform_coarse_mesh(0.25f);
+
+  Mesh *updated = subdiv_to_mesh(subdiv, &mesh_settings, coarse_mesh, *cache);
+  ASSERT_NE(updated, nullptr);
+  /* The whole mesh was created again. */
+  EXPECT_NE(updated->corner_verts().data(), first->corner_verts().data());
+
+  Mesh *full = subdiv_to_mesh(subdiv, &mesh_settings, coarse_mesh);
+  ASSERT_NE(full, nullptr);
+  expect_same_meshes(*full, *updated);
+
+  BKE_id_free(nullptr, full);
+  BKE_id_free(nullptr, updated);
+  BKE_id_free(nullptr, first);
+}
+
+}  // namespace blender::bke::subdiv::tests
+
+#endif
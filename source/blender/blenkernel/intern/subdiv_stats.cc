@@ -24,6 +24,8 @@ void stats_init(SubdivStats *stats)
   stats->subdiv_to_ccg_time = 0.0;
   stats->subdiv_to_ccg_elements_time = 0.0;
   stats->topology_compare_time = 0.0;
+  stats->subdiv_to_mesh_cached_time = 0.0;
+  stats->mesh_cache_memory = 0;
 }
 
 void stats_begin(SubdivStats *stats, StatsValue value)
@@ -60,6 +62,10 @@ void stats_print(const SubdivStats *stats)
   STATS_PRINT_TIME(stats, subdiv_to_ccg_time, "Subdivision to CCG time");
   STATS_PRINT_TIME(stats, subdiv_to_ccg_elements_time, "    Elements time");
   STATS_PRINT_TIME(stats, topology_compare_time, "Topology comparison time");
+  STATS_PRINT_TIME(stats, subdiv_to_mesh_cached_time, "Cached subdivision to mesh time");
+  if (stats->mesh_cache_memory > 0) {
+    printf("  Mesh cache memory: %.2f (MB)\n", double(stats->mesh_cache_memory) / (1024 * 1024));
+  }
 
 #undef STATS_PRINT_TIME
 }
@@ -0,0 +1,50 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <iostream>
+
+#include "testing/testing.h"
+
+#include "BLI_timeit.hh"
+
+#include "BKE_bake_items_serialize.hh"
+
+#include "bake_items_serialize_test_common.hh"
+
+namespace blender::bke::bake::tests {
+
+/** Print how fast the bakes are written and read with the different blob encodings. */
+TEST_F(BakeItemsSerializeTest, Throughput)
+{
+  const BakeState bake_state = create_pointcloud_bake_state(2'000'000);
+  const int64_t data_size = get_pointcloud(bake_state).totpoint * (sizeof(float3) + sizeof(int));
+
+  auto print_throughput = [&](const StringRef name, const timeit::Nanoseconds duration) {
+    const double seconds = std::chrono::duration<double>(duration).count();
+    std::cout << name << ": " << data_size / seconds / 1e6 << " MB/s\n";
+  };
+
+  for (const BlobCompression compression : {BlobCompression::None, BlobCompression::Zstd}) {
+    const bool use_compression = compression == BlobCompression::Zstd;
+    const timeit::TimePoint write_start = timeit::Clock::now();
+    const auto [meta, size] = write_bake(bake_state, blobs_dir, compression);
+    print_throughput(use_compression ? "Write compressed" : "Write",
+                     timeit::Clock::now() - write_start);
+    std::cout << "  Size: " << size / 1e6 << " MB\n";
+
+    const timeit::TimePoint copy_start = timeit::Clock::now();
+    EXPECT_TRUE(read_bake(meta, CopyingDiskBlobReader{blobs_dir}).has_value());
+    print_throughput(use_compression ? "Read compressed" : "Read copy",
+                     timeit::Clock::now() - copy_start);
+
+    if (!use_compression) {
+      const timeit::TimePoint mapped_start = timeit::Clock::now();
+      EXPECT_TRUE(read_bake(meta, DiskBlobReader{blobs_dir}).has_value());
+      print_throughput("Read mapped", timeit::Clock::now() - mapped_start);
+    }
+  }
+}
+
+
+}  // namespace blender::bke::bake::tests
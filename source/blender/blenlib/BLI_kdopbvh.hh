@@ -10,6 +10,7 @@
 
 #include "BLI_function_ref.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
 #include "BLI_sys_types.h"
 
 struct BVHTree;
@@ -78,6 +79,15 @@ enum {
    * pair once, rather than twice in different order as usual. */
   BVH_OVERLAP_SELF = (1 << 2),
 };
+enum {
+  /**
+   * Store a flattened copy of the tree with four children per node, whose bounds are tested at
+   * once using SIMD instructions by #BLI_bvhtree_ray_cast_ex and #BLI_bvhtree_find_nearest_ex.
+   * Only supported for axis aligned trees (`axis` of 6) with up to four children per node,
+   * ignored otherwise.
+   */
+  BVH_TREE_WIDE_NODES = (1 << 0),
+};
 enum {
   /* Use a priority queue to process nodes in the optimal order (for slow callbacks) */
   BVH_NEAREST_OPTIMAL_ORDER = (1 << 0),
@@ -139,6 +149,10 @@ class BVHTreeDeleter {
  * \note many callers don't check for `NULL` return.
  */
 BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis);
+/**
+ * \param flag: See #BVH_TREE_WIDE_NODES.
+ */
+BVHTree *BLI_bvhtree_new_ex(int maxsize, float epsilon, char tree_type, char axis, int flag);
 
 /**
  * Construct: first insert points, then call balance.
@@ -210,6 +224,17 @@ float BLI_bvhtree_get_epsilon(const BVHTree *tree);
  * This function returns the bounding box of the BVH tree.
  */
 void BLI_bvhtree_get_bounding_box(const BVHTree *tree, float r_bb_min[3], float r_bb_max[3]);
+/**
+ * Estimate the cost of queries on the tree, as the sum of the surface areas of the bounding boxes
+ * of all branch nodes relative to the surface area of the root. Since refitting with
+ * #BLI_bvhtree_update_tree does not rebalance the tree, comparing this with the estimate of a
+ * newly built tree shows how much the tree degraded.
+ */
+float BLI_bvhtree_get_cost_estimate(const BVHTree *tree);
+/**
+ * Size in bytes of all memory allocated for the tree.
+ */
+size_t BLI_bvhtree_get_memory_size(const BVHTree *tree);
 
 /**
  * Find nearest node to the given coordinates
@@ -253,6 +278,22 @@ int BLI_bvhtree_ray_cast(const BVHTree *tree,
                          BVHTreeRayHit *hit,
                          BVHTree_RayCastCallback callback,
                          void *userdata);
+/**
+ * Cast multiple rays with a shared traversal of the tree, only descending into nodes that are
+ * hit by any of the rays. This is faster than casting the rays one by one when they are coherent,
+ * e.g. when they have similar origins and directions.
+ *
+ * \param hits: The hit of every ray, which has to be initialized like for
+ * #BLI_bvhtree_ray_cast_ex.
+ */
+void BLI_bvhtree_ray_cast_packet(const BVHTree *tree,
+                                 blender::Span<blender::float3> origins,
+                                 blender::Span<blender::float3> directions,
+                                 float radius,
+                                 blender::MutableSpan<BVHTreeRayHit> hits,
+                                 BVHTree_RayCastCallback callback,
+                                 void *userdata,
+                                 int flag);
 
 /**
  * Calls the callback for every ray intersection
@@ -7,7 +7,10 @@
  * \brief A KD-tree for nearest neighbor search.
  */
 
+#include "BLI_array.hh"
 #include "BLI_compiler_attrs.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
 #include "BLI_sys_types.h"
 
 #define _BLI_CONCAT_AUX(MACRO_ARG1, MACRO_ARG2) MACRO_ARG1##MACRO_ARG2
@@ -33,6 +36,10 @@ typedef struct KDTreeNearest {
  */
 KDTree *BLI_kdtree_nd_(new)(unsigned int nodes_len_capacity);
 void BLI_kdtree_nd_(free)(KDTree *tree);
+/**
+ * Large trees are balanced using multiple threads, the result doesn't depend on the number of
+ * threads.
+ */
 void BLI_kdtree_nd_(balance)(KDTree *tree) ATTR_NONNULL(1);
 
 void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS]) ATTR_NONNULL(1, 3);
@@ -63,6 +70,40 @@ void BLI_kdtree_nd_(range_search_cb)(
     bool (*search_cb)(void *user_data, int index, const float co[KD_DIMS], float dist_sq),
     void *user_data);
 
+/**
+ * Batched versions of the queries above, the query points are processed in parallel.
+ */
+
+/**
+ * Find the nearest point for every query point.
+ * The index of the result is -1 when the tree is empty.
+ */
+void BLI_kdtree_nd_(find_nearest_batch)(const KDTree *tree,
+                                        blender::Span<blender::VecBase<float, KD_DIMS>> co,
+                                        blender::MutableSpan<KDTreeNearest> r_nearest)
+    ATTR_NONNULL(1);
+/**
+ * Find the nearest \a nearest_len_capacity points for every query point.
+ * \param r_nearest: The results of query point `i` start at `i * nearest_len_capacity`.
+ * \param r_nearest_len: The number of points found for every query point.
+ */
+void BLI_kdtree_nd_(find_nearest_n_batch)(const KDTree *tree,
+                                          blender::Span<blender::VecBase<float, KD_DIMS>> co,
+                                          uint nearest_len_capacity,
+                                          blender::MutableSpan<KDTreeNearest> r_nearest,
+                                          blender::MutableSpan<int> r_nearest_len)
+    ATTR_NONNULL(1);
+/**
+ * Find all points in range of every query point, sorted by distance.
+ * \param r_offsets: The results of query point `i` are in the range from `r_offsets[i]` to
+ * `r_offsets[i + 1]`, its size is one more than the number of query points.
+ */
+blender::Array<KDTreeNearest> BLI_kdtree_nd_(range_search_batch)(
+    const KDTree *tree,
+    blender::Span<blender::VecBase<float, KD_DIMS>> co,
+    float range,
+    blender::MutableSpan<int> r_offsets) ATTR_NONNULL(1);
+
 int BLI_kdtree_nd_(calc_duplicates_fast)(const KDTree *tree,
                                          float range,
                                          bool use_index_order,
@@ -369,6 +369,25 @@ struct BoundingBox {
  */
 bool bbs_might_intersect(const BoundingBox &bb_a, const BoundingBox &bb_b);
 
+/**
+ * Exact #orient3d of the vertices, which is evaluated with the double coordinates and an error
+ * bound first, and only uses the exact coordinates when the sign can't be determined that way.
+ */
+int filtered_orient3d(const Vert *a, const Vert *b, const Vert *c, const Vert *d);
+
+/**
+ * How many geometric predicates were decided by floating point filters, and how many needed
+ * exact arithmetic. Only counted while enabled with #predicate_stats_enable, for benchmarking.
+ */
+struct PredicateStats {
+  int64_t filtered_num = 0;
+  int64_t exact_num = 0;
+};
+
+/** Enable or disable counting of #PredicateStats, resetting the counts. */
+void predicate_stats_enable(bool enable);
+PredicateStats predicate_stats_get();
+
 /**
  * This is the main routine for calculating the self_intersection of a triangle mesh.
  *
@@ -6,6 +6,7 @@
 
 #include "BLI_math_matrix_types.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
 
 namespace blender::noise {
 
@@ -133,6 +134,33 @@ float3 perlin_float3_fractal_distorted(float4 position,
                                        int type,
                                        bool normalize);
 
+/* Batched versions of the 3D perlin noise functions above, which evaluate multiple positions at
+ * once with SIMD instructions when available. The results are the same as when calling the
+ * functions for every position separately. Only the fBM type is vectorized for the fractal
+ * functions currently, the other types are evaluated one position at a time. */
+
+void perlin_signed(Span<float3> positions, MutableSpan<float> r_values);
+void perlin_fractal_distorted(Span<float3> positions,
+                              float detail,
+                              float roughness,
+                              float lacunarity,
+                              float offset,
+                              float gain,
+                              float distortion,
+                              int type,
+                              bool normalize,
+                              MutableSpan<float> r_values);
+void perlin_float3_fractal_distorted(Span<float3> positions,
+                                     float detail,
+                                     float roughness,
+                                     float lacunarity,
+                                     float offset,
+                                     float gain,
+                                     float distortion,
+                                     int type,
+                                     bool normalize,
+                                     MutableSpan<float3> r_values);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -219,6 +247,18 @@ VoronoiOutput fractal_voronoi_x_fx(const VoronoiParams &params,
 template<typename T>
 float fractal_voronoi_distance_to_edge(const VoronoiParams &params, const T coord);
 
+/* Batched versions of the 3D Voronoi functions above, which evaluate multiple positions at once
+ * with SIMD instructions when available. The results are the same as when calling the functions
+ * for every position separately. Only the F1 feature with the Euclidean, Manhattan and Chebychev
+ * metrics is vectorized currently, the other cases are evaluated one position at a time. */
+
+void voronoi_f1(const VoronoiParams &params,
+                Span<float3> coords,
+                MutableSpan<VoronoiOutput> r_outputs);
+void fractal_voronoi_x_fx(const VoronoiParams &params,
+                          Span<float3> coords,
+                          MutableSpan<VoronoiOutput> r_outputs);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -7,6 +7,8 @@
 #include "BLI_cache_mutex.hh"
 
 #include <memory>
+#include <optional>
+#include <utility>
 
 namespace blender {
 
@@ -81,6 +83,22 @@ template<typename T> class SharedCache {
     cache_->mutex.ensure([&]() { compute_cache(this->cache_->data); });
   }
 
+  /**
+   * Tag the data for recomputation like #tag_dirty(), but move the cached data out of the cache
+   * first if it isn't shared with other objects. This allows reusing the old data to compute the
+   * new version, possibly in another object.
+   */
+  std::optional<T> release()
+  {
+    if (cache_.use_count() != 1 || !cache_->mutex.is_cached()) {
+      this->tag_dirty();
+      return std::nullopt;
+    }
+    std::optional<T> data = std::exchange(cache_->data, T());
+    cache_->mutex.tag_dirty();
+    return data;
+  }
+
   /** Retrieve the cached data. */
   const T &data() const
   {
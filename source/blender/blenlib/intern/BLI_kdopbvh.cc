@@ -30,8 +30,10 @@
 #include "BLI_alloca.h"
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.hh"
+#include "BLI_math_bits.h"
 #include "BLI_math_geom.h"
 #include "BLI_math_vector_types.hh"
+#include "BLI_simd.hh"
 #include "BLI_stack.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
@@ -58,6 +60,12 @@
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 1024
 #endif
 
+/* Number of children of the nodes used with #BVH_TREE_WIDE_NODES. */
+#define BVH_WIDE_NODE_WIDTH 4
+
+/* Maximum number of rays traversing the tree together in #BLI_bvhtree_ray_cast_packet. */
+#define BVH_RAYCAST_PACKET_SIZE 16
+
 /* -------------------------------------------------------------------- */
 /** \name Struct Definitions
  * \{ */
@@ -76,23 +84,41 @@ struct BVHNode {
   char main_axis; /* Axis used to split this node */
 };
 
+/**
+ * Flattened copy of a part of the tree, used by ray-cast and nearest queries when the tree is
+ * created with #BVH_TREE_WIDE_NODES. The branches of the regular tree are collapsed into nodes
+ * with up to #BVH_WIDE_NODE_WIDTH children, whose bounds are stored per axis so that all children
+ * can be tested at once.
+ */
+struct BVHWideNode {
+  /** Bounds of the children, with the axes in the same order as #BVHNode.bv. */
+  float bounds[6][BVH_WIDE_NODE_WIDTH];
+  /** Index of a child in #BVHTree.wide_nodes, or `-1 - i` for a leaf `i` of #BVHTree.nodearray. */
+  int children[BVH_WIDE_NODE_WIDTH];
+  /** Index of the child in #BVHTree.nodearray, to update the bounds. */
+  int sources[BVH_WIDE_NODE_WIDTH];
+  int node_num;
+};
+
 /* keep under 26 bytes for speed purposes */
 struct BVHTree {
   BVHNode **nodes;
-  BVHNode *nodearray;  /* Pre-allocate branch nodes. */
-  BVHNode **nodechild; /* Pre-allocate children for nodes. */
-  float *nodebv;       /* Pre-allocate bounding-volumes for nodes. */
-  float epsilon;       /* Epsilon is used for inflation of the K-DOP. */
-  int leaf_num;        /* Leafs. */
+  BVHNode *nodearray;      /* Pre-allocate branch nodes. */
+  BVHNode **nodechild;     /* Pre-allocate children for nodes. */
+  float *nodebv;           /* Pre-allocate bounding-volumes for nodes. */
+  BVHWideNode *wide_nodes; /* Optional, see #BVH_TREE_WIDE_NODES. */
+  float epsilon;           /* Epsilon is used for inflation of the K-DOP. */
+  int leaf_num;            /* Leafs. */
   int branch_num;
+  int wide_node_num;
   axis_t start_axis, stop_axis; /* bvhtree_kdop_axes array indices according to axis */
   axis_t axis;                  /* KDOP type (6 => OBB, 7 => AABB, ...) */
   char tree_type;               /* type of tree (4 => quad-tree). */
 };
 
 /* optimization, ensure we stay small */
-BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 48) ||
-                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 32),
+BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 64) ||
+                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 40),
                   "over sized")
 
 /* avoid duplicating vars in BVHOverlapData_Thread */
@@ -846,11 +872,121 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Wide Nodes
+ * \{ */
+
+static void bvhtree_wide_node_refit(const BVHTree *tree, BVHWideNode *wide_node)
+{
+  for (int i = 0; i < BVH_WIDE_NODE_WIDTH; i++) {
+    if (i < wide_node->node_num) {
+      const float *bv = tree->nodearray[wide_node->sources[i]].bv;
+      for (int j = 0; j < 6; j++) {
+        wide_node->bounds[j][i] = bv[j];
+      }
+    }
+    else {
+      /* Empty bounds, unused children are never tested but this keeps the values well defined. */
+      for (int j = 0; j < 6; j += 2) {
+        wide_node->bounds[j][i] = FLT_MAX;
+        wide_node->bounds[j + 1][i] = -FLT_MAX;
+      }
+    }
+  }
+}
+
+static float bvh_node_half_area(const float *bv)
+{
+  const float x = bv[1] - bv[0];
+  const float y = bv[3] - bv[2];
+  const float z = bv[5] - bv[4];
+  return x * y + y * z + z * x;
+}
+
+/**
+ * Add a wide node for the given branch, collapsing the children of its largest child branches
+ * into it as long as they fit.
+ */
+static int bvhtree_wide_node_build(BVHTree *tree, const BVHNode *node)
+{
+  const int wide_index = tree->wide_node_num++;
+
+  const BVHNode *lanes[BVH_WIDE_NODE_WIDTH];
+  int lanes_num = node->node_num;
+  std::copy_n(node->children, lanes_num, lanes);
+  while (true) {
+    int expand = -1;
+    float expand_area = -1.0f;
+    for (int i = 0; i < lanes_num; i++) {
+      const BVHNode *lane = lanes[i];
+      if (lane->node_num == 0 || lanes_num - 1 + lane->node_num > BVH_WIDE_NODE_WIDTH) {
+        continue;
+      }
+      const float area = bvh_node_half_area(lane->bv);
+      if (area > expand_area) {
+        expand = i;
+        expand_area = area;
+      }
+    }
+    if (expand == -1) {
+      break;
+    }
+    const BVHNode *lane = lanes[expand];
+    lanes[expand] = lane->children[0];
+    for (int i = 1; i < lane->node_num; i++) {
+      lanes[lanes_num++] = lane->children[i];
+    }
+  }
+
+  BVHWideNode *wide_node = &tree->wide_nodes[wide_index];
+  wide_node->node_num = lanes_num;
+  for (int i = 0; i < BVH_WIDE_NODE_WIDTH; i++) {
+    if (i < lanes_num) {
+      const int source = int(lanes[i] - tree->nodearray);
+      wide_node->sources[i] = source;
+      wide_node->children[i] = (lanes[i]->node_num == 0) ?
+                                   -1 - source :
+                                   bvhtree_wide_node_build(tree, lanes[i]);
+    }
+    else {
+      wide_node->sources[i] = -1;
+      wide_node->children[i] = -1;
+    }
+  }
+  bvhtree_wide_node_refit(tree, wide_node);
+  return wide_index;
+}
+
+/**
+ * Order the children that are closer than \a dist_max by their distance.
+ * \return The number of children in \a r_order.
+ */
+static int bvhtree_wide_node_sort(const BVHWideNode *wide_node,
+                                  const float dist[BVH_WIDE_NODE_WIDTH],
+                                  const float dist_max,
+                                  int r_order[BVH_WIDE_NODE_WIDTH])
+{
+  int order_num = 0;
+  for (int i = 0; i < wide_node->node_num; i++) {
+    if (dist[i] >= dist_max) {
+      continue;
+    }
+    int j = order_num++;
+    for (; j > 0 && dist[r_order[j - 1]] > dist[i]; j--) {
+      r_order[j] = r_order[j - 1];
+    }
+    r_order[j] = i;
+  }
+  return order_num;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
 
-BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
+BVHTree *BLI_bvhtree_new_ex(int maxsize, float epsilon, char tree_type, char axis, int flag)
 {
   int numnodes, i;
 
@@ -913,6 +1049,12 @@ BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
       tree->nodearray[i].bv = &tree->nodebv[i * axis];
       tree->nodearray[i].children = &tree->nodechild[i * tree_type];
     }
+
+    /* Every wide node contains at least one branch. */
+    if ((flag & BVH_TREE_WIDE_NODES) && axis == 6 && tree_type <= BVH_WIDE_NODE_WIDTH) {
+      tree->wide_nodes = MEM_cnew_array<BVHWideNode>(
+          size_t(implicit_needed_branches(tree_type, maxsize)), "BVHWideNode");
+    }
   }
   return tree;
 
@@ -921,6 +1063,11 @@ fail:
   return nullptr;
 }
 
+BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
+{
+  return BLI_bvhtree_new_ex(maxsize, epsilon, tree_type, axis, 0);
+}
+
 void BLI_bvhtree_free(BVHTree *tree)
 {
   if (tree) {
@@ -928,6 +1075,7 @@ void BLI_bvhtree_free(BVHTree *tree)
     MEM_SAFE_FREE(tree->nodearray);
     MEM_SAFE_FREE(tree->nodebv);
     MEM_SAFE_FREE(tree->nodechild);
+    MEM_SAFE_FREE(tree->wide_nodes);
     MEM_freeN(tree);
   }
 }
@@ -955,6 +1103,13 @@ void BLI_bvhtree_balance(BVHTree *tree)
   build_skip_links(tree, tree->nodes[tree->leaf_num], nullptr, nullptr);
 #endif
 
+  if (tree->wide_nodes && tree->leaf_num > 0) {
+    bvhtree_wide_node_build(tree, tree->nodes[tree->leaf_num]);
+    /* Most wide nodes contain multiple branches, so only a part of the array is used. */
+    tree->wide_nodes = static_cast<BVHWideNode *>(
+        MEM_reallocN(tree->wide_nodes, sizeof(BVHWideNode) * size_t(tree->wide_node_num)));
+  }
+
 #ifdef USE_VERIFY_TREE
   bvhtree_verify(tree);
 #endif
@@ -1028,6 +1183,10 @@ void BLI_bvhtree_update_tree(BVHTree *tree)
   for (; index >= root; index--) {
     node_join(tree, *index);
   }
+
+  for (int i = 0; i < tree->wide_node_num; i++) {
+    bvhtree_wide_node_refit(tree, &tree->wide_nodes[i]);
+  }
 }
 int BLI_bvhtree_get_len(const BVHTree *tree)
 {
@@ -1060,6 +1219,39 @@ void BLI_bvhtree_get_bounding_box(const BVHTree *tree, float r_bb_min[3], float
   }
 }
 
+static float node_bv_surface_area(const BVHNode *node)
+{
+  const float size[3] = {
+      node->bv[1] - node->bv[0], node->bv[3] - node->bv[2], node->bv[5] - node->bv[4]};
+  return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+}
+
+float BLI_bvhtree_get_cost_estimate(const BVHTree *tree)
+{
+  if (tree->branch_num == 0) {
+    return 0.0f;
+  }
+  const float root_area = node_bv_surface_area(tree->nodes[tree->leaf_num]);
+  if (root_area <= 0.0f) {
+    return 0.0f;
+  }
+  double area_sum = 0.0;
+  for (int i = 0; i < tree->branch_num; i++) {
+    area_sum += double(node_bv_surface_area(tree->nodes[tree->leaf_num + i]));
+  }
+  return float(area_sum / double(root_area));
+}
+
+size_t BLI_bvhtree_get_memory_size(const BVHTree *tree)
+{
+  size_t size = sizeof(BVHTree) + MEM_allocN_len(tree->nodes) + MEM_allocN_len(tree->nodearray) +
+                MEM_allocN_len(tree->nodechild) + MEM_allocN_len(tree->nodebv);
+  if (tree->wide_nodes) {
+    size += MEM_allocN_len(tree->wide_nodes);
+  }
+  return size;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -1594,6 +1786,73 @@ static void dfs_find_nearest_begin(BVHNearestData *data, BVHNode *node)
   dfs_find_nearest_dfs(data, node);
 }
 
+/* Wide nodes method */
+static void wide_node_nearest_dist_sq(const float proj[3],
+                                      const BVHWideNode *wide_node,
+                                      float r_dist_sq[BVH_WIDE_NODE_WIDTH])
+{
+#if BLI_HAVE_SSE2
+  __m128 dist_sq = _mm_setzero_ps();
+  for (int i = 0; i < 3; i++) {
+    const __m128 co = _mm_set1_ps(proj[i]);
+    __m128 val = _mm_max_ps(_mm_loadu_ps(wide_node->bounds[2 * i]), co);
+    val = _mm_min_ps(_mm_loadu_ps(wide_node->bounds[2 * i + 1]), val);
+    const __m128 delta = _mm_sub_ps(co, val);
+    dist_sq = _mm_add_ps(dist_sq, _mm_mul_ps(delta, delta));
+  }
+  _mm_storeu_ps(r_dist_sq, dist_sq);
+#else
+  for (int lane = 0; lane < BVH_WIDE_NODE_WIDTH; lane++) {
+    float dist_sq = 0.0f;
+    for (int i = 0; i < 3; i++) {
+      float val = std::max(wide_node->bounds[2 * i][lane], proj[i]);
+      val = std::min(wide_node->bounds[2 * i + 1][lane], val);
+      dist_sq += square_f(proj[i] - val);
+    }
+    r_dist_sq[lane] = dist_sq;
+  }
+#endif
+}
+
+static void wide_find_nearest_dfs(BVHNearestData *data, const BVHWideNode *wide_node)
+{
+  float dist_sq[BVH_WIDE_NODE_WIDTH];
+  int order[BVH_WIDE_NODE_WIDTH];
+  wide_node_nearest_dist_sq(data->proj, wide_node, dist_sq);
+  const int order_num = bvhtree_wide_node_sort(wide_node, dist_sq, data->nearest.dist_sq, order);
+
+  for (int i = 0; i < order_num; i++) {
+    const int lane = order[i];
+    /* The nearest distance may have changed since sorting. */
+    if (dist_sq[lane] >= data->nearest.dist_sq) {
+      continue;
+    }
+    const int child = wide_node->children[lane];
+    if (child >= 0) {
+      wide_find_nearest_dfs(data, &data->tree->wide_nodes[child]);
+      continue;
+    }
+    BVHNode *node = &data->tree->nodearray[-1 - child];
+    if (data->callback) {
+      data->callback(data->userdata, node->index, data->co, &data->nearest);
+    }
+    else {
+      data->nearest.index = node->index;
+      data->nearest.dist_sq = calc_nearest_point_squared(data->proj, node, data->nearest.co);
+    }
+  }
+}
+
+static void wide_find_nearest_begin(BVHNearestData *data, BVHNode *root)
+{
+  float nearest[3], dist_sq;
+  dist_sq = calc_nearest_point_squared(data->proj, root, nearest);
+  if (dist_sq >= data->nearest.dist_sq) {
+    return;
+  }
+  wide_find_nearest_dfs(data, &data->tree->wide_nodes[0]);
+}
+
 /* Priority queue method */
 static void heap_find_nearest_inner(BVHNearestData *data, HeapSimple *heap, BVHNode *node)
 {
@@ -1676,6 +1935,9 @@ int BLI_bvhtree_find_nearest_ex(const BVHTree *tree,
     if (flag & BVH_NEAREST_OPTIMAL_ORDER) {
       heap_find_nearest_begin(&data, root);
     }
+    else if (tree->wide_node_num > 0) {
+      wide_find_nearest_begin(&data, root);
+    }
     else {
       dfs_find_nearest_begin(&data, root);
     }
@@ -1834,10 +2096,8 @@ static float ray_nearest_hit(const BVHRayCastData *data, const float bv[6])
  * [http://tog.acm.org/resources/RTNews/html/rtnv21n1.html#art9]
  *
  * TODO: this doesn't take data->ray.radius into consideration. */
-static float fast_ray_nearest_hit(const BVHRayCastData *data, const BVHNode *node)
+static float fast_ray_nearest_hit(const BVHRayCastData *data, const float *bv)
 {
-  const float *bv = node->bv;
-
   float t1x = (bv[data->index[0]] - data->ray.origin[0]) * data->idot_axis[0];
   float t2x = (bv[data->index[1]] - data->ray.origin[0]) * data->idot_axis[0];
   float t1y = (bv[data->index[2]] - data->ray.origin[1]) * data->idot_axis[1];
@@ -1861,7 +2121,7 @@ static void dfs_raycast(BVHRayCastData *data, BVHNode *node)
   /* ray-bv is really fast.. and simple tests revealed its worth to test it
    * before calling the ray-primitive functions */
   /* XXX: temporary solution for particles until fast_ray_nearest_hit supports ray.radius */
-  float dist = (data->ray.radius == 0.0f) ? fast_ray_nearest_hit(data, node) :
+  float dist = (data->ray.radius == 0.0f) ? fast_ray_nearest_hit(data, node->bv) :
                                             ray_nearest_hit(data, node->bv);
   if (dist >= data->hit.dist) {
     return;
@@ -1892,6 +2152,91 @@ static void dfs_raycast(BVHRayCastData *data, BVHNode *node)
   }
 }
 
+/**
+ * Distance to the bounds of all children of the node, like #fast_ray_nearest_hit and
+ * #ray_nearest_hit. Only the common case without ray radius is vectorized.
+ */
+static void wide_node_ray_nearest_hit(const BVHRayCastData *data,
+                                      const BVHWideNode *wide_node,
+                                      float r_dist[BVH_WIDE_NODE_WIDTH])
+{
+#if BLI_HAVE_SSE2
+  if (data->ray.radius == 0.0f) {
+    __m128 t1[3], t2[3];
+    for (int i = 0; i < 3; i++) {
+      const __m128 origin = _mm_set1_ps(data->ray.origin[i]);
+      const __m128 idot_axis = _mm_set1_ps(data->idot_axis[i]);
+      t1[i] = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(wide_node->bounds[data->index[2 * i]]), origin),
+                         idot_axis);
+      t2[i] = _mm_mul_ps(
+          _mm_sub_ps(_mm_loadu_ps(wide_node->bounds[data->index[2 * i + 1]]), origin),
+          idot_axis);
+    }
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 hit_dist = _mm_set1_ps(data->hit.dist);
+    __m128 miss = _mm_or_ps(_mm_cmpgt_ps(t1[0], t2[1]), _mm_cmplt_ps(t2[0], t1[1]));
+    miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(t1[0], t2[2]), _mm_cmplt_ps(t2[0], t1[2])));
+    miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(t1[1], t2[2]), _mm_cmplt_ps(t2[1], t1[2])));
+    for (int i = 0; i < 3; i++) {
+      miss = _mm_or_ps(miss, _mm_cmplt_ps(t2[i], zero));
+      miss = _mm_or_ps(miss, _mm_cmpgt_ps(t1[i], hit_dist));
+    }
+    const __m128 dist = _mm_max_ps(_mm_max_ps(t1[0], t1[1]), t1[2]);
+    _mm_storeu_ps(r_dist,
+                  _mm_or_ps(_mm_and_ps(miss, _mm_set1_ps(FLT_MAX)), _mm_andnot_ps(miss, dist)));
+    return;
+  }
+#endif
+  for (int lane = 0; lane < wide_node->node_num; lane++) {
+    float bv[6];
+    for (int i = 0; i < 6; i++) {
+      bv[i] = wide_node->bounds[i][lane];
+    }
+    r_dist[lane] = (data->ray.radius == 0.0f) ? fast_ray_nearest_hit(data, bv) :
+                                                ray_nearest_hit(data, bv);
+  }
+}
+
+static void wide_raycast(BVHRayCastData *data, const BVHWideNode *wide_node)
+{
+  float dist[BVH_WIDE_NODE_WIDTH];
+  int order[BVH_WIDE_NODE_WIDTH];
+  wide_node_ray_nearest_hit(data, wide_node, dist);
+  const int order_num = bvhtree_wide_node_sort(wide_node, dist, data->hit.dist, order);
+
+  for (int i = 0; i < order_num; i++) {
+    const int lane = order[i];
+    /* The hit distance may have changed since sorting. */
+    if (dist[lane] >= data->hit.dist) {
+      continue;
+    }
+    const int child = wide_node->children[lane];
+    if (child >= 0) {
+      wide_raycast(data, &data->tree->wide_nodes[child]);
+      continue;
+    }
+    const BVHNode *node = &data->tree->nodearray[-1 - child];
+    if (data->callback) {
+      data->callback(data->userdata, node->index, &data->ray, &data->hit);
+    }
+    else {
+      data->hit.index = node->index;
+      data->hit.dist = dist[lane];
+      madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, dist[lane]);
+    }
+  }
+}
+
+static void wide_raycast_begin(BVHRayCastData *data, const BVHNode *root)
+{
+  const float dist = (data->ray.radius == 0.0f) ? fast_ray_nearest_hit(data, root->bv) :
+                                                  ray_nearest_hit(data, root->bv);
+  if (dist >= data->hit.dist) {
+    return;
+  }
+  wide_raycast(data, &data->tree->wide_nodes[0]);
+}
+
 /**
  * A version of #dfs_raycast with minor changes to reset the index & dist each ray cast.
  */
@@ -1902,7 +2247,7 @@ static void dfs_raycast_all(BVHRayCastData *data, BVHNode *node)
   /* ray-bv is really fast.. and simple tests revealed its worth to test it
    * before calling the ray-primitive functions */
   /* XXX: temporary solution for particles until fast_ray_nearest_hit supports ray.radius */
-  float dist = (data->ray.radius == 0.0f) ? fast_ray_nearest_hit(data, node) :
+  float dist = (data->ray.radius == 0.0f) ? fast_ray_nearest_hit(data, node->bv) :
                                             ray_nearest_hit(data, node->bv);
   if (dist >= data->hit.dist) {
     return;
@@ -1999,7 +2344,12 @@ int BLI_bvhtree_ray_cast_ex(const BVHTree *tree,
   }
 
   if (root) {
-    dfs_raycast(&data, root);
+    if (tree->wide_node_num > 0) {
+      wide_raycast_begin(&data, root);
+    }
+    else {
+      dfs_raycast(&data, root);
+    }
     //      iterative_raycast(&data, root);
   }
 
@@ -2022,6 +2372,94 @@ int BLI_bvhtree_ray_cast(const BVHTree *tree,
       tree, co, dir, radius, hit, callback, userdata, BVH_RAYCAST_DEFAULT);
 }
 
+static void dfs_raycast_packet(BVHRayCastData *packet, const BVHNode *node, const uint mask)
+{
+  float dist[BVH_RAYCAST_PACKET_SIZE];
+  uint hit_mask = 0;
+  for (uint i = 0; i < BVH_RAYCAST_PACKET_SIZE; i++) {
+    if (mask & (1u << i)) {
+      BVHRayCastData *data = &packet[i];
+      dist[i] = (data->ray.radius == 0.0f) ? fast_ray_nearest_hit(data, node->bv) :
+                                             ray_nearest_hit(data, node->bv);
+      if (dist[i] < data->hit.dist) {
+        hit_mask |= 1u << i;
+      }
+    }
+  }
+  if (hit_mask == 0) {
+    return;
+  }
+
+  if (node->node_num == 0) {
+    for (uint i = 0; i < BVH_RAYCAST_PACKET_SIZE; i++) {
+      if (hit_mask & (1u << i)) {
+        BVHRayCastData *data = &packet[i];
+        if (data->callback) {
+          data->callback(data->userdata, node->index, &data->ray, &data->hit);
+        }
+        else {
+          data->hit.index = node->index;
+          data->hit.dist = dist[i];
+          madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, dist[i]);
+        }
+      }
+    }
+  }
+  else {
+    /* Pick the loop direction based on the direction of the first ray that hit this node. */
+    const BVHRayCastData *first = &packet[bitscan_forward_uint(hit_mask)];
+    if (first->ray_dot_axis[node->main_axis] > 0.0f) {
+      for (int i = 0; i != node->node_num; i++) {
+        dfs_raycast_packet(packet, node->children[i], hit_mask);
+      }
+    }
+    else {
+      for (int i = node->node_num - 1; i >= 0; i--) {
+        dfs_raycast_packet(packet, node->children[i], hit_mask);
+      }
+    }
+  }
+}
+
+void BLI_bvhtree_ray_cast_packet(const BVHTree *tree,
+                                 const blender::Span<blender::float3> origins,
+                                 const blender::Span<blender::float3> directions,
+                                 const float radius,
+                                 blender::MutableSpan<BVHTreeRayHit> hits,
+                                 BVHTree_RayCastCallback callback,
+                                 void *userdata,
+                                 const int flag)
+{
+  BLI_assert(origins.size() == directions.size() && origins.size() == hits.size());
+  BVHNode *root = tree->nodes[tree->leaf_num];
+  if (root == nullptr) {
+    return;
+  }
+
+  BVHRayCastData packet[BVH_RAYCAST_PACKET_SIZE];
+  for (int64_t start = 0; start < origins.size(); start += BVH_RAYCAST_PACKET_SIZE) {
+    const int64_t size = std::min<int64_t>(BVH_RAYCAST_PACKET_SIZE, origins.size() - start);
+    for (int64_t i = 0; i < size; i++) {
+      BVHRayCastData *data = &packet[i];
+      BLI_ASSERT_UNIT_V3(directions[start + i]);
+      data->tree = tree;
+      data->callback = callback;
+      data->userdata = userdata;
+      copy_v3_v3(data->ray.origin, origins[start + i]);
+      copy_v3_v3(data->ray.direction, directions[start + i]);
+      data->ray.radius = radius;
+      bvhtree_ray_cast_data_precalc(data, flag);
+      data->hit = hits[start + i];
+    }
+
+    dfs_raycast_packet(packet, root, uint((uint64_t(1) << size) - 1));
+
+    for (int64_t i = 0; i < size; i++) {
+      hits[start + i] = packet[i].hit;
+    }
+  }
+}
+
 float BLI_bvhtree_bb_raycast(const float bv[6],
                              const float light_start[3],
                              const float light_end[3],
@@ -8,9 +8,9 @@
 
 #include "BLI_mmap.h"
 #include "BLI_fileops.h"
-#include "BLI_listbase.h"
 #include "MEM_guardedalloc.h"
 
+#include <atomic>
 #include <cstring>
 
 #ifndef WIN32
@@ -23,6 +23,10 @@
 #  include <io.h> /* For open close read. */
 #endif
 
+#ifndef WIN32
+struct MappedRegion;
+#endif
+
 struct BLI_mmap_file {
   /* The address to which the file was mapped. */
   char *memory;
@@ -33,48 +37,81 @@ struct BLI_mmap_file {
   /* Platform-specific handle for the mapping. */
   void *handle;
 
+  /* Whether the mapped memory is writable (copy-on-write). */
+  bool writable;
+
   /* Flag to indicate IO errors. Needs to be volatile since it's being set from
    * within the signal handler, which is not part of the normal execution flow. */
   volatile bool io_error;
+
+#ifndef WIN32
+  /* Entry in the list that the error handler checks, null once the memory is unmapped. */
+  MappedRegion *region;
+#endif
 };
 
 #ifndef WIN32
 /* When using memory-mapped files, any IO errors will result in a SIGBUS signal.
  * Therefore, we need to catch that signal and stop reading the file in question.
- * To do so, we keep a list of all current FileDatas that use memory-mapped files,
- * and if a SIGBUS is caught, we check if the failed address is inside one of the
- * mapped regions.
- * If it is, we set a flag to indicate a failed read and remap the memory in
- * question to a zero-backed region in order to avoid additional signals.
+ * To do so, we keep a list of all current memory-mapped regions, and if a SIGBUS is caught, we
+ * check if the failed address is inside one of the mapped regions.
+ * If it is, we set a flag to indicate a failed read and remap the page in question to a
+ * zero-backed page in order to avoid additional signals. Only the failing page is replaced, other
+ * pages may still be readable, or may have been modified already in a writable mapping.
  * The code that actually reads the memory area has to check whether the flag was
  * set after it's done reading.
  * If the error occurred outside of a memory-mapped region, we call the previous
  * handler if one was configured and abort the process otherwise.
+ *
+ * Mapped memory may be referenced by loaded data long after reading, and may be accessed and
+ * freed from any thread while the handler runs, so the list only uses lock-free atomics. Its entries are never freed, unused entries are reused instead. That way
+ * the handler never accesses freed memory.
  */
 
+struct MappedRegion {
+  /* Set while a file owns the entry. */
+  std::atomic<bool> in_use;
+  /* Set once the owner finished initializing the entry, checked by the handler. */
+  std::atomic<bool> active;
+  std::atomic<char *> memory;
+  std::atomic<size_t> length;
+  std::atomic<bool> writable;
+  std::atomic<bool> io_error;
+  /* Never changes after the entry was added to the list. */
+  MappedRegion *next;
+};
+
+static std::atomic<MappedRegion *> mapped_regions;
+
 static struct error_handler_data {
-  ListBase open_mmaps;
-  char configured;
+  size_t page_size;
   void (*next_handler)(int, siginfo_t *, void *);
-} error_handler = {{nullptr}};
+} error_handler = {0, nullptr};
 
 static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
 {
   /* We only handle SIGBUS here for now. */
   BLI_assert(sig == SIGBUS);
 
-  const char *error_addr = (const char *)siginfo->si_addr;
+  char *error_addr = (char *)siginfo->si_addr;
   /* Find the file that this error belongs to. */
-  LISTBASE_FOREACH (LinkData *, link, &error_handler.open_mmaps) {
-    BLI_mmap_file *file = static_cast<BLI_mmap_file *>(link->data);
+  for (MappedRegion *region = mapped_regions.load(); region; region = region->next) {
+    if (!region->active.load()) {
+      continue;
+    }
+    char *memory = region->memory.load();
+    const size_t length = region->length.load();
 
     /* Is the address where the error occurred in this file's mapped range? */
-    if (error_addr >= file->memory && error_addr < file->memory + file->length) {
-      file->io_error = true;
+    if (error_addr >= memory && error_addr < memory + length) {
+      region->io_error.store(true);
 
-      /* Replace the mapped memory with zeroes. */
+      /* Replace the page that failed with zeroes. */
+      const size_t page_size = error_handler.page_size;
+      char *error_page = memory + size_t(error_addr - memory) / page_size * page_size;
+      const int prot = region->writable.load() ? (PROT_READ | PROT_WRITE) : PROT_READ;
       const void *mapped_memory = mmap(
-          file->memory, file->length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+          error_page, page_size, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
       if (mapped_memory == MAP_FAILED) {
         fprintf(stderr, "SIGBUS handler: Error replacing mapped file with zeros\n");
       }
@@ -96,12 +133,14 @@ static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
 /* Ensures that the error handler is set up and ready. */
 static bool sigbus_handler_setup()
 {
-  if (!error_handler.configured) {
+  static const bool configured = []() {
     struct sigaction newact = {{nullptr}}, oldact = {{nullptr}};
 
     newact.sa_sigaction = sigbus_handler;
     newact.sa_flags = SA_SIGINFO;
 
+    error_handler.page_size = size_t(sysconf(_SC_PAGESIZE));
+
     if (sigaction(SIGBUS, &newact, &oldact)) {
       return false;
     }
@@ -109,28 +148,63 @@ static bool sigbus_handler_setup()
     /* Remember the previously configured handler to fall back to it if the error
      * does not belong to any of the mapped files. */
     error_handler.next_handler = oldact.sa_sigaction;
-    error_handler.configured = 1;
-  }
+    return true;
+  }();
 
-  return true;
+  return configured;
 }
 
 /* Adds a file to the list that the error handler checks. */
 static void sigbus_handler_add(BLI_mmap_file *file)
 {
-  BLI_addtail(&error_handler.open_mmaps, BLI_genericNodeN(file));
+  MappedRegion *region = nullptr;
+  for (MappedRegion *iter = mapped_regions.load(); iter; iter = iter->next) {
+    bool in_use = false;
+    if (iter->in_use.compare_exchange_strong(in_use, true)) {
+      region = iter;
+      break;
+    }
+  }
+  if (region == nullptr) {
+    /* Not allocated with the guarded allocator, entries are never freed. */
+    region = new MappedRegion();
+    region->in_use.store(true);
+    region->next = mapped_regions.load();
+    while (!mapped_regions.compare_exchange_weak(region->next, region)) {
+    }
+  }
+
+  region->memory.store(file->memory);
+  region->length.store(file->length);
+  region->writable.store(file->writable);
+  region->io_error.store(false);
+  region->active.store(true);
+  file->region = region;
 }
 
 /* Removes a file from the list that the error handler checks. */
 static void sigbus_handler_remove(BLI_mmap_file *file)
 {
-  LinkData *link = static_cast<LinkData *>(
-      BLI_findptr(&error_handler.open_mmaps, file, offsetof(LinkData, data)));
-  BLI_freelinkN(&error_handler.open_mmaps, link);
+  MappedRegion *region = file->region;
+  if (region == nullptr) {
+    return;
+  }
+  region->active.store(false);
+  if (region->io_error.load()) {
+    file->io_error = true;
+  }
+  region->in_use.store(false);
+  file->region = nullptr;
+}
+
+/* Whether an IO error happened while accessing the file. */
+static bool mmap_has_io_error(const BLI_mmap_file *file)
+{
+  return file->io_error || (file->region && file->region->io_error.load());
 }
 #endif
 
-BLI_mmap_file *BLI_mmap_open(int fd)
+static BLI_mmap_file *mmap_open(int fd, const bool writable)
 {
   void *memory, *handle = nullptr;
   const size_t length = BLI_lseek(fd, 0, SEEK_END);
@@ -145,7 +219,8 @@ BLI_mmap_file *BLI_mmap_open(int fd)
   }
 
   /* Map the given file to memory. */
-  memory = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+  memory = mmap(nullptr, length, prot, MAP_PRIVATE, fd, 0);
   if (memory == MAP_FAILED) {
     return nullptr;
   }
@@ -155,11 +230,12 @@ BLI_mmap_file *BLI_mmap_open(int fd)
   /* Memory mapping on Windows is a two-step process - first we create a mapping,
    * then we create a view into that mapping.
    * In our case, one view that spans the entire file is enough. */
-  handle = CreateFileMapping(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  handle = CreateFileMapping(
+      file_handle, nullptr, writable ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
   if (handle == nullptr) {
     return nullptr;
   }
-  memory = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+  memory = MapViewOfFile(handle, writable ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
   if (memory == nullptr) {
     CloseHandle(handle);
     return nullptr;
@@ -171,6 +247,7 @@ BLI_mmap_file *BLI_mmap_open(int fd)
   file->memory = static_cast<char *>(memory);
   file->handle = handle;
   file->length = length;
+  file->writable = writable;
 
 #ifndef WIN32
   /* Register the file with the error handler. */
@@ -180,19 +257,39 @@ BLI_mmap_file *BLI_mmap_open(int fd)
   return file;
 }
 
+BLI_mmap_file *BLI_mmap_open(int fd)
+{
+  return mmap_open(fd, false);
+}
+
+BLI_mmap_file *BLI_mmap_open_private_writable(int fd)
+{
+  return mmap_open(fd, true);
+}
+
 bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length)
 {
   /* If a previous read has already failed or we try to read past the end,
    * don't even attempt to read any further. */
-  if (file->io_error || (offset + length > file->length)) {
+  if (offset + length > file->length) {
     return false;
   }
 
 #ifndef WIN32
+  if (mmap_has_io_error(file)) {
+    return false;
+  }
+
   /* If an error occurs in this call, sigbus_handler will be called and will set
-   * file->io_error to true. */
+   * the io_error flag of the file's region. */
   memcpy(dest, file->memory + offset, length);
+
+  return !mmap_has_io_error(file);
 #else
+  if (file->io_error) {
+    return false;
+  }
+
   /* On Windows, we use exception handling to be notified of errors. */
   __try
   {
@@ -204,9 +301,9 @@ bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length
     file->io_error = true;
     return false;
   }
-#endif
 
   return !file->io_error;
+#endif
 }
 
 void *BLI_mmap_get_pointer(BLI_mmap_file *file)
@@ -219,11 +316,21 @@ size_t BLI_mmap_get_length(const BLI_mmap_file *file)
   return file->length;
 }
 
+bool BLI_mmap_has_io_error(const BLI_mmap_file *file)
+{
+#ifndef WIN32
+  return mmap_has_io_error(file);
+#else
+  return file->io_error;
+#endif
+}
+
 void BLI_mmap_free(BLI_mmap_file *file)
 {
 #ifndef WIN32
-  munmap((void *)file->memory, file->length);
+  /* Unregister first, so that the error handler never sees an unmapped range. */
   sigbus_handler_remove(file);
+  munmap((void *)file->memory, file->length);
 #else
   UnmapViewOfFile(file->memory);
   CloseHandle(file->handle);
@@ -7,11 +7,15 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <zstd.h>
 
+#include "BLI_array.hh"
 #include "BLI_fileops.hh"
 #include "BLI_filereader.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #ifdef __BIG_ENDIAN__
 #  include "BLI_endian_switch.h"
@@ -19,6 +23,42 @@
 
 #include "MEM_guardedalloc.h"
 
+/**
+ * Maximum number of frames that are decompressed ahead of the reading position.
+ * Frames written by Blender are 1mb each, so this bounds the extra memory to a few megabytes.
+ */
+#define ZSTD_READ_AHEAD_FRAMES_MAX 8
+
+/** A single buffer of the read-ahead ring, decompressed by a worker thread. */
+struct ZstdReadAheadSlot {
+  ZSTD_DCtx *ctx = nullptr;
+
+  /** Frame that is (being) decompressed into this slot, -1 when unused. */
+  int frame = -1;
+  char *compressed_data = nullptr;
+  size_t compressed_size = 0;
+  char *uncompressed_data = nullptr;
+  size_t uncompressed_size = 0;
+
+  /** Set by the worker once `uncompressed_data` is valid (or `error` is set). */
+  std::atomic<bool> done = false;
+  bool error = false;
+};
+
+/**
+ * Decompresses the frames following the current reading position on worker threads, so that
+ * sequential reads (which is how the file is read in the common case) rarely have to wait.
+ *
+ * Reading from the base #FileReader only ever happens on the thread that owns the reader,
+ * workers only operate on the compressed data that was read for them.
+ */
+struct ZstdReadAhead {
+  TaskPool *pool = nullptr;
+  blender::Array<ZstdReadAheadSlot> slots;
+  /** First frame that has not been scheduled for decompression yet. */
+  int next_frame = 0;
+};
+
 struct ZstdReader {
   FileReader reader;
 
@@ -35,6 +75,9 @@ struct ZstdReader {
 
     char *cached_content;
     int cached_frame;
+
+    /** Only used for seekable files with multiple frames when threading is available. */
+    ZstdReadAhead *read_ahead;
   } seek;
 };
 
@@ -160,6 +203,155 @@ static int zstd_frame_from_pos(ZstdReader *zstd, size_t pos)
   return low;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Read-Ahead
+ * \{ */
+
+static void zstd_read_ahead_task(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  ZstdReadAheadSlot *slot = static_cast<ZstdReadAheadSlot *>(taskdata);
+
+  size_t res = ZSTD_decompressDCtx(slot->ctx,
+                                   slot->uncompressed_data,
+                                   slot->uncompressed_size,
+                                   slot->compressed_data,
+                                   slot->compressed_size);
+  MEM_freeN(slot->compressed_data);
+  slot->compressed_data = nullptr;
+  slot->error = ZSTD_isError(res) || res < slot->uncompressed_size;
+  slot->done.store(true, std::memory_order_release);
+}
+
+static void zstd_read_ahead_slot_clear(ZstdReadAheadSlot &slot)
+{
+  MEM_SAFE_FREE(slot.compressed_data);
+  MEM_SAFE_FREE(slot.uncompressed_data);
+  slot.frame = -1;
+  slot.error = false;
+  slot.done.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * Read the compressed data of the next frame that is not scheduled yet and start decompressing
+ * it into the given (unused) slot.
+ */
+static void zstd_read_ahead_schedule(ZstdReader *zstd, ZstdReadAheadSlot &slot)
+{
+  ZstdReadAhead *read_ahead = zstd->seek.read_ahead;
+  const int frame = read_ahead->next_frame;
+  if (frame >= zstd->seek.frames_num) {
+    return;
+  }
+  read_ahead->next_frame++;
+
+  slot.frame = frame;
+  slot.compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
+  slot.uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
+                           zstd->seek.uncompressed_ofs[frame];
+  slot.compressed_data = static_cast<char *>(MEM_mallocN(slot.compressed_size, __func__));
+  slot.uncompressed_data = static_cast<char *>(MEM_mallocN(slot.uncompressed_size, __func__));
+
+  if (zstd->base->seek(zstd->base, zstd->seek.compressed_ofs[frame], SEEK_SET) < 0 ||
+      zstd->base->read(zstd->base, slot.compressed_data, slot.compressed_size) <
+          slot.compressed_size)
+  {
+    MEM_SAFE_FREE(slot.compressed_data);
+    slot.error = true;
+    slot.done.store(true, std::memory_order_relaxed);
+    return;
+  }
+
+  BLI_task_pool_push(read_ahead->pool, zstd_read_ahead_task, &slot, false, nullptr);
+}
+
+/** Discard all scheduled frames and restart reading ahead from `frame`. */
+static void zstd_read_ahead_restart(ZstdReader *zstd, int frame)
+{
+  ZstdReadAhead *read_ahead = zstd->seek.read_ahead;
+  BLI_task_pool_work_and_wait(read_ahead->pool);
+
+  for (ZstdReadAheadSlot &slot : read_ahead->slots) {
+    zstd_read_ahead_slot_clear(slot);
+  }
+  read_ahead->next_frame = frame;
+  for (ZstdReadAheadSlot &slot : read_ahead->slots) {
+    zstd_read_ahead_schedule(zstd, slot);
+  }
+}
+
+/**
+ * Take the decompressed content of `frame` from the read-ahead ring and schedule the next frame
+ * into the freed slot. Returns null on error.
+ */
+static char *zstd_read_ahead_take(ZstdReader *zstd, int frame)
+{
+  ZstdReadAhead *read_ahead = zstd->seek.read_ahead;
+
+  ZstdReadAheadSlot *found = nullptr;
+  for (ZstdReadAheadSlot &slot : read_ahead->slots) {
+    if (slot.frame == frame) {
+      found = &slot;
+      break;
+    }
+  }
+  if (found == nullptr) {
+    /* Not a sequential read, start over at the requested position. */
+    zstd_read_ahead_restart(zstd, frame);
+    found = &read_ahead->slots[0];
+  }
+
+  if (!found->done.load(std::memory_order_acquire)) {
+    /* Helps decompressing instead of idling. The following frames are most likely finished
+     * afterwards too, so waiting for all of them does not cost much. */
+    BLI_task_pool_work_and_wait(read_ahead->pool);
+  }
+
+  char *uncompressed_data = nullptr;
+  if (!found->error) {
+    uncompressed_data = found->uncompressed_data;
+    found->uncompressed_data = nullptr;
+  }
+  zstd_read_ahead_slot_clear(*found);
+  zstd_read_ahead_schedule(zstd, *found);
+
+  return uncompressed_data;
+}
+
+static void zstd_read_ahead_init(ZstdReader *zstd)
+{
+  const int slots_num = std::min(BLI_system_thread_count(), ZSTD_READ_AHEAD_FRAMES_MAX);
+  if (slots_num < 2 || zstd->seek.frames_num < 2) {
+    return;
+  }
+
+  ZstdReadAhead *read_ahead = MEM_new<ZstdReadAhead>(__func__);
+  read_ahead->pool = BLI_task_pool_create(nullptr, TASK_PRIORITY_HIGH);
+  read_ahead->slots.reinitialize(slots_num);
+  for (ZstdReadAheadSlot &slot : read_ahead->slots) {
+    slot.ctx = ZSTD_createDCtx();
+  }
+  zstd->seek.read_ahead = read_ahead;
+}
+
+static void zstd_read_ahead_free(ZstdReader *zstd)
+{
+  ZstdReadAhead *read_ahead = zstd->seek.read_ahead;
+  if (read_ahead == nullptr) {
+    return;
+  }
+
+  BLI_task_pool_work_and_wait(read_ahead->pool);
+  BLI_task_pool_free(read_ahead->pool);
+  for (ZstdReadAheadSlot &slot : read_ahead->slots) {
+    zstd_read_ahead_slot_clear(slot);
+    ZSTD_freeDCtx(slot.ctx);
+  }
+  MEM_delete(read_ahead);
+  zstd->seek.read_ahead = nullptr;
+}
+
+/** \} */
+
 /* Ensure that the currently loaded frame is the correct one. */
 static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
 {
@@ -168,6 +360,18 @@ static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
     return zstd->seek.cached_content;
   }
 
+  if (zstd->seek.read_ahead) {
+    MEM_SAFE_FREE(zstd->seek.cached_content);
+    char *uncompressed_data = zstd_read_ahead_take(zstd, frame);
+    if (uncompressed_data == nullptr) {
+      zstd->seek.cached_frame = -1;
+      return nullptr;
+    }
+    zstd->seek.cached_frame = frame;
+    zstd->seek.cached_content = uncompressed_data;
+    return uncompressed_data;
+  }
+
   /* Cached frame doesn't match, so discard it and cache the wanted one instead. */
   MEM_SAFE_FREE(zstd->seek.cached_content);
 
@@ -286,6 +490,7 @@ static void zstd_close(FileReader *reader)
 
   ZSTD_freeDCtx(zstd->ctx);
   if (zstd->reader.seek) {
+    zstd_read_ahead_free(zstd);
     MEM_freeN(zstd->seek.uncompressed_ofs);
     MEM_freeN(zstd->seek.compressed_ofs);
     /* When an error has occurred this may be nullptr, see: #99744. */
@@ -311,6 +516,7 @@ FileReader *BLI_filereader_new_zstd(FileReader *base)
   if (zstd_read_seek_table(zstd)) {
     zstd->reader.read = zstd_read_seekable;
     zstd->reader.seek = zstd_seek;
+    zstd_read_ahead_init(zstd);
   }
   else {
     zstd->reader.read = zstd_read;
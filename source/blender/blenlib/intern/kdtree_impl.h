@@ -10,6 +10,8 @@
 
 #include "BLI_kdtree_impl.h"
 #include "BLI_math_base.h"
+#include "BLI_offset_indices.hh"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 #include "BLI_vector.hh"
 
@@ -58,6 +60,11 @@ struct KDTree {
  */
 #define KD_NODE_ROOT_IS_INIT ((uint)-2)
 
+/** Sub-trees with fewer nodes are balanced on a single thread. */
+#define KD_BALANCE_THREADING_THRESHOLD 8192
+/** Number of query points handled by a single task in batched queries. */
+#define KD_BATCH_GRAIN_SIZE 256
+
 /* -------------------------------------------------------------------- */
 /** \name Local Math API
  * \{ */
@@ -187,13 +194,18 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
     }
   }
 
-  /* Set node and sort sub-nodes. */
+  /* Set node and sort sub-nodes. The sub-trees don't overlap, so they can be balanced in
+   * parallel. */
   node = &nodes[median];
   node->d = axis;
   axis = (axis + 1) % KD_DIMS;
-  node->left = kdtree_balance(nodes, median, axis, ofs);
-  node->right = kdtree_balance(
-      nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
+  blender::threading::parallel_invoke(
+      nodes_len >= KD_BALANCE_THREADING_THRESHOLD,
+      [&]() { node->left = kdtree_balance(nodes, median, axis, ofs); },
+      [&]() {
+        node->right = kdtree_balance(
+            nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
+      });
 
   return median + ofs;
 }
@@ -812,6 +824,79 @@ static blender::Vector<int> kdtree_order(const KDTree *tree)
   return order;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Queries
+ * \{ */
+
+void BLI_kdtree_nd_(find_nearest_batch)(const KDTree *tree,
+                                        const blender::Span<blender::VecBase<float, KD_DIMS>> co,
+                                        blender::MutableSpan<KDTreeNearest> r_nearest)
+{
+  BLI_assert(co.size() == r_nearest.size());
+  blender::threading::parallel_for(
+      co.index_range(), KD_BATCH_GRAIN_SIZE, [&](const blender::IndexRange range) {
+        for (const int64_t i : range) {
+          if (BLI_kdtree_nd_(find_nearest)(tree, co[i], &r_nearest[i]) == -1) {
+            r_nearest[i].index = -1;
+          }
+        }
+      });
+}
+
+void BLI_kdtree_nd_(find_nearest_n_batch)(
+    const KDTree *tree,
+    const blender::Span<blender::VecBase<float, KD_DIMS>> co,
+    const uint nearest_len_capacity,
+    blender::MutableSpan<KDTreeNearest> r_nearest,
+    blender::MutableSpan<int> r_nearest_len)
+{
+  BLI_assert(r_nearest.size() == co.size() * int64_t(nearest_len_capacity));
+  BLI_assert(co.size() == r_nearest_len.size());
+  blender::threading::parallel_for(
+      co.index_range(), KD_BATCH_GRAIN_SIZE, [&](const blender::IndexRange range) {
+        for (const int64_t i : range) {
+          r_nearest_len[i] = BLI_kdtree_nd_(find_nearest_n)(
+              tree, co[i], &r_nearest[i * int64_t(nearest_len_capacity)], nearest_len_capacity);
+        }
+      });
+}
+
+blender::Array<KDTreeNearest> BLI_kdtree_nd_(range_search_batch)(
+    const KDTree *tree,
+    const blender::Span<blender::VecBase<float, KD_DIMS>> co,
+    const float range,
+    blender::MutableSpan<int> r_offsets)
+{
+  BLI_assert(r_offsets.size() == co.size() + 1);
+  /* The number of results is only known after searching, so keep the results of every query point
+   * until they can be gathered into a single array. */
+  blender::Array<KDTreeNearest *> nearest_per_co(co.size());
+  blender::threading::parallel_for(
+      co.index_range(), KD_BATCH_GRAIN_SIZE, [&](const blender::IndexRange co_range) {
+        for (const int64_t i : co_range) {
+          nearest_per_co[i] = nullptr;
+          r_offsets[i] = BLI_kdtree_nd_(range_search)(tree, co[i], &nearest_per_co[i], range);
+        }
+      });
+  const blender::OffsetIndices<int> offsets =
+      blender::offset_indices::accumulate_counts_to_offsets(r_offsets);
+
+  blender::Array<KDTreeNearest> nearest(offsets.total_size());
+  blender::threading::parallel_for(
+      co.index_range(), KD_BATCH_GRAIN_SIZE, [&](const blender::IndexRange co_range) {
+        for (const int64_t i : co_range) {
+          if (nearest_per_co[i] == nullptr) {
+            continue;
+          }
+          std::copy_n(nearest_per_co[i], offsets[i].size(), &nearest[offsets[i].start()]);
+          MEM_freeN(nearest_per_co[i]);
+        }
+      });
+  return nearest;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_kdtree_3d_calc_duplicates_fast
  * \{ */
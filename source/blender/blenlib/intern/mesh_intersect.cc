@@ -10,17 +10,20 @@
 #ifdef WITH_GMP
 
 #  include <algorithm>
+#  include <atomic>
 #  include <fstream>
 #  include <functional>
 #  include <iostream>
 #  include <memory>
 #  include <numeric>
+#  include <optional>
 
 #  include "BLI_array.hh"
 #  include "BLI_assert.h"
 #  include "BLI_delaunay_2d.hh"
 #  include "BLI_kdopbvh.hh"
 #  include "BLI_map.hh"
+#  include "BLI_math_boolean.hh"
 #  include "BLI_math_geom.h"
 #  include "BLI_math_matrix.h"
 #  include "BLI_math_mpq.hh"
@@ -1126,6 +1129,78 @@ static int filter_plane_side(const double3 &p,
   return 0;
 }
 
+/**
+ * The index of #orient3d on input coordinates with index 1: the differences have index 2,
+ * their cross product 6, and the dot product with another difference 11.
+ */
+constexpr int index_orient3d = 11;
+
+/**
+ * Return the approximate #orient3d of points a, b, c, and d, i.e. the sign of
+ * `dot(a - d, cross(b - d, c - d))`. Like #filter_plane_side, the answer is only nonzero
+ * if it is the same as the answer with exact arithmetic.
+ */
+static int filter_orient3d(const double3 &a, const double3 &b, const double3 &c, const double3 &d)
+{
+  const double3 ad = a - d;
+  const double3 bd = b - d;
+  const double3 cd = c - d;
+  const double det = math::dot(ad, math::cross(bd, cd));
+  if (det == 0.0) {
+    return 0;
+  }
+  const double3 abs_d = math::abs(d);
+  const double3 sup_ad = math::abs(a) + abs_d;
+  const double3 sup_bd = math::abs(b) + abs_d;
+  const double3 sup_cd = math::abs(c) + abs_d;
+  const double3 sup_cross(sup_bd[1] * sup_cd[2] + sup_bd[2] * sup_cd[1],
+                          sup_bd[2] * sup_cd[0] + sup_bd[0] * sup_cd[2],
+                          sup_bd[0] * sup_cd[1] + sup_bd[1] * sup_cd[0]);
+  const double err_bound = math::dot(sup_ad, sup_cross) * index_orient3d * DBL_EPSILON;
+  if (fabs(det) > err_bound) {
+    return det > 0 ? 1 : -1;
+  }
+  return 0;
+}
+
+static std::atomic<bool> predicate_stats_enabled = false;
+static std::atomic<int64_t> predicate_stats_filtered_num = 0;
+static std::atomic<int64_t> predicate_stats_exact_num = 0;
+
+/** Count a predicate evaluation for #predicate_stats_get, if enabled. */
+static inline void count_predicate(const bool filtered)
+{
+  if (predicate_stats_enabled.load(std::memory_order_relaxed)) {
+    (filtered ? predicate_stats_filtered_num : predicate_stats_exact_num)++;
+  }
+}
+
+void predicate_stats_enable(const bool enable)
+{
+  predicate_stats_filtered_num = 0;
+  predicate_stats_exact_num = 0;
+  predicate_stats_enabled = enable;
+}
+
+PredicateStats predicate_stats_get()
+{
+  PredicateStats stats;
+  stats.filtered_num = predicate_stats_filtered_num;
+  stats.exact_num = predicate_stats_exact_num;
+  return stats;
+}
+
+int filtered_orient3d(const Vert *a, const Vert *b, const Vert *c, const Vert *d)
+{
+  const int orient = filter_orient3d(a->co, b->co, c->co, d->co);
+  if (orient != 0) {
+    count_predicate(true);
+    return orient;
+  }
+  count_predicate(false);
+  return orient3d(a->co_exact, b->co_exact, c->co_exact, d->co_exact);
+}
+
 /*
  * #intersect_tri_tri and helper functions.
  * This code uses the algorithm of Guigue and Devillers, as described
@@ -1158,7 +1233,6 @@ static inline mpq3 tti_interp(
 /**
  * Return +1, 0, -1 as a + ad is above, on, or below the oriented plane containing a, b, c in CCW
  * order. This is the same as -oriented(a, b, c, a + ad), but uses fewer arithmetic operations.
- * TODO: change arguments to `const Vert *` and use floating filters.
  * The ba, ca, n, and dotbuf arguments are used as temporaries; declaring them
  * in the caller can avoid many allocations and frees of mpq3 and mpq_class structures.
  */
@@ -1183,6 +1257,30 @@ static inline int tti_above(const mpq3 &a,
   return sgn(math::dot_with_buffer(ad, n, dotbuf));
 }
 
+/**
+ * Like #tti_above with `ad = d - a`, but using the floating point filter first. Exact arithmetic
+ * is only used when the filter is inconclusive, and \a ad is only computed then, if it is not
+ * already set by an earlier call. The buffers are passed on to #tti_above.
+ */
+static inline int tti_above_filtered(const Vert *a,
+                                     const Vert *b,
+                                     const Vert *c,
+                                     const Vert *d,
+                                     std::optional<mpq3> &ad,
+                                     mpq3 *buf)
+{
+  const int orient = filter_orient3d(a->co, b->co, c->co, d->co);
+  if (orient != 0) {
+    count_predicate(true);
+    return -orient;
+  }
+  count_predicate(false);
+  if (!ad) {
+    ad = d->co_exact - a->co_exact;
+  }
+  return tti_above(a->co_exact, b->co_exact, c->co_exact, *ad, buf[0], buf[1], buf[2], buf[3]);
+}
+
 /**
  * Given that triangles (p1, q1, r1) and (p2, q2, r2) are in canonical order,
  * use the classification chart in the Guigue and Devillers paper to find out
@@ -1196,15 +1294,21 @@ static inline int tti_above(const mpq3 &a,
  *   of the plane and at least one of q1 and r1 are off the plane.
  * Similarly for p2, q2, r2 with respect to the first triangle's plane.
  */
-static ITT_value itt_canon2(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon2(const Vert *vp1,
+                            const Vert *vq1,
+                            const Vert *vr1,
+                            const Vert *vp2,
+                            const Vert *vq2,
+                            const Vert *vr2,
                             const mpq3 &n1,
                             const mpq3 &n2)
 {
+  const mpq3 &p1 = vp1->co_exact;
+  const mpq3 &q1 = vq1->co_exact;
+  const mpq3 &r1 = vr1->co_exact;
+  const mpq3 &p2 = vp2->co_exact;
+  const mpq3 &q2 = vq2->co_exact;
+  const mpq3 &r2 = vr2->co_exact;
   constexpr int dbg_level = 0;
   if (dbg_level > 0) {
     std::cout << "\ntri_tri_intersect_canon:\n";
@@ -1221,17 +1325,17 @@ static ITT_value itt_canon2(const mpq3 &p1,
     std::cout << "n1=(" << n1[0].get_d() << "," << n1[1].get_d() << "," << n1[2].get_d() << ")\n";
     std::cout << "n2=(" << n2[0].get_d() << "," << n2[1].get_d() << "," << n2[2].get_d() << ")\n";
   }
-  mpq3 p1p2 = p2 - p1;
+  std::optional<mpq3> p1p2;
   mpq3 intersect_1;
   mpq3 intersect_2;
   mpq3 buf[4];
   bool no_overlap = false;
   /* Top test in classification tree. */
-  if (tti_above(p1, q1, r2, p1p2, buf[0], buf[1], buf[2], buf[3]) > 0) {
+  if (tti_above_filtered(vp1, vq1, vr2, vp2, p1p2, buf) > 0) {
     /* Middle right test in classification tree. */
-    if (tti_above(p1, r1, r2, p1p2, buf[0], buf[1], buf[2], buf[3]) <= 0) {
+    if (tti_above_filtered(vp1, vr1, vr2, vp2, p1p2, buf) <= 0) {
       /* Bottom right test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) > 0) {
+      if (tti_above_filtered(vp1, vr1, vq2, vp2, p1p2, buf) > 0) {
         /* Overlap is [k [i l] j]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i l] j]\n";
@@ -1260,7 +1364,7 @@ static ITT_value itt_canon2(const mpq3 &p1,
   }
   else {
     /* Middle left test in classification tree. */
-    if (tti_above(p1, q1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) < 0) {
+    if (tti_above_filtered(vp1, vq1, vq2, vp2, p1p2, buf) < 0) {
       /* No overlap: [i j] [k l]. */
       if (dbg_level > 0) {
         std::cout << "no overlap: [i j] [k l]\n";
@@ -1269,7 +1373,7 @@ static ITT_value itt_canon2(const mpq3 &p1,
     }
     else {
       /* Bottom left test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) >= 0) {
+      if (tti_above_filtered(vp1, vr1, vq2, vp2, p1p2, buf) >= 0) {
         /* Overlap is [k [i j] l]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i j] l]\n";
@@ -1306,12 +1410,12 @@ static ITT_value itt_canon2(const mpq3 &p1,
 
 /* Helper function for intersect_tri_tri. Arguments have been canonicalized for triangle 1. */
 
-static ITT_value itt_canon1(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon1(const Vert *p1,
+                            const Vert *q1,
+                            const Vert *r1,
+                            const Vert *p2,
+                            const Vert *q2,
+                            const Vert *r2,
                             const mpq3 &n1,
                             const mpq3 &n2,
                             int sp2,
@@ -1408,6 +1512,9 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   int sp1 = filter_plane_side(d_p1, d_r2, d_n2, abs_d_p1, abs_d_r2, abs_d_n2);
   int sq1 = filter_plane_side(d_q1, d_r2, d_n2, abs_d_q1, abs_d_r2, abs_d_n2);
   int sr1 = filter_plane_side(d_r1, d_r2, d_n2, abs_d_r1, abs_d_r2, abs_d_n2);
+  count_predicate(sp1 != 0);
+  count_predicate(sq1 != 0);
+  count_predicate(sr1 != 0);
   if ((sp1 > 0 && sq1 > 0 && sr1 > 0) || (sp1 < 0 && sq1 < 0 && sr1 < 0)) {
 #  ifdef PERFDEBUG
     incperfcount(2); /* Triangle-triangle intersects decided by filter plane tests. */
@@ -1426,6 +1533,9 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   int sp2 = filter_plane_side(d_p2, d_r1, d_n1, abs_d_p2, abs_d_r1, abs_d_n1);
   int sq2 = filter_plane_side(d_q2, d_r1, d_n1, abs_d_q2, abs_d_r1, abs_d_n1);
   int sr2 = filter_plane_side(d_r2, d_r1, d_n1, abs_d_r2, abs_d_r1, abs_d_n1);
+  count_predicate(sp2 != 0);
+  count_predicate(sq2 != 0);
+  count_predicate(sr2 != 0);
   if ((sp2 > 0 && sq2 > 0 && sr2 > 0) || (sp2 < 0 && sq2 < 0 && sr2 < 0)) {
 #  ifdef PERFDEBUG
     incperfcount(2); /* Triangle-triangle intersects decided by filter plane tests. */
@@ -1513,49 +1623,49 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   ITT_value ans;
   if (sp1 > 0) {
     if (sq1 > 0) {
-      ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
     else if (sr1 > 0) {
-      ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
   }
   else if (sp1 < 0) {
     if (sq1 < 0) {
-      ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
     else if (sr1 < 0) {
-      ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
   }
   else {
     if (sq1 < 0) {
       if (sr1 >= 0) {
-        ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
-        ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
     }
     else if (sq1 > 0) {
       if (sr1 > 0) {
-        ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
-        ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
     }
     else {
       if (sr1 > 0) {
-        ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
       else if (sr1 < 0) {
-        ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
         if (dbg_level > 0) {
@@ -9,12 +9,14 @@
 #include <cmath>
 #include <cstdint>
 
+#include "BLI_array.hh"
 #include "BLI_math_base.h"
 #include "BLI_math_base.hh"
 #include "BLI_math_matrix_types.hh"
 #include "BLI_math_numbers.hh"
 #include "BLI_math_vector.hh"
 #include "BLI_noise.hh"
+#include "BLI_simd.hh"
 #include "BLI_utildefines.h"
 
 namespace blender::noise {
@@ -1022,6 +1024,371 @@ float3 perlin_float3_fractal_distorted(float4 position,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Perlin Noise
+ *
+ * Evaluates 3D perlin noise at four positions at once. Every operation is the same as in the
+ * single position functions above, including the double precision parts of #fade, so the results
+ * are bit-exact.
+ * \{ */
+
+#if BLI_HAVE_SSE4
+
+template<int k> BLI_INLINE __m128i hash_bit_rotate_x4(const __m128i x)
+{
+  return _mm_or_si128(_mm_slli_epi32(x, k), _mm_srli_epi32(x, 32 - k));
+}
+
+BLI_INLINE void hash_bit_mix_x4(__m128i &a, __m128i &b, __m128i &c)
+{
+  a = _mm_sub_epi32(a, c);
+  a = _mm_xor_si128(a, hash_bit_rotate_x4<4>(c));
+  c = _mm_add_epi32(c, b);
+  b = _mm_sub_epi32(b, a);
+  b = _mm_xor_si128(b, hash_bit_rotate_x4<6>(a));
+  a = _mm_add_epi32(a, c);
+  c = _mm_sub_epi32(c, b);
+  c = _mm_xor_si128(c, hash_bit_rotate_x4<8>(b));
+  b = _mm_add_epi32(b, a);
+  a = _mm_sub_epi32(a, c);
+  a = _mm_xor_si128(a, hash_bit_rotate_x4<16>(c));
+  c = _mm_add_epi32(c, b);
+  b = _mm_sub_epi32(b, a);
+  b = _mm_xor_si128(b, hash_bit_rotate_x4<19>(a));
+  a = _mm_add_epi32(a, c);
+  c = _mm_sub_epi32(c, b);
+  c = _mm_xor_si128(c, hash_bit_rotate_x4<4>(b));
+  b = _mm_add_epi32(b, a);
+}
+
+BLI_INLINE void hash_bit_final_x4(__m128i &a, __m128i &b, __m128i &c)
+{
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_x4<14>(b));
+  a = _mm_xor_si128(a, c);
+  a = _mm_sub_epi32(a, hash_bit_rotate_x4<11>(c));
+  b = _mm_xor_si128(b, a);
+  b = _mm_sub_epi32(b, hash_bit_rotate_x4<25>(a));
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_x4<16>(b));
+  a = _mm_xor_si128(a, c);
+  a = _mm_sub_epi32(a, hash_bit_rotate_x4<4>(c));
+  b = _mm_xor_si128(b, a);
+  b = _mm_sub_epi32(b, hash_bit_rotate_x4<14>(a));
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_x4<24>(b));
+}
+
+BLI_INLINE __m128i hash_x4(const __m128i kx, const __m128i ky, const __m128i kz)
+{
+  __m128i a, b, c;
+  a = b = c = _mm_set1_epi32(int(0xdeadbeef + (3 << 2) + 13));
+
+  c = _mm_add_epi32(c, kz);
+  b = _mm_add_epi32(b, ky);
+  a = _mm_add_epi32(a, kx);
+  hash_bit_final_x4(a, b, c);
+
+  return c;
+}
+
+BLI_INLINE __m128i hash_x4(const __m128i kx, const __m128i ky, const __m128i kz, const __m128i kw)
+{
+  __m128i a, b, c;
+  a = b = c = _mm_set1_epi32(int(0xdeadbeef + (4 << 2) + 13));
+
+  a = _mm_add_epi32(a, kx);
+  b = _mm_add_epi32(b, ky);
+  c = _mm_add_epi32(c, kz);
+  hash_bit_mix_x4(a, b, c);
+
+  a = _mm_add_epi32(a, kw);
+  hash_bit_final_x4(a, b, c);
+
+  return c;
+}
+
+BLI_INLINE __m128 fade_x4(const __m128 t)
+{
+  const __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+  auto fade_pd = [](const __m128 t, const __m128 t3) {
+    const __m128d td = _mm_cvtps_pd(t);
+    const __m128d poly = _mm_add_pd(
+        _mm_mul_pd(td, _mm_sub_pd(_mm_mul_pd(td, _mm_set1_pd(6.0)), _mm_set1_pd(15.0))),
+        _mm_set1_pd(10.0));
+    return _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(t3), poly));
+  };
+  return _mm_movelh_ps(fade_pd(t, t3), fade_pd(_mm_movehl_ps(t, t), _mm_movehl_ps(t3, t3)));
+}
+
+BLI_INLINE __m128 negate_if_x4(const __m128 value, const __m128i condition, const int bit)
+{
+  const __m128i sign = _mm_slli_epi32(_mm_and_si128(condition, _mm_set1_epi32(1 << bit)),
+                                      31 - bit);
+  return _mm_xor_ps(value, _mm_castsi128_ps(sign));
+}
+
+BLI_INLINE __m128 noise_grad_x4(const __m128i hash, const __m128 x, const __m128 y, const __m128 z)
+{
+  const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+  const __m128 u = _mm_blendv_ps(y, x, _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8))));
+  const __m128i is_x = _mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)),
+                                    _mm_cmpeq_epi32(h, _mm_set1_epi32(14)));
+  const __m128 vt = _mm_blendv_ps(z, x, _mm_castsi128_ps(is_x));
+  const __m128 v = _mm_blendv_ps(vt, y, _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4))));
+  return _mm_add_ps(negate_if_x4(u, h, 0), negate_if_x4(v, h, 1));
+}
+
+BLI_INLINE __m128 mix_x4(const __m128 v0, const __m128 v1, const __m128 x, const __m128 x1)
+{
+  return _mm_add_ps(_mm_mul_ps(v0, x1), _mm_mul_ps(v1, x));
+}
+
+static __m128 perlin_noise_x4(const __m128 x, const __m128 y, const __m128 z)
+{
+  const __m128 x_floor = _mm_floor_ps(x);
+  const __m128 y_floor = _mm_floor_ps(y);
+  const __m128 z_floor = _mm_floor_ps(z);
+  const __m128i X = _mm_cvttps_epi32(x_floor);
+  const __m128i Y = _mm_cvttps_epi32(y_floor);
+  const __m128i Z = _mm_cvttps_epi32(z_floor);
+  const __m128i X1 = _mm_add_epi32(X, _mm_set1_epi32(1));
+  const __m128i Y1 = _mm_add_epi32(Y, _mm_set1_epi32(1));
+  const __m128i Z1 = _mm_add_epi32(Z, _mm_set1_epi32(1));
+
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 fx = _mm_sub_ps(x, x_floor);
+  const __m128 fy = _mm_sub_ps(y, y_floor);
+  const __m128 fz = _mm_sub_ps(z, z_floor);
+  const __m128 fx1 = _mm_sub_ps(fx, one);
+  const __m128 fy1 = _mm_sub_ps(fy, one);
+  const __m128 fz1 = _mm_sub_ps(fz, one);
+
+  const __m128 u = fade_x4(fx);
+  const __m128 v = fade_x4(fy);
+  const __m128 w = fade_x4(fz);
+  const __m128 u1 = _mm_sub_ps(one, u);
+  const __m128 v1 = _mm_sub_ps(one, v);
+  const __m128 w1 = _mm_sub_ps(one, w);
+
+  /* Same order of operations as the trilinear #mix. */
+  const __m128 r0 = mix_x4(
+      mix_x4(mix_x4(noise_grad_x4(hash_x4(X, Y, Z), fx, fy, fz),
+                    noise_grad_x4(hash_x4(X1, Y, Z), fx1, fy, fz),
+                    u,
+                    u1),
+             mix_x4(noise_grad_x4(hash_x4(X, Y1, Z), fx, fy1, fz),
+                    noise_grad_x4(hash_x4(X1, Y1, Z), fx1, fy1, fz),
+                    u,
+                    u1),
+             v,
+             v1),
+      mix_x4(mix_x4(noise_grad_x4(hash_x4(X, Y, Z1), fx, fy, fz1),
+                    noise_grad_x4(hash_x4(X1, Y, Z1), fx1, fy, fz1),
+                    u,
+                    u1),
+             mix_x4(noise_grad_x4(hash_x4(X, Y1, Z1), fx, fy1, fz1),
+                    noise_grad_x4(hash_x4(X1, Y1, Z1), fx1, fy1, fz1),
+                    u,
+                    u1),
+             v,
+             v1),
+      w,
+      w1);
+  return r0;
+}
+
+/** Same as the scalar `math::mod(value, 100000.0f)` + precision correction. */
+BLI_INLINE __m128 perlin_wrap_x4(const __m128 value)
+{
+  const __m128 abs_value = _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+  const __m128 precision_correction = _mm_and_ps(
+      _mm_cmpge_ps(abs_value, _mm_set1_ps(1000000.0f)), _mm_set1_ps(0.5f));
+  /* The modulo does not change values below the period, which is by far the most common case. */
+  __m128 wrapped = value;
+  if (_mm_movemask_ps(_mm_cmplt_ps(abs_value, _mm_set1_ps(100000.0f))) != 0b1111) {
+    alignas(16) float values[4];
+    _mm_store_ps(values, value);
+    for (float &v : values) {
+      v = math::mod(v, 100000.0f);
+    }
+    wrapped = _mm_load_ps(values);
+  }
+  return _mm_add_ps(wrapped, precision_correction);
+}
+
+static __m128 perlin_signed_x4(const __m128 x, const __m128 y, const __m128 z)
+{
+  return _mm_mul_ps(perlin_noise_x4(perlin_wrap_x4(x), perlin_wrap_x4(y), perlin_wrap_x4(z)),
+                    _mm_set1_ps(0.9820f));
+}
+
+static __m128 perlin_fbm_x4(const __m128 x,
+                            const __m128 y,
+                            const __m128 z,
+                            const float detail,
+                            const float roughness,
+                            const float lacunarity,
+                            const bool normalize)
+{
+  float fscale = 1.0f;
+  float amp = 1.0f;
+  float maxamp = 0.0f;
+  __m128 sum = _mm_setzero_ps();
+
+  auto octave = [&]() {
+    const __m128 scale = _mm_set1_ps(fscale);
+    return perlin_signed_x4(_mm_mul_ps(scale, x), _mm_mul_ps(scale, y), _mm_mul_ps(scale, z));
+  };
+  auto normalized = [](const __m128 sum, const float maxamp) {
+    return _mm_add_ps(_mm_div_ps(_mm_mul_ps(_mm_set1_ps(0.5f), sum), _mm_set1_ps(maxamp)),
+                      _mm_set1_ps(0.5f));
+  };
+
+  for (int i = 0; i <= int(detail); i++) {
+    sum = _mm_add_ps(sum, _mm_mul_ps(octave(), _mm_set1_ps(amp)));
+    maxamp += amp;
+    amp *= roughness;
+    fscale *= lacunarity;
+  }
+  float rmd = detail - std::floor(detail);
+  if (rmd != 0.0f) {
+    const __m128 sum2 = _mm_add_ps(sum, _mm_mul_ps(octave(), _mm_set1_ps(amp)));
+    const __m128 factor = _mm_set1_ps(rmd);
+    const __m128 factor1 = _mm_set1_ps(1 - rmd);
+    return normalize ? mix_x4(normalized(sum, maxamp),
+                              normalized(sum2, maxamp + amp),
+                              factor,
+                              factor1) :
+                       mix_x4(sum, sum2, factor, factor1);
+  }
+  return normalize ? normalized(sum, maxamp) : sum;
+}
+
+/** Same as #perlin_distortion for #float3. */
+BLI_INLINE void perlin_distort_x4(__m128 &x, __m128 &y, __m128 &z, const float strength)
+{
+  __m128 distortion[3];
+  for (const int i : IndexRange(3)) {
+    const float3 offset = random_float3_offset(float(i));
+    distortion[i] = _mm_mul_ps(perlin_signed_x4(_mm_add_ps(x, _mm_set1_ps(offset.x)),
+                                                _mm_add_ps(y, _mm_set1_ps(offset.y)),
+                                                _mm_add_ps(z, _mm_set1_ps(offset.z))),
+                               _mm_set1_ps(strength));
+  }
+  x = _mm_add_ps(x, distortion[0]);
+  y = _mm_add_ps(y, distortion[1]);
+  z = _mm_add_ps(z, distortion[2]);
+}
+
+/**
+ * Call \a fn with the coordinates of four positions at a time as SIMD registers, and the index of
+ * the first position. Returns the number of positions that were processed.
+ */
+template<typename Fn>
+static int64_t foreach_position_x4(const Span<float3> positions, const Fn &fn)
+{
+  const int64_t size_x4 = positions.size() & ~int64_t(3);
+  for (int64_t i = 0; i < size_x4; i += 4) {
+    const float3 *p = &positions[i];
+    fn(i,
+       _mm_setr_ps(p[0].x, p[1].x, p[2].x, p[3].x),
+       _mm_setr_ps(p[0].y, p[1].y, p[2].y, p[3].y),
+       _mm_setr_ps(p[0].z, p[1].z, p[2].z, p[3].z));
+  }
+  return size_x4;
+}
+
+#endif /* BLI_HAVE_SSE4 */
+
+void perlin_signed(const Span<float3> positions, MutableSpan<float> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  int64_t start = 0;
+#if BLI_HAVE_SSE4
+  start = foreach_position_x4(positions, [&](const int64_t i, __m128 x, __m128 y, __m128 z) {
+    _mm_storeu_ps(&r_values[i], perlin_signed_x4(x, y, z));
+  });
+#endif
+  for (const int64_t i : positions.index_range().drop_front(start)) {
+    r_values[i] = perlin_signed(positions[i]);
+  }
+}
+
+void perlin_fractal_distorted(const Span<float3> positions,
+                              const float detail,
+                              const float roughness,
+                              const float lacunarity,
+                              const float offset,
+                              const float gain,
+                              const float distortion,
+                              const int type,
+                              const bool normalize,
+                              MutableSpan<float> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  int64_t start = 0;
+#if BLI_HAVE_SSE4
+  if (type == NOISE_SHD_PERLIN_FBM) {
+    start = foreach_position_x4(positions, [&](const int64_t i, __m128 x, __m128 y, __m128 z) {
+      perlin_distort_x4(x, y, z, distortion);
+      _mm_storeu_ps(&r_values[i],
+                    perlin_fbm_x4(x, y, z, detail, roughness, lacunarity, normalize));
+    });
+  }
+#endif
+  for (const int64_t i : positions.index_range().drop_front(start)) {
+    r_values[i] = perlin_fractal_distorted(
+        positions[i], detail, roughness, lacunarity, offset, gain, distortion, type, normalize);
+  }
+}
+
+void perlin_float3_fractal_distorted(const Span<float3> positions,
+                                     const float detail,
+                                     const float roughness,
+                                     const float lacunarity,
+                                     const float offset,
+                                     const float gain,
+                                     const float distortion,
+                                     const int type,
+                                     const bool normalize,
+                                     MutableSpan<float3> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  int64_t start = 0;
+#if BLI_HAVE_SSE4
+  if (type == NOISE_SHD_PERLIN_FBM) {
+    const float3 offset_g = random_float3_offset(3.0f);
+    const float3 offset_b = random_float3_offset(4.0f);
+    start = foreach_position_x4(positions, [&](const int64_t i, __m128 x, __m128 y, __m128 z) {
+      perlin_distort_x4(x, y, z, distortion);
+      alignas(16) float channels[3][4];
+      _mm_store_ps(channels[0], perlin_fbm_x4(x, y, z, detail, roughness, lacunarity, normalize));
+      for (const int channel : IndexRange(1, 2)) {
+        const float3 offset = channel == 1 ? offset_g : offset_b;
+        _mm_store_ps(channels[channel],
+                     perlin_fbm_x4(_mm_add_ps(x, _mm_set1_ps(offset.x)),
+                                   _mm_add_ps(y, _mm_set1_ps(offset.y)),
+                                   _mm_add_ps(z, _mm_set1_ps(offset.z)),
+                                   detail,
+                                   roughness,
+                                   lacunarity,
+                                   normalize));
+      }
+      for (const int j : IndexRange(4)) {
+        r_values[i + j] = float3(channels[0][j], channels[1][j], channels[2][j]);
+      }
+    });
+  }
+#endif
+  for (const int64_t i : positions.index_range().drop_front(start)) {
+    r_values[i] = perlin_float3_fractal_distorted(
+        positions[i], detail, roughness, lacunarity, offset, gain, distortion, type, normalize);
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Voronoi Noise
  *
@@ -2069,6 +2436,247 @@ template float fractal_voronoi_distance_to_edge<float4>(const VoronoiParams &par
                                                         const float4 coord);
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Voronoi Noise
+ *
+ * Evaluates 3D Voronoi F1 noise at four positions at once. The search over the 27 surrounding
+ * cells has a fixed size, so every position runs the same instructions and only the closest point
+ * is selected per position. Every operation is the same as in #voronoi_f1, so the results are
+ * bit-exact. The Minkowski metric uses #std::pow, which has no SIMD version, so it is evaluated
+ * one position at a time.
+ * \{ */
+
+#if BLI_HAVE_SSE4
+
+/**
+ * Same as #uint_to_float_01. There is no unsigned integer conversion, so the upper and lower half
+ * are converted separately. Both conversions and the multiplication are exact, so the result is
+ * only rounded once by the addition.
+ */
+BLI_INLINE __m128 uint_to_float_01_x4(const __m128i k)
+{
+  const __m128 high = _mm_cvtepi32_ps(_mm_srli_epi32(k, 16));
+  const __m128 low = _mm_cvtepi32_ps(_mm_and_si128(k, _mm_set1_epi32(0xFFFF)));
+  return _mm_div_ps(_mm_add_ps(_mm_mul_ps(high, _mm_set1_ps(65536.0f)), low),
+                    _mm_set1_ps(float(0xFFFFFFFFu)));
+}
+
+/** Same as #hash_float_to_float3 for #float3. */
+BLI_INLINE void hash_float_to_float3_x4(const __m128 x,
+                                        const __m128 y,
+                                        const __m128 z,
+                                        __m128 &r_x,
+                                        __m128 &r_y,
+                                        __m128 &r_z)
+{
+  const __m128i kx = _mm_castps_si128(x);
+  const __m128i ky = _mm_castps_si128(y);
+  const __m128i kz = _mm_castps_si128(z);
+  r_x = uint_to_float_01_x4(hash_x4(kx, ky, kz));
+  r_y = uint_to_float_01_x4(hash_x4(kx, ky, kz, _mm_castps_si128(_mm_set1_ps(1.0f))));
+  r_z = uint_to_float_01_x4(hash_x4(kx, ky, kz, _mm_castps_si128(_mm_set1_ps(2.0f))));
+}
+
+BLI_INLINE __m128 abs_x4(const __m128 value)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+}
+
+/** Same as #voronoi_distance for #float3, except for the Minkowski metric. */
+BLI_INLINE __m128 voronoi_distance_x4(const __m128 dx,
+                                      const __m128 dy,
+                                      const __m128 dz,
+                                      const int metric)
+{
+  switch (metric) {
+    case NOISE_SHD_VORONOI_EUCLIDEAN:
+      return _mm_sqrt_ps(
+          _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+    case NOISE_SHD_VORONOI_MANHATTAN:
+      return _mm_add_ps(_mm_add_ps(abs_x4(dx), abs_x4(dy)), abs_x4(dz));
+    case NOISE_SHD_VORONOI_CHEBYCHEV:
+      return _mm_max_ps(_mm_max_ps(abs_x4(dx), abs_x4(dy)), abs_x4(dz));
+    default:
+      BLI_assert_unreachable();
+      break;
+  }
+  return _mm_setzero_ps();
+}
+
+static void voronoi_f1_x4(const VoronoiParams &params,
+                          const __m128 x,
+                          const __m128 y,
+                          const __m128 z,
+                          MutableSpan<VoronoiOutput> r_outputs)
+{
+  const __m128 cell_x = _mm_floor_ps(x);
+  const __m128 cell_y = _mm_floor_ps(y);
+  const __m128 cell_z = _mm_floor_ps(z);
+  const __m128 local_x = _mm_sub_ps(x, cell_x);
+  const __m128 local_y = _mm_sub_ps(y, cell_y);
+  const __m128 local_z = _mm_sub_ps(z, cell_z);
+  const __m128 randomness = _mm_set1_ps(params.randomness);
+
+  __m128 min_distance = _mm_set1_ps(FLT_MAX);
+  __m128 target_offset_x = _mm_setzero_ps();
+  __m128 target_offset_y = _mm_setzero_ps();
+  __m128 target_offset_z = _mm_setzero_ps();
+  __m128 target_x = _mm_setzero_ps();
+  __m128 target_y = _mm_setzero_ps();
+  __m128 target_z = _mm_setzero_ps();
+  for (int k = -1; k <= 1; k++) {
+    for (int j = -1; j <= 1; j++) {
+      for (int i = -1; i <= 1; i++) {
+        const __m128 offset_x = _mm_set1_ps(float(i));
+        const __m128 offset_y = _mm_set1_ps(float(j));
+        const __m128 offset_z = _mm_set1_ps(float(k));
+        __m128 hash_x, hash_y, hash_z;
+        hash_float_to_float3_x4(_mm_add_ps(cell_x, offset_x),
+                                _mm_add_ps(cell_y, offset_y),
+                                _mm_add_ps(cell_z, offset_z),
+                                hash_x,
+                                hash_y,
+                                hash_z);
+        const __m128 point_x = _mm_add_ps(offset_x, _mm_mul_ps(hash_x, randomness));
+        const __m128 point_y = _mm_add_ps(offset_y, _mm_mul_ps(hash_y, randomness));
+        const __m128 point_z = _mm_add_ps(offset_z, _mm_mul_ps(hash_z, randomness));
+        const __m128 distance = voronoi_distance_x4(_mm_sub_ps(point_x, local_x),
+                                                    _mm_sub_ps(point_y, local_y),
+                                                    _mm_sub_ps(point_z, local_z),
+                                                    params.metric);
+        const __m128 closer = _mm_cmplt_ps(distance, min_distance);
+        min_distance = _mm_blendv_ps(min_distance, distance, closer);
+        target_offset_x = _mm_blendv_ps(target_offset_x, offset_x, closer);
+        target_offset_y = _mm_blendv_ps(target_offset_y, offset_y, closer);
+        target_offset_z = _mm_blendv_ps(target_offset_z, offset_z, closer);
+        target_x = _mm_blendv_ps(target_x, point_x, closer);
+        target_y = _mm_blendv_ps(target_y, point_y, closer);
+        target_z = _mm_blendv_ps(target_z, point_z, closer);
+      }
+    }
+  }
+
+  __m128 color_x, color_y, color_z;
+  hash_float_to_float3_x4(_mm_add_ps(cell_x, target_offset_x),
+                          _mm_add_ps(cell_y, target_offset_y),
+                          _mm_add_ps(cell_z, target_offset_z),
+                          color_x,
+                          color_y,
+                          color_z);
+
+  alignas(16) float values[7][4];
+  _mm_store_ps(values[0], min_distance);
+  _mm_store_ps(values[1], color_x);
+  _mm_store_ps(values[2], color_y);
+  _mm_store_ps(values[3], color_z);
+  _mm_store_ps(values[4], _mm_add_ps(target_x, cell_x));
+  _mm_store_ps(values[5], _mm_add_ps(target_y, cell_y));
+  _mm_store_ps(values[6], _mm_add_ps(target_z, cell_z));
+  for (const int i : IndexRange(4)) {
+    VoronoiOutput &output = r_outputs[i];
+    output.distance = values[0][i];
+    output.color = float3(values[1][i], values[2][i], values[3][i]);
+    output.position = voronoi_position(float3(values[4][i], values[5][i], values[6][i]));
+  }
+}
+
+#endif /* BLI_HAVE_SSE4 */
+
+void voronoi_f1(const VoronoiParams &params,
+                const Span<float3> coords,
+                MutableSpan<VoronoiOutput> r_outputs)
+{
+  BLI_assert(coords.size() == r_outputs.size());
+  int64_t start = 0;
+#if BLI_HAVE_SSE4
+  if (params.metric != NOISE_SHD_VORONOI_MINKOWSKI) {
+    start = foreach_position_x4(coords, [&](const int64_t i, __m128 x, __m128 y, __m128 z) {
+      voronoi_f1_x4(params, x, y, z, r_outputs.slice(i, 4));
+    });
+  }
+#endif
+  for (const int64_t i : coords.index_range().drop_front(start)) {
+    r_outputs[i] = voronoi_f1(params, coords[i]);
+  }
+}
+
+void fractal_voronoi_x_fx(const VoronoiParams &params,
+                          const Span<float3> coords,
+                          MutableSpan<VoronoiOutput> r_outputs)
+{
+  BLI_assert(coords.size() == r_outputs.size());
+  if (params.feature == NOISE_SHD_VORONOI_F2 ||
+      (params.feature == NOISE_SHD_VORONOI_SMOOTH_F1 && params.smoothness != 0.0f))
+  {
+    for (const int64_t i : coords.index_range()) {
+      r_outputs[i] = fractal_voronoi_x_fx<float3>(params, coords[i], true);
+    }
+    return;
+  }
+
+  /* Same as the single position version, with every octave evaluated for all positions. */
+  float amplitude = 1.0f;
+  float max_amplitude = 0.0f;
+  float scale = 1.0f;
+
+  r_outputs.fill(VoronoiOutput());
+  const bool zero_input = params.detail == 0.0f || params.roughness == 0.0f;
+
+  Array<float3> octave_coords(coords.size());
+  Array<VoronoiOutput> octaves(coords.size());
+  for (int i = 0; i <= ceilf(params.detail); ++i) {
+    for (const int64_t j : coords.index_range()) {
+      octave_coords[j] = coords[j] * scale;
+    }
+    voronoi_f1(params, octave_coords, octaves);
+
+    if (zero_input) {
+      max_amplitude = 1.0f;
+      r_outputs.copy_from(octaves);
+      break;
+    }
+    if (i <= params.detail) {
+      max_amplitude += amplitude;
+      for (const int64_t j : coords.index_range()) {
+        VoronoiOutput &output = r_outputs[j];
+        const VoronoiOutput &octave = octaves[j];
+        output.distance += octave.distance * amplitude;
+        output.color += octave.color * amplitude;
+        output.position = mix(output.position, octave.position / scale, amplitude);
+      }
+      scale *= params.lacunarity;
+      amplitude *= params.roughness;
+    }
+    else {
+      float remainder = params.detail - floorf(params.detail);
+      if (remainder != 0.0f) {
+        max_amplitude = mix(max_amplitude, max_amplitude + amplitude, remainder);
+        for (const int64_t j : coords.index_range()) {
+          VoronoiOutput &output = r_outputs[j];
+          const VoronoiOutput &octave = octaves[j];
+          output.distance = mix(
+              output.distance, output.distance + octave.distance * amplitude, remainder);
+          output.color = mix(output.color, output.color + octave.color * amplitude, remainder);
+          output.position = mix(output.position,
+                                mix(output.position, octave.position / scale, amplitude),
+                                remainder);
+        }
+      }
+    }
+  }
+
+  for (VoronoiOutput &output : r_outputs) {
+    if (params.normalize) {
+      output.distance /= max_amplitude * params.max_distance;
+      output.color /= max_amplitude;
+    }
+    output.position = (params.scale != 0.0f) ? output.position / params.scale :
+                                               float4{0.0f, 0.0f, 0.0f, 0.0f};
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Gabor Noise
  *
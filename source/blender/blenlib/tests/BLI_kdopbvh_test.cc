@@ -8,6 +8,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_compiler_attrs.h"
 #include "BLI_kdopbvh.hh"
 #include "BLI_math_vector.h"
@@ -134,3 +135,151 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+/**
+ * Compare queries on trees with and without #BVH_TREE_WIDE_NODES, using boxes around random
+ * points so that the closest hit is the same regardless of the traversal order.
+ */
+static void wide_nodes_test(int points_len, char tree_type, float radius, int random_seed)
+{
+  RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.01f, tree_type, 6);
+  BVHTree *tree_wide = BLI_bvhtree_new_ex(points_len, 0.01f, tree_type, 6, BVH_TREE_WIDE_NODES);
+
+  for (int i = 0; i < points_len; i++) {
+    float co[3];
+    rng_v3_round(co, 3, rng, 1 << 20, 1.0f);
+    BLI_bvhtree_insert(tree, i, co, 1);
+    BLI_bvhtree_insert(tree_wide, i, co, 1);
+  }
+  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance(tree_wide);
+
+  int hits_num = 0;
+  for (int i = 0; i < 100; i++) {
+    float co[3], dir[3];
+    rng_v3_round(co, 3, rng, 1 << 20, 2.0f);
+    negate_v3_v3(dir, co);
+    normalize_v3(dir);
+
+    BVHTreeRayHit hit = {-1, {0}, {0}, BVH_RAYCAST_DIST_MAX};
+    BVHTreeRayHit hit_wide = hit;
+    BLI_bvhtree_ray_cast(tree, co, dir, radius, &hit, nullptr, nullptr);
+    BLI_bvhtree_ray_cast(tree_wide, co, dir, radius, &hit_wide, nullptr, nullptr);
+    EXPECT_EQ(hit.index, hit_wide.index);
+    EXPECT_FLOAT_EQ(hit.dist, hit_wide.dist);
+    hits_num += (hit.index != -1);
+
+    BVHTreeNearest nearest = {-1, {0}, {0}, FLT_MAX, 0};
+    BVHTreeNearest nearest_wide = nearest;
+    BLI_bvhtree_find_nearest(tree, co, &nearest, nullptr, nullptr);
+    BLI_bvhtree_find_nearest(tree_wide, co, &nearest_wide, nullptr, nullptr);
+    EXPECT_FLOAT_EQ(nearest.dist_sq, nearest_wide.dist_sq);
+  }
+  if (points_len > 1) {
+    EXPECT_GT(hits_num, 0);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_bvhtree_free(tree_wide);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, WideNodes_1)
+{
+  wide_nodes_test(1, 2, 0.0f, 1234);
+}
+TEST(kdopbvh, WideNodesBinary_1000)
+{
+  wide_nodes_test(1000, 2, 0.0f, 123);
+}
+TEST(kdopbvh, WideNodesQuad_1000)
+{
+  wide_nodes_test(1000, 4, 0.0f, 12);
+}
+TEST(kdopbvh, WideNodesRadius_1000)
+{
+  wide_nodes_test(1000, 2, 0.05f, 1);
+}
+
+static void ray_cast_packet_test(int points_len, int rays_len, float radius, int random_seed)
+{
+  RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.01f, 2, 6);
+  for (int i = 0; i < points_len; i++) {
+    float co[3];
+    rng_v3_round(co, 3, rng, 1 << 20, 1.0f);
+    BLI_bvhtree_insert(tree, i, co, 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  blender::Array<blender::float3> origins(rays_len);
+  blender::Array<blender::float3> directions(rays_len);
+  blender::Array<BVHTreeRayHit> hits(rays_len);
+  for (int i = 0; i < rays_len; i++) {
+    rng_v3_round(origins[i], 3, rng, 1 << 20, 2.0f);
+    negate_v3_v3(directions[i], origins[i]);
+    normalize_v3(directions[i]);
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+  BLI_bvhtree_ray_cast_packet(
+      tree, origins, directions, radius, hits, nullptr, nullptr, BVH_RAYCAST_DEFAULT);
+
+  int hits_num = 0;
+  for (int i = 0; i < rays_len; i++) {
+    BVHTreeRayHit hit = {-1, {0}, {0}, BVH_RAYCAST_DIST_MAX};
+    BLI_bvhtree_ray_cast(tree, origins[i], directions[i], radius, &hit, nullptr, nullptr);
+    EXPECT_EQ(hit.index, hits[i].index);
+    EXPECT_FLOAT_EQ(hit.dist, hits[i].dist);
+    hits_num += (hit.index != -1);
+  }
+  EXPECT_GT(hits_num, 0);
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, RayCastPacket)
+{
+  ray_cast_packet_test(1000, 1000, 0.0f, 12);
+}
+TEST(kdopbvh, RayCastPacketRadius)
+{
+  ray_cast_packet_test(1000, 37, 0.05f, 123);
+}
+
+TEST(kdopbvh, CostEstimateRefit)
+{
+  const int grid_size = 32;
+  BVHTree *tree = BLI_bvhtree_new(grid_size * grid_size, 0.0, 2, 6);
+  for (int i = 0; i < grid_size * grid_size; i++) {
+    const float co[3] = {float(i % grid_size), float(i / grid_size), 0.0f};
+    BLI_bvhtree_insert(tree, i, co, 1);
+  }
+  BLI_bvhtree_balance(tree);
+  const float build_cost = BLI_bvhtree_get_cost_estimate(tree);
+  EXPECT_GT(build_cost, 1.0f);
+
+  /* Moving all points by the same amount doesn't change the quality of the tree. */
+  for (int i = 0; i < grid_size * grid_size; i++) {
+    const float co[3] = {float(i % grid_size) + 10.0f, float(i / grid_size), 5.0f};
+    BLI_bvhtree_update_node(tree, i, co, nullptr, 1);
+  }
+  BLI_bvhtree_update_tree(tree);
+  EXPECT_NEAR(BLI_bvhtree_get_cost_estimate(tree), build_cost, build_cost * 1e-4f);
+
+  /* Scrambling the points makes every node cover most of the root. */
+  RNG *rng = BLI_rng_new(0);
+  for (int i = 0; i < grid_size * grid_size; i++) {
+    const float co[3] = {BLI_rng_get_float(rng) * float(grid_size),
+                         BLI_rng_get_float(rng) * float(grid_size),
+                         0.0f};
+    BLI_bvhtree_update_node(tree, i, co, nullptr, 1);
+  }
+  BLI_bvhtree_update_tree(tree);
+  EXPECT_GT(BLI_bvhtree_get_cost_estimate(tree), build_cost * 10.0f);
+
+  BLI_rng_free(rng);
+  BLI_bvhtree_free(tree);
+}
@@ -4,7 +4,12 @@
 
 #include "testing/testing.h"
 
+#include "MEM_guardedalloc.h"
+
 #include "BLI_kdtree.h"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
 
 #include <cmath>
 
@@ -63,3 +68,124 @@ TEST(kdtree, Deduplicate)
 {
   deduplicate_test();
 }
+
+namespace blender::tests {
+
+static KDTree_3d *random_tree(const Span<float3> positions)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(uint(positions.size()));
+  for (const int i : positions.index_range()) {
+    BLI_kdtree_3d_insert(tree, i, positions[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  return tree;
+}
+
+static Vector<float3> random_positions(const int size, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Vector<float3> positions(size);
+  for (float3 &position : positions) {
+    position = float3(rng.get_float(), rng.get_float(), rng.get_float());
+  }
+  return positions;
+}
+
+TEST(kdtree, BalanceLarge)
+{
+  /* Large enough to be balanced on multiple threads. */
+  const Vector<float3> positions = random_positions(100000, 0);
+  const Vector<float3> queries = random_positions(100, 1);
+  KDTree_3d *tree = random_tree(positions);
+  for (const float3 &query : queries) {
+    int expected_index = -1;
+    float expected_dist_sq = FLT_MAX;
+    for (const int i : positions.index_range()) {
+      const float dist_sq = math::distance_squared(query, positions[i]);
+      if (dist_sq < expected_dist_sq) {
+        expected_dist_sq = dist_sq;
+        expected_index = i;
+      }
+    }
+    EXPECT_EQ(BLI_kdtree_3d_find_nearest(tree, query, nullptr), expected_index);
+  }
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, FindNearestBatch)
+{
+  const Vector<float3> positions = random_positions(10000, 0);
+  const Vector<float3> queries = random_positions(1000, 1);
+  KDTree_3d *tree = random_tree(positions);
+
+  Array<KDTreeNearest_3d> nearest(queries.size());
+  BLI_kdtree_3d_find_nearest_batch(tree, queries, nearest);
+  for (const int i : queries.index_range()) {
+    KDTreeNearest_3d expected;
+    EXPECT_EQ(BLI_kdtree_3d_find_nearest(tree, queries[i], &expected), nearest[i].index);
+    EXPECT_EQ(expected.dist, nearest[i].dist);
+  }
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, FindNearestBatchEmpty)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(0);
+  BLI_kdtree_3d_balance(tree);
+  const Vector<float3> queries = random_positions(10, 1);
+  Array<KDTreeNearest_3d> nearest(queries.size());
+  BLI_kdtree_3d_find_nearest_batch(tree, queries, nearest);
+  for (const KDTreeNearest_3d &result : nearest) {
+    EXPECT_EQ(result.index, -1);
+  }
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, FindNearestNBatch)
+{
+  const Vector<float3> positions = random_positions(10000, 0);
+  const Vector<float3> queries = random_positions(1000, 1);
+  KDTree_3d *tree = random_tree(positions);
+
+  const uint nearest_len_capacity = 8;
+  Array<KDTreeNearest_3d> nearest(queries.size() * nearest_len_capacity);
+  Array<int> nearest_len(queries.size());
+  BLI_kdtree_3d_find_nearest_n_batch(tree, queries, nearest_len_capacity, nearest, nearest_len);
+  for (const int i : queries.index_range()) {
+    KDTreeNearest_3d expected[nearest_len_capacity];
+    const int expected_len = BLI_kdtree_3d_find_nearest_n(
+        tree, queries[i], expected, nearest_len_capacity);
+    EXPECT_EQ(expected_len, nearest_len[i]);
+    for (const int j : IndexRange(expected_len)) {
+      EXPECT_EQ(expected[j].index, nearest[i * nearest_len_capacity + j].index);
+    }
+  }
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, RangeSearchBatch)
+{
+  const Vector<float3> positions = random_positions(10000, 0);
+  const Vector<float3> queries = random_positions(1000, 1);
+  KDTree_3d *tree = random_tree(positions);
+
+  const float range = 0.05f;
+  Array<int> offsets(queries.size() + 1);
+  const Array<KDTreeNearest_3d> nearest = BLI_kdtree_3d_range_search_batch(
+      tree, queries, range, offsets);
+  EXPECT_EQ(offsets.last(), nearest.size());
+  for (const int i : queries.index_range()) {
+    KDTreeNearest_3d *expected = nullptr;
+    const int expected_len = BLI_kdtree_3d_range_search(tree, queries[i], &expected, range);
+    EXPECT_EQ(expected_len, offsets[i + 1] - offsets[i]);
+    for (const int j : IndexRange(expected_len)) {
+      EXPECT_EQ(expected[j].index, nearest[offsets[i] + j].index);
+    }
+    if (expected) {
+      MEM_freeN(expected);
+    }
+  }
+  BLI_kdtree_3d_free(tree);
+}
+
+}  // namespace blender::tests
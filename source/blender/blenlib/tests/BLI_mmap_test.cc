@@ -0,0 +1,104 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_mmap.h"
+
+#ifndef WIN32
+
+#  include <cstdio>
+#  include <unistd.h>
+
+#  include "BLI_vector.hh"
+
+namespace blender::tests {
+
+/* Creates a temporary file with the given number of pages. Every byte of a page contains the page
+ * index plus one. */
+static FILE *create_test_file(const int pages_num)
+{
+  FILE *file = std::tmpfile();
+  EXPECT_NE(file, nullptr);
+  const size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+  for (const int page : IndexRange(pages_num)) {
+    const Vector<char> data(int64_t(page_size), char(page + 1));
+    EXPECT_EQ(fwrite(data.data(), 1, page_size, file), page_size);
+  }
+  fflush(file);
+  return file;
+}
+
+TEST(mmap, Read)
+{
+  FILE *file = create_test_file(2);
+  const size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+
+  BLI_mmap_file *mmap_file = BLI_mmap_open(fileno(file));
+  ASSERT_NE(mmap_file, nullptr);
+  EXPECT_EQ(BLI_mmap_get_length(mmap_file), 2 * page_size);
+
+  char value = 0;
+  EXPECT_TRUE(BLI_mmap_read(mmap_file, &value, page_size + 1, 1));
+  EXPECT_EQ(value, 2);
+  EXPECT_FALSE(BLI_mmap_read(mmap_file, &value, 2 * page_size, 1));
+  EXPECT_FALSE(BLI_mmap_has_io_error(mmap_file));
+
+  BLI_mmap_free(mmap_file);
+  fclose(file);
+}
+
+TEST(mmap, ReadTruncatedFile)
+{
+  FILE *file = create_test_file(2);
+  const size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+
+  BLI_mmap_file *mmap_file = BLI_mmap_open(fileno(file));
+  ASSERT_NE(mmap_file, nullptr);
+  EXPECT_EQ(ftruncate(fileno(file), 0), 0);
+
+  char value = 0;
+  EXPECT_FALSE(BLI_mmap_read(mmap_file, &value, page_size, 1));
+  EXPECT_TRUE(BLI_mmap_has_io_error(mmap_file));
+  /* Reading fails after an error, also for pages that have not failed themselves. */
+  EXPECT_FALSE(BLI_mmap_read(mmap_file, &value, 0, 1));
+
+  BLI_mmap_free(mmap_file);
+  fclose(file);
+}
+
+TEST(mmap, WritableTruncatedFile)
+{
+  FILE *file = create_test_file(3);
+  const size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+
+  BLI_mmap_file *mmap_file = BLI_mmap_open_private_writable(fileno(file));
+  ASSERT_NE(mmap_file, nullptr);
+  /* Volatile, so that every access actually reads the mapped memory. */
+  volatile char *memory = static_cast<char *>(BLI_mmap_get_pointer(mmap_file));
+
+  memory[0] = 10;
+  EXPECT_EQ(memory[0], 10);
+  EXPECT_EQ(memory[2 * page_size], 3);
+  EXPECT_FALSE(BLI_mmap_has_io_error(mmap_file));
+
+  EXPECT_EQ(ftruncate(fileno(file), 0), 0);
+
+  /* Pages that can't be read anymore are replaced with zeros instead of crashing. */
+  EXPECT_EQ(memory[page_size], 0);
+  EXPECT_EQ(memory[page_size + 1], 0);
+  EXPECT_TRUE(BLI_mmap_has_io_error(mmap_file));
+  EXPECT_EQ(memory[2 * page_size], 0);
+
+  /* The replaced pages are still writable. */
+  memory[page_size] = 20;
+  EXPECT_EQ(memory[page_size], 20);
+
+  BLI_mmap_free(mmap_file);
+  fclose(file);
+}
+
+}  // namespace blender::tests
+
+#endif
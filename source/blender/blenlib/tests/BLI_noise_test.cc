@@ -0,0 +1,97 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_noise.hh"
+#include "BLI_rand.hh"
+
+namespace blender::noise::tests {
+
+static Array<float3> random_positions(const int size)
+{
+  RandomNumberGenerator rng(42);
+  Array<float3> positions(size);
+  for (const int i : positions.index_range()) {
+    /* Include positions that are wrapped to avoid precision issues. */
+    const float range = (i % 5 == 0) ? 3000000.0f : 20.0f;
+    positions[i] = float3(rng.get_float(), rng.get_float(), rng.get_float()) * 2.0f * range -
+                   range;
+  }
+  return positions;
+}
+
+TEST(noise, PerlinSignedBatched)
+{
+  const Array<float3> positions = random_positions(1003);
+  Array<float> values(positions.size());
+  perlin_signed(positions, values);
+  for (const int i : positions.index_range()) {
+    EXPECT_EQ(values[i], perlin_signed(positions[i]));
+  }
+}
+
+TEST(noise, PerlinFractalDistortedBatched)
+{
+  const Array<float3> positions = random_positions(1003);
+  Array<float> values(positions.size());
+  Array<float3> colors(positions.size());
+  for (const int type : IndexRange(5)) {
+    for (const float detail : {0.0f, 2.0f, 4.5f}) {
+      for (const bool normalize : {false, true}) {
+        const float distortion = detail * 0.5f;
+        perlin_fractal_distorted(
+            positions, detail, 0.6f, 2.1f, 0.5f, 1.1f, distortion, type, normalize, values);
+        perlin_float3_fractal_distorted(
+            positions, detail, 0.6f, 2.1f, 0.5f, 1.1f, distortion, type, normalize, colors);
+        for (const int i : positions.index_range()) {
+          const float3 position = positions[i];
+          EXPECT_EQ(values[i],
+                    perlin_fractal_distorted(
+                        position, detail, 0.6f, 2.1f, 0.5f, 1.1f, distortion, type, normalize));
+          EXPECT_EQ(colors[i],
+                    perlin_float3_fractal_distorted(
+                        position, detail, 0.6f, 2.1f, 0.5f, 1.1f, distortion, type, normalize));
+        }
+      }
+    }
+  }
+}
+
+TEST(noise, FractalVoronoiBatched)
+{
+  const Array<float3> positions = random_positions(1003);
+  Array<VoronoiOutput> outputs(positions.size());
+  VoronoiParams params{};
+  params.scale = 1.5f;
+  params.roughness = 0.6f;
+  params.lacunarity = 2.1f;
+  params.exponent = 1.5f;
+  params.randomness = 0.8f;
+  params.max_distance = 1.2f;
+  /* Only F1 is vectorized, F2 checks the fallback. */
+  for (const int feature : {0, 1}) {
+    for (const int metric : IndexRange(4)) {
+      for (const float detail : {0.0f, 2.0f, 3.5f}) {
+        for (const bool normalize : {false, true}) {
+          params.feature = feature;
+          params.metric = metric;
+          params.detail = detail;
+          params.normalize = normalize;
+          fractal_voronoi_x_fx(params, positions, outputs);
+          for (const int i : positions.index_range()) {
+            const VoronoiOutput expected = fractal_voronoi_x_fx<float3>(
+                params, positions[i], true);
+            EXPECT_EQ(outputs[i].distance, expected.distance);
+            EXPECT_EQ(outputs[i].color, expected.color);
+            EXPECT_EQ(outputs[i].position, expected.position);
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace blender::noise::tests
@@ -0,0 +1,132 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_kdopbvh.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+#include "BLI_timeit.hh"
+
+namespace blender::tests {
+
+static Array<float3> random_positions(const int size, const float scale, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> positions(size);
+  for (float3 &position : positions) {
+    position = (float3(rng.get_float(), rng.get_float(), rng.get_float()) * 2.0f - 1.0f) * scale;
+  }
+  return positions;
+}
+
+static void kdopbvh_benchmark(const char *name,
+                              const Span<float3> positions,
+                              const Span<float3> queries,
+                              const char tree_type,
+                              const int flag)
+{
+  std::cout << name << "\n";
+  BVHTree *tree = BLI_bvhtree_new_ex(int(positions.size()), 0.001f, tree_type, 6, flag);
+  for (const int i : positions.index_range()) {
+    BLI_bvhtree_insert(tree, i, positions[i], 1);
+  }
+  {
+    SCOPED_TIMER("  balance");
+    BLI_bvhtree_balance(tree);
+  }
+
+  int hits_num = 0;
+  {
+    SCOPED_TIMER("  ray cast");
+    for (const float3 &query : queries) {
+      const float3 dir = math::normalize(-query);
+      BVHTreeRayHit hit;
+      hit.index = -1;
+      hit.dist = BVH_RAYCAST_DIST_MAX;
+      BLI_bvhtree_ray_cast(tree, query, dir, 0.0f, &hit, nullptr, nullptr);
+      hits_num += (hit.index != -1);
+    }
+  }
+  {
+    SCOPED_TIMER("  find nearest");
+    for (const float3 &query : queries) {
+      BVHTreeNearest nearest;
+      nearest.index = -1;
+      nearest.dist_sq = FLT_MAX;
+      BLI_bvhtree_find_nearest(tree, query, &nearest, nullptr, nullptr);
+    }
+  }
+  std::cout << "  hits: " << hits_num << "\n";
+  BLI_bvhtree_free(tree);
+}
+
+static void kdopbvh_benchmark_layouts(const int size)
+{
+  const Array<float3> positions = random_positions(size, 1.0f, 0);
+  const Array<float3> queries = random_positions(100000, 2.0f, 1);
+  kdopbvh_benchmark("Binary", positions, queries, 2, 0);
+  kdopbvh_benchmark("Binary wide nodes", positions, queries, 2, BVH_TREE_WIDE_NODES);
+  kdopbvh_benchmark("Quad", positions, queries, 4, 0);
+  kdopbvh_benchmark("Quad wide nodes", positions, queries, 4, BVH_TREE_WIDE_NODES);
+}
+
+/** Parallel rays on a grid, which are coherent. */
+static void kdopbvh_packet_benchmark(const int size, const int grid_size)
+{
+  const Array<float3> positions = random_positions(size, 1.0f, 0);
+  BVHTree *tree = BLI_bvhtree_new(size, 0.01f, 2, 6);
+  for (const int i : positions.index_range()) {
+    BLI_bvhtree_insert(tree, i, positions[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  Array<float3> origins(grid_size * grid_size);
+  Array<float3> directions(origins.size(), float3(0.0f, 0.0f, -1.0f));
+  for (const int y : IndexRange(grid_size)) {
+    for (const int x : IndexRange(grid_size)) {
+      origins[y * grid_size + x] = float3(float(x) / float(grid_size) * 2.0f - 1.0f,
+                                          float(y) / float(grid_size) * 2.0f - 1.0f,
+                                          2.0f);
+    }
+  }
+  Array<BVHTreeRayHit> hits(origins.size());
+  const auto reset_hits = [&]() {
+    for (BVHTreeRayHit &hit : hits) {
+      hit.index = -1;
+      hit.dist = BVH_RAYCAST_DIST_MAX;
+    }
+  };
+
+  std::cout << "Coherent rays\n";
+  reset_hits();
+  {
+    SCOPED_TIMER("  ray cast");
+    for (const int i : origins.index_range()) {
+      BLI_bvhtree_ray_cast(tree, origins[i], directions[i], 0.0f, &hits[i], nullptr, nullptr);
+    }
+  }
+  reset_hits();
+  {
+    SCOPED_TIMER("  ray cast packet");
+    BLI_bvhtree_ray_cast_packet(
+        tree, origins, directions, 0.0f, hits, nullptr, nullptr, BVH_RAYCAST_DEFAULT);
+  }
+  BLI_bvhtree_free(tree);
+}
+
+TEST(kdopbvh_performance, Small)
+{
+  kdopbvh_benchmark_layouts(10000);
+  kdopbvh_packet_benchmark(10000, 300);
+}
+
+TEST(kdopbvh_performance, Large)
+{
+  kdopbvh_benchmark_layouts(1000000);
+  kdopbvh_packet_benchmark(1000000, 1000);
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,101 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_kdtree.h"
+#include "BLI_math_base.h"
+#include "BLI_rand.hh"
+#include "BLI_timeit.hh"
+
+namespace blender::tests {
+
+static Array<float3> random_positions(const int size, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> positions(size);
+  for (float3 &position : positions) {
+    position = float3(rng.get_float(), rng.get_float(), rng.get_float());
+  }
+  return positions;
+}
+
+static void kdtree_benchmark(const int size)
+{
+  const Array<float3> positions = random_positions(size, 0);
+  const Array<float3> queries = random_positions(size, 1);
+  std::cout << "Points: " << size << "\n";
+
+  KDTree_3d *tree = BLI_kdtree_3d_new(uint(size));
+  for (const int i : positions.index_range()) {
+    BLI_kdtree_3d_insert(tree, i, positions[i]);
+  }
+  {
+    SCOPED_TIMER("  balance");
+    BLI_kdtree_3d_balance(tree);
+  }
+
+  Array<KDTreeNearest_3d> nearest(size);
+  {
+    SCOPED_TIMER("  find nearest");
+    for (const int i : queries.index_range()) {
+      BLI_kdtree_3d_find_nearest(tree, queries[i], &nearest[i]);
+    }
+  }
+  {
+    SCOPED_TIMER("  find nearest batch");
+    BLI_kdtree_3d_find_nearest_batch(tree, queries, nearest);
+  }
+
+  const uint nearest_len_capacity = 8;
+  Array<KDTreeNearest_3d> nearest_n(size * nearest_len_capacity);
+  Array<int> nearest_len(size);
+  {
+    SCOPED_TIMER("  find nearest n");
+    for (const int i : queries.index_range()) {
+      nearest_len[i] = BLI_kdtree_3d_find_nearest_n(
+          tree, queries[i], &nearest_n[i * nearest_len_capacity], nearest_len_capacity);
+    }
+  }
+  {
+    SCOPED_TIMER("  find nearest n batch");
+    BLI_kdtree_3d_find_nearest_n_batch(
+        tree, queries, nearest_len_capacity, nearest_n, nearest_len);
+  }
+
+  /* About 8 points in range on average. */
+  const float range = std::cbrt(8.0f / float(size) * 3.0f / (4.0f * float(M_PI)));
+  {
+    SCOPED_TIMER("  range search");
+    for (const int i : queries.index_range()) {
+      KDTreeNearest_3d *nearest_in_range = nullptr;
+      BLI_kdtree_3d_range_search(tree, queries[i], &nearest_in_range, range);
+      if (nearest_in_range) {
+        MEM_freeN(nearest_in_range);
+      }
+    }
+  }
+  {
+    SCOPED_TIMER("  range search batch");
+    Array<int> offsets(size + 1);
+    BLI_kdtree_3d_range_search_batch(tree, queries, range, offsets);
+  }
+
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree_performance, Small)
+{
+  kdtree_benchmark(10000);
+}
+
+TEST(kdtree_performance, Large)
+{
+  kdtree_benchmark(1000000);
+}
+
+}  // namespace blender::tests
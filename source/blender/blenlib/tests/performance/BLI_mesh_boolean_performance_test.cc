@@ -0,0 +1,206 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <iostream>
+#include <sstream>
+
+#include "BLI_array.hh"
+#include "BLI_math_base.h"
+#include "BLI_math_mpq.hh"
+#include "BLI_math_vector_mpq_types.hh"
+#include "BLI_mesh_boolean.hh"
+#include "BLI_mesh_intersect.hh"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
+
+#ifdef WITH_GMP
+namespace blender::meshintersect::tests {
+
+/**
+ * Build an #IMesh from a spec in the same format as `BLI_mesh_boolean_test.cc`:
+ * a line with the number of verts and faces, the vertex coordinates, then the face indices.
+ */
+static IMesh mesh_from_spec(const char *spec, IMeshArena &arena)
+{
+  std::istringstream ss(spec);
+  int verts_num, faces_num;
+  ss >> verts_num >> faces_num;
+  arena.reserve(verts_num, faces_num);
+  Array<const Vert *> verts(verts_num);
+  for (const int i : IndexRange(verts_num)) {
+    mpq_class x, y, z;
+    ss >> x >> y >> z;
+    verts[i] = arena.add_or_find_vert(mpq3(x, y, z), i);
+  }
+  std::string line;
+  getline(ss, line);
+  Vector<Face *> faces;
+  while (getline(ss, line) && faces.size() < faces_num) {
+    std::istringstream fss(line);
+    Vector<const Vert *> face_verts;
+    int v;
+    while (fss >> v) {
+      face_verts.append(verts[v]);
+    }
+    if (!face_verts.is_empty()) {
+      faces.append(arena.add_face(face_verts, int(faces.size())));
+    }
+  }
+  return IMesh(faces);
+}
+
+/** Append a closed UV sphere made of quads, with triangle fans at the poles. */
+static void append_sphere(const double3 &center,
+                          const double radius,
+                          const int rings,
+                          const int segments,
+                          IMeshArena &arena,
+                          Vector<Face *> &faces)
+{
+  Array<const Vert *> verts(segments * (rings - 1));
+  for (const int ring : IndexRange(rings - 1)) {
+    const double theta = M_PI * (ring + 1) / rings;
+    for (const int seg : IndexRange(segments)) {
+      const double phi = 2.0 * M_PI * seg / segments;
+      const double3 co(
+          std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+      verts[ring * segments + seg] = arena.add_or_find_vert(center + co * radius, 0);
+    }
+  }
+  const Vert *top = arena.add_or_find_vert(center + double3(0, 0, radius), 0);
+  const Vert *bottom = arena.add_or_find_vert(center - double3(0, 0, radius), 0);
+  auto vert = [&](const int ring, const int seg) {
+    return verts[ring * segments + seg % segments];
+  };
+  for (const int seg : IndexRange(segments)) {
+    faces.append(arena.add_face({top, vert(0, seg), vert(0, seg + 1)}, int(faces.size())));
+    faces.append(arena.add_face({bottom, vert(rings - 2, seg + 1), vert(rings - 2, seg)},
+                                int(faces.size())));
+    for (const int ring : IndexRange(rings - 2)) {
+      faces.append(arena.add_face(
+          {vert(ring, seg), vert(ring + 1, seg), vert(ring + 1, seg + 1), vert(ring, seg + 1)},
+          int(faces.size())));
+    }
+  }
+}
+
+/** Union of two shapes, where the faces of the second shape start at \a b_start. */
+static void boolean_benchmark(const char *name, IMesh &mesh, const int b_start, IMeshArena &arena)
+{
+  std::cout << name << " (" << mesh.face_size() << " faces)\n";
+  predicate_stats_enable(true);
+  IMesh result;
+  {
+    SCOPED_TIMER("  union");
+    result = boolean_mesh(
+        mesh,
+        BoolOpType::Union,
+        2,
+        [&](int f) { return f < b_start ? 0 : 1; },
+        false,
+        false,
+        nullptr,
+        &arena);
+  }
+  const PredicateStats stats = predicate_stats_get();
+  predicate_stats_enable(false);
+  const int64_t total = stats.filtered_num + stats.exact_num;
+  const double hit_rate = total > 0 ? 100.0 * double(stats.filtered_num) / double(total) : 100.0;
+  std::cout << "  predicates: " << total << ", filtered: " << stats.filtered_num
+            << ", exact: " << stats.exact_num << ", filter hit rate: " << hit_rate << "%\n";
+  std::cout << "  result faces: " << result.face_size() << "\n";
+}
+
+static void spec_benchmark(const char *name, const char *spec, const int b_start)
+{
+  IMeshArena arena;
+  IMesh mesh = mesh_from_spec(spec, arena);
+  boolean_benchmark(name, mesh, b_start, arena);
+}
+
+static void spheres_benchmark(const int rings, const int segments, const double offset)
+{
+  IMeshArena arena;
+  Vector<Face *> faces;
+  append_sphere(double3(0), 1.0, rings, segments, arena, faces);
+  const int b_start = int(faces.size());
+  append_sphere(double3(offset, offset * 0.5, offset * 0.25), 1.0, rings, segments, arena, faces);
+  IMesh mesh(faces);
+  boolean_benchmark("Spheres", mesh, b_start, arena);
+}
+
+TEST(mesh_boolean_performance, TetTet)
+{
+  spec_benchmark("TetTet",
+                 R"(8 8
+  0 0 0
+  2 0 0
+  1 2 0
+  1 1 2
+  0 0 1
+  2 0 1
+  1 2 1
+  1 1 3
+  0 2 1
+  0 1 3
+  1 2 3
+  2 0 3
+  4 6 5
+  4 5 7
+  5 6 7
+  6 4 7
+  )",
+                 4);
+}
+
+TEST(mesh_boolean_performance, CubeCube)
+{
+  spec_benchmark("CubeCube",
+                 R"(16 12
+  -1 -1 -1
+  -1 -1 1
+  -1 1 -1
+  -1 1 1
+  1 -1 -1
+  1 -1 1
+  1 1 -1
+  1 1 1
+  1/2 1/2 1/2
+  1/2 1/2 5/2
+  1/2 5/2 1/2
+  1/2 5/2 5/2
+  5/2 1/2 1/2
+  5/2 1/2 5/2
+  5/2 5/2 1/2
+  5/2 5/2 5/2
+  0 1 3 2
+  6 2 3 7
+  4 6 7 5
+  0 4 5 1
+  0 2 6 4
+  3 1 5 7
+  8 9 11 10
+  14 10 11 15
+  12 14 15 13
+  8 12 13 9
+  8 10 14 12
+  11 9 13 15
+  )",
+                 6);
+}
+
+TEST(mesh_boolean_performance, SpheresSmall)
+{
+  spheres_benchmark(16, 32, 0.5);
+}
+
+TEST(mesh_boolean_performance, SpheresLarge)
+{
+  spheres_benchmark(64, 128, 0.5);
+}
+
+}  // namespace blender::meshintersect::tests
+#endif
@@ -371,6 +371,20 @@ const blender::ImplicitSharingInfo *BLO_read_shared(
   return shared_data.sharing_info;
 }
 
+/**
+ * Reference an array of trivial data directly in the memory-mapped blend-file instead of copying
+ * it. This is only possible for large arrays in uncompressed files that are stored with the memory
+ * layout of the running Blender, and only when the data does not need any processing after
+ * reading. Meant to be used in the read callback of #BLO_read_shared.
+ *
+ * \return The sharing-info that owns the data now referenced by `*ptr_p`, or null if the data has
+ * to be read as usual.
+ */
+const blender::ImplicitSharingInfo *BLO_read_mapped_array(BlendDataReader *reader,
+                                                          int64_t size_in_bytes,
+                                                          int64_t alignment,
+                                                          void **ptr_p);
+
 int BLO_read_fileversion_get(BlendDataReader *reader);
 bool BLO_read_requires_endian_switch(BlendDataReader *reader);
 bool BLO_read_data_is_undo(BlendDataReader *reader);
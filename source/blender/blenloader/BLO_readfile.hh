@@ -111,6 +111,14 @@ struct BlendFileReadReport {
     double lib_overrides;
     double lib_overrides_resync;
     double lib_overrides_recursive_resync;
+    /** Reading the data of all data-blocks, including DNA conversion for older files. */
+    double read_data;
+    /** Running the #IDTypeInfo.blend_read_data callbacks. */
+    double read_data_callbacks;
+    /** Remapping of ID pointers, included in #libraries. */
+    double lib_link;
+    /** Versioning of the main file and its libraries, before and after linking. */
+    double versioning;
   } duration;
 
   /** Count information. */
@@ -17,6 +17,7 @@ namespace blender {
 class ImplicitSharingInfo;
 }
 struct Main;
+struct MemFile;
 struct Scene;
 
 struct MemFileSharedStorage {
@@ -28,12 +29,47 @@ struct MemFileSharedStorage {
   ~MemFileSharedStorage();
 };
 
+/**
+ * Data of a #MemFileChunk. Chunks with the same content share the same data, also across undo
+ * steps, see #MemFileChunkStore.
+ */
+struct MemFileChunkData {
+  /** Links in #MemFileChunkStore::compress_candidates. */
+  MemFileChunkData *next, *prev;
+  /** Uncompressed data, null while the data is compressed. */
+  char *buf;
+  /** Compressed data, only used for data that has not been written by recent undo steps. */
+  void *compressed_buf;
+  /** Size in bytes. */
+  size_t size;
+  /** Size of #compressed_buf in bytes. */
+  size_t compressed_size;
+  uint64_t hash;
+  /** Number of #MemFileChunk using this data. */
+  int users;
+  /** Last #MemFileChunkStore::generation in which a chunk with this data was written. */
+  uint64_t last_used;
+  /**
+   * The memfile the memory of this data is accounted to (its #MemFile.size). When that undo step
+   * is freed while the data is still in use by another one, this is null until a remaining
+   * memfile using the data takes over its memory.
+   */
+  MemFile *owner;
+  /** False for data that could not be added to the store because of a hash collision. */
+  bool in_store;
+  /** Compression has been tried already but did not reduce the size enough. */
+  bool is_incompressible;
+  /** The data is in #MemFileChunkStore::compress_candidates. */
+  bool is_compress_candidate;
+};
+
 struct MemFileChunk {
   void *next, *prev;
-  const char *buf;
+  /** Shared data of the chunk, with its own user count. */
+  MemFileChunkData *data;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** When true, the data is identical to the chunk at the same position in the previous step. */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -46,6 +82,7 @@ struct MemFileChunk {
 
 struct MemFile {
   ListBase chunks;
+  /** Size in bytes of the chunk data owned by this memfile (compressed data counts as such). */
   size_t size;
   /**
    * Some data is not serialized into a new buffer because the undo-step can take ownership of it
@@ -79,6 +116,10 @@ struct UndoReader {
   int undo_direction;
 
   bool memchunk_identical;
+
+  /** Decompressed data of the last read compressed chunk. */
+  const MemFileChunkData *decompressed_data;
+  char *decompressed_buf;
 };
 
 /* Actually only used `writefile.cc`. */
@@ -107,6 +148,11 @@ void BLO_memfile_merge(MemFile *first, MemFile *second);
  * Clear is_identical_future before adding next memfile.
  */
 void BLO_memfile_clear_future(MemFile *memfile);
+/**
+ * Size of the data owned by the memfile, it can change when older data is compressed while
+ * writing later memfiles.
+ */
+size_t BLO_memfile_size_get(MemFile *memfile);
 
 /* Utilities. */
 
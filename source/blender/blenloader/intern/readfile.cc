@@ -48,13 +48,18 @@
 #include "BLI_endian_switch.h"
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_implicit_sharing.hh"
 #include "BLI_map.hh"
 #include "BLI_memarena.h"
+#include "BLI_mmap.h"
 #include "BLI_string.h"
 #include "BLI_string_ref.hh"
+#include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 #include "BLI_time.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BLT_translation.hh"
 
@@ -184,6 +189,7 @@ static CLG_LogRef LOG_UNDO = {"blo.readfile.undo"};
 static void read_libraries(FileData *basefd, ListBase *mainlist);
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname, const int id_type_index);
 static BHead *find_bhead_from_code_name(FileData *fd, const short idcode, const char *name);
+static void data_reconstruct_prefetch_free(FileData *fd);
 
 struct BHeadN {
   BHeadN *next, *prev;
@@ -314,20 +320,160 @@ static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const bool is
   return nullptr;
 }
 
-static void oldnewmap_clear(OldNewMap *onm)
+static void oldnewmap_free(OldNewMap *onm)
 {
-  /* Free unused data. */
-  for (NewAddress &new_addr : onm->map.values()) {
-    if (new_addr.nr == 0) {
-      MEM_freeN(new_addr.newp);
+  MEM_delete(onm);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Memory-Mapped Data
+ *
+ * When enabled with the `use_mmap_file_data` experimental option, large data blocks of
+ * uncompressed files that are stored with the memory layout of the running Blender are not copied
+ * while reading. Instead, the #datamap references them in the memory-mapped file directly. Code
+ * reading the data through #BLO_read_mapped_array takes over a reference to the mapping (via
+ * implicit sharing), all other code gets a regular copy on first access.
+ *
+ * The file is mapped copy-on-write, so owners of the data can still modify it in place. The
+ * mapping stays alive as long as any loaded data references it. Blender itself never modifies
+ * the file in place, it is replaced when saving. When another program truncates the file, the
+ * pages that can't be read anymore are replaced with zeros (see #BLI_mmap_has_io_error) instead
+ * of crashing.
+ * \{ */
+
+/** Smaller data blocks are always copied, referencing them does not save much. */
+#define MAPPED_DATA_MIN_SIZE (1 << 16)
+
+/** Owns the memory-mapped file. It is freed when neither reading nor loaded data need it. */
+class MappedFileSharingInfo : public blender::ImplicitSharingInfo {
+ public:
+  BLI_mmap_file *mmap_file;
+
+  MappedFileSharingInfo(BLI_mmap_file *mmap_file) : mmap_file(mmap_file) {}
+
+  MEM_CXX_CLASS_ALLOC_FUNCS("MappedFileSharingInfo");
+
+ private:
+  void delete_self_with_data() override
+  {
+    BLI_mmap_free(mmap_file);
+    delete this;
+  }
+};
+
+/** Owns a single data array that is part of a memory-mapped file. */
+class MappedDataSharingInfo : public blender::ImplicitSharingInfo {
+ private:
+  const MappedFileSharingInfo *file_info_;
+
+ public:
+  MappedDataSharingInfo(const MappedFileSharingInfo *file_info) : file_info_(file_info)
+  {
+    file_info_->add_user();
+  }
+
+  MEM_CXX_CLASS_ALLOC_FUNCS("MappedDataSharingInfo");
+
+ private:
+  void delete_self_with_data() override
+  {
+    file_info_->remove_user_and_delete_if_last();
+    delete this;
+  }
+};
+
+/**
+ * Get the data of the given block in the memory-mapped file, if it can be used there directly.
+ * Otherwise it has to be read with #read_struct.
+ */
+static void *read_struct_mapped(FileData *fd, BHead *bh)
+{
+  if (fd->mapped_file == nullptr || bh->len < MAPPED_DATA_MIN_SIZE) {
+    return nullptr;
+  }
+  if ((fd->flags & FD_FLAGS_SWITCH_ENDIAN) || fd->compflags[bh->SDNAnr] != SDNA_CMP_EQUAL) {
+    return nullptr;
+  }
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  const BHeadN *bhn = BHEADN_FROM_BHEAD(bh);
+  if (bhn->has_data) {
+    return nullptr;
+  }
+  BLI_mmap_file *mmap_file = fd->mapped_file->mmap_file;
+  if (size_t(bhn->file_offset) + size_t(bh->len) > BLI_mmap_get_length(mmap_file)) {
+    return nullptr;
+  }
+  char *data = static_cast<char *>(BLI_mmap_get_pointer(mmap_file)) + bhn->file_offset;
+  const int alignment = DNA_struct_alignment(fd->filesdna, bh->SDNAnr);
+  if (uintptr_t(data) % alignment != 0) {
+    return nullptr;
+  }
+  fd->mapped_data.add(data, bh);
+  return data;
+#else
+  return nullptr;
+#endif
+}
+
+/**
+ * Data that is not read through #BLO_read_mapped_array is owned by the regular allocator, so
+ * make a copy of mapped data for it.
+ */
+static void mapped_data_ensure_allocated(FileData *fd, NewAddress &entry)
+{
+  const BHead *bh = fd->mapped_data.lookup_default(entry.newp, nullptr);
+  if (bh == nullptr) {
+    return;
+  }
+  const int alignment = DNA_struct_alignment(fd->filesdna, bh->SDNAnr);
+  void *data = MEM_mallocN_aligned(bh->len, alignment, "Data from mapped file");
+  memcpy(data, entry.newp, bh->len);
+  fd->mapped_data.remove(entry.newp);
+  entry.newp = data;
+}
+
+/**
+ * Called once the file has been read. Reports whether reading the mapped data failed, in which
+ * case it may have been replaced with zeros. Loaded data that references the file keeps the
+ * mapping alive.
+ */
+static void mapped_file_release(FileData *fd, const bool report)
+{
+  MappedFileSharingInfo *mapped_file = fd->mapped_file;
+  if (mapped_file == nullptr) {
+    return;
+  }
+  fd->mapped_file = nullptr;
+
+  if (BLI_mmap_has_io_error(mapped_file->mmap_file)) {
+    if (report && fd->reports) {
+      BLO_reportf_wrap(fd->reports,
+                       RPT_ERROR,
+                       "Unable to read '%s', the file has been changed while it was being read. "
+                       "Some data may be lost",
+                       fd->relabase);
+    }
+    else {
+      CLOG_ERROR(&LOG, "Failed to read '%s' while it was memory-mapped", fd->relabase);
     }
   }
-  onm->map.clear();
+
+  mapped_file->remove_user_and_delete_if_last();
 }
 
-static void oldnewmap_free(OldNewMap *onm)
+/** Free the unused data read for an ID, while leaving the data in the mapped file alone. */
+static void datamap_clear(FileData *fd)
 {
-  MEM_delete(onm);
+  /* Free unused data. */
+  for (NewAddress &new_addr : fd->datamap->map.values()) {
+    if (new_addr.nr == 0 && !fd->mapped_data.contains(new_addr.newp)) {
+      MEM_freeN(new_addr.newp);
+    }
+  }
+  fd->datamap->map.clear();
+  fd->mapped_data.clear();
 }
 
 /** \} */
@@ -1265,8 +1411,21 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   /* Rewind the file after reading the header. */
   rawfile->seek(rawfile, 0, SEEK_SET);
 
+  MappedFileSharingInfo *mapped_file = nullptr;
+
   /* Check if we have a regular file. */
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
+#ifndef WIN32
+    /* Not on Windows, where a file can't be replaced while it is mapped, which would make it
+     * impossible to save over the opened file. */
+    if (USER_EXPERIMENTAL_TEST(&U, use_mmap_file_data)) {
+      /* A separate mapping that loaded data can reference directly. Unlike the mapping used for
+       * reading, it is writable and may outlive the #FileData. */
+      if (BLI_mmap_file *mmap_file = BLI_mmap_open_private_writable(filedes)) {
+        mapped_file = new MappedFileSharingInfo(mmap_file);
+      }
+    }
+#endif
     /* Try opening the file with memory-mapped IO. */
     file = BLI_filereader_new_mmap(filedes);
     if (file == nullptr) {
@@ -1299,6 +1458,7 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   FileData *fd = filedata_new(reports);
   fd->file = file;
+  fd->mapped_file = mapped_file;
 
   return fd;
 }
@@ -1413,7 +1573,11 @@ void blo_filedata_free(FileData *fd)
     MEM_freeN(new_bhead);
   }
 #endif
+  data_reconstruct_prefetch_free(fd);
   fd->file->close(fd->file);
+  /* The reports may not exist anymore when a link handle is closed, so errors are reported when
+   * reading is done instead. This only handles files whose reading was aborted. */
+  mapped_file_release(fd, false);
 
   if (fd->filesdna) {
     DNA_sdna_free(fd->filesdna);
@@ -1499,15 +1663,31 @@ short BLO_version_from_file(const char *filepath)
  * \{ */
 
 /* Only direct data-blocks. */
+static void *datamap_lookup_and_inc(FileData *fd, const void *adr, const bool increase_users)
+{
+  if (fd->mapped_data.is_empty()) {
+    return oldnewmap_lookup_and_inc(fd->datamap, adr, increase_users);
+  }
+  NewAddress *entry = fd->datamap->map.lookup_ptr(adr);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  mapped_data_ensure_allocated(fd, *entry);
+  if (increase_users) {
+    entry->nr++;
+  }
+  return entry->newp;
+}
+
 static void *newdataadr(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return datamap_lookup_and_inc(fd, adr, true);
 }
 
 /* Only direct data-blocks. */
 static void *newdataadr_no_us(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, false);
+  return datamap_lookup_and_inc(fd, adr, false);
 }
 
 void *blo_read_get_new_globaldata_address(FileData *fd, const void *adr)
@@ -2586,29 +2766,259 @@ static bool direct_link_id(FileData *fd,
   return success;
 }
 
-/* Read all data associated with a datablock into datamap. */
+/** A data block of an ID that is converted to the current DNA after all its data has been read. */
+struct DataReconstructTask {
+  const void *old_address;
+  /** Contains the file data, can be a temporary copy for blocks that are read on demand. */
+  BHead *bhead;
+  bool free_bhead;
+  const char *alloc_name;
+  void *new_address;
+};
+
+/**
+ * Conversion of the data blocks of the next ID in the file, which runs on worker threads while
+ * the current ID is processed further (#direct_link_id, ...). Only used while reading all IDs of a
+ * file in order.
+ */
+struct DataReconstructPrefetch {
+  /** The ID the tasks belong to, null when nothing is being converted. */
+  const BHead *id_bhead = nullptr;
+  blender::Vector<DataReconstructTask> tasks;
+  TaskPool *task_pool = nullptr;
+};
+
+/**
+ * Whether #DNA_struct_reconstruct can be deferred for the block, so that it can run in parallel
+ * with the conversion of the other data of the same ID.
+ */
+static bool read_struct_reconstruct_can_defer(FileData *fd, const BHead *bh)
+{
+  return bh->len != 0 && fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL &&
+         (fd->flags & FD_FLAGS_SWITCH_ENDIAN) == 0;
+}
+
+/** Total size of the blocks of an ID below which converting them on multiple threads is slower. */
+#define DATA_RECONSTRUCT_PARALLEL_MIN_SIZE (1 << 18)
+
+/** Read the data of a block whose conversion is deferred, if it is not loaded yet. */
+static void data_reconstruct_task_add(FileData *fd,
+                                      BHead *bhead,
+                                      const char *allocname,
+                                      const int id_type_index,
+                                      blender::Vector<DataReconstructTask> &tasks)
+{
+  DataReconstructTask task{};
+  task.old_address = bhead->old;
+  task.bhead = bhead;
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  if (BHEADN_FROM_BHEAD(bhead)->has_data == false) {
+    task.bhead = blo_bhead_read_full(fd, bhead);
+    task.free_bhead = true;
+  }
+#endif
+  if (UNLIKELY(task.bhead == nullptr)) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+    return;
+  }
+  /* Not thread-safe, see #get_alloc_name. */
+  task.alloc_name = get_alloc_name(fd, bhead, allocname, id_type_index);
+  tasks.append(task);
+}
+
+/** Convert the data blocks of an ID, on multiple threads if there is enough data. */
+static void data_reconstruct_tasks_run(FileData *fd,
+                                       blender::MutableSpan<DataReconstructTask> tasks)
+{
+  int64_t reconstruct_size = 0;
+  for (const DataReconstructTask &task : tasks) {
+    reconstruct_size += task.bhead->len;
+  }
+  const int64_t grain_size = reconstruct_size < DATA_RECONSTRUCT_PARALLEL_MIN_SIZE ?
+                                 std::max<int64_t>(tasks.size(), 1) :
+                                 1;
+  blender::threading::parallel_for(
+      tasks.index_range(), grain_size, [&](const blender::IndexRange range) {
+        for (DataReconstructTask &task : tasks.slice(range)) {
+          task.new_address = DNA_struct_reconstruct(fd->reconstruct_info,
+                                                    task.bhead->SDNAnr,
+                                                    task.bhead->nr,
+                                                    task.bhead + 1,
+                                                    task.alloc_name);
+        }
+      });
+}
+
+static void data_reconstruct_prefetch_task(TaskPool *__restrict pool, void *taskdata)
+{
+  FileData *fd = static_cast<FileData *>(BLI_task_pool_user_data(pool));
+  DataReconstructPrefetch *prefetch = static_cast<DataReconstructPrefetch *>(taskdata);
+  data_reconstruct_tasks_run(fd, prefetch->tasks);
+}
+
+/**
+ * Start converting the data of the ID at \a id_bhead, if it has data that needs conversion.
+ * The data is read from the file here, only the conversion runs in the background.
+ */
+static void data_reconstruct_prefetch_start(FileData *fd, BHead *id_bhead)
+{
+  DataReconstructPrefetch *prefetch = fd->reconstruct_prefetch;
+  BLI_assert(prefetch->id_bhead == nullptr && prefetch->tasks.is_empty());
+  if (id_bhead == nullptr || id_bhead->code == ID_LINK_PLACEHOLDER ||
+      !blo_bhead_is_id_valid_type(id_bhead))
+  {
+    return;
+  }
+
+  /* Same names as used by #read_libblock. */
+  const int id_type_index = BKE_idtype_idcode_to_index(id_bhead->code);
+#ifndef NDEBUG
+  const char *blockname = nullptr;
+#else
+  const char *blockname = get_alloc_name(fd, id_bhead, nullptr, id_type_index);
+#endif
+
+  for (BHead *bhead = blo_bhead_next(fd, id_bhead); bhead && bhead->code == BLO_CODE_DATA;
+       bhead = blo_bhead_next(fd, bhead))
+  {
+    if (read_struct_reconstruct_can_defer(fd, bhead)) {
+      data_reconstruct_task_add(fd, bhead, blockname, id_type_index, prefetch->tasks);
+    }
+  }
+  if (prefetch->tasks.is_empty()) {
+    return;
+  }
+
+  prefetch->id_bhead = id_bhead;
+  if (prefetch->task_pool == nullptr) {
+    prefetch->task_pool = BLI_task_pool_create(fd, TASK_PRIORITY_HIGH);
+  }
+  BLI_task_pool_push(
+      prefetch->task_pool, data_reconstruct_prefetch_task, prefetch, false, nullptr);
+}
+
+static void data_reconstruct_tasks_free(blender::Vector<DataReconstructTask> &tasks)
+{
+  for (DataReconstructTask &task : tasks) {
+    if (task.new_address) {
+      MEM_freeN(task.new_address);
+    }
+    if (task.free_bhead) {
+      MEM_freeN(BHEADN_FROM_BHEAD(task.bhead));
+    }
+  }
+  tasks.clear();
+}
+
+/**
+ * Wait for the conversion started by #data_reconstruct_prefetch_start.
+ * \return True if the converted blocks belong to the ID at \a id_bhead, they are moved to
+ * \a r_tasks then. Otherwise they are not needed anymore and are freed.
+ */
+static bool data_reconstruct_prefetch_finish(FileData *fd,
+                                             const BHead *id_bhead,
+                                             blender::Vector<DataReconstructTask> &r_tasks)
+{
+  DataReconstructPrefetch *prefetch = fd->reconstruct_prefetch;
+  if (prefetch->id_bhead == nullptr) {
+    return false;
+  }
+  BLI_task_pool_work_and_wait(prefetch->task_pool);
+
+  const bool is_used = prefetch->id_bhead == id_bhead;
+  prefetch->id_bhead = nullptr;
+  if (!is_used) {
+    data_reconstruct_tasks_free(prefetch->tasks);
+    return false;
+  }
+  r_tasks = std::move(prefetch->tasks);
+  prefetch->tasks.clear();
+  return true;
+}
+
+static void data_reconstruct_prefetch_free(FileData *fd)
+{
+  DataReconstructPrefetch *prefetch = fd->reconstruct_prefetch;
+  if (prefetch == nullptr) {
+    return;
+  }
+  if (prefetch->task_pool) {
+    BLI_task_pool_work_and_wait(prefetch->task_pool);
+    BLI_task_pool_free(prefetch->task_pool);
+  }
+  data_reconstruct_tasks_free(prefetch->tasks);
+  MEM_delete(prefetch);
+  fd->reconstruct_prefetch = nullptr;
+}
+
+/**
+ * Read all data associated with a datablock into datamap.
+ *
+ * Reading from the file has to happen sequentially, but converting blocks from older DNA is
+ * independent for every block and is done in parallel once all blocks of the ID are read. When all
+ * IDs of the file are read in order, the data of the next ID is converted in the background while
+ * the current one is processed further.
+ */
 static BHead *read_data_into_datamap(FileData *fd,
                                      BHead *bhead,
                                      const char *allocname,
                                      const int id_type_index)
 {
+  const double start_time = BLI_time_now_seconds();
+
+  auto datamap_insert = [&](const void *old_address, void *data) {
+    const bool is_new = oldnewmap_insert(fd->datamap, old_address, data, 0);
+    if (!is_new) {
+      CLOG_ERROR(&LOG,
+                 "Blendfile corruption: Invalid, or multiple `bhead` with same old address "
+                 "value (%p) for a given ID.",
+                 old_address);
+    }
+  };
+
+  blender::Vector<DataReconstructTask> reconstruct_tasks;
+  const bool is_prefetched = fd->reconstruct_prefetch &&
+                             data_reconstruct_prefetch_finish(fd, bhead, reconstruct_tasks);
+
   bhead = blo_bhead_next(fd, bhead);
 
   while (bhead && bhead->code == BLO_CODE_DATA) {
-    void *data = read_struct(fd, bhead, allocname, id_type_index);
-    if (data) {
-      const bool is_new = oldnewmap_insert(fd->datamap, bhead->old, data, 0);
-      if (!is_new) {
-        CLOG_ERROR(&LOG,
-                   "Blendfile corruption: Invalid, or multiple `bhead` with same old address "
-                   "value (%p) for a given ID.",
-                   bhead->old);
+    if (read_struct_reconstruct_can_defer(fd, bhead)) {
+      if (!is_prefetched) {
+        data_reconstruct_task_add(fd, bhead, allocname, id_type_index, reconstruct_tasks);
+      }
+    }
+    else {
+      void *data = read_struct_mapped(fd, bhead);
+      if (data == nullptr) {
+        data = read_struct(fd, bhead, allocname, id_type_index);
+      }
+      if (data) {
+        datamap_insert(bhead->old, data);
       }
     }
 
     bhead = blo_bhead_next(fd, bhead);
   }
 
+  if (!is_prefetched) {
+    data_reconstruct_tasks_run(fd, reconstruct_tasks);
+  }
+  if (fd->reconstruct_prefetch) {
+    data_reconstruct_prefetch_start(fd, bhead);
+  }
+
+  for (DataReconstructTask &task : reconstruct_tasks) {
+    if (task.new_address) {
+      datamap_insert(task.old_address, task.new_address);
+    }
+    if (task.free_bhead) {
+      MEM_freeN(BHEADN_FROM_BHEAD(task.bhead));
+    }
+  }
+
+  fd->reports->duration.read_data += BLI_time_now_seconds() - start_time;
+
   return bhead;
 }
 
@@ -3088,8 +3498,10 @@ static BHead *read_libblock(FileData *fd,
   /* Read datablock contents.
    * Use convenient malloc name for debugging and better memory link prints. */
   bhead = read_data_into_datamap(fd, bhead, blockname, id_type_index);
+  const double read_data_start_time = BLI_time_now_seconds();
   const bool success = direct_link_id(fd, main, id_tag, id_read_tags, id, id_old);
-  oldnewmap_clear(fd->datamap);
+  fd->reports->duration.read_data_callbacks += BLI_time_now_seconds() - read_data_start_time;
+  datamap_clear(fd);
 
   if (!success) {
     /* XXX This is probably working OK currently given the very limited scope of that flag.
@@ -3133,7 +3545,7 @@ BHead *blo_read_asset_data_block(FileData *fd, BHead *bhead, AssetMetaData **r_a
   BLO_read_struct(&reader, AssetMetaData, r_asset_data);
   BKE_asset_metadata_read(&reader, *r_asset_data);
 
-  oldnewmap_clear(fd->datamap);
+  datamap_clear(fd);
 
   return bhead;
 }
@@ -3234,6 +3646,8 @@ static void do_versions(FileData *fd, Library *lib, Main *main)
 {
   /* WATCH IT!!!: pointers from libdata have not been converted */
 
+  const double start_time = BLI_time_now_seconds();
+
   /* Don't allow versioning to create new data-blocks. */
   main->is_locked_for_linking = true;
 
@@ -3289,6 +3703,8 @@ static void do_versions(FileData *fd, Library *lib, Main *main)
   /* don't forget to set version number in BKE_blender_version.h! */
 
   main->is_locked_for_linking = false;
+
+  fd->reports->duration.versioning += BLI_time_now_seconds() - start_time;
 }
 
 static void do_versions_after_linking(FileData *fd, Main *main)
@@ -3303,6 +3719,8 @@ static void do_versions_after_linking(FileData *fd, Main *main)
             main->versionfile,
             main->subversionfile);
 
+  const double start_time = BLI_time_now_seconds();
+
   /* Don't allow versioning to create new data-blocks. */
   main->is_locked_for_linking = true;
 
@@ -3329,6 +3747,8 @@ static void do_versions_after_linking(FileData *fd, Main *main)
   }
 
   main->is_locked_for_linking = false;
+
+  fd->reports->duration.versioning += BLI_time_now_seconds() - start_time;
 }
 
 /** \} */
@@ -3367,6 +3787,8 @@ static int lib_link_cb(LibraryIDLinkCallbackData *cb_data)
 
 static void lib_link_all(FileData *fd, Main *bmain)
 {
+  const double start_time = BLI_time_now_seconds();
+
   BlendLibReader reader = {fd, bmain};
 
   ID *id;
@@ -3430,6 +3852,8 @@ static void lib_link_all(FileData *fd, Main *bmain)
   }
   FOREACH_MAIN_ID_END;
 #endif
+
+  fd->reports->duration.lib_link += BLI_time_now_seconds() - start_time;
 }
 
 /**
@@ -3573,7 +3997,7 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
   user->edit_studio_light = 0;
 
   /* free fd->datamap again */
-  oldnewmap_clear(fd->datamap);
+  datamap_clear(fd);
 
   return bhead;
 }
@@ -3708,6 +4132,11 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     read_undo_reuse_noundo_local_ids(fd);
   }
 
+  if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
+    /* IDs are read in the order of the file, so their data can be converted ahead of time. */
+    fd->reconstruct_prefetch = MEM_new<DataReconstructPrefetch>(__func__);
+  }
+
   while (bhead) {
     switch (bhead->code) {
       case BLO_CODE_DATA:
@@ -3772,6 +4201,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  data_reconstruct_prefetch_free(fd);
+
   if (is_undo) {
     /* Move the remaining Library IDs and their linked data to the new main.
      *
@@ -3865,10 +4296,14 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
       BKE_main_id_refcount_recompute(bfd->main, false);
     }
 
+    /* All data has been read. */
+    mapped_file_release(fd, true);
+
     LISTBASE_FOREACH_MUTABLE (Library *, lib, &bfd->main->libraries) {
       /* Now we can clear this runtime library filedata, it is not needed anymore. */
       if (lib->runtime->filedata) {
         BLI_assert(lib->runtime->versionfile != 0);
+        mapped_file_release(lib->runtime->filedata, true);
         blo_filedata_free(lib->runtime->filedata);
         lib->runtime->filedata = nullptr;
       }
@@ -4595,6 +5030,9 @@ void BLO_library_link_end(Main *mainl, BlendHandle **bh, const LibraryLink_Param
   if (!mainl->is_read_invalid) {
     library_link_end(mainl, &fd, params->flag);
   }
+  if (fd) {
+    mapped_file_release(fd, true);
+  }
 
   LISTBASE_FOREACH (Library *, lib, &params->bmain->libraries) {
     /* Now we can clear this runtime library filedata, it is not needed anymore. */
@@ -4609,6 +5047,7 @@ void BLO_library_link_end(Main *mainl, BlendHandle **bh, const LibraryLink_Param
        * TODO: In the future, could be worth keeping them in case data are linked from several
        * libraries at once? To avoid closing and re-opening the same file several times. Would need
        * a global cleanup callback then once all linking is done, though. */
+      mapped_file_release(lib->runtime->filedata, true);
       blo_filedata_free(lib->runtime->filedata);
       lib->runtime->filedata = nullptr;
     }
@@ -5266,6 +5705,29 @@ blender::ImplicitSharingInfoAndData blo_read_shared_impl(
   return shared_data;
 }
 
+const blender::ImplicitSharingInfo *BLO_read_mapped_array(BlendDataReader *reader,
+                                                          const int64_t size_in_bytes,
+                                                          const int64_t alignment,
+                                                          void **ptr_p)
+{
+  FileData *fd = reader->fd;
+  if (fd->mapped_data.is_empty() || *ptr_p == nullptr) {
+    return nullptr;
+  }
+  NewAddress *entry = fd->datamap->map.lookup_ptr(*ptr_p);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  const BHead *bh = fd->mapped_data.lookup_default(entry->newp, nullptr);
+  if (bh == nullptr || bh->len < size_in_bytes || uintptr_t(entry->newp) % alignment != 0) {
+    return nullptr;
+  }
+  /* The data stays in #FileData.mapped_data, other users of the same address still get a copy. */
+  entry->nr++;
+  *ptr_p = entry->newp;
+  return new MappedDataSharingInfo(fd->mapped_file);
+}
+
 bool BLO_read_data_is_undo(BlendDataReader *reader)
 {
   return (reader->fd->flags & FD_FLAGS_IS_MEMFILE);
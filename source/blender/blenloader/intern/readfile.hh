@@ -31,9 +31,11 @@ struct BlendFileReadReport;
 struct BLOCacheStorage;
 struct BHeadSort;
 struct DNA_ReconstructInfo;
+struct DataReconstructPrefetch;
 struct IDNameLib_Map;
 struct Key;
 struct Main;
+class MappedFileSharingInfo;
 struct MemFile;
 struct Object;
 struct OldNewMap;
@@ -119,6 +121,20 @@ struct FileData {
   OldNewMap *datamap = nullptr;
   OldNewMap *globmap = nullptr;
 
+  /** Converts the data of the next ID while reading IDs in order, see #read_data_into_datamap. */
+  DataReconstructPrefetch *reconstruct_prefetch = nullptr;
+
+  /**
+   * Owns the memory-mapped file when large data arrays are referenced in it directly instead of
+   * being copied, see #BLO_read_mapped_array. Null when that is not possible or disabled.
+   */
+  MappedFileSharingInfo *mapped_file = nullptr;
+  /**
+   * Data in #datamap that points into #mapped_file instead of being allocated, with the #BHead it
+   * was read from.
+   */
+  blender::Map<const void *, const BHead *> mapped_data;
+
   /**
    * Store mapping from old ID pointers (the values they have in the .blend file) to new ones,
    * typically from value in `bhead->old` to address in memory where the ID was read.
@@ -11,6 +11,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
+#include <mutex>
 
 /* open/close */
 #ifndef _WIN32
@@ -22,8 +23,12 @@
 #include "MEM_guardedalloc.h"
 
 #include "DNA_listBase.h"
+#include "DNA_userdef_types.h"
 
 #include "BLI_implicit_sharing.hh"
+#include "BLI_map.hh"
+#include "BLI_set.hh"
+#include "BLI_vector.hh"
 
 #include "BLO_readfile.hh"
 #include "BLO_undofile.hh"
@@ -32,21 +37,391 @@
 #include "BKE_main.hh"
 #include "BKE_undo_system.hh"
 
+#include <xxhash.h>
+#include <zstd.h>
+
 #include "BLI_strict_flags.h" /* IWYU pragma: keep. Keep last. */
 
+/* -------------------------------------------------------------------- */
+/** \name Chunk Store
+ *
+ * The data of all memfile chunks is stored in one store, keyed by a hash of their content. A chunk
+ * with the same content as any chunk in any other undo step shares its data, so that e.g.
+ * inserting a single ID (which shifts all following chunks) does not duplicate all data.
+ *
+ * Optionally, data that has not been written by the last few undo steps is compressed, since it
+ * is only needed again when undoing that far back.
+ * \{ */
+
+/** Data that has not been used by this many undo pushes is compressed. */
+#define MEMFILE_COLD_GENERATIONS 4
+/** Smaller data is never compressed, the gain would not be worth the overhead. */
+#define MEMFILE_COMPRESS_MIN_SIZE 1024
+#define MEMFILE_COMPRESSION_LEVEL 1
+
+struct MemFileChunkStore {
+  std::mutex mutex;
+  blender::Map<uint64_t, MemFileChunkData *> data_by_hash;
+  /** Number of #MemFileChunkData, including the ones not in #data_by_hash. */
+  int64_t data_num = 0;
+  /** Incremented for every written memfile. */
+  uint64_t generation = 0;
+  /** Total size of all uncompressed data. */
+  size_t size = 0;
+  /** Total size of all compressed data. */
+  size_t compressed_size = 0;
+  /**
+   * Uncompressed data that can be compressed once it is cold, least recently used first. This
+   * avoids visiting all data in the store on every undo push.
+   */
+  ListBase compress_candidates = {nullptr, nullptr};
+  /** Number of memfiles being written, the store is kept alive while this is not zero. */
+  int writers = 0;
+  /** All memfiles that have been written and not freed yet. */
+  blender::Set<MemFile *> memfiles;
+  /**
+   * Data that is still used after the memfile it was accounted to has been freed. Ownership is
+   * moved to a remaining memfile using it, see #chunk_store_adopt_orphaned_data.
+   */
+  blender::Set<MemFileChunkData *> orphaned_data;
+};
+
+/** Created for the first chunk and freed with the last chunk data. */
+static MemFileChunkStore *g_chunk_store = nullptr;
+
+static MemFileChunkStore &chunk_store_ensure()
+{
+  if (g_chunk_store == nullptr) {
+    g_chunk_store = MEM_new<MemFileChunkStore>(__func__);
+  }
+  return *g_chunk_store;
+}
+
+/**
+ * Frees the store when it has no data and no writers anymore. Only called from the main thread.
+ */
+static void chunk_store_free_if_unused()
+{
+  if (g_chunk_store == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard lock{g_chunk_store->mutex};
+    if (g_chunk_store->data_num != 0 || g_chunk_store->writers != 0) {
+      return;
+    }
+  }
+  MEM_delete(g_chunk_store);
+  g_chunk_store = nullptr;
+}
+
+/** Changes the size accounted to the owner of the data (if any). */
+static void chunk_data_owner_size_update(MemFileChunkData *data,
+                                         const size_t old_size,
+                                         const size_t new_size)
+{
+  if (data->owner) {
+    data->owner->size = data->owner->size - old_size + new_size;
+  }
+}
+
+static size_t chunk_data_memory_size(const MemFileChunkData *data)
+{
+  return data->buf ? data->size : data->compressed_size;
+}
+
+/** Returns the decompressed data in a new buffer, or null on failure. */
+static char *chunk_data_decompress(const MemFileChunkData *data)
+{
+  BLI_assert(data->compressed_buf != nullptr);
+  char *buf = static_cast<char *>(MEM_mallocN(data->size, "Chunk buffer"));
+  const size_t result = ZSTD_decompress(
+      buf, data->size, data->compressed_buf, data->compressed_size);
+  if (ZSTD_isError(result) || result != data->size) {
+    MEM_freeN(buf);
+    return nullptr;
+  }
+  return buf;
+}
+
+static bool chunk_data_is_cold(const MemFileChunkStore &store, const MemFileChunkData *data)
+{
+  return data->last_used + MEMFILE_COLD_GENERATIONS < store.generation;
+}
+
+/** Add uncompressed data to the end of the compression candidates, if it is worth compressing. */
+static void chunk_data_compress_candidate_add(MemFileChunkStore &store, MemFileChunkData *data)
+{
+  BLI_assert(data->buf != nullptr && !data->is_compress_candidate);
+  if (data->is_incompressible || data->size < MEMFILE_COMPRESS_MIN_SIZE) {
+    return;
+  }
+  BLI_addtail(&store.compress_candidates, data);
+  data->is_compress_candidate = true;
+}
+
+static void chunk_data_compress_candidate_remove(MemFileChunkStore &store, MemFileChunkData *data)
+{
+  if (data->is_compress_candidate) {
+    BLI_remlink(&store.compress_candidates, data);
+    data->is_compress_candidate = false;
+  }
+}
+
+/** Replace compressed data by its decompressed data, because it is used by a recent step. */
+static void chunk_data_make_hot(MemFileChunkStore &store, MemFileChunkData *data, char *buf)
+{
+  chunk_data_owner_size_update(data, data->compressed_size, data->size);
+  store.compressed_size -= data->compressed_size;
+  store.size += data->size;
+  MEM_freeN(data->compressed_buf);
+  data->compressed_buf = nullptr;
+  data->compressed_size = 0;
+  data->buf = buf;
+  chunk_data_compress_candidate_add(store, data);
+}
+
+/**
+ * Returns the compressed data in a new buffer, or null when compression does not save a
+ * meaningful amount of memory. Does not modify the data, so it can run without the store lock.
+ */
+static void *chunk_data_compress(const MemFileChunkData *data, size_t *r_compressed_size)
+{
+  BLI_assert(data->buf != nullptr);
+  const size_t bound = ZSTD_compressBound(data->size);
+  void *compressed_buf = MEM_mallocN(bound, "Chunk compressed buffer");
+  const size_t compressed_size = ZSTD_compress(
+      compressed_buf, bound, data->buf, data->size, MEMFILE_COMPRESSION_LEVEL);
+  if (ZSTD_isError(compressed_size) || compressed_size > data->size - data->size / 8) {
+    MEM_freeN(compressed_buf);
+    return nullptr;
+  }
+  *r_compressed_size = compressed_size;
+  return MEM_reallocN(compressed_buf, compressed_size);
+}
+
+/** Replace the uncompressed data by its compressed data. */
+static void chunk_data_compressed_set(MemFileChunkStore &store,
+                                      MemFileChunkData *data,
+                                      void *compressed_buf,
+                                      const size_t compressed_size)
+{
+  chunk_data_owner_size_update(data, data->size, compressed_size);
+  store.size -= data->size;
+  store.compressed_size += compressed_size;
+  MEM_freeN(data->buf);
+  data->buf = nullptr;
+  data->compressed_buf = compressed_buf;
+  data->compressed_size = compressed_size;
+}
+
+static void chunk_data_remove_user(MemFileChunkStore &store,
+                                   MemFile *memfile,
+                                   MemFileChunkData *data);
+
+/**
+ * Compresses all data that has not been written by any of the recent undo steps. The store is
+ * only locked to take the cold data from the compression candidates and to replace the
+ * uncompressed data, so the lock is not held while compressing.
+ */
+static void chunk_store_compress_cold(MemFileChunkStore &store)
+{
+  blender::Vector<MemFileChunkData *> cold_data;
+  {
+    std::lock_guard lock{store.mutex};
+    /* Candidates are ordered by last use, so only the cold data at the start is visited. */
+    while (MemFileChunkData *data = static_cast<MemFileChunkData *>(
+               store.compress_candidates.first))
+    {
+      if (!chunk_data_is_cold(store, data)) {
+        break;
+      }
+      chunk_data_compress_candidate_remove(store, data);
+      /* Keep the data alive while it is compressed, even when its undo steps are freed. */
+      data->users++;
+      cold_data.append(data);
+    }
+  }
+
+  for (MemFileChunkData *data : cold_data) {
+    /* The uncompressed data is only freed or replaced here, or when there are no users. */
+    size_t compressed_size = 0;
+    void *compressed_buf = chunk_data_compress(data, &compressed_size);
+
+    std::lock_guard lock{store.mutex};
+    if (compressed_buf == nullptr) {
+      data->is_incompressible = true;
+    }
+    else if (!chunk_data_is_cold(store, data)) {
+      /* Written again by a newer undo step in the meantime. */
+      MEM_freeN(compressed_buf);
+      chunk_data_compress_candidate_add(store, data);
+    }
+    else {
+      chunk_data_compressed_set(store, data, compressed_buf, compressed_size);
+    }
+    chunk_data_remove_user(store, nullptr, data);
+  }
+}
+
+static void chunk_data_add_user(MemFileChunkStore &store,
+                                MemFile *memfile,
+                                MemFileChunkData *data)
+{
+  data->users++;
+  data->last_used = store.generation;
+  if (data->is_compress_candidate) {
+    /* Keep the candidates ordered by last use. */
+    BLI_remlink(&store.compress_candidates, data);
+    BLI_addtail(&store.compress_candidates, data);
+  }
+  if (data->owner == nullptr) {
+    /* The memfile the data was accounted to has been freed, take over its memory. */
+    data->owner = memfile;
+    memfile->size += chunk_data_memory_size(data);
+    store.orphaned_data.remove(data);
+  }
+}
+
+/**
+ * Find the data with the same content as \a buf in the store, or add it.
+ * The returned data has a user for the caller.
+ */
+static MemFileChunkData *chunk_store_add(MemFile *memfile, const char *buf, const size_t size)
+{
+  MemFileChunkStore &store = chunk_store_ensure();
+  const uint64_t hash = XXH3_64bits(buf, size);
+
+  std::lock_guard lock{store.mutex};
+
+  MemFileChunkData *existing = store.data_by_hash.lookup_default(hash, nullptr);
+  if (existing && existing->size == size) {
+    if (existing->buf) {
+      if (memcmp(existing->buf, buf, size) == 0) {
+        chunk_data_add_user(store, memfile, existing);
+        return existing;
+      }
+    }
+    else if (char *decompressed = chunk_data_decompress(existing)) {
+      if (memcmp(decompressed, buf, size) == 0) {
+        chunk_data_make_hot(store, existing, decompressed);
+        chunk_data_add_user(store, memfile, existing);
+        return existing;
+      }
+      MEM_freeN(decompressed);
+    }
+  }
+
+  MemFileChunkData *data = MEM_cnew<MemFileChunkData>(__func__);
+  data->buf = static_cast<char *>(MEM_mallocN(size, "Chunk buffer"));
+  memcpy(data->buf, buf, size);
+  data->size = size;
+  data->hash = hash;
+  data->users = 1;
+  data->last_used = store.generation;
+  data->owner = memfile;
+  /* On a hash collision, the data is simply not shared. */
+  data->in_store = existing == nullptr;
+  if (data->in_store) {
+    store.data_by_hash.add_new(hash, data);
+  }
+  chunk_data_compress_candidate_add(store, data);
+  store.data_num++;
+  store.size += size;
+  memfile->size += size;
+  return data;
+}
+
+/**
+ * Remove a user of the data and free it when it was the last one. The store has to be locked.
+ * \param memfile: The memfile of the user, null for temporary users.
+ */
+static void chunk_data_remove_user(MemFileChunkStore &store,
+                                   MemFile *memfile,
+                                   MemFileChunkData *data)
+{
+  data->users--;
+  if (data->users > 0) {
+    if (memfile != nullptr && data->owner == memfile) {
+      /* Still used by another undo step which is not known here, see #BLO_memfile_merge. Its
+       * memory is accounted to that step by #chunk_store_adopt_orphaned_data. */
+      data->owner = nullptr;
+      store.orphaned_data.add(data);
+    }
+    return;
+  }
+
+  if (data->owner == nullptr) {
+    store.orphaned_data.remove(data);
+  }
+  if (data->in_store) {
+    store.data_by_hash.remove(data->hash);
+  }
+  chunk_data_compress_candidate_remove(store, data);
+  if (data->buf) {
+    store.size -= data->size;
+    MEM_freeN(data->buf);
+  }
+  else {
+    store.compressed_size -= data->compressed_size;
+    MEM_freeN(data->compressed_buf);
+  }
+  MEM_freeN(data);
+  store.data_num--;
+}
+
+static void chunk_store_remove_user(MemFile *memfile, MemFileChunkData *data)
+{
+  MemFileChunkStore &store = *g_chunk_store;
+  std::lock_guard lock{store.mutex};
+  chunk_data_remove_user(store, memfile, data);
+}
+
+/**
+ * Account the memory of data whose memfile has been freed to a remaining memfile that uses it,
+ * so that the undo memory limit takes all retained memory into account.
+ */
+static void chunk_store_adopt_orphaned_data()
+{
+  if (g_chunk_store == nullptr) {
+    return;
+  }
+  MemFileChunkStore &store = *g_chunk_store;
+  std::lock_guard lock{store.mutex};
+  for (MemFile *memfile : store.memfiles) {
+    if (store.orphaned_data.is_empty()) {
+      break;
+    }
+    LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+      MemFileChunkData *data = chunk->data;
+      if (data->owner == nullptr) {
+        data->owner = memfile;
+        memfile->size += chunk_data_memory_size(data);
+        store.orphaned_data.remove(data);
+      }
+    }
+  }
+}
+
+/** \} */
+
 /* **************** support for memory-write, for undo buffers *************** */
 
 void BLO_memfile_free(MemFile *memfile)
 {
+  if (g_chunk_store) {
+    std::lock_guard lock{g_chunk_store->mutex};
+    g_chunk_store->memfiles.remove(memfile);
+  }
   while (MemFileChunk *chunk = static_cast<MemFileChunk *>(BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
-    }
+    chunk_store_remove_user(memfile, chunk->data);
     MEM_freeN(chunk);
   }
   MEM_delete(memfile->shared_storage);
   memfile->shared_storage = nullptr;
   memfile->size = 0;
+  chunk_store_adopt_orphaned_data();
+  chunk_store_free_if_unused();
 }
 
 MemFileSharedStorage::~MemFileSharedStorage()
@@ -59,29 +434,31 @@ MemFileSharedStorage::~MemFileSharedStorage()
 
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
-  /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
-   * by it (i.e. shared with some previous memory steps). */
-  blender::Map<const char *, MemFileChunk *> buffer_to_second_memchunk;
-
-  /* First, detect all memchunks in second memfile that are not owned by it. */
-  LISTBASE_FOREACH (MemFileChunk *, sc, &second->chunks) {
-    if (sc->is_identical) {
-      buffer_to_second_memchunk.add(sc->buf, sc);
+  /* Data of chunks in the first memfile (the one we are removing) that changed compared to the
+   * step before it. */
+  blender::Set<const MemFileChunkData *> first_changed_data;
+  LISTBASE_FOREACH (MemFileChunk *, fc, &first->chunks) {
+    if (!fc->is_identical) {
+      first_changed_data.add(fc->data);
     }
   }
 
-  /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
-   * it is also used by the second memfile, transfer the ownership. */
-  LISTBASE_FOREACH (MemFileChunk *, fc, &first->chunks) {
-    if (!fc->is_identical) {
-      if (MemFileChunk *sc = buffer_to_second_memchunk.lookup_default(fc->buf, nullptr)) {
-        BLI_assert(sc->is_identical);
-        sc->is_identical = false;
-        fc->is_identical = true;
-      }
-      /* Note that if the second memfile does not use that chunk, we assume that the first one
-       * fully owns it without sharing it with any other memfile, and hence it should be freed with
-       * it. */
+  LISTBASE_FOREACH (MemFileChunk *, sc, &second->chunks) {
+    MemFileChunkData *data = sc->data;
+    /* Chunks of the second memfile are now compared to the step before the first one. Since data
+     * is shared by content, the chunk it was compared to is not known anymore, so be
+     * conservative and consider it changed when any chunk of the first memfile with that data
+     * changed. */
+    if (sc->is_identical && first_changed_data.contains(data)) {
+      sc->is_identical = false;
+    }
+    /* If data owned by the first memfile is also used by the second one, transfer the ownership.
+     * Otherwise the first one releases its user, and the data is freed if no other step uses
+     * it. */
+    if (data->owner == first) {
+      data->owner = second;
+      first->size -= chunk_data_memory_size(data);
+      second->size += chunk_data_memory_size(data);
     }
   }
 
@@ -95,10 +472,27 @@ void BLO_memfile_clear_future(MemFile *memfile)
   }
 }
 
+size_t BLO_memfile_size_get(MemFile *memfile)
+{
+  if (g_chunk_store == nullptr) {
+    return memfile->size;
+  }
+  std::lock_guard lock{g_chunk_store->mutex};
+  return memfile->size;
+}
+
 void BLO_memfile_write_init(MemFileWriteData *mem_data,
                             MemFile *written_memfile,
                             MemFile *reference_memfile)
 {
+  {
+    MemFileChunkStore &store = chunk_store_ensure();
+    std::lock_guard lock{store.mutex};
+    store.generation++;
+    store.writers++;
+    store.memfiles.add(written_memfile);
+  }
+
   mem_data->written_memfile = written_memfile;
   mem_data->reference_memfile = reference_memfile;
   mem_data->reference_current_chunk = reference_memfile ? static_cast<MemFileChunk *>(
@@ -124,6 +518,16 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
 void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
 {
   mem_data->id_session_uid_mapping.clear();
+
+  MemFileChunkStore &store = *g_chunk_store;
+  if (USER_EXPERIMENTAL_TEST(&U, use_undo_compression)) {
+    chunk_store_compress_cold(store);
+  }
+  {
+    std::lock_guard lock{store.mutex};
+    store.writers--;
+  }
+  chunk_store_free_if_unused();
 }
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
@@ -134,7 +538,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   MemFileChunk *curchunk = static_cast<MemFileChunk *>(
       MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk"));
   curchunk->size = size;
-  curchunk->buf = nullptr;
+  curchunk->data = chunk_store_add(memfile, buf, size);
   curchunk->is_identical = false;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
@@ -143,26 +547,15 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   curchunk->id_session_uid = mem_data->current_id_session_uid;
   BLI_addtail(&memfile->chunks, curchunk);
 
-  /* we compare compchunk with buf */
+  /* Chunks with the same content share their data, so comparing it is enough. */
   if (*compchunk_step != nullptr) {
     MemFileChunk *compchunk = *compchunk_step;
-    if (compchunk->size == curchunk->size) {
-      if (memcmp(compchunk->buf, buf, size) == 0) {
-        curchunk->buf = compchunk->buf;
-        curchunk->is_identical = true;
-        compchunk->is_identical_future = true;
-      }
+    if (compchunk->data == curchunk->data) {
+      curchunk->is_identical = true;
+      compchunk->is_identical_future = true;
     }
     *compchunk_step = static_cast<MemFileChunk *>(compchunk->next);
   }
-
-  /* not equal... */
-  if (curchunk->buf == nullptr) {
-    char *buf_new = static_cast<char *>(MEM_mallocN(size, "Chunk buffer"));
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
-    memfile->size += size;
-  }
 }
 
 Main *BLO_memfile_main_get(MemFile *memfile, Main *bmain, Scene **r_scene)
@@ -184,6 +577,22 @@ Main *BLO_memfile_main_get(MemFile *memfile, Main *bmain, Scene **r_scene)
   return bmain_undo;
 }
 
+/** Returns the uncompressed data of the chunk, decompressing it if necessary. */
+static const char *undo_chunk_buf_get(UndoReader *undo, const MemFileChunk *chunk)
+{
+  MemFileChunkData *data = chunk->data;
+  std::lock_guard lock{g_chunk_store->mutex};
+  if (data->buf) {
+    return data->buf;
+  }
+  if (undo->decompressed_data != data) {
+    MEM_SAFE_FREE(undo->decompressed_buf);
+    undo->decompressed_buf = chunk_data_decompress(data);
+    undo->decompressed_data = undo->decompressed_buf ? data : nullptr;
+  }
+  return undo->decompressed_buf;
+}
+
 static int64_t undo_read(FileReader *reader, void *buffer, size_t size)
 {
   UndoReader *undo = (UndoReader *)reader;
@@ -240,7 +649,12 @@ static int64_t undo_read(FileReader *reader, void *buffer, size_t size)
         readsize = chunk->size - chunkoffset;
       }
 
-      memcpy(POINTER_OFFSET(buffer, totread), chunk->buf + chunkoffset, readsize);
+      const char *chunk_buf = undo_chunk_buf_get(undo, chunk);
+      if (chunk_buf == nullptr) {
+        printf("illegal read, chunk data cannot be decompressed\n");
+        return 0;
+      }
+      memcpy(POINTER_OFFSET(buffer, totread), chunk_buf + chunkoffset, readsize);
       totread += readsize;
       undo->reader.offset += (off64_t)readsize;
       seek += readsize;
@@ -261,6 +675,8 @@ static int64_t undo_read(FileReader *reader, void *buffer, size_t size)
 
 static void undo_close(FileReader *reader)
 {
+  UndoReader *undo = (UndoReader *)reader;
+  MEM_SAFE_FREE(undo->decompressed_buf);
   MEM_freeN(reader);
 }
 
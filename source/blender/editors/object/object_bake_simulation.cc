@@ -215,9 +215,16 @@ struct NodeBakeRequest {
   std::optional<bake::BakePath> path;
   int frame_start;
   int frame_end;
+  bake::BlobCompression compression = bake::BlobCompression::None;
   std::unique_ptr<bake::BlobWriteSharing> blob_sharing;
 };
 
+static bake::BlobCompression get_bake_compression(const NodesModifierBake &bake)
+{
+  return (bake.flag & NODES_MODIFIER_BAKE_COMPRESS) ? bake::BlobCompression::Zstd :
+                                                      bake::BlobCompression::None;
+}
+
 struct BakeGeometryNodesJob {
   wmWindowManager *wm;
   Main *bmain;
@@ -325,6 +332,7 @@ static void bake_geometry_nodes_startjob(void *customdata, wmJobWorkerStatus *wo
                       (frame_file_name + ".json").c_str());
         BLI_file_ensure_parent_dir_exists(meta_path);
         bake::DiskBlobWriter blob_writer{request.path->blobs_dir, frame_file_name};
+        blob_writer.set_compression(request.compression);
         fstream meta_file{meta_path, std::ios::out};
         bake::serialize_bake(frame_cache.state, blob_writer, *request.blob_sharing, meta_file);
         written_size += blob_writer.written_size();
@@ -334,6 +342,7 @@ static void bake_geometry_nodes_startjob(void *customdata, wmJobWorkerStatus *wo
         PackedBake &packed_data = packed_data_by_bake.lookup_or_add_default(&request);
 
         bake::MemoryBlobWriter blob_writer{frame_file_name};
+        blob_writer.set_compression(request.compression);
         std::ostringstream meta_file{std::ios::binary};
         bake::serialize_bake(frame_cache.state, blob_writer, *request.blob_sharing, meta_file);
 
@@ -623,6 +632,9 @@ static Vector<NodeBakeRequest> collect_simulations_to_bake(Main &bmain,
         request.bake_id = id;
         request.node_type = node->type_legacy;
         request.blob_sharing = std::make_unique<bake::BlobWriteSharing>();
+        if (const NodesModifierBake *bake = nmd->find_bake(id)) {
+          request.compression = get_bake_compression(*bake);
+        }
         if (bake::get_node_bake_target(*object, *nmd, id) == NODES_MODIFIER_BAKE_TARGET_DISK) {
           request.path = bake::get_node_bake_path(bmain, *object, *nmd, id);
         }
@@ -952,6 +964,7 @@ static Vector<NodeBakeRequest> bake_single_node_gather_bake_request(bContext *C,
   if (!bake) {
     return {};
   }
+  request.compression = get_bake_compression(*bake);
   if (bake::get_node_bake_target(*object, nmd, bake_id) == NODES_MODIFIER_BAKE_TARGET_DISK) {
     request.path = bake::get_node_bake_path(*bmain, *object, nmd, bake_id);
     if (!request.path) {
@@ -52,6 +52,7 @@
 #include "BKE_scene.hh"
 #include "BKE_subdiv_ccg.hh"
 #include "BKE_subdiv_modifier.hh"
+#include "BKE_undo_system.hh"
 
 #include "DEG_depsgraph_query.hh"
 
@@ -674,6 +675,25 @@ const char *ED_info_statusbar_string_ex(Main *bmain,
     uintptr_t mem_in_use = MEM_get_memory_in_use();
     BLI_str_format_byte_unit(formatted_mem, mem_in_use, false);
     ofs += BLI_snprintf_rlen(info + ofs, len, IFACE_("Memory: %s"), formatted_mem);
+
+    /* Undo memory, in total and for the active step. */
+    const wmWindowManager *wm = static_cast<const wmWindowManager *>(bmain->wm.first);
+    const UndoStack *ustack = wm ? wm->undo_stack : nullptr;
+    if (ustack && ustack->step_active) {
+      size_t undo_size = 0;
+      LISTBASE_FOREACH (const UndoStep *, us, &ustack->steps) {
+        undo_size += us->data_size;
+      }
+      char formatted_undo_step[BLI_STR_FORMAT_INT64_BYTE_UNIT_SIZE];
+      BLI_str_format_byte_unit(formatted_mem, int64_t(undo_size), false);
+      BLI_str_format_byte_unit(
+          formatted_undo_step, int64_t(ustack->step_active->data_size), false);
+      ofs += BLI_snprintf_rlen(info + ofs,
+                               len - ofs,
+                               IFACE_(" (Undo: %s, Step: %s)"),
+                               formatted_mem,
+                               formatted_undo_step);
+    }
   }
 
   /* GPU VRAM status. */
@@ -2973,6 +2973,53 @@ static std::optional<NodeExtraInfoRow> node_get_execution_time_label_row(
   return row;
 }
 
+static std::optional<NodeExtraInfoRow> node_get_memoization_row(TreeDrawContext &tree_draw_ctx,
+                                                                const bNode &node)
+{
+  geo_log::GeoTreeLog *tree_log = [&]() -> geo_log::GeoTreeLog * {
+    const bNodeTreeZones *zones = node.owner_tree().zones();
+    if (!zones) {
+      return nullptr;
+    }
+    const bNodeTreeZone *zone = zones->get_zone_by_node(node.identifier);
+    return tree_draw_ctx.geo_log_by_zone.lookup_default(zone, nullptr);
+  }();
+  if (tree_log == nullptr) {
+    return std::nullopt;
+  }
+  tree_log->ensure_execution_times();
+  const geo_log::GeoNodeLog *node_log = tree_log->nodes.lookup_ptr(node.identifier);
+  if (node_log == nullptr) {
+    return std::nullopt;
+  }
+  const int hits = node_log->memoization_hits;
+  const int total = hits + node_log->memoization_misses;
+  if (total == 0) {
+    return std::nullopt;
+  }
+
+  NodeExtraInfoRow row;
+  if (hits == total) {
+    row.text = RPT_("Reused");
+  }
+  else if (hits == 0) {
+    row.text = RPT_("Computed");
+  }
+  else {
+    row.text = fmt::format(fmt::runtime(RPT_("{}/{} Reused")), hits, total);
+  }
+  if (node_log->memoized_bytes > 0) {
+    char memory_str[BLI_STR_FORMAT_INT64_BYTE_UNIT_SIZE];
+    BLI_str_format_byte_unit(memory_str, node_log->memoized_bytes, false);
+    row.text += fmt::format(" ({})", memory_str);
+  }
+  row.tooltip = TIP_(
+      "Whether the outputs from the previous evaluation were reused because the inputs of the "
+      "node did not change, and the memory used to keep the outputs for the next evaluation");
+  row.icon = ICON_FILE_CACHE;
+  return row;
+}
+
 static void node_get_compositor_extra_info(TreeDrawContext &tree_draw_ctx,
                                            const SpaceNode &snode,
                                            const bNode &node,
@@ -3076,6 +3123,11 @@ static Vector<NodeExtraInfoRow> node_get_extra_info(const bContext &C,
     if (row.has_value()) {
       rows.append(std::move(*row));
     }
+    if (std::optional<NodeExtraInfoRow> memoization_row = node_get_memoization_row(tree_draw_ctx,
+                                                                                  node))
+    {
+      rows.append(std::move(*memoization_row));
+    }
   }
 
   geo_log::GeoTreeLog *tree_log = [&]() -> geo_log::GeoTreeLog * {
@@ -83,6 +83,14 @@ static bool memfile_undosys_step_encode(bContext * /*C*/, Main *bmain, UndoStep
   us->data = BKE_memfile_undo_encode(bmain, us_prev ? us_prev->data : nullptr);
   us->step.data_size = us->data->undo_size;
 
+  /* Chunk data is shared between all memfile steps and older data may have been compressed,
+   * which changes the memory accounted to previous steps too. */
+  LISTBASE_FOREACH (UndoStep *, us_iter, &ustack->steps) {
+    if (us_iter->type == BKE_UNDOSYS_TYPE_MEMFILE && us_iter != us_p) {
+      us_iter->data_size = BLO_memfile_size_get(&((MemFileUndoStep *)us_iter)->data->memfile);
+    }
+  }
+
   /* Store the fact that we should not re-use old data with that undo step, and reset the Main
    * flag. */
   us->step.use_old_bmain_data = !bmain->use_memfile_full_barrier;
@@ -71,6 +71,7 @@ enum class ValueUsage : uint8_t {
 };
 
 class LazyFunction;
+class GraphExecutorTracer;
 
 /**
  * Extension of #UserData that is thread-local. This avoids accessing e.g.
@@ -97,6 +98,11 @@ class UserData {
    * Get thread local data for this user-data and the current thread.
    */
   virtual destruct_ptr<LocalUserData> get_local(LinearAllocator<> &allocator);
+
+  /**
+   * Get the tracer that records the execution of nodes in graph executors, if any.
+   */
+  virtual GraphExecutorTracer *graph_executor_tracer();
 };
 
 /**
@@ -0,0 +1,99 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup fn
+ *
+ * A #GraphExecutorTracer records which nodes a #GraphExecutor executes, when and on which thread.
+ * It also records how long a node waited to be started after it was scheduled and how long it
+ * waited for node locks. This helps to find out why the evaluation of a graph does not scale to
+ * many threads. The recorded data can be exported in the Chrome trace event format, which can be
+ * viewed with e.g. `chrome://tracing` or Perfetto.
+ *
+ * The tracer can also find the critical path of each graph from the recorded execution times. When
+ * critical path scheduling is enabled, the executor starts the nodes with the longest remaining
+ * path first in the following evaluations, so that fewer threads are idle at the end.
+ *
+ * The tracer is passed to the executor with #UserData::graph_executor_tracer. It can be shared by
+ * multiple graph executors and threads. Geometry nodes modifiers use a tracer when the
+ * `BLENDER_GEOMETRY_NODES_TRACE` or `BLENDER_GEOMETRY_NODES_CRITICAL_PATH` environment variables
+ * are set.
+ */
+
+#include <mutex>
+#include <thread>
+
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_map.hh"
+#include "BLI_timeit.hh"
+
+#include "FN_lazy_function_graph.hh"
+
+namespace blender::fn::lazy_function {
+
+class GraphExecutorTracer : NonCopyable, NonMovable {
+ public:
+  struct NodeExecution {
+    const Graph *graph;
+    const FunctionNode *node;
+    std::thread::id thread;
+    /** When the node was scheduled to run. */
+    timeit::TimePoint schedule_time;
+    timeit::TimePoint start_time;
+    timeit::TimePoint end_time;
+    /** Time the thread spent waiting for node locks while running the node. */
+    timeit::Nanoseconds lock_wait_time;
+  };
+
+ private:
+  bool use_critical_path_scheduling_;
+  /** Recorded on every thread separately to avoid synchronization. */
+  mutable threading::EnumerableThreadSpecific<Vector<NodeExecution>> node_executions_;
+
+  mutable std::mutex critical_paths_mutex_;
+  /**
+   * Length of the longest path from each node to the end of the graph in nanoseconds, indexed by
+   * #Node::index_in_graph. Only contains the graphs from the previous evaluation.
+   */
+  Map<const Graph *, std::shared_ptr<const Array<int64_t>>> critical_path_lengths_;
+
+ public:
+  explicit GraphExecutorTracer(bool use_critical_path_scheduling = false);
+
+  bool use_critical_path_scheduling() const
+  {
+    return use_critical_path_scheduling_;
+  }
+
+  /** Called by the executor when a node has been executed. */
+  void add_node_execution(const NodeExecution &execution);
+
+  /**
+   * All recorded node executions sorted by their start time. This must not be called while graphs
+   * are evaluated with this tracer.
+   */
+  Vector<NodeExecution> node_executions() const;
+
+  /**
+   * Write the recorded node executions as Chrome trace JSON. This must not be called while graphs
+   * are evaluated with this tracer.
+   */
+  void export_chrome_trace(std::ostream &stream) const;
+
+  /**
+   * Find the critical paths for the next evaluation from the recorded node executions and clear
+   * them. This must not be called while graphs are evaluated with this tracer.
+   */
+  void finish_evaluation();
+
+  /**
+   * Get the critical path lengths that were found in the previous evaluation for every node of the
+   * graph, or null if the graph wasn't evaluated.
+   */
+  std::shared_ptr<const Array<int64_t>> critical_path_lengths(const Graph &graph) const;
+};
+
+}  // namespace blender::fn::lazy_function
@@ -73,4 +73,9 @@ destruct_ptr<LocalUserData> UserData::get_local(LinearAllocator<> & /*allocator*
   return {};
 }
 
+GraphExecutorTracer *UserData::graph_executor_tracer()
+{
+  return nullptr;
+}
+
 }  // namespace blender::fn::lazy_function
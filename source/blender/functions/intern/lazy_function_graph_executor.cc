@@ -51,6 +51,7 @@
 #include "BLI_task.hh"
 
 #include "FN_lazy_function_graph_executor.hh"
+#include "FN_lazy_function_graph_executor_tracer.hh"
 
 namespace blender::fn::lazy_function {
 
@@ -183,6 +184,10 @@ struct NodeState {
    * Custom storage of the node.
    */
   void *storage = nullptr;
+  /**
+   * When the node has been scheduled most recently. This is only set when the execution is traced.
+   */
+  timeit::TimePoint schedule_time;
 };
 
 /**
@@ -234,15 +239,33 @@ struct ScheduledNodes {
     }
   }
 
-  const FunctionNode *pop_next_node()
+  /**
+   * \param critical_path_lengths: If not empty, the normal node with the longest remaining path
+   * in the graph is run next. Otherwise, the most recently scheduled node is run next.
+   */
+  const FunctionNode *pop_next_node(const Span<int64_t> critical_path_lengths)
   {
     if (!this->priority_.is_empty()) {
       return this->priority_.pop_last();
     }
-    if (!this->normal_.is_empty()) {
+    if (this->normal_.is_empty()) {
+      return nullptr;
+    }
+    if (critical_path_lengths.is_empty()) {
       return this->normal_.pop_last();
     }
-    return nullptr;
+    /* Prefer more recently scheduled nodes when the lengths are the same, for better locality. */
+    int64_t best_index = normal_.size() - 1;
+    for (int64_t i = normal_.size() - 2; i >= 0; i--) {
+      if (critical_path_lengths[normal_[i]->index_in_graph()] >
+          critical_path_lengths[normal_[best_index]->index_in_graph()])
+      {
+        best_index = i;
+      }
+    }
+    const FunctionNode *node = normal_[best_index];
+    normal_.remove(best_index);
+    return node;
   }
 
   bool is_empty() const
@@ -286,6 +309,12 @@ struct CurrentTask {
   std::atomic<bool> has_scheduled_nodes = false;
 };
 
+/**
+ * Time that the current thread has waited for node locks. Only measured when the execution is
+ * traced.
+ */
+static thread_local timeit::Nanoseconds lock_wait_time_in_thread{0};
+
 class Executor {
  private:
   const GraphExecutor &self_;
@@ -308,6 +337,15 @@ class Executor {
    * If this is empty, the executor is in single threaded mode.
    */
   std::atomic<TaskPool *> task_pool_ = nullptr;
+  /**
+   * Optional tracer provided by the caller. This is only set while the graph is executed.
+   */
+  GraphExecutorTracer *tracer_ = nullptr;
+  /**
+   * Learned by the tracer in the previous evaluation to run the nodes on the critical path first.
+   * Indexed by #Node::index_in_graph.
+   */
+  std::shared_ptr<const Array<int64_t>> critical_path_lengths_;
 #ifdef FN_LAZY_FUNCTION_DEBUG_THREADS
   std::thread::id current_main_thread_;
 #endif
@@ -368,6 +406,7 @@ class Executor {
   {
     params_ = &params;
     context_ = &context;
+    tracer_ = context.user_data ? context.user_data->graph_executor_tracer() : nullptr;
 #ifdef FN_LAZY_FUNCTION_DEBUG_THREADS
     current_main_thread_ = std::this_thread::get_id();
 #endif
@@ -375,6 +414,7 @@ class Executor {
       /* Make sure the pointers are not dangling, even when it shouldn't be accessed by anyone. */
       params_ = nullptr;
       context_ = nullptr;
+      tracer_ = nullptr;
       is_first_execution_ = false;
 #ifdef FN_LAZY_FUNCTION_DEBUG_THREADS
       current_main_thread_ = {};
@@ -415,6 +455,16 @@ class Executor {
 
       this->initialize_static_value_usages(side_effect_nodes);
       this->schedule_side_effect_nodes(side_effect_nodes, current_task, local_data);
+
+      if (tracer_ != nullptr && tracer_->use_critical_path_scheduling()) {
+        critical_path_lengths_ = tracer_->critical_path_lengths(self_.graph_);
+        if (critical_path_lengths_ &&
+            critical_path_lengths_->size() != self_.graph_.nodes().size())
+        {
+          /* The graph has changed since the critical path was found. */
+          critical_path_lengths_.reset();
+        }
+      }
     }
 
     this->schedule_for_new_output_usages(current_task, local_data);
@@ -740,6 +790,9 @@ class Executor {
     switch (locked_node.node_state.schedule_state) {
       case NodeScheduleState::NotScheduled: {
         locked_node.node_state.schedule_state = NodeScheduleState::Scheduled;
+        if (tracer_ != nullptr) {
+          locked_node.node_state.schedule_time = timeit::Clock::now();
+        }
         const FunctionNode &node = static_cast<const FunctionNode &>(locked_node.node);
         if (this->use_multi_threading()) {
           std::lock_guard lock{current_task.mutex};
@@ -774,7 +827,7 @@ class Executor {
 
     LockedNode locked_node{node, node_state};
     if (this->use_multi_threading()) {
-      std::lock_guard lock{node_state.mutex};
+      std::unique_lock lock = this->lock_node(node_state);
       threading::isolate_task([&]() { f(locked_node); });
     }
     else {
@@ -787,6 +840,20 @@ class Executor {
         locked_node.delayed_unused_outputs, current_task, local_data);
   }
 
+  std::unique_lock<std::mutex> lock_node(NodeState &node_state)
+  {
+    if (tracer_ == nullptr) {
+      return std::unique_lock{node_state.mutex};
+    }
+    std::unique_lock lock{node_state.mutex, std::try_to_lock};
+    if (!lock.owns_lock()) {
+      const timeit::TimePoint start_time = timeit::Clock::now();
+      lock.lock();
+      lock_wait_time_in_thread += timeit::Clock::now() - start_time;
+    }
+    return lock;
+  }
+
   void send_output_required_notifications(const Span<const OutputSocket *> sockets,
                                           CurrentTask &current_task,
                                           const LocalData &local_data)
@@ -807,7 +874,12 @@ class Executor {
 
   void run_task(CurrentTask &current_task, const LocalData &local_data)
   {
-    while (const FunctionNode *node = current_task.scheduled_nodes.pop_next_node()) {
+    const Span<int64_t> critical_path_lengths = critical_path_lengths_ ?
+                                                    critical_path_lengths_->as_span() :
+                                                    Span<int64_t>();
+    while (const FunctionNode *node = current_task.scheduled_nodes.pop_next_node(
+               critical_path_lengths))
+    {
       if (current_task.scheduled_nodes.is_empty()) {
         current_task.has_scheduled_nodes.store(false, std::memory_order_relaxed);
       }
@@ -834,11 +906,15 @@ class Executor {
     Context local_context{context_->storage, context_->user_data, local_data.local_user_data};
     const LazyFunction &fn = node.function();
 
+    const timeit::Nanoseconds lock_wait_time_before = lock_wait_time_in_thread;
+    timeit::TimePoint schedule_time;
+
     bool node_needs_execution = false;
     this->with_locked_node(
         node, node_state, current_task, local_data, [&](LockedNode &locked_node) {
           BLI_assert(node_state.schedule_state == NodeScheduleState::Scheduled);
           node_state.schedule_state = NodeScheduleState::Running;
+          schedule_time = node_state.schedule_time;
 
           if (node_state.node_has_finished) {
             return;
@@ -921,7 +997,21 @@ class Executor {
       /* Importantly, the node must not be locked when it is executed. That would result in locks
        * being hold very long in some cases and results in multiple locks being hold by the same
        * thread in the same graph which can lead to deadlocks. */
-      this->execute_node(node, node_state, current_task, local_data);
+      if (tracer_ == nullptr) {
+        this->execute_node(node, node_state, current_task, local_data);
+      }
+      else {
+        GraphExecutorTracer::NodeExecution execution;
+        execution.graph = &self_.graph_;
+        execution.node = &node;
+        execution.thread = std::this_thread::get_id();
+        execution.schedule_time = schedule_time;
+        execution.start_time = timeit::Clock::now();
+        this->execute_node(node, node_state, current_task, local_data);
+        execution.end_time = timeit::Clock::now();
+        execution.lock_wait_time = lock_wait_time_in_thread - lock_wait_time_before;
+        tracer_->add_node_execution(execution);
+      }
     }
 
     this->with_locked_node(
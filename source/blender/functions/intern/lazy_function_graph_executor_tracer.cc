@@ -0,0 +1,184 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <algorithm>
+
+#include "BLI_serialize.hh"
+#include "BLI_stack.hh"
+
+#include "FN_lazy_function_graph_executor_tracer.hh"
+
+namespace blender::fn::lazy_function {
+
+GraphExecutorTracer::GraphExecutorTracer(const bool use_critical_path_scheduling)
+    : use_critical_path_scheduling_(use_critical_path_scheduling)
+{
+}
+
+void GraphExecutorTracer::add_node_execution(const NodeExecution &execution)
+{
+  node_executions_.local().append(execution);
+}
+
+Vector<GraphExecutorTracer::NodeExecution> GraphExecutorTracer::node_executions() const
+{
+  Vector<NodeExecution> executions;
+  for (const Vector<NodeExecution> &local_executions : node_executions_) {
+    executions.extend(local_executions);
+  }
+  std::sort(executions.begin(),
+            executions.end(),
+            [](const NodeExecution &a, const NodeExecution &b) {
+              return a.start_time < b.start_time;
+            });
+  return executions;
+}
+
+static double to_microseconds(const timeit::Nanoseconds duration)
+{
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+void GraphExecutorTracer::export_chrome_trace(std::ostream &stream) const
+{
+  using namespace io::serialize;
+
+  const Vector<NodeExecution> executions = this->node_executions();
+
+  DictionaryValue root;
+  ArrayValue &events = *root.append_array("traceEvents");
+
+  /* Use small thread indices instead of the platform specific identifiers. There are only few
+   * threads, so a linear search is fine. */
+  Vector<std::thread::id> threads;
+  Array<int> thread_indices(executions.size());
+  for (const int i : executions.index_range()) {
+    const std::thread::id thread = executions[i].thread;
+    int thread_index = threads.first_index_of_try(thread);
+    if (thread_index != -1) {
+      thread_indices[i] = thread_index;
+      continue;
+    }
+    thread_index = threads.append_and_get_index(thread);
+    thread_indices[i] = thread_index;
+    DictionaryValue &event = *events.append_dict();
+    event.append_str("name", "thread_name");
+    event.append_str("ph", "M");
+    event.append_int("pid", 0);
+    event.append_int("tid", thread_index);
+    DictionaryValue &args = *event.append_dict("args");
+    args.append_str("name", "Thread " + std::to_string(thread_index));
+  }
+
+  if (!executions.is_empty()) {
+    const timeit::TimePoint begin_time = executions.first().start_time;
+    for (const int i : executions.index_range()) {
+      const NodeExecution &execution = executions[i];
+      DictionaryValue &event = *events.append_dict();
+      event.append_str("name", execution.node->name());
+      event.append_str("cat", execution.graph->name());
+      event.append_str("ph", "X");
+      event.append_double("ts", to_microseconds(execution.start_time - begin_time));
+      event.append_double("dur", to_microseconds(execution.end_time - execution.start_time));
+      event.append_int("pid", 0);
+      event.append_int("tid", thread_indices[i]);
+      DictionaryValue &args = *event.append_dict("args");
+      args.append_double("schedule_latency_us",
+                         to_microseconds(execution.start_time - execution.schedule_time));
+      args.append_double("lock_wait_us", to_microseconds(execution.lock_wait_time));
+    }
+  }
+
+  JsonFormatter formatter;
+  formatter.serialize(stream, root);
+}
+
+/**
+ * Find the length of the longest path from every node to the end of the graph, where the length
+ * of a path is the total execution time of its nodes. Links that would close a cycle are ignored.
+ */
+static Array<int64_t> compute_critical_path_lengths(const Graph &graph,
+                                                    const Span<int64_t> node_durations)
+{
+  const Span<const Node *> nodes = graph.nodes();
+  Array<int64_t> lengths(nodes.size(), -1);
+  Array<bool> is_in_progress(nodes.size(), false);
+
+  /* Depth-first search that computes the lengths of all targets of a node before the node. */
+  Stack<const Node *> nodes_to_check;
+  for (const Node *start_node : nodes) {
+    nodes_to_check.push(start_node);
+    while (!nodes_to_check.is_empty()) {
+      const Node &node = *nodes_to_check.peek();
+      const int node_index = node.index_in_graph();
+      if (lengths[node_index] != -1) {
+        nodes_to_check.pop();
+        continue;
+      }
+      is_in_progress[node_index] = true;
+      bool all_targets_done = true;
+      int64_t max_target_length = 0;
+      for (const OutputSocket *output_socket : node.outputs()) {
+        for (const InputSocket *target_socket : output_socket->targets()) {
+          const Node &target_node = target_socket->node();
+          const int target_index = target_node.index_in_graph();
+          if (lengths[target_index] != -1) {
+            max_target_length = std::max(max_target_length, lengths[target_index]);
+          }
+          else if (!is_in_progress[target_index]) {
+            nodes_to_check.push(&target_node);
+            all_targets_done = false;
+          }
+        }
+      }
+      if (all_targets_done) {
+        lengths[node_index] = node_durations[node_index] + max_target_length;
+        is_in_progress[node_index] = false;
+        nodes_to_check.pop();
+      }
+    }
+  }
+  return lengths;
+}
+
+void GraphExecutorTracer::finish_evaluation()
+{
+  if (!use_critical_path_scheduling_) {
+    for (Vector<NodeExecution> &local_executions : node_executions_) {
+      local_executions.clear();
+    }
+    return;
+  }
+
+  /* Accumulate the execution times of nodes that are executed more than once, e.g. because their
+   * graph is used multiple times. */
+  Map<const Graph *, Array<int64_t>> node_durations_by_graph;
+  for (Vector<NodeExecution> &local_executions : node_executions_) {
+    for (const NodeExecution &execution : local_executions) {
+      Array<int64_t> &node_durations = node_durations_by_graph.lookup_or_add_cb(
+          execution.graph, [&]() { return Array<int64_t>(execution.graph->nodes().size(), 0); });
+      const timeit::Nanoseconds duration = execution.end_time - execution.start_time;
+      node_durations[execution.node->index_in_graph()] += duration.count();
+    }
+    local_executions.clear();
+  }
+
+  Map<const Graph *, std::shared_ptr<const Array<int64_t>>> critical_path_lengths;
+  for (const auto item : node_durations_by_graph.items()) {
+    critical_path_lengths.add_new(item.key,
+                                  std::make_shared<const Array<int64_t>>(
+                                      compute_critical_path_lengths(*item.key, item.value)));
+  }
+  std::lock_guard lock{critical_paths_mutex_};
+  critical_path_lengths_ = std::move(critical_path_lengths);
+}
+
+std::shared_ptr<const Array<int64_t>> GraphExecutorTracer::critical_path_lengths(
+    const Graph &graph) const
+{
+  std::lock_guard lock{critical_paths_mutex_};
+  return critical_path_lengths_.lookup_default(&graph, nullptr);
+}
+
+}  // namespace blender::fn::lazy_function
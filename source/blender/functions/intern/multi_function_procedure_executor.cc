@@ -148,8 +148,18 @@ class ValueAllocator : NonCopyable, NonMovable {
   Stack<void *> small_single_value_free_list_;
   Map<const CPPType *, Stack<void *>> single_value_free_lists_;
 
+  /**
+   * Span buffers are allocated with at least this many elements. This allows reusing buffers when
+   * the allocator is used for multiple masks with different sizes, as long as none of them needs
+   * larger buffers.
+   */
+  int min_span_size_;
+
  public:
-  ValueAllocator(LinearAllocator<> &linear_allocator) : linear_allocator_(linear_allocator) {}
+  ValueAllocator(LinearAllocator<> &linear_allocator, const int min_span_size = 0)
+      : linear_allocator_(linear_allocator), min_span_size_(min_span_size)
+  {
+  }
 
   VariableValue_GVArray *obtain_GVArray(const GVArray &varray)
   {
@@ -168,6 +178,8 @@ class ValueAllocator : NonCopyable, NonMovable {
 
   VariableValue_Span *obtain_Span(const CPPType &type, int size)
   {
+    BLI_assert(min_span_size_ == 0 || size <= min_span_size_);
+    size = std::max(size, min_span_size_);
     void *buffer = nullptr;
 
     const int64_t element_size = type.size();
@@ -813,17 +825,18 @@ class VariableState : NonCopyable, NonMovable {
 /** Keeps track of the states of all variables during evaluation. */
 class VariableStates {
  private:
-  ValueAllocator value_allocator_;
+  /** May be shared with other evaluations of the same procedure, to reuse buffers. */
+  ValueAllocator &value_allocator_;
   const Procedure &procedure_;
   /** The state of every variable, indexed by #Variable::index_in_procedure(). */
   Array<VariableState> variable_states_;
   const IndexMask &full_mask_;
 
  public:
-  VariableStates(LinearAllocator<> &linear_allocator,
+  VariableStates(ValueAllocator &value_allocator,
                  const Procedure &procedure,
                  const IndexMask &full_mask)
-      : value_allocator_(linear_allocator),
+      : value_allocator_(value_allocator),
         procedure_(procedure),
         variable_states_(procedure.variables().size()),
         full_mask_(full_mask)
@@ -1157,19 +1170,18 @@ class InstructionScheduler {
   }
 };
 
-void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context context) const
+static void execute_procedure(const ProcedureExecutor &fn,
+                              const Procedure &procedure,
+                              const IndexMask &full_mask,
+                              Params params,
+                              const Context &context,
+                              ValueAllocator &value_allocator)
 {
-  BLI_assert(procedure_.validate());
-
-  AlignedBuffer<512, 64> local_buffer;
-  LinearAllocator<> linear_allocator;
-  linear_allocator.provide_buffer(local_buffer);
-
-  VariableStates variable_states{linear_allocator, procedure_, full_mask};
-  variable_states.add_initial_variable_states(*this, procedure_, params);
+  VariableStates variable_states{value_allocator, procedure, full_mask};
+  variable_states.add_initial_variable_states(fn, procedure, params);
 
   InstructionScheduler scheduler;
-  scheduler.add_referenced_indices(*procedure_.entry(), full_mask);
+  scheduler.add_referenced_indices(*procedure.entry(), full_mask);
 
   /* Loop until all indices got to a return instruction. */
   while (!scheduler.is_done()) {
@@ -1218,9 +1230,9 @@ void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context
     }
   }
 
-  for (const int param_index : this->param_indices()) {
-    const ParamType param_type = this->param_type(param_index);
-    const Variable *variable = procedure_.params()[param_index].variable;
+  for (const int param_index : fn.param_indices()) {
+    const ParamType param_type = fn.param_type(param_index);
+    const Variable *variable = procedure.params()[param_index].variable;
     VariableState &variable_state = variable_states.get_variable_state(*variable);
     switch (param_type.interface_type()) {
       case ParamType::Input: {
@@ -1241,6 +1253,118 @@ void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context
   }
 }
 
+/**
+ * Number of indices that are processed by all instructions of the procedure before moving on to
+ * the next indices. Intermediate buffers only have to be that large, so that they can stay in the
+ * CPU cache instead of streaming every intermediate value through main memory once per
+ * instruction. Larger chunks reduce the per-instruction overhead.
+ */
+static constexpr int64_t fused_chunk_size = 1024;
+
+/**
+ * Processing the procedure in chunks only works when its parameters can be sliced. Also, functions
+ * that are expensive per index are better called with all indices at once, so that they can use
+ * multi-threading internally.
+ */
+static bool supports_fused_chunks(const ProcedureExecutor &fn, const Procedure &procedure)
+{
+  for (const int param_index : fn.param_indices()) {
+    if (fn.param_type(param_index).data_type().is_vector()) {
+      return false;
+    }
+  }
+  const int64_t default_grain_size = MultiFunction::ExecutionHints().min_grain_size;
+  for (const CallInstruction *instruction : procedure.call_instructions()) {
+    if (instruction->fn().execution_hints().min_grain_size < default_grain_size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Slice the input without the overhead of a wrapper virtual array for spans that own their data.
+ * That is fine, because the caller keeps the full input alive during the evaluation.
+ */
+static GVArray slice_varray_for_chunk(const GVArray &varray, const IndexRange slice)
+{
+  const CommonVArrayInfo info = varray.common_info();
+  if (info.type == CommonVArrayInfo::Type::Span) {
+    return GVArray::ForSpan(GSpan(varray.type(), info.data, varray.size()).slice(slice));
+  }
+  return varray.slice(slice);
+}
+
+static void add_chunk_parameters(const ProcedureExecutor &fn,
+                                 Params &full_params,
+                                 const IndexRange chunk_range,
+                                 ParamsBuilder &r_chunk_params)
+{
+  for (const int param_index : fn.param_indices()) {
+    switch (fn.param_type(param_index).category()) {
+      case ParamCategory::SingleInput: {
+        const GVArray &varray = full_params.readonly_single_input(param_index);
+        r_chunk_params.add_readonly_single_input(slice_varray_for_chunk(varray, chunk_range));
+        break;
+      }
+      case ParamCategory::SingleMutable: {
+        const GMutableSpan span = full_params.single_mutable(param_index);
+        r_chunk_params.add_single_mutable(span.slice(chunk_range));
+        break;
+      }
+      case ParamCategory::SingleOutput: {
+        const GMutableSpan span = full_params.uninitialized_single_output(param_index);
+        r_chunk_params.add_uninitialized_single_output(span.slice(chunk_range));
+        break;
+      }
+      case ParamCategory::VectorInput:
+      case ParamCategory::VectorMutable:
+      case ParamCategory::VectorOutput: {
+        BLI_assert_unreachable();
+        break;
+      }
+    }
+  }
+}
+
+void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context context) const
+{
+  BLI_assert(procedure_.validate());
+
+  AlignedBuffer<512, 64> local_buffer;
+  LinearAllocator<> linear_allocator;
+  linear_allocator.provide_buffer(local_buffer);
+
+  const IndexRange bounds = full_mask.bounds();
+  /* Sparse masks would result in many small chunks, whose overhead outweighs the benefit. */
+  const bool use_fused_chunks = full_mask.size() > fused_chunk_size &&
+                                full_mask.size() * 4 >= bounds.size() &&
+                                supports_fused_chunks(*this, procedure_);
+  if (!use_fused_chunks) {
+    ValueAllocator value_allocator{linear_allocator};
+    execute_procedure(*this, procedure_, full_mask, params, context, value_allocator);
+    return;
+  }
+
+  /* The same allocator is used for all chunks, so that intermediate buffers are reused. */
+  ValueAllocator value_allocator{linear_allocator, fused_chunk_size};
+  for (int64_t chunk_start = bounds.start(); chunk_start < bounds.one_after_last();
+       chunk_start += fused_chunk_size)
+  {
+    const IndexRange chunk_range = IndexRange::from_begin_end(
+        chunk_start, std::min(chunk_start + fused_chunk_size, bounds.one_after_last()));
+    IndexMaskMemory memory;
+    const IndexMask chunk_mask = full_mask.slice_content(chunk_range)
+                                     .shift(-chunk_range.start(), memory);
+    if (chunk_mask.is_empty()) {
+      continue;
+    }
+    ParamsBuilder chunk_params{*this, &chunk_mask};
+    add_chunk_parameters(*this, params, chunk_range, chunk_params);
+    execute_procedure(*this, procedure_, chunk_mask, chunk_params, context, value_allocator);
+  }
+}
+
 MultiFunction::ExecutionHints ProcedureExecutor::get_execution_hints() const
 {
   ExecutionHints hints;
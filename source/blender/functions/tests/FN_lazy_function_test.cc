@@ -7,6 +7,7 @@
 #include "FN_lazy_function_execute.hh"
 #include "FN_lazy_function_graph.hh"
 #include "FN_lazy_function_graph_executor.hh"
+#include "FN_lazy_function_graph_executor_tracer.hh"
 
 #include "BLI_task.h"
 
@@ -178,4 +179,83 @@ TEST(lazy_function, GraphWithCycle)
   EXPECT_EQ(result, 10 * 2 * 5);
 }
 
+class TracerUserData : public UserData {
+ public:
+  GraphExecutorTracer tracer{true};
+
+  GraphExecutorTracer *graph_executor_tracer() override
+  {
+    return &tracer;
+  }
+};
+
+TEST(lazy_function, Tracing)
+{
+  const AddLazyFunction add_fn;
+
+  /* A long chain of nodes and a single node that both depend on the input. */
+  Graph graph;
+  GraphInputSocket &input_socket = graph.add_input(CPPType::get<int>());
+  GraphOutputSocket &output_1 = graph.add_output(CPPType::get<int>());
+  GraphOutputSocket &output_2 = graph.add_output(CPPType::get<int>());
+  const int value_1 = 1;
+  OutputSocket *previous_socket = &input_socket;
+  Vector<FunctionNode *> chain_nodes;
+  for ([[maybe_unused]] const int i : IndexRange(5)) {
+    FunctionNode &node = graph.add_function(add_fn);
+    graph.add_link(*previous_socket, node.input(0));
+    node.input(1).set_default_value(&value_1);
+    previous_socket = &node.output(0);
+    chain_nodes.append(&node);
+  }
+  graph.add_link(*previous_socket, output_1);
+  FunctionNode &single_node = graph.add_function(add_fn);
+  graph.add_link(input_socket, single_node.input(0));
+  single_node.input(1).set_default_value(&value_1);
+  graph.add_link(single_node.output(0), output_2);
+  graph.update_node_indices();
+
+  GraphExecutor executor_fn{
+      graph, {&input_socket}, {&output_1, &output_2}, nullptr, nullptr, nullptr};
+
+  TracerUserData user_data;
+  for ([[maybe_unused]] const int evaluation : IndexRange(2)) {
+    int result_1 = 0;
+    int result_2 = 0;
+    execute_lazy_function_eagerly(executor_fn,
+                                  &user_data,
+                                  nullptr,
+                                  std::make_tuple(10),
+                                  std::make_tuple(&result_1, &result_2));
+    EXPECT_EQ(result_1, 15);
+    EXPECT_EQ(result_2, 11);
+
+    const Vector<GraphExecutorTracer::NodeExecution> executions =
+        user_data.tracer.node_executions();
+    EXPECT_EQ(executions.size(), 6);
+    for (const GraphExecutorTracer::NodeExecution &execution : executions) {
+      EXPECT_EQ(execution.graph, &graph);
+      EXPECT_LE(execution.schedule_time, execution.start_time);
+      EXPECT_LE(execution.start_time, execution.end_time);
+    }
+
+    std::stringstream stream;
+    user_data.tracer.export_chrome_trace(stream);
+    EXPECT_NE(stream.str().find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(stream.str().find("\"Add\""), std::string::npos);
+
+    user_data.tracer.finish_evaluation();
+    EXPECT_TRUE(user_data.tracer.node_executions().is_empty());
+  }
+
+  /* Nodes at the start of the chain have the longest remaining path. */
+  const std::shared_ptr<const Array<int64_t>> lengths = user_data.tracer.critical_path_lengths(
+      graph);
+  ASSERT_NE(lengths, nullptr);
+  for (const int i : chain_nodes.index_range().drop_back(1)) {
+    EXPECT_GE((*lengths)[chain_nodes[i]->index_in_graph()],
+              (*lengths)[chain_nodes[i + 1]->index_in_graph()]);
+  }
+}
+
 }  // namespace blender::fn::lazy_function::tests
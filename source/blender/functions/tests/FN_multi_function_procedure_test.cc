@@ -149,6 +149,74 @@ TEST(multi_function_procedure, BranchTest)
   EXPECT_EQ(values_a[4], 22);
 }
 
+TEST(multi_function_procedure, LargeMaskInChunks)
+{
+  /**
+   * procedure(float var1, bool var2, float *var4) {
+   *   float var3 = var1 * 2;
+   *   if (var2) {
+   *     var3 += 100;
+   *   }
+   *   var4 = var3 + var1;
+   * }
+   */
+
+  auto mul_2_fn = build::SI1_SO<float, float>("mul_2", [](float a) { return a * 2.0f; });
+  auto add_100_fn = build::SM<float>("add_100", [](float &a) { a += 100.0f; });
+  auto add_fn = build::SI2_SO<float, float, float>("add", [](float a, float b) { return a + b; });
+
+  Procedure procedure;
+  ProcedureBuilder builder{procedure};
+
+  Variable *var1 = &builder.add_single_input_parameter<float>();
+  Variable *var2 = &builder.add_single_input_parameter<bool>();
+  auto [var3] = builder.add_call<1>(mul_2_fn, {var1});
+  ProcedureBuilder::Branch branch = builder.add_branch(*var2);
+  branch.branch_true.add_call(add_100_fn, {var3});
+  builder.set_cursor_after_branch(branch);
+  auto [var4] = builder.add_call<1>(add_fn, {var3, var1});
+  builder.add_destruct({var1, var2, var3});
+  builder.add_return();
+  builder.add_output_parameter(*var4);
+
+  EXPECT_TRUE(procedure.validate());
+
+  ProcedureExecutor procedure_fn{procedure};
+
+  const int size = 5000;
+  Array<float> values_in(size);
+  Array<bool> values_cond(size);
+  for (const int i : IndexRange(size)) {
+    values_in[i] = float(i);
+    values_cond[i] = i % 3 == 0;
+  }
+
+  /* The mask is large enough to be processed in multiple chunks, one of which is empty. */
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_predicate(
+      IndexRange(size), GrainSize(1024), memory, [](const int64_t i) {
+        return i < 1500 || i >= 3500;
+      });
+  Array<float> values_out(size, -1.0f);
+
+  ParamsBuilder params(procedure_fn, &mask);
+  params.add_readonly_single_input(values_in.as_span());
+  params.add_readonly_single_input(values_cond.as_span());
+  params.add_uninitialized_single_output(values_out.as_mutable_span());
+
+  ContextBuilder context;
+  procedure_fn.call(mask, params, context);
+
+  for (const int i : IndexRange(size)) {
+    if (mask.contains(i)) {
+      EXPECT_EQ(values_out[i], float(i) * 3.0f + (i % 3 == 0 ? 100.0f : 0.0f));
+    }
+    else {
+      EXPECT_EQ(values_out[i], -1.0f);
+    }
+  }
+}
+
 TEST(multi_function_procedure, EvaluateOne)
 {
   /**
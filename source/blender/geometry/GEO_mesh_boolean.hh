@@ -22,6 +22,11 @@ enum class Solver {
   MeshArr = 0,
   /** The original BMesh floating point solver. */
   Float = 1,
+  /**
+   * A faster exact solver for closed manifold inputs, which intersects the triangles in parallel
+   * and builds the result mesh directly. Falls back to #MeshArr for other inputs.
+   */
+  Manifold = 2,
 };
 
 enum class Operation {
@@ -28,6 +28,19 @@ std::optional<Mesh *> mesh_merge_by_distance_all(const Mesh &mesh,
                                                  const IndexMask &selection,
                                                  float merge_distance);
 
+/**
+ * Merge clusters of selected vertices into the vertex with the lowest index in each cluster. A
+ * cluster contains all vertices that are connected by a chain of vertices within the
+ * \a merge_distance of each other, so unlike #mesh_merge_by_distance_all, the result does not
+ * depend on the order of the vertices. The clusters are found with a uniform grid in parallel.
+ *
+ * \returns #std::nullopt if the mesh should not be changed (no vertices are merged), in order to
+ * avoid copying the input. Otherwise returns the new mesh with merged geometry.
+ */
+std::optional<Mesh *> mesh_merge_by_distance_clusters(const Mesh &mesh,
+                                                      const IndexMask &selection,
+                                                      float merge_distance);
+
 /**
  * Merge selected vertices along edges to other selected vertices. Only vertices connected by edges
  * are considered for merging.
@@ -29,6 +29,8 @@
 #include "bmesh.hh"
 #include "tools/bmesh_intersect.hh"
 
+#include "mesh_boolean_manifold.hh"
+
 namespace blender::geometry::boolean {
 
 /* -------------------------------------------------------------------- */
@@ -1172,6 +1174,31 @@ Mesh *mesh_boolean(Span<const Mesh *> meshes,
                                    r_intersecting_edges);
 #else
       return nullptr;
+#endif
+    case Solver::Manifold:
+#ifdef WITH_GMP
+      /* Self intersections and holes are only handled by the general exact solver. */
+      if (op_params.no_self_intersections && op_params.watertight) {
+        if (Mesh *result = mesh_boolean_manifold(meshes,
+                                                 transforms,
+                                                 target_transform,
+                                                 material_remaps,
+                                                 op_params.boolean_mode,
+                                                 r_intersecting_edges))
+        {
+          return result;
+        }
+      }
+      return mesh_boolean_mesh_arr(meshes,
+                                   transforms,
+                                   target_transform,
+                                   material_remaps,
+                                   !op_params.no_self_intersections,
+                                   !op_params.watertight,
+                                   operation_to_mesh_arr_mode(op_params.boolean_mode),
+                                   r_intersecting_edges);
+#else
+      return nullptr;
 #endif
     default:
       BLI_assert_unreachable();
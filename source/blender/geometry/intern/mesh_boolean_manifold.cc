@@ -0,0 +1,1606 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup geo
+ *
+ * Boolean solver for closed manifold meshes.
+ *
+ * All combinatorial decisions are made with exact orientation predicates on the vertex positions,
+ * and the degenerate cases (coplanar faces, vertices on faces, edges crossing edges) are resolved
+ * with symbolic perturbation. That makes the topology of the result consistent, so it is a closed
+ * manifold again. Only the positions of the new intersection vertices are rounded.
+ *
+ * A boolean between two operands works like this:
+ * - Find pairs of triangles with overlapping bounds with a BVH tree overlap query.
+ * - For every pair, find the edges of either triangle that cross the other triangle. Under the
+ *   perturbation, there are either none or two crossings, which form an intersection segment.
+ *   Crossings are identified by their edge and triangle, so that the triangles sharing an edge
+ *   also share the intersection vertex.
+ * - Triangulate every triangle that has intersection segments, with the segments as constraints.
+ * - Classify the triangles as inside or outside of the other operand. Vertices connected by an
+ *   edge that doesn't cross the other operand are on the same side, so only one winding number
+ *   is computed for every group of connected vertices.
+ * - Keep the triangles required by the operation.
+ *
+ * More operands are combined in a balanced tree of binary operations that runs in parallel, which
+ * is important when there are many cutters.
+ */
+
+#include "BKE_attribute.hh"
+#include "BKE_attribute_math.hh"
+#include "BKE_mesh.hh"
+
+#include "BLI_array.hh"
+#include "BLI_array_utils.hh"
+#include "BLI_atomic_disjoint_set.hh"
+#include "BLI_bounds.hh"
+#include "BLI_delaunay_2d.hh"
+#include "BLI_disjoint_set.hh"
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_kdopbvh.hh"
+#include "BLI_map.hh"
+#include "BLI_math_boolean.hh"
+#include "BLI_math_geom.h"
+#include "BLI_math_matrix.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_math_vector_mpq_types.hh"
+#include "BLI_offset_indices.hh"
+#include "BLI_ordered_edge.hh"
+#include "BLI_set.hh"
+#include "BLI_sort.hh"
+#include "BLI_struct_equality_utils.hh"
+#include "BLI_task.hh"
+#include "BLI_vector_set.hh"
+
+#include "mesh_boolean_manifold.hh"
+
+namespace blender::geometry::boolean {
+
+#ifdef WITH_GMP
+
+/* -------------------------------------------------------------------- */
+/** \name Predicates
+ * \{ */
+
+/** A point for the exact predicates, which may be moved by an infinitesimal amount. */
+struct PerturbedPoint {
+  const double3 *co;
+  /** Direction in which the point is moved, or null when it stays in place. */
+  const double3 *dir;
+};
+
+static mpq3 to_mpq(const double3 &co)
+{
+  return mpq3(co.x, co.y, co.z);
+}
+
+/**
+ * The sign of #orient3d, with zero results resolved by symbolic perturbation: every point with a
+ * direction is moved by an infinitesimal multiple of that direction, and when that doesn't decide
+ * the sign, by an even smaller translation that is different along each axis. Zero is only
+ * returned when the points stay degenerate under the perturbation, e.g. for collinear points.
+ */
+static int orient3d_perturbed(const PerturbedPoint &a,
+                              const PerturbedPoint &b,
+                              const PerturbedPoint &c,
+                              const PerturbedPoint &d)
+{
+  const int orient = orient3d(*a.co, *b.co, *c.co, *d.co);
+  if (orient != 0) {
+    return orient;
+  }
+  const std::array<const PerturbedPoint *, 4> points = {&a, &b, &c, &d};
+  if (std::none_of(points.begin(), points.end(), [](const PerturbedPoint *point) {
+        return point->dir != nullptr;
+      }))
+  {
+    return 0;
+  }
+  /* The derivatives of the determinant with respect to each of the points, computed exactly. */
+  const mpq3 d_exact = to_mpq(*d.co);
+  const mpq3 ad = to_mpq(*a.co) - d_exact;
+  const mpq3 bd = to_mpq(*b.co) - d_exact;
+  const mpq3 cd = to_mpq(*c.co) - d_exact;
+  std::array<mpq3, 4> gradients;
+  gradients[0] = math::cross(bd, cd);
+  gradients[1] = math::cross(cd, ad);
+  gradients[2] = math::cross(ad, bd);
+  gradients[3] = -(gradients[0] + gradients[1] + gradients[2]);
+
+  mpq_class first_order = 0;
+  mpq3 translation(0, 0, 0);
+  for (const int i : IndexRange(4)) {
+    if (points[i]->dir) {
+      first_order += math::dot(gradients[i], to_mpq(*points[i]->dir));
+      translation += gradients[i];
+    }
+  }
+  if (const int sign = sgn(first_order)) {
+    return sign;
+  }
+  for (const int axis : IndexRange(3)) {
+    if (const int sign = sgn(translation[axis])) {
+      return sign;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Test whether the segment from p to q crosses the triangle abc after perturbation.
+ * \return Zero when there is no crossing, 1 when p is on the back side of the triangle, and -1
+ * when p is on the front side.
+ */
+static int segment_triangle_crossing(const PerturbedPoint &p,
+                                     const PerturbedPoint &q,
+                                     const PerturbedPoint &a,
+                                     const PerturbedPoint &b,
+                                     const PerturbedPoint &c)
+{
+  const int side_p = orient3d_perturbed(a, b, c, p);
+  const int side_q = orient3d_perturbed(a, b, c, q);
+  if (side_p == 0 || side_q == 0 || side_p == side_q) {
+    return 0;
+  }
+  const int orient_ab = orient3d_perturbed(p, q, a, b);
+  if (orient_ab == 0) {
+    return 0;
+  }
+  if (orient3d_perturbed(p, q, b, c) != orient_ab || orient3d_perturbed(p, q, c, a) != orient_ab)
+  {
+    return 0;
+  }
+  return side_p;
+}
+
+/** Factor along the segment from p to q where it intersects the plane of the triangle abc. */
+static double segment_plane_factor(const double3 &p,
+                                   const double3 &q,
+                                   const double3 &a,
+                                   const double3 &b,
+                                   const double3 &c)
+{
+  const double3 normal = math::cross(b - a, c - a);
+  const double dist_p = math::dot(normal, p - a);
+  const double dist_q = math::dot(normal, q - a);
+  if (dist_p == dist_q) {
+    return 0.5;
+  }
+  return std::clamp(dist_p / (dist_p - dist_q), 0.0, 1.0);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Binary Boolean of Triangle Meshes
+ * \{ */
+
+/**
+ * Triangles in the space of the first input mesh, with double precision positions and the
+ * information needed to map the result back to the elements of the input meshes.
+ */
+struct TriMesh {
+  Array<double3> positions;
+  /** Index of the vertex in the concatenated input meshes, or -1 for intersection vertices. */
+  Array<int> vert_src;
+  Array<int3> tris;
+  /** Index in the concatenated input corner triangles, or -1 for parts of split triangles. */
+  Array<int> tri_src;
+  /** Index of the face in the concatenated input meshes that contains the triangle. */
+  Array<int> tri_face;
+  /** Whether the triangle winding order is reversed compared to its face. */
+  Array<bool> tri_flip;
+  /** Edges created by intersections. May contain duplicates. */
+  Vector<OrderedEdge> intersection_edges;
+};
+
+/** An edge of one operand that crosses a triangle of the other operand. */
+struct Crossing {
+  OrderedEdge edge = {0, 0};
+  int tri = 0;
+
+  uint64_t hash() const
+  {
+    return get_default_hash(this->edge, this->tri);
+  }
+
+  BLI_STRUCT_EQUALITY_OPERATORS_2(Crossing, edge, tri)
+};
+
+/** The part of the intersection curve in a pair of triangles, from one crossing to another. */
+struct Segment {
+  int tri_a;
+  int tri_b;
+  std::array<Crossing, 2> crossings;
+};
+
+/**
+ * The two operands of a binary boolean in one index space: the vertices and triangles of the
+ * second operand come after those of the first.
+ */
+struct BooleanData {
+  int verts_a_num;
+  int tris_a_num;
+  Array<double3> positions;
+  Array<int3> tris;
+  /**
+   * Vertices of the first operand are moved along their normal by the symbolic perturbation:
+   * outwards for unions, so that touching faces merge, and inwards otherwise, so that flush
+   * cutters cut cleanly.
+   */
+  Array<double3> perturb_dirs;
+  Bounds<double3> bounds_a;
+  Bounds<double3> bounds_b;
+  BVHTree *tree_a = nullptr;
+  BVHTree *tree_b = nullptr;
+
+  PerturbedPoint point(const int vert) const
+  {
+    const bool in_a = vert < this->verts_a_num;
+    return {&this->positions[vert], in_a ? &this->perturb_dirs[vert] : nullptr};
+  }
+
+  bool tri_in_a(const int tri) const
+  {
+    return tri < this->tris_a_num;
+  }
+};
+
+/** The triangles replacing a triangle that is cut by intersection segments. */
+struct SplitTriangle {
+  /**
+   * Vertex indices in the #BooleanData index space, the crossings after that, and vertices that
+   * are created by the triangulation encoded as negative values (see #new_positions).
+   */
+  Vector<int3> tris;
+  /**
+   * For every triangle, an original vertex on the same side of the other operand, or a negative
+   * value encoding an index into #region_points when no original vertex is reachable.
+   */
+  Vector<int> tri_class;
+  /** Positions of vertices created by the triangulation, which are rare. */
+  Vector<double3> new_positions;
+  /** Points inside the regions of the triangle that don't contain any original vertex. */
+  Vector<double3> region_points;
+  /** The perturbation of the region points, so that they stay on the perturbed triangle. */
+  Vector<double3> region_dirs;
+  Vector<OrderedEdge> intersection_edges;
+  /** Vertices merged by the triangulation because they have the same rounded position. */
+  Vector<int2> merged_verts;
+};
+
+static int decode_new_vert(const int vert)
+{
+  return -1 - vert;
+}
+
+/** Barycentric weights of the point projected onto the plane of the triangle. */
+static double3 barycentric_weights(const double3 &a,
+                                   const double3 &b,
+                                   const double3 &c,
+                                   const double3 &p)
+{
+  const double3 normal = math::cross(b - a, c - a);
+  const double length_squared = math::length_squared(normal);
+  if (length_squared == 0.0) {
+    return double3(1.0 / 3.0);
+  }
+  return double3(math::dot(math::cross(c - b, p - b), normal),
+                 math::dot(math::cross(a - c, p - c), normal),
+                 math::dot(math::cross(b - a, p - a), normal)) /
+         length_squared;
+}
+
+static double3 interpolate_tri(const Span<double3> values,
+                               const int3 &tri,
+                               const double3 &weights)
+{
+  return values[tri[0]] * weights[0] + values[tri[1]] * weights[1] + values[tri[2]] * weights[2];
+}
+
+static BVHTree *build_tri_tree(const BooleanData &data, const IndexRange tris, const float epsilon)
+{
+  BVHTree *tree = BLI_bvhtree_new(int(tris.size()), epsilon, 2, 6);
+  for (const int64_t i : tris.index_range()) {
+    const int3 &tri = data.tris[tris[i]];
+    float co[3][3];
+    for (const int j : IndexRange(3)) {
+      copy_v3_v3(co[j], float3(data.positions[tri[j]]));
+    }
+    BLI_bvhtree_insert(tree, int(i), co[0], 3);
+  }
+  BLI_bvhtree_balance(tree);
+  return tree;
+}
+
+static Array<double3> calc_perturb_dirs(const TriMesh &mesh, const Operation operation)
+{
+  Array<double3> dirs(mesh.positions.size(), double3(0));
+  for (const int3 &tri : mesh.tris) {
+    const double3 normal = math::cross(mesh.positions[tri[1]] - mesh.positions[tri[0]],
+                                       mesh.positions[tri[2]] - mesh.positions[tri[0]]);
+    for (const int j : IndexRange(3)) {
+      dirs[tri[j]] += normal;
+    }
+  }
+  if (operation != Operation::Union) {
+    for (double3 &dir : dirs) {
+      dir = -dir;
+    }
+  }
+  return dirs;
+}
+
+/** A ray direction that is unlikely to be parallel to edges of typical meshes. */
+static const float3 &inside_test_ray_dir()
+{
+  static const float3 dir = math::normalize(float3(1.0f, 0.001271f, 0.000937f));
+  return dir;
+}
+
+/**
+ * Whether the point is inside of the operand that it is not part of, using the sum of the
+ * exact crossings with a ray that ends outside of that operand.
+ */
+static bool point_inside_other(const BooleanData &data,
+                               const PerturbedPoint &point,
+                               const bool point_in_a)
+{
+  const Bounds<double3> &bounds = point_in_a ? data.bounds_b : data.bounds_a;
+  const double3 &co = *point.co;
+  if (math::reduce_min(co - bounds.min) < 0.0 || math::reduce_min(bounds.max - co) < 0.0) {
+    return false;
+  }
+  const float3 &ray_dir = inside_test_ray_dir();
+  const double length = math::distance(bounds.min, bounds.max) + 1.0;
+  const double3 far_co = co + double3(ray_dir) * length;
+  const PerturbedPoint far_point{&far_co, nullptr};
+  const int tri_offset = point_in_a ? data.tris_a_num : 0;
+  int winding = 0;
+  BLI_bvhtree_ray_cast_all_cpp(*(point_in_a ? data.tree_b : data.tree_a),
+                               float3(co),
+                               ray_dir,
+                               0.0f,
+                               float(length),
+                               [&](const int index, const BVHTreeRay & /*ray*/, BVHTreeRayHit &
+                                   /*hit*/) {
+                                 const int3 &tri = data.tris[tri_offset + index];
+                                 winding += segment_triangle_crossing(point,
+                                                                      far_point,
+                                                                      data.point(tri[0]),
+                                                                      data.point(tri[1]),
+                                                                      data.point(tri[2]));
+                               });
+  return winding > 0;
+}
+
+static Vector<Segment> find_intersection_segments(const BooleanData &data)
+{
+  uint overlaps_num = 0;
+  BVHTreeOverlap *overlaps = BLI_bvhtree_overlap_ex(data.tree_a,
+                                                    data.tree_b,
+                                                    &overlaps_num,
+                                                    nullptr,
+                                                    nullptr,
+                                                    0,
+                                                    BVH_OVERLAP_USE_THREADING |
+                                                        BVH_OVERLAP_RETURN_PAIRS);
+  threading::EnumerableThreadSpecific<Vector<Segment>> all_segments;
+  threading::parallel_for(IndexRange(overlaps_num), 512, [&](const IndexRange range) {
+    Vector<Segment> &segments = all_segments.local();
+    for (const int64_t i : range) {
+      Segment segment;
+      segment.tri_a = overlaps[i].indexA;
+      segment.tri_b = data.tris_a_num + overlaps[i].indexB;
+      int crossings_num = 0;
+      auto add_edge_crossings = [&](const int tri, const int other_tri) {
+        const int3 &verts = data.tris[tri];
+        const int3 &other = data.tris[other_tri];
+        for (const int j : IndexRange(3)) {
+          const OrderedEdge edge(verts[j], verts[(j + 1) % 3]);
+          if (segment_triangle_crossing(data.point(edge.v_low),
+                                        data.point(edge.v_high),
+                                        data.point(other[0]),
+                                        data.point(other[1]),
+                                        data.point(other[2])) == 0)
+          {
+            continue;
+          }
+          if (crossings_num < 2) {
+            segment.crossings[crossings_num] = {edge, other_tri};
+          }
+          crossings_num++;
+        }
+      };
+      add_edge_crossings(segment.tri_a, segment.tri_b);
+      add_edge_crossings(segment.tri_b, segment.tri_a);
+      /* Other numbers of crossings are only possible for degenerate triangles. */
+      if (crossings_num == 2) {
+        segments.append(segment);
+      }
+    }
+  });
+  MEM_SAFE_FREE(overlaps);
+
+  Vector<Segment> segments;
+  for (Vector<Segment> &local_segments : all_segments) {
+    segments.extend(local_segments);
+  }
+  /* Make the result independent of the thread scheduling. */
+  parallel_sort(segments.begin(), segments.end(), [](const Segment &a, const Segment &b) {
+    return a.tri_a < b.tri_a || (a.tri_a == b.tri_a && a.tri_b < b.tri_b);
+  });
+  return segments;
+}
+
+/**
+ * Group the vertices that are connected by edges which don't cross the other operand, and find
+ * whether each group is inside the other operand.
+ */
+static Array<bool> classify_vertices(const BooleanData &data,
+                                     const Set<OrderedEdge> &crossed_edges)
+{
+  const int verts_num = int(data.positions.size());
+  AtomicDisjointSet groups(verts_num);
+  threading::parallel_for(data.tris.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t tri : range) {
+      const int3 &verts = data.tris[tri];
+      for (const int j : IndexRange(3)) {
+        const OrderedEdge edge(verts[j], verts[(j + 1) % 3]);
+        if (!crossed_edges.contains(edge)) {
+          groups.join(edge.v_low, edge.v_high);
+        }
+      }
+    }
+  });
+  Array<int> group_ids(verts_num);
+  const int groups_num = groups.calc_reduced_ids(group_ids);
+
+  /* The ids are ordered by first occurrence, so the first vertex of every group is found by
+   * looking for the next id. */
+  Array<int> group_verts(groups_num);
+  int next_group = 0;
+  for (const int vert : IndexRange(verts_num)) {
+    if (group_ids[vert] == next_group) {
+      group_verts[next_group++] = vert;
+    }
+  }
+
+  Array<bool> group_inside(groups_num);
+  threading::parallel_for(group_verts.index_range(), 64, [&](const IndexRange range) {
+    for (const int64_t group : range) {
+      const int vert = group_verts[group];
+      group_inside[group] = point_inside_other(
+          data, data.point(vert), vert < data.verts_a_num);
+    }
+  });
+
+  Array<bool> vert_inside(verts_num);
+  array_utils::gather(group_inside.as_span(), group_ids.as_span(), vert_inside.as_mutable_span());
+  return vert_inside;
+}
+
+/**
+ * Replace the triangle with a triangulation that contains the intersection segments as edges.
+ * \param crossing_verts: The vertex indices of the crossings of each segment.
+ */
+static SplitTriangle split_triangle(const BooleanData &data,
+                                    const int tri,
+                                    const Span<int> tri_segments,
+                                    const Span<int2> segment_verts,
+                                    const VectorSet<Crossing> &crossings,
+                                    const Span<double3> crossing_positions,
+                                    const Span<double> crossing_factors)
+{
+  const int verts_num = int(data.positions.size());
+  const int3 &corners = data.tris[tri];
+  auto vert_position = [&](const int vert) -> const double3 & {
+    return vert < verts_num ? data.positions[vert] : crossing_positions[vert - verts_num];
+  };
+
+  /* Local vertex indices: the corners first, then the crossings. */
+  VectorSet<int> local_verts;
+  for (const int j : IndexRange(3)) {
+    local_verts.add_new(corners[j]);
+  }
+  Array<std::pair<int, int>> local_segments(tri_segments.size());
+  for (const int i : tri_segments.index_range()) {
+    const int2 &verts = segment_verts[tri_segments[i]];
+    local_segments[i] = {local_verts.index_of_or_add(verts[0]),
+                         local_verts.index_of_or_add(verts[1])};
+  }
+
+  /* Crossings of the triangle's own edges are on its boundary, sorted along each edge. */
+  std::array<Vector<std::pair<double, int>>, 3> edge_verts;
+  for (const int i : local_verts.index_range().drop_front(3)) {
+    const int crossing_i = local_verts[i] - verts_num;
+    const Crossing &crossing = crossings[crossing_i];
+    if (crossing.tri == tri) {
+      continue;
+    }
+    for (const int j : IndexRange(3)) {
+      const OrderedEdge edge(corners[j], corners[(j + 1) % 3]);
+      if (edge == crossing.edge) {
+        const double factor = crossing_factors[crossing_i];
+        edge_verts[j].append({corners[j] == edge.v_low ? factor : 1.0 - factor, i});
+        break;
+      }
+    }
+  }
+  Vector<int> boundary;
+  for (const int j : IndexRange(3)) {
+    boundary.append(j);
+    std::sort(edge_verts[j].begin(), edge_verts[j].end());
+    for (const std::pair<double, int> &edge_vert : edge_verts[j]) {
+      boundary.append(edge_vert.second);
+    }
+  }
+
+  /* Project along the dominant axis of the normal, keeping counter-clockwise winding. */
+  const double3 &origin = data.positions[corners[0]];
+  const double3 normal = math::cross(data.positions[corners[1]] - origin,
+                                     data.positions[corners[2]] - origin);
+  const int axis = math::dominant_axis(normal);
+  int axis_x = (axis + 1) % 3;
+  int axis_y = (axis + 2) % 3;
+  if (normal[axis] < 0.0) {
+    std::swap(axis_x, axis_y);
+  }
+  meshintersect::CDT_input<double> input;
+  input.vert.reinitialize(local_verts.size());
+  double extent = 0.0;
+  for (const int i : local_verts.index_range()) {
+    const double3 co = vert_position(local_verts[i]) - origin;
+    input.vert[i] = double2(co[axis_x], co[axis_y]);
+    extent = std::max({extent, std::abs(co[axis_x]), std::abs(co[axis_y])});
+  }
+  input.edge = local_segments;
+  input.face.reinitialize(1);
+  input.face[0] = boundary;
+  input.epsilon = extent * 1e-10;
+
+  SplitTriangle split;
+  const bool is_degenerate = orient2d(input.vert[0], input.vert[1], input.vert[2]) <= 0;
+  meshintersect::CDT_result<double> result;
+  if (!is_degenerate) {
+    result = meshintersect::delaunay_2d_calc(input, CDT_INSIDE);
+  }
+  if (is_degenerate || result.face.is_empty()) {
+    /* Keep the topology consistent with the neighbors with a fan of degenerate triangles. */
+    for (const int i : boundary.index_range().drop_front(1).drop_back(1)) {
+      split.tris.append({local_verts[boundary[0]],
+                         local_verts[boundary[i]],
+                         local_verts[boundary[i + 1]]});
+      split.tri_class.append(corners[0]);
+    }
+    return split;
+  }
+
+  Array<int> result_verts(result.vert.size());
+  for (const int i : result.vert.index_range()) {
+    const Span<int> orig = result.vert_orig[i];
+    if (!orig.is_empty()) {
+      result_verts[i] = local_verts[*std::min_element(orig.begin(), orig.end())];
+      for (const int other : orig) {
+        if (local_verts[other] != result_verts[i]) {
+          split.merged_verts.append({result_verts[i], local_verts[other]});
+        }
+      }
+      continue;
+    }
+    /* A vertex created where segments intersect, which only happens for self-intersecting
+     * operands. Interpolate its position in the triangle. */
+    const double3 weights = barycentric_weights(double3(input.vert[0], 0.0),
+                                                double3(input.vert[1], 0.0),
+                                                double3(input.vert[2], 0.0),
+                                                double3(result.vert[i], 0.0));
+    result_verts[i] = decode_new_vert(int(split.new_positions.size()));
+    split.new_positions.append(interpolate_tri(data.positions, corners, weights));
+  }
+
+  Set<OrderedEdge> constrained_edges;
+  for (const int i : result.edge.index_range()) {
+    for (const int orig : result.edge_orig[i]) {
+      if (orig < result.face_edge_offset) {
+        const OrderedEdge edge(result_verts[result.edge[i].first],
+                               result_verts[result.edge[i].second]);
+        constrained_edges.add(edge);
+        split.intersection_edges.append(edge);
+        break;
+      }
+    }
+  }
+
+  for (const Vector<int> &face : result.face) {
+    if (orient2d(result.vert[face[0]], result.vert[face[1]], result.vert[face[2]]) >= 0) {
+      split.tris.append({result_verts[face[0]], result_verts[face[1]], result_verts[face[2]]});
+    }
+    else {
+      split.tris.append({result_verts[face[0]], result_verts[face[2]], result_verts[face[1]]});
+    }
+  }
+
+  /* Triangles connected without crossing a segment are on the same side of the other operand. */
+  DisjointSet<int> regions(split.tris.size());
+  Map<OrderedEdge, int> edge_tris;
+  for (const int i : split.tris.index_range()) {
+    const int3 &verts = split.tris[i];
+    for (const int j : IndexRange(3)) {
+      const OrderedEdge edge(verts[j], verts[(j + 1) % 3]);
+      if (constrained_edges.contains(edge)) {
+        continue;
+      }
+      const int other = edge_tris.lookup_or_add(edge, i);
+      if (other != i) {
+        regions.join(i, other);
+      }
+    }
+  }
+  /* A corner that was merged with a crossing is only connected to the region by a collapsed
+   * piece of the triangle, so it can't be used to classify the region. */
+  auto is_merged = [&](const int vert) {
+    return std::any_of(split.merged_verts.begin(),
+                       split.merged_verts.end(),
+                       [&](const int2 &verts) { return verts[0] == vert || verts[1] == vert; });
+  };
+  Map<int, int> region_class;
+  for (const int i : split.tris.index_range()) {
+    for (const int j : IndexRange(3)) {
+      const int vert = split.tris[i][j];
+      if (vert >= 0 && vert < verts_num && !is_merged(vert)) {
+        region_class.add(regions.find_root(i), vert);
+      }
+    }
+  }
+  for (const int i : split.tris.index_range()) {
+    const int region = regions.find_root(i);
+    split.tri_class.append(region_class.lookup_or_add_cb(region, [&]() {
+      const int3 &verts = split.tris[i];
+      double3 center(0);
+      for (const int j : IndexRange(3)) {
+        const int vert = verts[j];
+        center += vert < 0 ? split.new_positions[decode_new_vert(vert)] : vert_position(vert);
+      }
+      center /= 3.0;
+      split.region_points.append(center);
+      if (data.tri_in_a(tri)) {
+        split.region_dirs.append(interpolate_tri(
+            data.perturb_dirs,
+            corners,
+            barycentric_weights(data.positions[corners[0]],
+                                data.positions[corners[1]],
+                                data.positions[corners[2]],
+                                center)));
+      }
+      return decode_new_vert(int(split.region_points.size()) - 1);
+    }));
+  }
+  return split;
+}
+
+static bool keep_triangle(const Operation operation, const bool in_a, const bool inside_other)
+{
+  switch (operation) {
+    case Operation::Intersect:
+      return inside_other;
+    case Operation::Union:
+      return !inside_other;
+    case Operation::Difference:
+      return in_a ? !inside_other : inside_other;
+  }
+  BLI_assert_unreachable();
+  return false;
+}
+
+static int3 flip_tri(const int3 &tri)
+{
+  return {tri[0], tri[2], tri[1]};
+}
+
+/** Build a mesh from the triangles, removing vertices that aren't used anymore. */
+static TriMesh compact_tri_mesh(const Span<double3> positions,
+                                const Span<int> vert_src,
+                                const Span<int3> tris,
+                                TriMesh &&data)
+{
+  Array<int> vert_map(positions.size(), 0);
+  for (const int3 &tri : tris) {
+    for (const int j : IndexRange(3)) {
+      vert_map[tri[j]] = 1;
+    }
+  }
+  int used_num = 0;
+  for (int &vert : vert_map) {
+    vert = vert ? used_num++ : -1;
+  }
+
+  TriMesh result = std::move(data);
+  result.positions.reinitialize(used_num);
+  result.vert_src.reinitialize(used_num);
+  threading::parallel_for(positions.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      if (vert_map[i] != -1) {
+        result.positions[vert_map[i]] = positions[i];
+        result.vert_src[vert_map[i]] = vert_src[i];
+      }
+    }
+  });
+  result.tris.reinitialize(tris.size());
+  threading::parallel_for(tris.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      result.tris[i] = {vert_map[tris[i][0]], vert_map[tris[i][1]], vert_map[tris[i][2]]};
+    }
+  });
+  Vector<OrderedEdge> intersection_edges;
+  for (const OrderedEdge &edge : result.intersection_edges) {
+    if (edge.v_low >= 0 && vert_map[edge.v_low] != -1 && vert_map[edge.v_high] != -1) {
+      intersection_edges.append({vert_map[edge.v_low], vert_map[edge.v_high]});
+    }
+  }
+  result.intersection_edges = std::move(intersection_edges);
+  return result;
+}
+
+static TriMesh concatenate_tri_meshes(const TriMesh &a, const TriMesh &b)
+{
+  const int verts_a_num = int(a.positions.size());
+  TriMesh result;
+  result.positions.reinitialize(a.positions.size() + b.positions.size());
+  result.positions.as_mutable_span().take_front(verts_a_num).copy_from(a.positions);
+  result.positions.as_mutable_span().drop_front(verts_a_num).copy_from(b.positions);
+  result.vert_src.reinitialize(result.positions.size());
+  result.vert_src.as_mutable_span().take_front(verts_a_num).copy_from(a.vert_src);
+  result.vert_src.as_mutable_span().drop_front(verts_a_num).copy_from(b.vert_src);
+
+  const int tris_a_num = int(a.tris.size());
+  result.tris.reinitialize(a.tris.size() + b.tris.size());
+  result.tris.as_mutable_span().take_front(tris_a_num).copy_from(a.tris);
+  threading::parallel_for(b.tris.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      result.tris[tris_a_num + i] = b.tris[i] + int3(verts_a_num);
+    }
+  });
+  result.tri_src.reinitialize(result.tris.size());
+  result.tri_src.as_mutable_span().take_front(tris_a_num).copy_from(a.tri_src);
+  result.tri_src.as_mutable_span().drop_front(tris_a_num).copy_from(b.tri_src);
+  result.tri_face.reinitialize(result.tris.size());
+  result.tri_face.as_mutable_span().take_front(tris_a_num).copy_from(a.tri_face);
+  result.tri_face.as_mutable_span().drop_front(tris_a_num).copy_from(b.tri_face);
+  result.tri_flip.reinitialize(result.tris.size());
+  result.tri_flip.as_mutable_span().take_front(tris_a_num).copy_from(a.tri_flip);
+  result.tri_flip.as_mutable_span().drop_front(tris_a_num).copy_from(b.tri_flip);
+
+  result.intersection_edges = a.intersection_edges;
+  for (const OrderedEdge &edge : b.intersection_edges) {
+    result.intersection_edges.append({edge.v_low + verts_a_num, edge.v_high + verts_a_num});
+  }
+  return result;
+}
+
+static bool bounds_overlap(const Bounds<double3> &a, const Bounds<double3> &b)
+{
+  return math::reduce_min(a.max - b.min) >= 0.0 && math::reduce_min(b.max - a.min) >= 0.0;
+}
+
+static TriMesh boolean_tri_meshes(const TriMesh &a, const TriMesh &b, const Operation operation)
+{
+  const std::optional<Bounds<double3>> bounds_a = bounds::min_max(a.positions.as_span());
+  const std::optional<Bounds<double3>> bounds_b = bounds::min_max(b.positions.as_span());
+  if (a.tris.is_empty() || b.tris.is_empty() || !bounds_overlap(*bounds_a, *bounds_b)) {
+    /* Neither operand can be inside of the other. */
+    switch (operation) {
+      case Operation::Intersect:
+        return {};
+      case Operation::Union:
+        return concatenate_tri_meshes(a, b);
+      case Operation::Difference:
+        return a;
+    }
+  }
+
+  BooleanData data;
+  data.verts_a_num = int(a.positions.size());
+  data.tris_a_num = int(a.tris.size());
+  data.bounds_a = *bounds_a;
+  data.bounds_b = *bounds_b;
+  const TriMesh combined = concatenate_tri_meshes(a, b);
+  data.positions = combined.positions;
+  data.tris = combined.tris;
+  const Bounds<double3> bounds = bounds::merge(*bounds_a, *bounds_b);
+  /* Make sure that the bounds in the BVH trees contain the exact triangles, and the rays used for
+   * the inside tests. */
+  const float epsilon = float(
+      std::max(math::reduce_max(math::abs(bounds.min)), math::reduce_max(math::abs(bounds.max))) *
+          1e-6 +
+      1e-12);
+  threading::parallel_invoke(
+      [&]() { data.tree_a = build_tri_tree(data, a.tris.index_range(), epsilon); },
+      [&]() {
+        data.tree_b = build_tri_tree(
+            data, b.tris.index_range().shift(data.tris_a_num), epsilon);
+      },
+      [&]() { data.perturb_dirs = calc_perturb_dirs(a, operation); });
+
+  const Vector<Segment> segments = find_intersection_segments(data);
+
+  /* Number the crossings, which are shared by the triangles around the crossing edge. */
+  const int verts_num = int(data.positions.size());
+  VectorSet<Crossing> crossings;
+  Array<int2> segment_verts(segments.size());
+  for (const int i : segments.index_range()) {
+    for (const int j : IndexRange(2)) {
+      segment_verts[i][j] = verts_num + int(crossings.index_of_or_add(segments[i].crossings[j]));
+    }
+  }
+  Array<double3> crossing_positions(crossings.size());
+  Array<double> crossing_factors(crossings.size());
+  threading::parallel_for(crossings.index_range(), 1024, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const Crossing &crossing = crossings[i];
+      const double3 &p = data.positions[crossing.edge.v_low];
+      const double3 &q = data.positions[crossing.edge.v_high];
+      const int3 &tri = data.tris[crossing.tri];
+      const double factor = segment_plane_factor(
+          p, q, data.positions[tri[0]], data.positions[tri[1]], data.positions[tri[2]]);
+      crossing_factors[i] = factor;
+      crossing_positions[i] = math::interpolate(p, q, factor);
+    }
+  });
+
+  Array<int> tri_segment_offsets(data.tris.size() + 1, 0);
+  for (const Segment &segment : segments) {
+    tri_segment_offsets[segment.tri_a]++;
+    tri_segment_offsets[segment.tri_b]++;
+  }
+  const OffsetIndices<int> tri_segment_groups = offset_indices::accumulate_counts_to_offsets(
+      tri_segment_offsets);
+  Array<int> tri_segments(tri_segment_groups.total_size());
+  {
+    Array<int> counts(data.tris.size(), 0);
+    for (const int i : segments.index_range()) {
+      for (const int tri : {segments[i].tri_a, segments[i].tri_b}) {
+        tri_segments[tri_segment_groups[tri][counts[tri]++]] = i;
+      }
+    }
+  }
+
+  Set<OrderedEdge> crossed_edges;
+  for (const Crossing &crossing : crossings) {
+    crossed_edges.add(crossing.edge);
+  }
+  const Array<bool> vert_inside = classify_vertices(data, crossed_edges);
+
+  IndexMaskMemory memory;
+  const IndexMask split_tris = IndexMask::from_predicate(
+      data.tris.index_range(), GrainSize(4096), memory, [&](const int tri) {
+        return !tri_segment_groups[tri].is_empty();
+      });
+  Array<SplitTriangle> splits(split_tris.size());
+  split_tris.foreach_index(GrainSize(32), [&](const int tri, const int pos) {
+    splits[pos] = split_triangle(data,
+                                 tri,
+                                 tri_segments.as_span().slice(tri_segment_groups[tri]),
+                                 segment_verts,
+                                 crossings,
+                                 crossing_positions,
+                                 crossing_factors);
+  });
+
+  /* Classify the regions of split triangles that aren't connected to an original vertex. */
+  Array<int> region_offsets(splits.size() + 1);
+  Array<int> new_vert_offsets(splits.size() + 1);
+  for (const int i : splits.index_range()) {
+    region_offsets[i] = int(splits[i].region_points.size());
+    new_vert_offsets[i] = int(splits[i].new_positions.size());
+  }
+  const OffsetIndices<int> region_groups = offset_indices::accumulate_counts_to_offsets(
+      region_offsets);
+  const OffsetIndices<int> new_vert_groups = offset_indices::accumulate_counts_to_offsets(
+      new_vert_offsets);
+  Array<bool> region_inside(region_groups.total_size());
+  threading::parallel_for(splits.index_range(), 64, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const bool in_a = data.tri_in_a(int(split_tris[i]));
+      for (const int j : splits[i].region_points.index_range()) {
+        region_inside[region_groups[i][j]] = point_inside_other(
+            data,
+            {&splits[i].region_points[j], in_a ? &splits[i].region_dirs[j] : nullptr},
+            in_a);
+      }
+    }
+  });
+
+  const int new_verts_start = verts_num + int(crossings.size());
+  const int result_verts_num = new_verts_start + int(new_vert_groups.total_size());
+
+  /* Vertices that were merged in one triangle have to be merged in all triangles, which collapses
+   * the intersection segments that are shorter than the precision of the positions. */
+  Array<int> vert_merge;
+  if (std::any_of(splits.begin(), splits.end(), [](const SplitTriangle &split) {
+        return !split.merged_verts.is_empty();
+      }))
+  {
+    DisjointSet<int> merge_sets(result_verts_num);
+    for (const SplitTriangle &split : splits) {
+      for (const int2 &verts : split.merged_verts) {
+        merge_sets.join(verts[0], verts[1]);
+      }
+    }
+    /* Prefer original vertices, which come first, to keep their attributes. */
+    Array<int> root_vert(result_verts_num, -1);
+    vert_merge.reinitialize(result_verts_num);
+    for (const int vert : vert_merge.index_range()) {
+      const int root = merge_sets.find_root(vert);
+      if (root_vert[root] == -1) {
+        root_vert[root] = vert;
+      }
+      vert_merge[vert] = root_vert[root];
+    }
+  }
+  auto merge_vert = [&](const int vert) {
+    return vert_merge.is_empty() ? vert : vert_merge[vert];
+  };
+  auto merge_tri = [&](const int3 &tri) {
+    return int3(merge_vert(tri[0]), merge_vert(tri[1]), merge_vert(tri[2]));
+  };
+  auto is_collapsed = [](const int3 &tri) {
+    return tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0];
+  };
+
+  /* Gather the triangles that are kept. */
+  Vector<int3> result_tris;
+  TriMesh result;
+  Vector<int> tri_src;
+  Vector<int> tri_face;
+  Vector<bool> tri_flip;
+  result.intersection_edges = combined.intersection_edges;
+  int split_i = 0;
+  for (const int tri : data.tris.index_range()) {
+    const bool in_a = data.tri_in_a(tri);
+    const bool flip = operation == Operation::Difference && !in_a;
+    const int tri_i = in_a ? tri : tri - data.tris_a_num;
+    const TriMesh &src = in_a ? a : b;
+    if (split_i < splits.size() && split_tris[split_i] == tri) {
+      const SplitTriangle &split = splits[split_i];
+      auto map_vert = [&](const int vert) {
+        return merge_vert(vert >= 0 ? vert :
+                                      new_verts_start +
+                                          int(new_vert_groups[split_i][decode_new_vert(vert)]));
+      };
+      for (const int i : split.tris.index_range()) {
+        const int tri_class = split.tri_class[i];
+        const bool inside = tri_class >= 0 ?
+                                vert_inside[tri_class] :
+                                region_inside[region_groups[split_i][decode_new_vert(tri_class)]];
+        if (!keep_triangle(operation, in_a, inside)) {
+          continue;
+        }
+        const int3 verts(map_vert(split.tris[i][0]),
+                         map_vert(split.tris[i][1]),
+                         map_vert(split.tris[i][2]));
+        if (is_collapsed(verts)) {
+          continue;
+        }
+        result_tris.append(flip ? flip_tri(verts) : verts);
+        tri_src.append(-1);
+        tri_face.append(src.tri_face[tri_i]);
+        tri_flip.append(src.tri_flip[tri_i] != flip);
+      }
+      for (const OrderedEdge &edge : split.intersection_edges) {
+        const int v1 = map_vert(edge.v_low);
+        const int v2 = map_vert(edge.v_high);
+        if (v1 != v2) {
+          result.intersection_edges.append({v1, v2});
+        }
+      }
+      split_i++;
+      continue;
+    }
+    if (!keep_triangle(operation, in_a, vert_inside[data.tris[tri][0]])) {
+      continue;
+    }
+    const int3 verts = merge_tri(data.tris[tri]);
+    if (is_collapsed(verts)) {
+      continue;
+    }
+    result_tris.append(flip ? flip_tri(verts) : verts);
+    tri_src.append(src.tri_src[tri_i]);
+    tri_face.append(src.tri_face[tri_i]);
+    tri_flip.append(src.tri_flip[tri_i] != flip);
+  }
+  BLI_bvhtree_free(data.tree_a);
+  BLI_bvhtree_free(data.tree_b);
+
+  Array<double3> positions(result_verts_num);
+  positions.as_mutable_span().take_front(verts_num).copy_from(data.positions);
+  positions.as_mutable_span().slice(verts_num, crossings.size()).copy_from(crossing_positions);
+  Array<int> vert_src(positions.size(), -1);
+  vert_src.as_mutable_span().take_front(verts_num).copy_from(combined.vert_src);
+  for (const int i : splits.index_range()) {
+    positions.as_mutable_span()
+        .slice(new_vert_groups[i].shift(new_verts_start))
+        .copy_from(splits[i].new_positions);
+  }
+
+  result.tri_src = tri_src.as_span();
+  result.tri_face = tri_face.as_span();
+  result.tri_flip = tri_flip.as_span();
+  return compact_tri_mesh(positions, vert_src, result_tris, std::move(result));
+}
+
+/** Combine the meshes with a balanced tree of binary operations. */
+static TriMesh reduce_tri_meshes(MutableSpan<TriMesh> meshes, const Operation operation)
+{
+  if (meshes.size() == 1) {
+    return std::move(meshes.first());
+  }
+  const int64_t mid = meshes.size() / 2;
+  TriMesh a;
+  TriMesh b;
+  threading::parallel_invoke(
+      meshes.size() > 2,
+      [&]() { a = reduce_tri_meshes(meshes.take_front(mid), operation); },
+      [&]() { b = reduce_tri_meshes(meshes.drop_front(mid), operation); });
+  return boolean_tri_meshes(a, b, operation);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh Conversion
+ * \{ */
+
+/** Offsets of the elements of every input mesh when all their elements are concatenated. */
+struct MeshOffsets {
+  Array<int> vert;
+  Array<int> edge;
+  Array<int> face;
+  Array<int> corner;
+  Array<int> tri;
+
+  MeshOffsets(const Span<const Mesh *> meshes)
+      : vert(meshes.size() + 1),
+        edge(meshes.size() + 1),
+        face(meshes.size() + 1),
+        corner(meshes.size() + 1),
+        tri(meshes.size() + 1)
+  {
+    for (const int i : meshes.index_range()) {
+      this->vert[i] = meshes[i]->verts_num;
+      this->edge[i] = meshes[i]->edges_num;
+      this->face[i] = meshes[i]->faces_num;
+      this->corner[i] = meshes[i]->corners_num;
+      this->tri[i] = poly_to_tri_count(meshes[i]->faces_num, meshes[i]->corners_num);
+    }
+    offset_indices::accumulate_counts_to_offsets(this->vert);
+    offset_indices::accumulate_counts_to_offsets(this->edge);
+    offset_indices::accumulate_counts_to_offsets(this->face);
+    offset_indices::accumulate_counts_to_offsets(this->corner);
+    offset_indices::accumulate_counts_to_offsets(this->tri);
+  }
+};
+
+/** Find the input mesh that contains an element in the concatenated element indices. */
+static int mesh_for_index(const Span<int> offsets, const int index)
+{
+  return int(std::upper_bound(offsets.begin(), offsets.end(), index) - offsets.begin()) - 1;
+}
+
+/** Whether every edge is used by two faces that traverse it in opposite directions. */
+static bool mesh_is_closed_manifold(const Mesh &mesh)
+{
+  const Span<int2> edges = mesh.edges();
+  const Span<int> corner_verts = mesh.corner_verts();
+  const Span<int> corner_edges = mesh.corner_edges();
+  Array<int2> edge_uses(edges.size(), int2(0));
+  for (const int corner : corner_verts.index_range()) {
+    const int edge = corner_edges[corner];
+    edge_uses[edge][edges[edge][0] == corner_verts[corner] ? 0 : 1]++;
+  }
+  return std::all_of(edge_uses.begin(), edge_uses.end(), [](const int2 &uses) {
+    return uses == int2(1, 1);
+  });
+}
+
+/**
+ * Rounding the intersection positions can collapse parts of the triangles that the perturbation
+ * needs to connect the result, which is detected by checking the result topology.
+ */
+static bool tri_mesh_is_closed_manifold(const TriMesh &mesh)
+{
+  Map<OrderedEdge, int2> edge_uses;
+  edge_uses.reserve(mesh.tris.size() * 3 / 2);
+  for (const int3 &tri : mesh.tris) {
+    for (const int j : IndexRange(3)) {
+      const int v1 = tri[j];
+      const int v2 = tri[(j + 1) % 3];
+      edge_uses.lookup_or_add(OrderedEdge(v1, v2), int2(0))[v1 < v2 ? 0 : 1]++;
+    }
+  }
+  return std::all_of(edge_uses.values().begin(), edge_uses.values().end(), [](const int2 &uses) {
+    return uses == int2(1, 1);
+  });
+}
+
+static TriMesh mesh_to_tri_mesh(const Mesh &mesh,
+                                const float4x4 &transform,
+                                const bool flip,
+                                const MeshOffsets &offsets,
+                                const int mesh_index)
+{
+  TriMesh tri_mesh;
+  const Span<float3> positions = mesh.vert_positions();
+  tri_mesh.positions.reinitialize(positions.size());
+  const bool use_transform = transform != float4x4::identity();
+  threading::parallel_for(positions.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      tri_mesh.positions[i] = double3(
+          use_transform ? math::transform_point(transform, positions[i]) : positions[i]);
+    }
+  });
+  tri_mesh.vert_src.reinitialize(positions.size());
+  array_utils::fill_index_range<int>(tri_mesh.vert_src, offsets.vert[mesh_index]);
+
+  const Span<int> corner_verts = mesh.corner_verts();
+  const Span<int3> corner_tris = mesh.corner_tris();
+  const Span<int> tri_faces = mesh.corner_tri_faces();
+  tri_mesh.tris.reinitialize(corner_tris.size());
+  tri_mesh.tri_face.reinitialize(corner_tris.size());
+  threading::parallel_for(corner_tris.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const int3 tri(corner_verts[corner_tris[i][0]],
+                     corner_verts[corner_tris[i][1]],
+                     corner_verts[corner_tris[i][2]]);
+      tri_mesh.tris[i] = flip ? flip_tri(tri) : tri;
+      tri_mesh.tri_face[i] = offsets.face[mesh_index] + tri_faces[i];
+    }
+  });
+  tri_mesh.tri_src.reinitialize(corner_tris.size());
+  array_utils::fill_index_range<int>(tri_mesh.tri_src, offsets.tri[mesh_index]);
+  tri_mesh.tri_flip = Array<bool>(corner_tris.size(), flip);
+  return tri_mesh;
+}
+
+/** Elements of the result grouped by the input mesh that they come from. */
+struct SourceGroups {
+  /** For every input mesh, a range in #dst_indices and #src_indices. */
+  Array<int> offsets;
+  Array<int> dst_indices;
+  /** Index of the element in the input mesh. */
+  Array<int> src_indices;
+
+  IndexRange group(const int mesh_index) const
+  {
+    return OffsetIndices<int>(this->offsets)[mesh_index];
+  }
+};
+
+static SourceGroups group_by_source_mesh(const Span<int> src, const Span<int> mesh_offsets)
+{
+  const int meshes_num = int(mesh_offsets.size()) - 1;
+  Array<int> src_mesh(src.size());
+  SourceGroups groups;
+  groups.offsets.reinitialize(meshes_num + 1);
+  groups.offsets.fill(0);
+  for (const int i : src.index_range()) {
+    src_mesh[i] = src[i] == -1 ? -1 : mesh_for_index(mesh_offsets, src[i]);
+    if (src_mesh[i] != -1) {
+      groups.offsets[src_mesh[i]]++;
+    }
+  }
+  const OffsetIndices<int> offsets = offset_indices::accumulate_counts_to_offsets(groups.offsets);
+  groups.dst_indices.reinitialize(offsets.total_size());
+  groups.src_indices.reinitialize(offsets.total_size());
+  Array<int> counts(meshes_num, 0);
+  for (const int i : src.index_range()) {
+    if (src_mesh[i] != -1) {
+      const int pos = offsets[src_mesh[i]][counts[src_mesh[i]]++];
+      groups.dst_indices[pos] = i;
+      groups.src_indices[pos] = src[i] - mesh_offsets[src_mesh[i]];
+    }
+  }
+  return groups;
+}
+
+/** Interpolation weights for corners of the result that are inside of an input face. */
+struct CornerInterpolation {
+  SourceGroups groups;
+  /** Offsets into #weights for every element in the groups, using the input face sizes. */
+  Array<int> weight_offsets;
+  Array<float> weights;
+};
+
+static void copy_group_values(const SourceGroups &groups,
+                              const int mesh_index,
+                              const GSpan src,
+                              GMutableSpan dst)
+{
+  const CPPType &type = dst.type();
+  threading::parallel_for(groups.group(mesh_index), 2048, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      type.copy_assign(src[groups.src_indices[i]], dst[groups.dst_indices[i]]);
+    }
+  });
+}
+
+static void interpolate_group_values(const CornerInterpolation &interpolation,
+                                     const OffsetIndices<int> src_faces,
+                                     const int mesh_index,
+                                     const GSpan src,
+                                     GMutableSpan dst)
+{
+  const IndexRange range = interpolation.groups.group(mesh_index);
+  const OffsetIndices<int> weight_offsets(interpolation.weight_offsets);
+  bke::attribute_math::convert_to_static_type(dst.type(), [&](auto dummy) {
+    using T = decltype(dummy);
+    using Mixer = bke::attribute_math::DefaultMixer<T>;
+    const Span<T> src_typed = src.typed<T>();
+    MutableSpan<T> dst_typed = dst.typed<T>();
+    if constexpr (std::is_void_v<Mixer>) {
+      /* Use the value of the corner with the largest weight. */
+      for (const int64_t i : range) {
+        const Span<float> weights = interpolation.weights.as_span().slice(weight_offsets[i]);
+        const int64_t max_i = std::max_element(weights.begin(), weights.end()) - weights.begin();
+        dst_typed[interpolation.groups.dst_indices[i]] =
+            src_typed[src_faces[interpolation.groups.src_indices[i]][max_i]];
+      }
+    }
+    else {
+      Array<T> values(range.size());
+      Mixer mixer(values);
+      for (const int64_t i : range) {
+        const IndexRange src_face = src_faces[interpolation.groups.src_indices[i]];
+        const Span<float> weights = interpolation.weights.as_span().slice(weight_offsets[i]);
+        for (const int j : src_face.index_range()) {
+          mixer.mix_in(i - range.start(), src_typed[src_face[j]], weights[j]);
+        }
+      }
+      mixer.finalize();
+      for (const int64_t i : range) {
+        dst_typed[interpolation.groups.dst_indices[i]] = values[i - range.start()];
+      }
+    }
+  });
+}
+
+static bool skip_attribute(const StringRef name)
+{
+  return ELEM(name, "position", ".edge_verts", ".corner_vert", ".corner_edge", "material_index");
+}
+
+/**
+ * Build the result mesh. Faces whose triangles are all unchanged keep their original corners, the
+ * remaining triangles become faces of their own.
+ */
+static Mesh *tri_mesh_to_mesh(const TriMesh &tri_mesh,
+                              const Span<const Mesh *> meshes,
+                              const MeshOffsets &offsets,
+                              const Span<float4x4> to_target,
+                              const Span<Array<short>> material_remaps,
+                              Vector<int> *r_intersecting_edges)
+{
+  Array<int> face_unchanged_tris(offsets.face.last(), 0);
+  for (const int tri : tri_mesh.tris.index_range()) {
+    if (tri_mesh.tri_src[tri] != -1) {
+      face_unchanged_tris[tri_mesh.tri_face[tri]]++;
+    }
+  }
+  Array<int> src_vert_to_result(offsets.vert.last(), -1);
+  for (const int vert : tri_mesh.vert_src.index_range()) {
+    if (tri_mesh.vert_src[vert] != -1) {
+      src_vert_to_result[tri_mesh.vert_src[vert]] = vert;
+    }
+  }
+
+  Vector<int> face_sizes;
+  Vector<int> face_src;
+  Vector<int> corner_verts;
+  Vector<int> corner_src;
+  for (const int tri : tri_mesh.tris.index_range()) {
+    const int face = tri_mesh.tri_face[tri];
+    const int mesh_i = mesh_for_index(offsets.face, face);
+    const Mesh &mesh = *meshes[mesh_i];
+    const int face_i = face - offsets.face[mesh_i];
+    const IndexRange src_face = mesh.faces()[face_i];
+    const bool flip = tri_mesh.tri_flip[tri];
+    const int3 &tri_verts = tri_mesh.tris[tri];
+    const int src_tri = tri_mesh.tri_src[tri];
+    if (src_tri != -1 &&
+        face_unchanged_tris[face] == bke::mesh::face_triangles_num(int(src_face.size())))
+    {
+      const int first_tri = offsets.tri[mesh_i] +
+                            int(bke::mesh::face_triangles_range(mesh.faces(), face_i).start());
+      if (src_tri != first_tri) {
+        continue;
+      }
+      const Span<int> src_corner_verts = mesh.corner_verts();
+      for (const int i : src_face.index_range()) {
+        const int corner = src_face[flip ? src_face.size() - 1 - i : i];
+        corner_verts.append(src_vert_to_result[offsets.vert[mesh_i] + src_corner_verts[corner]]);
+        corner_src.append(offsets.corner[mesh_i] + corner);
+      }
+      face_sizes.append(int(src_face.size()));
+      face_src.append(face);
+      continue;
+    }
+    for (const int i : IndexRange(3)) {
+      corner_verts.append(tri_verts[i]);
+      if (src_tri == -1) {
+        corner_src.append(-1);
+        continue;
+      }
+      const int3 &src_corners = mesh.corner_tris()[src_tri - offsets.tri[mesh_i]];
+      corner_src.append(offsets.corner[mesh_i] + src_corners[flip ? (3 - i) % 3 : i]);
+    }
+    face_sizes.append(3);
+    face_src.append(face);
+  }
+
+  Mesh *result = BKE_mesh_new_nomain(
+      int(tri_mesh.positions.size()), 0, int(face_sizes.size()), int(corner_verts.size()));
+  BKE_mesh_copy_parameters_for_eval(result, meshes[0]);
+  MutableSpan<float3> positions = result->vert_positions_for_write();
+  threading::parallel_for(positions.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      positions[i] = float3(tri_mesh.positions[i]);
+    }
+  });
+  MutableSpan<int> face_offsets = result->face_offsets_for_write();
+  face_offsets.drop_back(1).copy_from(face_sizes);
+  offset_indices::accumulate_counts_to_offsets(face_offsets);
+  result->corner_verts_for_write().copy_from(corner_verts);
+  bke::mesh_calc_edges(*result, false, false);
+
+  const OffsetIndices<int> dst_faces = result->faces();
+  const Span<int> dst_corner_edges = result->corner_edges();
+
+  /* Corners of split triangles at original vertices of the face copy the corner values. */
+  threading::parallel_for(dst_faces.index_range(), 1024, [&](const IndexRange range) {
+    for (const int64_t face : range) {
+      const int mesh_i = mesh_for_index(offsets.face, face_src[face]);
+      const IndexRange src_face = meshes[mesh_i]->faces()[face_src[face] - offsets.face[mesh_i]];
+      const Span<int> src_corner_verts = meshes[mesh_i]->corner_verts();
+      for (const int corner : dst_faces[face]) {
+        const int vert_src = tri_mesh.vert_src[corner_verts[corner]];
+        if (corner_src[corner] != -1 || vert_src == -1) {
+          continue;
+        }
+        for (const int src_corner : src_face) {
+          if (offsets.vert[mesh_i] + src_corner_verts[src_corner] == vert_src) {
+            corner_src[corner] = offsets.corner[mesh_i] + src_corner;
+            break;
+          }
+        }
+      }
+    }
+  });
+
+  /* Edges that existed in the face they are part of keep their values. */
+  Array<int> edge_src(result->edges_num, -1);
+  for (const int face : dst_faces.index_range()) {
+    const IndexRange dst_face = dst_faces[face];
+    const int mesh_i = mesh_for_index(offsets.face, face_src[face]);
+    const Mesh &mesh = *meshes[mesh_i];
+    const IndexRange src_face = mesh.faces()[face_src[face] - offsets.face[mesh_i]];
+    for (const int i : dst_face.index_range()) {
+      const int corner = corner_src[dst_face[i]];
+      const int next_corner = corner_src[dst_face[(i + 1) % dst_face.size()]];
+      if (corner == -1 || next_corner == -1) {
+        continue;
+      }
+      const int corner_i = corner - offsets.corner[mesh_i];
+      const int next_corner_i = next_corner - offsets.corner[mesh_i];
+      if (bke::mesh::face_corner_next(src_face, corner_i) == next_corner_i) {
+        edge_src[dst_corner_edges[dst_face[i]]] = offsets.edge[mesh_i] +
+                                                  mesh.corner_edges()[corner_i];
+      }
+      else if (bke::mesh::face_corner_next(src_face, next_corner_i) == corner_i) {
+        edge_src[dst_corner_edges[dst_face[i]]] = offsets.edge[mesh_i] +
+                                                  mesh.corner_edges()[next_corner_i];
+      }
+    }
+  }
+
+  const SourceGroups vert_groups = group_by_source_mesh(tri_mesh.vert_src, offsets.vert);
+  const SourceGroups edge_groups = group_by_source_mesh(edge_src, offsets.edge);
+  const SourceGroups face_groups = group_by_source_mesh(face_src, offsets.face);
+  const SourceGroups corner_groups = group_by_source_mesh(corner_src, offsets.corner);
+
+  CornerInterpolation interpolation;
+  {
+    Array<int> interpolated_face_src(corner_src.size(), -1);
+    for (const int face : dst_faces.index_range()) {
+      for (const int corner : dst_faces[face]) {
+        if (corner_src[corner] == -1) {
+          interpolated_face_src[corner] = face_src[face];
+        }
+      }
+    }
+    interpolation.groups = group_by_source_mesh(interpolated_face_src, offsets.face);
+    const int interpolated_num = int(interpolation.groups.dst_indices.size());
+    interpolation.weight_offsets.reinitialize(interpolated_num + 1);
+    for (const int i : IndexRange(interpolated_num)) {
+      const int mesh_i = mesh_for_index(interpolation.groups.offsets, i);
+      interpolation.weight_offsets[i] =
+          meshes[mesh_i]->faces()[interpolation.groups.src_indices[i]].size();
+    }
+    const OffsetIndices<int> weight_offsets = offset_indices::accumulate_counts_to_offsets(
+        interpolation.weight_offsets);
+    interpolation.weights.reinitialize(weight_offsets.total_size());
+    for (const int mesh_i : meshes.index_range()) {
+      const Mesh &mesh = *meshes[mesh_i];
+      const Span<float3> src_positions = mesh.vert_positions();
+      const Span<int> src_corner_verts = mesh.corner_verts();
+      threading::parallel_for(
+          interpolation.groups.group(mesh_i), 256, [&](const IndexRange range) {
+            Vector<float3> face_positions;
+            for (const int64_t i : range) {
+              const IndexRange src_face = mesh.faces()[interpolation.groups.src_indices[i]];
+              face_positions.resize(src_face.size());
+              for (const int j : src_face.index_range()) {
+                face_positions[j] = math::transform_point(
+                    to_target[mesh_i], src_positions[src_corner_verts[src_face[j]]]);
+              }
+              const int corner = interpolation.groups.dst_indices[i];
+              interp_weights_poly_v3(
+                  interpolation.weights.as_mutable_span().slice(weight_offsets[i]).data(),
+                  reinterpret_cast<float(*)[3]>(face_positions.data()),
+                  int(src_face.size()),
+                  positions[corner_verts[corner]]);
+            }
+          });
+    }
+  }
+
+  /* Gather the attributes of all input meshes. */
+  Map<std::string, bke::AttributeDomainAndType> attributes_to_copy;
+  for (const Mesh *mesh : meshes) {
+    mesh->attributes().foreach_attribute([&](const bke::AttributeIter &iter) {
+      if (skip_attribute(iter.name) || iter.data_type == CD_PROP_STRING) {
+        return;
+      }
+      attributes_to_copy.add_or_modify(
+          iter.name,
+          [&](bke::AttributeDomainAndType *value) {
+            *value = {iter.domain, iter.data_type};
+          },
+          [&](bke::AttributeDomainAndType *value) {
+            value->data_type = bke::attribute_data_type_highest_complexity(
+                {value->data_type, iter.data_type});
+          });
+    });
+  }
+
+  bke::MutableAttributeAccessor dst_attributes = result->attributes_for_write();
+  for (const auto item : attributes_to_copy.items()) {
+    const bke::AttrDomain domain = item.value.domain;
+    const eCustomDataType data_type = item.value.data_type;
+    bke::GSpanAttributeWriter dst = dst_attributes.lookup_or_add_for_write_span(
+        item.key, domain, data_type);
+    if (!dst) {
+      continue;
+    }
+    for (const int mesh_i : meshes.index_range()) {
+      const bke::GAttributeReader src = meshes[mesh_i]->attributes().lookup(
+          item.key, domain, data_type);
+      if (!src) {
+        continue;
+      }
+      const GVArraySpan src_span(*src);
+      switch (domain) {
+        case bke::AttrDomain::Point:
+          copy_group_values(vert_groups, mesh_i, src_span, dst.span);
+          break;
+        case bke::AttrDomain::Edge:
+          copy_group_values(edge_groups, mesh_i, src_span, dst.span);
+          break;
+        case bke::AttrDomain::Face:
+          copy_group_values(face_groups, mesh_i, src_span, dst.span);
+          break;
+        case bke::AttrDomain::Corner:
+          copy_group_values(corner_groups, mesh_i, src_span, dst.span);
+          interpolate_group_values(
+              interpolation, meshes[mesh_i]->faces(), mesh_i, src_span, dst.span);
+          break;
+        default:
+          BLI_assert_unreachable();
+          break;
+      }
+    }
+    dst.finish();
+  }
+
+  bke::SpanAttributeWriter<int> dst_material_indices =
+      dst_attributes.lookup_or_add_for_write_only_span<int>("material_index",
+                                                            bke::AttrDomain::Face);
+  for (const int mesh_i : meshes.index_range()) {
+    const VArraySpan<int> src_material_indices = *meshes[mesh_i]->attributes().lookup_or_default(
+        "material_index", bke::AttrDomain::Face, 0);
+    const Span<short> remap = material_remaps.is_empty() ? Span<short>() :
+                                                           material_remaps[mesh_i].as_span();
+    const IndexRange group = face_groups.group(mesh_i);
+    threading::parallel_for(group, 4096, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        const int src_index = src_material_indices[face_groups.src_indices[i]];
+        const int remapped = remap.index_range().contains(src_index) ? remap[src_index] : -1;
+        dst_material_indices.span[face_groups.dst_indices[i]] = remapped >= 0 ? remapped :
+                                                                                 src_index;
+      }
+    });
+  }
+  dst_material_indices.finish();
+
+  if (r_intersecting_edges != nullptr) {
+    const Set<OrderedEdge> intersection_edges(tri_mesh.intersection_edges);
+    const Span<int2> edges = result->edges();
+    for (const int edge : edges.index_range()) {
+      if (intersection_edges.contains(edges[edge])) {
+        r_intersecting_edges->append(edge);
+      }
+    }
+  }
+  return result;
+}
+
+/** \} */
+
+Mesh *mesh_boolean_manifold(Span<const Mesh *> meshes,
+                            Span<float4x4> transforms,
+                            const float4x4 &target_transform,
+                            Span<Array<short>> material_remaps,
+                            const Operation operation,
+                            Vector<int> *r_intersecting_edges)
+{
+  BLI_assert(transforms.is_empty() || meshes.size() == transforms.size());
+  BLI_assert(material_remaps.is_empty() || material_remaps.size() == meshes.size());
+  if (meshes.is_empty()) {
+    return nullptr;
+  }
+  Array<bool> is_manifold(meshes.size());
+  threading::parallel_for(meshes.index_range(), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      is_manifold[i] = mesh_is_closed_manifold(*meshes[i]);
+    }
+  });
+  if (!std::all_of(is_manifold.begin(), is_manifold.end(), [](const bool v) { return v; })) {
+    return nullptr;
+  }
+
+  const MeshOffsets offsets(meshes);
+  const float4x4 inv_target = math::invert(target_transform);
+  Array<float4x4> to_target(meshes.size());
+  Array<TriMesh> tri_meshes(meshes.size());
+  threading::parallel_for(meshes.index_range(), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const float4x4 transform = transforms.is_empty() ? float4x4::identity() : transforms[i];
+      to_target[i] = inv_target * transform;
+      /* Like the other solvers, flip meshes whose transform is mirrored compared to the first. */
+      const bool flip = !transforms.is_empty() &&
+                        math::is_negative(transform) != math::is_negative(transforms[0]);
+      tri_meshes[i] = mesh_to_tri_mesh(*meshes[i], to_target[i], flip, offsets, int(i));
+    }
+  });
+
+  TriMesh tri_mesh;
+  if (operation == Operation::Difference && meshes.size() > 2) {
+    const TriMesh cutters = reduce_tri_meshes(tri_meshes.as_mutable_span().drop_front(1),
+                                              Operation::Union);
+    tri_mesh = boolean_tri_meshes(tri_meshes[0], cutters, operation);
+  }
+  else {
+    tri_mesh = reduce_tri_meshes(tri_meshes, operation);
+  }
+  if (!tri_mesh_is_closed_manifold(tri_mesh)) {
+    return nullptr;
+  }
+
+  return tri_mesh_to_mesh(
+      tri_mesh, meshes, offsets, to_target, material_remaps, r_intersecting_edges);
+}
+
+#endif /* WITH_GMP */
+
+}  // namespace blender::geometry::boolean
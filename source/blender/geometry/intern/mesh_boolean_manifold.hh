@@ -0,0 +1,30 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "GEO_mesh_boolean.hh"
+
+namespace blender::geometry::boolean {
+
+#ifdef WITH_GMP
+
+/**
+ * Boolean operation for meshes that are all closed manifolds, i.e. every edge is used by exactly
+ * two faces which traverse it in opposite directions. See #Solver::Manifold.
+ *
+ * \return The result mesh, or null when one of the meshes isn't a closed manifold or when
+ * degenerate intersections (like partially overlapping coplanar faces) couldn't be resolved with
+ * rounded positions, so that the caller can use a more general solver instead.
+ */
+Mesh *mesh_boolean_manifold(Span<const Mesh *> meshes,
+                            Span<float4x4> transforms,
+                            const float4x4 &target_transform,
+                            Span<Array<short>> material_remaps,
+                            Operation operation,
+                            Vector<int> *r_intersecting_edges);
+
+#endif
+
+}  // namespace blender::geometry::boolean
@@ -5,16 +5,24 @@
 // #define USE_WELD_DEBUG
 // #define USE_WELD_DEBUG_TIME
 
+#include <atomic>
+
 #include "BLI_array.hh"
+#include "BLI_atomic_disjoint_set.hh"
 #include "BLI_bit_vector.hh"
+#include "BLI_bounds.hh"
 #include "BLI_index_mask.hh"
 #include "BLI_kdtree.h"
 #include "BLI_math_vector.h"
+#include "BLI_math_vector.hh"
 #include "BLI_offset_indices.hh"
+#include "BLI_sort.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "BKE_customdata.hh"
 #include "BKE_mesh.hh"
+#include "BKE_mesh_mapping.hh"
 #include "DNA_meshdata_types.h"
 
 #include "GEO_mesh_merge_by_distance.hh"
@@ -333,35 +341,54 @@ static Vector<WeldEdge> weld_edge_ctx_alloc_and_find_collapsed(Span<int2> edges,
                                                                int *r_edge_collapsed_len)
 {
   /* Edge Context. */
-  int edge_collapsed_len = 0;
+  *r_edge_collapsed_len = threading::parallel_reduce(
+      edges.index_range(),
+      4096,
+      0,
+      [&](const IndexRange range, int edge_collapsed_len) {
+        for (const int i : range) {
+          const int v1 = edges[i][0];
+          const int v2 = edges[i][1];
+          const int v_dest_1 = vert_dest_map[v1];
+          const int v_dest_2 = vert_dest_map[v2];
+          if (v_dest_1 == OUT_OF_CONTEXT && v_dest_2 == OUT_OF_CONTEXT) {
+            r_edge_dest_map[i] = OUT_OF_CONTEXT;
+            continue;
+          }
 
-  Vector<WeldEdge> wedge;
-  wedge.reserve(edges.size());
-
-  for (const int i : edges.index_range()) {
-    int v1 = edges[i][0];
-    int v2 = edges[i][1];
-    int v_dest_1 = vert_dest_map[v1];
-    int v_dest_2 = vert_dest_map[v2];
-    if (v_dest_1 == OUT_OF_CONTEXT && v_dest_2 == OUT_OF_CONTEXT) {
-      r_edge_dest_map[i] = OUT_OF_CONTEXT;
-      continue;
-    }
+          const int vert_a = (v_dest_1 == OUT_OF_CONTEXT) ? v1 : v_dest_1;
+          const int vert_b = (v_dest_2 == OUT_OF_CONTEXT) ? v2 : v_dest_2;
 
+          if (vert_a == vert_b) {
+            r_edge_dest_map[i] = ELEM_COLLAPSED;
+            edge_collapsed_len++;
+          }
+          else {
+            r_edge_dest_map[i] = i;
+          }
+        }
+        return edge_collapsed_len;
+      },
+      std::plus<>());
+
+  /* Gather the remaining edges of the context in a second pass, so that their order does not
+   * depend on the threading. */
+  IndexMaskMemory memory;
+  const IndexMask wedge_mask = IndexMask::from_predicate(
+      edges.index_range(), GrainSize(4096), memory, [&](const int i) {
+        return r_edge_dest_map[i] == i;
+      });
+
+  Vector<WeldEdge> wedge(wedge_mask.size());
+  wedge_mask.foreach_index(GrainSize(4096), [&](const int i, const int pos) {
+    const int v1 = edges[i][0];
+    const int v2 = edges[i][1];
+    const int v_dest_1 = vert_dest_map[v1];
+    const int v_dest_2 = vert_dest_map[v2];
     const int vert_a = (v_dest_1 == OUT_OF_CONTEXT) ? v1 : v_dest_1;
     const int vert_b = (v_dest_2 == OUT_OF_CONTEXT) ? v2 : v_dest_2;
-
-    if (vert_a == vert_b) {
-      r_edge_dest_map[i] = ELEM_COLLAPSED;
-      edge_collapsed_len++;
-    }
-    else {
-      wedge.append({i, vert_a, vert_b});
-      r_edge_dest_map[i] = i;
-    }
-  }
-
-  *r_edge_collapsed_len = edge_collapsed_len;
+    wedge[pos] = {i, vert_a, vert_b};
+  });
   return wedge;
 }
 
@@ -380,104 +407,86 @@ static void weld_edge_find_doubles(Span<WeldEdge> weld_edges,
                                    int *r_edge_double_kill_len)
 {
   /* Setup Edge Overlap. */
-  int edge_double_kill_len = 0;
-
   if (weld_edges.is_empty()) {
-    *r_edge_double_kill_len = edge_double_kill_len;
+    *r_edge_double_kill_len = 0;
     return;
   }
 
-  /* Add +1 to allow calculation of the length of the last group. */
-  Array<int> v_links(mvert_num + 1, 0);
-
-  for (const WeldEdge &we : weld_edges) {
-    BLI_assert(r_edge_dest_map[we.edge_orig] != ELEM_COLLAPSED);
-    BLI_assert(we.vert_a != we.vert_b);
-    v_links[we.vert_a]++;
-    v_links[we.vert_b]++;
-  }
-
-  int link_len = 0;
-  for (const int i : IndexRange(mvert_num)) {
-    link_len += v_links[i];
-    v_links[i] = link_len;
-  }
-  v_links.last() = link_len;
-
-  BLI_assert(link_len > 0);
-  Array<int> link_edge_buffer(link_len);
-
-  /* Use a reverse for loop to ensure that indexes are assigned in ascending order. */
-  for (int i = weld_edges.size(); i--;) {
-    const WeldEdge &we = weld_edges[i];
-    BLI_assert(r_edge_dest_map[we.edge_orig] != ELEM_COLLAPSED);
-    int dst_vert_a = we.vert_a;
-    int dst_vert_b = we.vert_b;
-
-    link_edge_buffer[--v_links[dst_vert_a]] = i;
-    link_edge_buffer[--v_links[dst_vert_b]] = i;
-  }
-
-  for (const int i : weld_edges.index_range()) {
-    const WeldEdge &we = weld_edges[i];
-    BLI_assert(r_edge_dest_map[we.edge_orig] != OUT_OF_CONTEXT);
-    if (r_edge_dest_map[we.edge_orig] != we.edge_orig) {
-      /* Already a duplicate. */
-      continue;
-    }
-
-    int dst_vert_a = we.vert_a;
-    int dst_vert_b = we.vert_b;
-
-    const int link_a = v_links[dst_vert_a];
-    const int link_b = v_links[dst_vert_b];
-
-    int edges_len_a = v_links[dst_vert_a + 1] - link_a;
-    int edges_len_b = v_links[dst_vert_b + 1] - link_b;
-
-    int edge_orig = we.edge_orig;
-    if (edges_len_a <= 1 || edges_len_b <= 1) {
-      /* This edge would form a group with only one element.
-       * For better performance, mark these edges and avoid forming these groups. */
-      r_edge_dest_map[edge_orig] = OUT_OF_CONTEXT;
-      continue;
-    }
-
-    int *edges_ctx_a = &link_edge_buffer[link_a];
-    int *edges_ctx_b = &link_edge_buffer[link_b];
-
-    const int edge_double_len_prev = edge_double_kill_len;
-    for (; edges_len_a--; edges_ctx_a++) {
-      int e_ctx_a = *edges_ctx_a;
-      if (e_ctx_a == i) {
-        continue;
-      }
-      while (edges_len_b && *edges_ctx_b < e_ctx_a) {
-        edges_ctx_b++;
-        edges_len_b--;
-      }
-      if (edges_len_b == 0) {
-        break;
-      }
-      int e_ctx_b = *edges_ctx_b;
-      if (e_ctx_a == e_ctx_b) {
-        const WeldEdge &we_b = weld_edges[e_ctx_b];
-        BLI_assert(ELEM(we_b.vert_a, dst_vert_a, dst_vert_b));
-        BLI_assert(ELEM(we_b.vert_b, dst_vert_a, dst_vert_b));
-        BLI_assert(we_b.edge_orig != edge_orig);
-        BLI_assert(r_edge_dest_map[we_b.edge_orig] == we_b.edge_orig);
-        r_edge_dest_map[we_b.edge_orig] = edge_orig;
-        edge_double_kill_len++;
-      }
-    }
-    if (edge_double_len_prev == edge_double_kill_len) {
-      /* This edge would form a group with only one element.
-       * For better performance, mark these edges and avoid forming these groups. */
-      r_edge_dest_map[edge_orig] = OUT_OF_CONTEXT;
-    }
-  }
+  Array<int2> weld_edge_verts(weld_edges.size());
+  threading::parallel_for(weld_edges.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      const WeldEdge &we = weld_edges[i];
+      BLI_assert(r_edge_dest_map[we.edge_orig] != ELEM_COLLAPSED);
+      BLI_assert(we.vert_a != we.vert_b);
+      weld_edge_verts[i] = int2(we.vert_a, we.vert_b);
+    }
+  });
+
+  /* The weld edges of every vertex, in ascending order. */
+  Array<int> link_offsets;
+  Array<int> link_edges;
+  const GroupedSpan<int> vert_to_weld_edge = bke::mesh::build_vert_to_edge_map(
+      weld_edge_verts, mvert_num, link_offsets, link_edges);
+
+  /* Edges with the same vertices are merged into the first of them. Every edge finds that first
+   * edge independently, so this does not depend on the order in which the edges are handled. */
+  *r_edge_double_kill_len = threading::parallel_reduce(
+      weld_edges.index_range(),
+      1024,
+      0,
+      [&](const IndexRange range, int edge_double_kill_len) {
+        for (const int i : range) {
+          const WeldEdge &we = weld_edges[i];
+          BLI_assert(r_edge_dest_map[we.edge_orig] == we.edge_orig);
+          const Span<int> edges_a = vert_to_weld_edge[we.vert_a];
+          const Span<int> edges_b = vert_to_weld_edge[we.vert_b];
+          if (edges_a.size() <= 1 || edges_b.size() <= 1) {
+            /* This edge would form a group with only one element.
+             * For better performance, mark these edges and avoid forming these groups. */
+            r_edge_dest_map[we.edge_orig] = OUT_OF_CONTEXT;
+            continue;
+          }
 
-  *r_edge_double_kill_len = edge_double_kill_len;
+          /* Both spans are sorted, so the first common edge is the target of the group and the
+           * second one tells whether the group has more than one element. */
+          int first_double = -1;
+          bool has_doubles = false;
+          const int *edge_b = edges_b.begin();
+          for (const int e_ctx_a : edges_a) {
+            while (edge_b != edges_b.end() && *edge_b < e_ctx_a) {
+              edge_b++;
+            }
+            if (edge_b == edges_b.end()) {
+              break;
+            }
+            if (*edge_b == e_ctx_a) {
+              if (first_double == -1) {
+                first_double = e_ctx_a;
+              }
+              else {
+                has_doubles = true;
+                break;
+              }
+            }
+          }
+          BLI_assert(first_double != -1 && first_double <= i);
+
+          if (first_double != i) {
+            const WeldEdge &we_dest = weld_edges[first_double];
+            BLI_assert(ELEM(we_dest.vert_a, we.vert_a, we.vert_b));
+            BLI_assert(ELEM(we_dest.vert_b, we.vert_a, we.vert_b));
+            r_edge_dest_map[we.edge_orig] = we_dest.edge_orig;
+            edge_double_kill_len++;
+          }
+          else if (!has_doubles) {
+            /* This edge would form a group with only one element.
+             * For better performance, mark these edges and avoid forming these groups. */
+            r_edge_dest_map[we.edge_orig] = OUT_OF_CONTEXT;
+          }
+        }
+        return edge_double_kill_len;
+      },
+      std::plus<>());
 }
 
 /** \} */
@@ -583,100 +592,100 @@ static void weld_poly_loop_ctx_alloc(const OffsetIndices<int> faces,
   /* Loop/Poly Context. */
   Array<int> loop_map(corner_verts.size());
   Array<int> face_map(faces.size());
-  int wloop_len = 0;
-  int wpoly_len = 0;
-  int max_ctx_poly_len = 4;
-
-  Vector<WeldLoop> wloop;
-  wloop.reserve(corner_verts.size());
 
-  Vector<WeldPoly> wpoly;
-  wpoly.reserve(faces.size());
-
-  int maybe_new_poly = 0;
-
-  for (const int i : faces.index_range()) {
-    const int loopstart = faces[i].start();
-    const int totloop = faces[i].size();
-    const int loop_end = loopstart + totloop - 1;
-    int v_first = corner_verts[loopstart];
-    int v_dest_first = vert_dest_map[v_first];
-    bool is_vert_first_ctx = v_dest_first != OUT_OF_CONTEXT;
-
-    int v_next = v_first;
-    int v_dest_next = v_dest_first;
-    bool is_vert_next_ctx = is_vert_first_ctx;
-
-    int prev_wloop_len = wloop_len;
-    for (const int loop_orig : faces[i]) {
-      int v = v_next;
-      int v_dest = v_dest_next;
-      bool is_vert_ctx = is_vert_next_ctx;
+  /* A loop is part of the context when its vertex or the next vertex is merged. */
+  auto is_loop_ctx = [&](const IndexRange face, const int loop) {
+    return vert_dest_map[corner_verts[loop]] != OUT_OF_CONTEXT ||
+           vert_dest_map[corner_verts[bke::mesh::face_corner_next(face, loop)]] != OUT_OF_CONTEXT;
+  };
 
-      int loop_next;
-      if (loop_orig != loop_end) {
-        loop_next = loop_orig + 1;
-        v_next = corner_verts[loop_next];
-        v_dest_next = vert_dest_map[v_next];
-        is_vert_next_ctx = v_dest_next != OUT_OF_CONTEXT;
-      }
-      else {
-        loop_next = loopstart;
-        v_next = v_first;
-        v_dest_next = v_dest_first;
-        is_vert_next_ctx = is_vert_first_ctx;
+  /* Count the context loops of every face first, so that the context loops and faces can be
+   * filled in parallel afterwards. Their order is the same as when iterating over the faces. */
+  Array<int> loop_ctx_offset_data(faces.size() + 1);
+  const int2 new_poly_estimate = threading::parallel_reduce(
+      faces.index_range(),
+      1024,
+      int2(0, 4),
+      [&](const IndexRange range, int2 estimate) {
+        for (const int i : range) {
+          const IndexRange face = faces[i];
+          int loop_ctx_len = 0;
+          for (const int loop_orig : face) {
+            if (is_loop_ctx(face, loop_orig)) {
+              loop_ctx_len++;
+            }
+            else {
+              loop_map[loop_orig] = OUT_OF_CONTEXT;
+            }
+          }
+          loop_ctx_offset_data[i] = loop_ctx_len;
+          if (loop_ctx_len == 0) {
+            face_map[i] = OUT_OF_CONTEXT;
+          }
+          else if (face.size() > 5 && loop_ctx_len > 1) {
+            /* We could be smarter here and actually count how many new polygons will be created.
+             * But counting this can be inefficient as it depends on the number of non-consecutive
+             * self face merges. For now just estimate a maximum value. */
+            estimate[0] += std::min(int(face.size() / 3), loop_ctx_len) - 1;
+            estimate[1] = std::max(estimate[1], int(face.size()));
+          }
+        }
+        return estimate;
+      },
+      [](const int2 a, const int2 b) { return int2(a[0] + b[0], std::max(a[1], b[1])); });
+  const int maybe_new_poly = new_poly_estimate[0];
+  const int max_ctx_poly_len = new_poly_estimate[1];
+
+  const OffsetIndices<int> loop_ctx_offsets = offset_indices::accumulate_counts_to_offsets(
+      loop_ctx_offset_data);
+
+  IndexMaskMemory memory;
+  const IndexMask faces_ctx = IndexMask::from_predicate(
+      faces.index_range(), GrainSize(1024), memory, [&](const int i) {
+        return !loop_ctx_offsets[i].is_empty();
+      });
+
+  Vector<WeldLoop> wloop(loop_ctx_offsets.total_size());
+  Vector<WeldPoly> wpoly(faces_ctx.size());
+
+  faces_ctx.foreach_index(GrainSize(1024), [&](const int i, const int wpoly_index) {
+    const IndexRange face = faces[i];
+    const IndexRange loop_ctx = loop_ctx_offsets[i];
+
+    int wloop_index = loop_ctx.start();
+    for (const int loop_orig : face) {
+      if (!is_loop_ctx(face, loop_orig)) {
+        continue;
       }
+      const int v = corner_verts[loop_orig];
+      const int v_dest = vert_dest_map[v];
+      const int e = corner_edges[loop_orig];
+      const int e_dest = edge_dest_map[e];
 
-      if (is_vert_ctx || is_vert_next_ctx) {
-        int e = corner_edges[loop_orig];
-        int e_dest = edge_dest_map[e];
-        bool is_edge_ctx = e_dest != OUT_OF_CONTEXT;
+      WeldLoop &wl = wloop[wloop_index];
+      wl.vert = (v_dest != OUT_OF_CONTEXT) ? v_dest : v;
+      wl.edge = (e_dest != OUT_OF_CONTEXT) ? e_dest : e;
+      wl.loop_orig = loop_orig;
+      wl.loop_next = bke::mesh::face_corner_next(face, loop_orig);
 
-        wloop.increase_size_by_unchecked(1);
-        WeldLoop &wl = wloop.last();
-        wl.vert = is_vert_ctx ? v_dest : v;
-        wl.edge = is_edge_ctx ? e_dest : e;
-        wl.loop_orig = loop_orig;
-        wl.loop_next = loop_next;
-
-        loop_map[loop_orig] = wloop_len++;
-      }
-      else {
-        loop_map[loop_orig] = OUT_OF_CONTEXT;
-      }
+      loop_map[loop_orig] = wloop_index++;
     }
 
-    if (wloop_len != prev_wloop_len) {
-      int loop_ctx_len = wloop_len - prev_wloop_len;
-      wpoly.increase_size_by_unchecked(1);
+    WeldPoly &wp = wpoly[wpoly_index];
+    wp.poly_dst = OUT_OF_CONTEXT;
+    wp.poly_orig = i;
+    wp.loop_start = face.first();
+    wp.loop_end = face.last();
 
-      WeldPoly &wp = wpoly.last();
-      wp.poly_dst = OUT_OF_CONTEXT;
-      wp.poly_orig = i;
-      wp.loop_start = loopstart;
-      wp.loop_end = loop_end;
-
-      wp.loop_ctx_start = prev_wloop_len;
-      wp.loop_ctx_len = loop_ctx_len;
+    wp.loop_ctx_start = loop_ctx.start();
+    wp.loop_ctx_len = loop_ctx.size();
 
 #ifdef USE_WELD_DEBUG
-      wp.loop_len = totloop;
+    wp.loop_len = face.size();
 #endif
 
-      face_map[i] = wpoly_len++;
-      if (totloop > 5 && loop_ctx_len > 1) {
-        /* We could be smarter here and actually count how many new polygons will be created.
-         * But counting this can be inefficient as it depends on the number of non-consecutive
-         * self face merges. For now just estimate a maximum value. */
-        int max_new = std::min((totloop / 3), loop_ctx_len) - 1;
-        maybe_new_poly += max_new;
-        CLAMP_MIN(max_ctx_poly_len, totloop);
-      }
-    }
-    else {
-      face_map[i] = OUT_OF_CONTEXT;
-    }
-  }
+    face_map[i] = wpoly_index;
+  });
 
   wpoly.reserve(wpoly.size() + maybe_new_poly);
 
@@ -1717,6 +1726,194 @@ std::optional<Mesh *> mesh_merge_by_distance_all(const Mesh &mesh,
   return create_merged_mesh(mesh, vert_dest_map, vert_kill_len, true);
 }
 
+/**
+ * Join all selected vertices that are within the \a merge_distance of each other. The vertices
+ * are sorted into a uniform grid with cells that are half as large as the merge distance, so only
+ * vertices in cells up to two cells apart have to be compared. Each cell is compared with half of
+ * its neighbors in parallel.
+ *
+ * All vertices in such a small cell are within the merge distance of each other, so they are
+ * joined without comparing them. That way dense regions don't need a quadratic number of
+ * comparisons, and neighboring cells that are joined already don't have to be compared anymore.
+ */
+static void join_close_verts_with_grid(const Span<float3> positions,
+                                       const IndexMask &selection,
+                                       const float merge_distance,
+                                       AtomicDisjointSet &r_clusters)
+{
+  /* Cell coordinates are packed into a single key, which limits the resolution of the grid. */
+  constexpr int cell_bits = 21;
+  constexpr int max_cell = 1 << (cell_bits - 1);
+  const Bounds<float3> bounds = *bounds::min_max(selection, positions);
+  const float max_extent = math::reduce_max(bounds.max - bounds.min);
+  const float cell_size = std::max({0.5f * merge_distance, max_extent / max_cell, FLT_MIN});
+  /* When the resolution of the grid is too low for the merge distance, the vertices in a cell
+   * have to be compared with each other. */
+  const bool cells_are_clusters = cell_size <= 0.5f * merge_distance;
+
+  auto cell_key = [](const int3 cell) {
+    return (uint64_t(cell.x) << (2 * cell_bits)) | (uint64_t(cell.y) << cell_bits) |
+           uint64_t(cell.z);
+  };
+
+  struct GridVert {
+    uint64_t cell;
+    int vert;
+  };
+  Array<GridVert> grid_verts(selection.size());
+  selection.foreach_index(GrainSize(4096), [&](const int vert, const int pos) {
+    const float3 cell = math::clamp(
+        (positions[vert] - bounds.min) / cell_size, float3(0.0f), float3(max_cell));
+    grid_verts[pos] = {cell_key(int3(cell)), vert};
+  });
+  parallel_sort(grid_verts.begin(), grid_verts.end(), [](const GridVert &a, const GridVert &b) {
+    return a.cell < b.cell || (a.cell == b.cell && a.vert < b.vert);
+  });
+
+  IndexMaskMemory memory;
+  const IndexMask cell_starts = IndexMask::from_predicate(
+      grid_verts.index_range(), GrainSize(4096), memory, [&](const int i) {
+        return i == 0 || grid_verts[i].cell != grid_verts[i - 1].cell;
+      });
+  Array<uint64_t> cell_keys(cell_starts.size());
+  Array<int> cell_offset_data(cell_starts.size() + 1);
+  cell_starts.foreach_index(GrainSize(4096), [&](const int i, const int cell) {
+    cell_keys[cell] = grid_verts[i].cell;
+    cell_offset_data[cell] = i;
+  });
+  cell_offset_data.last() = grid_verts.size();
+  const OffsetIndices<int> cells(cell_offset_data);
+
+  /* Rows of neighbors along the Z axis that are compared with a cell. They have larger keys than
+   * the cell, the other half of the neighbors compare themselves with the cell. The cells in the
+   * same row as the cell are handled separately. */
+  Vector<int2> neighbor_rows;
+  for (int x = 0; x <= 2; x++) {
+    for (int y = -2; y <= 2; y++) {
+      if (x > 0 || y > 0) {
+        neighbor_rows.append({x, y});
+      }
+    }
+  }
+
+  const float merge_dist_sq = square_f(merge_distance);
+  auto join_close_verts = [&](const int a, const IndexRange verts_b) {
+    const int vert_a = grid_verts[a].vert;
+    for (const int b : verts_b) {
+      const int vert_b = grid_verts[b].vert;
+      if (math::distance_squared(positions[vert_a], positions[vert_b]) <= merge_dist_sq) {
+        r_clusters.join(vert_a, vert_b);
+      }
+    }
+  };
+  /* Large cells are compared in parallel, so that a dense region does not end up in a single
+   * serial loop. */
+  auto pair_grain_size = [](const IndexRange verts_b) {
+    return std::max<int64_t>(1, 4096 / verts_b.size());
+  };
+  auto join_cells = [&](const IndexRange verts_a, const IndexRange verts_b) {
+    const int first_vert_a = grid_verts[verts_a.first()].vert;
+    const int first_vert_b = grid_verts[verts_b.first()].vert;
+    threading::parallel_for(verts_a, pair_grain_size(verts_b), [&](const IndexRange range) {
+      for (const int a : range) {
+        if (cells_are_clusters && r_clusters.in_same_set(first_vert_a, first_vert_b)) {
+          return;
+        }
+        join_close_verts(a, verts_b);
+      }
+    });
+  };
+
+  threading::parallel_for(cells.index_range(), 256, [&](const IndexRange range) {
+    for (const int cell : range) {
+      const IndexRange verts = cells[cell];
+      if (cells_are_clusters) {
+        for (const int i : verts.drop_front(1)) {
+          r_clusters.join(grid_verts[verts.first()].vert, grid_verts[i].vert);
+        }
+      }
+      else {
+        threading::parallel_for(verts, pair_grain_size(verts), [&](const IndexRange sub_range) {
+          for (const int i : sub_range) {
+            join_close_verts(i, IndexRange::from_begin_end(i + 1, verts.one_after_last()));
+          }
+        });
+      }
+
+      const uint64_t key = cell_keys[cell];
+      const int3 cell_co(int(key >> (2 * cell_bits)),
+                         int((key >> cell_bits) & ((1 << cell_bits) - 1)),
+                         int(key & ((1 << cell_bits) - 1)));
+      auto join_row = [&](const uint64_t *row_begin, const int2 row_co) {
+        const uint64_t row_end_key = cell_key(int3(row_co, cell_co.z + 2));
+        for (const uint64_t *neighbor = row_begin;
+             neighbor != cell_keys.end() && *neighbor <= row_end_key;
+             neighbor++)
+        {
+          join_cells(verts, cells[neighbor - cell_keys.begin()]);
+        }
+      };
+      join_row(cell_keys.begin() + cell + 1, cell_co.xy());
+      for (const int2 &offset : neighbor_rows) {
+        const int2 row_co = cell_co.xy() + offset;
+        if (math::reduce_min(row_co) < 0 || math::reduce_max(row_co) > max_cell) {
+          continue;
+        }
+        const uint64_t row_begin_key = cell_key(int3(row_co, std::max(cell_co.z - 2, 0)));
+        join_row(std::lower_bound(cell_keys.begin() + cell + 1, cell_keys.end(), row_begin_key),
+                 row_co);
+      }
+    }
+  });
+}
+
+std::optional<Mesh *> mesh_merge_by_distance_clusters(const Mesh &mesh,
+                                                      const IndexMask &selection,
+                                                      const float merge_distance)
+{
+  if (selection.is_empty()) {
+    return std::nullopt;
+  }
+  const Span<float3> positions = mesh.vert_positions();
+  AtomicDisjointSet clusters(mesh.verts_num);
+  join_close_verts_with_grid(positions, selection, merge_distance, clusters);
+
+  /* Merge every cluster into its vertex with the lowest index, so that the result does not depend
+   * on the order in which the vertices were joined. */
+  Array<std::atomic<int>> cluster_targets(mesh.verts_num);
+  selection.foreach_index(GrainSize(4096), [&](const int vert) {
+    cluster_targets[vert].store(std::numeric_limits<int>::max(), std::memory_order_relaxed);
+  });
+  selection.foreach_index(GrainSize(4096), [&](const int vert) {
+    std::atomic<int> &target = cluster_targets[clusters.find_root(vert)];
+    int current = target.load(std::memory_order_relaxed);
+    while (vert < current &&
+           !target.compare_exchange_weak(current, vert, std::memory_order_relaxed))
+    {
+    }
+  });
+  auto cluster_target = [&](const int vert) {
+    return cluster_targets[clusters.find_root(vert)].load(std::memory_order_relaxed);
+  };
+
+  IndexMaskMemory memory;
+  const IndexMask merged_verts = IndexMask::from_predicate(
+      selection, GrainSize(4096), memory, [&](const int vert) {
+        return cluster_target(vert) != vert;
+      });
+  if (merged_verts.is_empty()) {
+    return std::nullopt;
+  }
+
+  /* The targets are added to the context by #weld_vert_ctx_alloc_and_setup. */
+  Array<int> vert_dest_map(mesh.verts_num, OUT_OF_CONTEXT);
+  merged_verts.foreach_index(GrainSize(4096), [&](const int vert) {
+    vert_dest_map[vert] = cluster_target(vert);
+  });
+
+  return create_merged_mesh(mesh, vert_dest_map, merged_verts.size(), true);
+}
+
 struct WeldVertexCluster {
   float co[3];
   int merged_verts;
@@ -498,9 +498,9 @@ static void gather_realize_tasks_recursive(GatherTasksInfo &gather_info,
  * corresponding attribute data.
  */
 static Vector<std::pair<int, GSpan>> prepare_attribute_fallbacks(
-    GatherTasksInfo &gather_info,
     const Instances &instances,
-    const OrderedAttributes &ordered_attributes)
+    const OrderedAttributes &ordered_attributes,
+    Vector<std::unique_ptr<GArray<>>> &r_temporary_arrays)
 {
   Vector<std::pair<int, GSpan>> attributes_to_override;
   const bke::AttributeAccessor attributes = instances.attributes();
@@ -529,7 +529,7 @@ static Vector<std::pair<int, GSpan>> prepare_attribute_fallbacks(
           to_type, instances.instances_num());
       conversions.convert_to_initialized_n(span, temporary_array->as_mutable_span());
       span = temporary_array->as_span();
-      gather_info.r_temporary_arrays.append(std::move(temporary_array));
+      r_temporary_arrays.append(std::move(temporary_array));
     }
     attributes_to_override.append({attribute_index, span});
   });
@@ -574,15 +574,15 @@ static void gather_realize_tasks_for_instances(GatherTasksInfo &gather_info,
   /* Prepare attribute fallbacks. */
   InstanceContext instance_context = base_instance_context;
   Vector<std::pair<int, GSpan>> pointcloud_attributes_to_override = prepare_attribute_fallbacks(
-      gather_info, instances, gather_info.pointclouds.attributes);
+      instances, gather_info.pointclouds.attributes, gather_info.r_temporary_arrays);
   Vector<std::pair<int, GSpan>> mesh_attributes_to_override = prepare_attribute_fallbacks(
-      gather_info, instances, gather_info.meshes.attributes);
+      instances, gather_info.meshes.attributes, gather_info.r_temporary_arrays);
   Vector<std::pair<int, GSpan>> curve_attributes_to_override = prepare_attribute_fallbacks(
-      gather_info, instances, gather_info.curves.attributes);
+      instances, gather_info.curves.attributes, gather_info.r_temporary_arrays);
   Vector<std::pair<int, GSpan>> grease_pencil_attributes_to_override = prepare_attribute_fallbacks(
-      gather_info, instances, gather_info.grease_pencils.attributes);
+      instances, gather_info.grease_pencils.attributes, gather_info.r_temporary_arrays);
   Vector<std::pair<int, GSpan>> instance_attributes_to_override = prepare_attribute_fallbacks(
-      gather_info, instances, gather_info.instances_attriubutes);
+      instances, gather_info.instances_attriubutes, gather_info.r_temporary_arrays);
 
   const bool is_top_level = current_depth == 0;
   /* If at top level, get instance indices from selection field, else use all instances. */
@@ -1280,6 +1280,147 @@ static void execute_realize_pointcloud_tasks(const RealizeInstancesOptions &opti
   point_ids.finish();
 }
 
+/**
+ * Faster version of realizing all instances for the common case where every top-level instance
+ * references a point cloud, e.g. when points are instanced on points. The point offsets of all
+ * instances are computed with a prefix sum over the referenced point cloud sizes and the output
+ * attributes are filled from the instances directly, in parallel chunks. This avoids gathering a
+ * #RealizePointCloudTask for every instance, which can take more memory than the realized points.
+ *
+ * \param reference_geometries: The geometry of every instance reference, which contains nothing
+ * but point clouds.
+ * \return None if the generic code path should be used instead.
+ */
+static std::optional<bke::GeometrySet> realize_pointcloud_instances_directly(
+    const bke::GeometrySet &geometry_set,
+    const Span<bke::GeometrySet> reference_geometries,
+    const RealizeInstancesOptions &options,
+    const VariedDepthOptions &varied_depth_option)
+{
+  const Instances &instances = *geometry_set.get_instances();
+  const Span<InstanceReference> references = instances.references();
+  Array<const PointCloud *> pointcloud_by_handle(references.size());
+  for (const int handle : references.index_range()) {
+    pointcloud_by_handle[handle] = reference_geometries[handle].get_pointcloud();
+  }
+
+  const Span<int> handles = instances.reference_handles();
+  Array<int> offsets_data(instances.instances_num() + 1);
+  int realized_instances_num = 0;
+  int first_instance = -1;
+  for (const int i : handles.index_range()) {
+    const PointCloud *pointcloud = pointcloud_by_handle[handles[i]];
+    offsets_data[i] = pointcloud ? pointcloud->totpoint : 0;
+    if (offsets_data[i] > 0) {
+      realized_instances_num++;
+      if (first_instance == -1) {
+        first_instance = i;
+      }
+    }
+  }
+  if (realized_instances_num < 2) {
+    /* The generic code path can share the data of a single point cloud. */
+    return std::nullopt;
+  }
+  const OffsetIndices points_by_instance = offset_indices::accumulate_counts_to_offsets(
+      offsets_data);
+
+  const AllPointCloudsInfo all_pointclouds_info = preprocess_pointclouds(
+      geometry_set, options, varied_depth_option);
+  const OrderedAttributes &ordered_attributes = all_pointclouds_info.attributes;
+  Array<const PointCloudRealizeInfo *> info_by_handle(references.size(), nullptr);
+  for (const int handle : references.index_range()) {
+    const int pointcloud_index = all_pointclouds_info.order.index_of_try(
+        pointcloud_by_handle[handle]);
+    if (pointcloud_index != -1) {
+      info_by_handle[handle] = &all_pointclouds_info.realize_info[pointcloud_index];
+    }
+  }
+
+  Vector<std::unique_ptr<GArray<>>> temporary_arrays;
+  const Vector<std::pair<int, GSpan>> attributes_to_override = prepare_attribute_fallbacks(
+      instances, ordered_attributes, temporary_arrays);
+
+  const bool create_id_attribute = all_pointclouds_info.create_id_attribute;
+  Span<int> stored_instance_ids;
+  if (create_id_attribute) {
+    bke::AttributeReader ids = instances.attributes().lookup<int>("id");
+    if (ids) {
+      stored_instance_ids = ids.varray.get_internal_span();
+    }
+  }
+
+  PointCloud *dst_pointcloud = BKE_pointcloud_new_nomain(points_by_instance.total_size());
+  bke::GeometrySet new_geometry_set = bke::GeometrySet::from_pointcloud(dst_pointcloud);
+  bke::MutableAttributeAccessor dst_attributes = dst_pointcloud->attributes_for_write();
+
+  const PointCloud &first_pointcloud = *pointcloud_by_handle[handles[first_instance]];
+  dst_pointcloud->mat = static_cast<Material **>(MEM_dupallocN(first_pointcloud.mat));
+  dst_pointcloud->totcol = first_pointcloud.totcol;
+
+  SpanAttributeWriter<float3> positions = dst_attributes.lookup_or_add_for_write_only_span<float3>(
+      "position", bke::AttrDomain::Point);
+  SpanAttributeWriter<int> point_ids;
+  if (create_id_attribute) {
+    point_ids = dst_attributes.lookup_or_add_for_write_only_span<int>("id",
+                                                                      bke::AttrDomain::Point);
+  }
+  SpanAttributeWriter<float> point_radii;
+  if (all_pointclouds_info.create_radius_attribute) {
+    point_radii = dst_attributes.lookup_or_add_for_write_only_span<float>("radius",
+                                                                          bke::AttrDomain::Point);
+  }
+  Vector<GSpanAttributeWriter> dst_attribute_writers;
+  for (const int attribute_index : ordered_attributes.index_range()) {
+    const StringRef attribute_id = ordered_attributes.ids[attribute_index];
+    const eCustomDataType data_type = ordered_attributes.kinds[attribute_index].data_type;
+    dst_attribute_writers.append(dst_attributes.lookup_or_add_for_write_only_span(
+        attribute_id, bke::AttrDomain::Point, data_type));
+  }
+
+  const Span<float4x4> transforms = instances.transforms();
+  const int64_t approximate_used_bytes_num = int64_t(points_by_instance.total_size()) * 32;
+  threading::memory_bandwidth_bound_task(approximate_used_bytes_num, [&]() {
+    threading::parallel_for(handles.index_range(), 100, [&](const IndexRange instances_range) {
+      /* The task is only reused for all instances in the chunk, so that the attribute fallbacks
+       * don't have to be allocated for every instance. */
+      RealizePointCloudTask task{0, nullptr, float4x4::identity(), ordered_attributes.size()};
+      for (const int i : instances_range) {
+        task.pointcloud_info = info_by_handle[handles[i]];
+        if (task.pointcloud_info == nullptr) {
+          continue;
+        }
+        task.start_index = points_by_instance[i].start();
+        task.transform = transforms[i];
+        for (const std::pair<int, GSpan> &pair : attributes_to_override) {
+          task.attribute_fallbacks.array[pair.first] = pair.second[i];
+        }
+        if (create_id_attribute) {
+          const uint32_t local_instance_id = stored_instance_ids.is_empty() ?
+                                                 uint32_t(i) :
+                                                 uint32_t(stored_instance_ids[i]);
+          task.id = noise::hash(0, local_instance_id);
+        }
+        execute_realize_pointcloud_task(options,
+                                        task,
+                                        ordered_attributes,
+                                        dst_attribute_writers,
+                                        point_radii.span,
+                                        point_ids.span,
+                                        positions.span);
+      }
+    });
+  });
+
+  for (GSpanAttributeWriter &dst_attribute : dst_attribute_writers) {
+    dst_attribute.finish();
+  }
+  positions.finish();
+  point_radii.finish();
+  point_ids.finish();
+  return new_geometry_set;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -1551,49 +1692,42 @@ static void copy_vertex_group_names(Mesh &dst_mesh,
   }
 }
 
-static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
-                                       const AllMeshesInfo &all_meshes_info,
-                                       const Span<RealizeMeshTask> tasks,
-                                       const OrderedAttributes &ordered_attributes,
-                                       const VectorSet<Material *> &ordered_materials,
-                                       bke::GeometrySet &r_realized_geometry)
-{
-  if (tasks.is_empty()) {
-    return;
-  }
-
-  if (tasks.size() == 1) {
-    const RealizeMeshTask &task = tasks.first();
-    Mesh *new_mesh = BKE_mesh_copy_for_eval(*task.mesh_info->mesh);
-    if (!skip_transform(task.transform)) {
-      transform_positions(task.transform, new_mesh->vert_positions_for_write());
-      new_mesh->tag_positions_changed();
-    }
-    add_instance_attributes_to_single_geometry(
-        ordered_attributes, task.attribute_fallbacks, new_mesh->attributes_for_write());
-    r_realized_geometry.replace_mesh(new_mesh);
-    return;
-  }
-
-  const RealizeMeshTask &last_task = tasks.last();
-  const Mesh &last_mesh = *last_task.mesh_info->mesh;
-  const int tot_vertices = last_task.start_indices.vertex + last_mesh.verts_num;
-  const int tot_edges = last_task.start_indices.edge + last_mesh.edges_num;
-  const int tot_loops = last_task.start_indices.loop + last_mesh.corners_num;
-  const int tot_faces = last_task.start_indices.face + last_mesh.faces_num;
+/** The output mesh of realized mesh instances and the spans that the realize tasks write to. */
+struct RealizedMeshOutput {
+  Mesh *mesh = nullptr;
+  MutableSpan<float3> positions;
+  MutableSpan<int2> edges;
+  MutableSpan<int> face_offsets;
+  MutableSpan<int> corner_verts;
+  MutableSpan<int> corner_edges;
+  SpanAttributeWriter<int> vertex_ids;
+  SpanAttributeWriter<int> material_indices;
+  Vector<GSpanAttributeWriter> attribute_writers;
+};
 
-  Mesh *dst_mesh = BKE_mesh_new_nomain(tot_vertices, tot_edges, tot_faces, tot_loops);
+/**
+ * Create the mesh that all realized meshes are copied to, with the settings of the first realized
+ * mesh, and add it to the result geometry.
+ */
+static RealizedMeshOutput create_realized_mesh(const AllMeshesInfo &all_meshes_info,
+                                               const OrderedAttributes &ordered_attributes,
+                                               const VectorSet<Material *> &ordered_materials,
+                                               const Mesh &first_mesh,
+                                               const MeshElementStartIndices &sizes,
+                                               bke::GeometrySet &r_realized_geometry)
+{
+  RealizedMeshOutput output;
+  Mesh *dst_mesh = BKE_mesh_new_nomain(sizes.vertex, sizes.edge, sizes.face, sizes.loop);
+  output.mesh = dst_mesh;
   r_realized_geometry.replace_mesh(dst_mesh);
   bke::MutableAttributeAccessor dst_attributes = dst_mesh->attributes_for_write();
-  MutableSpan<float3> dst_positions = dst_mesh->vert_positions_for_write();
-  MutableSpan<int2> dst_edges = dst_mesh->edges_for_write();
-  MutableSpan<int> dst_face_offsets = dst_mesh->face_offsets_for_write();
-  MutableSpan<int> dst_corner_verts = dst_mesh->corner_verts_for_write();
-  MutableSpan<int> dst_corner_edges = dst_mesh->corner_edges_for_write();
+  output.positions = dst_mesh->vert_positions_for_write();
+  output.edges = dst_mesh->edges_for_write();
+  output.face_offsets = dst_mesh->face_offsets_for_write();
+  output.corner_verts = dst_mesh->corner_verts_for_write();
+  output.corner_edges = dst_mesh->corner_edges_for_write();
 
   /* Copy settings from the first input geometry set with a mesh. */
-  const RealizeMeshTask &first_task = tasks.first();
-  const Mesh &first_mesh = *first_task.mesh_info->mesh;
   BKE_mesh_copy_parameters_for_eval(dst_mesh, &first_mesh);
 
   BLI_assert(BLI_listbase_count(&dst_mesh->vertex_group_names) ==
@@ -1609,25 +1743,22 @@ static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
   }
 
   /* Prepare id attribute. */
-  SpanAttributeWriter<int> vertex_ids;
   if (all_meshes_info.create_id_attribute) {
-    vertex_ids = dst_attributes.lookup_or_add_for_write_only_span<int>("id",
-                                                                       bke::AttrDomain::Point);
+    output.vertex_ids = dst_attributes.lookup_or_add_for_write_only_span<int>(
+        "id", bke::AttrDomain::Point);
   }
   /* Prepare material indices. */
-  SpanAttributeWriter<int> material_indices;
   if (all_meshes_info.create_material_index_attribute) {
-    material_indices = dst_attributes.lookup_or_add_for_write_only_span<int>(
+    output.material_indices = dst_attributes.lookup_or_add_for_write_only_span<int>(
         "material_index", bke::AttrDomain::Face);
   }
 
   /* Prepare generic output attributes. */
-  Vector<GSpanAttributeWriter> dst_attribute_writers;
   for (const int attribute_index : ordered_attributes.index_range()) {
     const StringRef attribute_id = ordered_attributes.ids[attribute_index];
     const bke::AttrDomain domain = ordered_attributes.kinds[attribute_index].domain;
     const eCustomDataType data_type = ordered_attributes.kinds[attribute_index].data_type;
-    dst_attribute_writers.append(
+    output.attribute_writers.append(
         dst_attributes.lookup_or_add_for_write_only_span(attribute_id, domain, data_type));
   }
   const char *active_layer = CustomData_get_active_layer_name(&first_mesh.corner_data,
@@ -1646,40 +1777,210 @@ static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
       CustomData_set_layer_render(&dst_mesh->corner_data, CD_PROP_FLOAT2, id);
     }
   }
+  return output;
+}
+
+static void execute_realize_mesh_task(const RealizeInstancesOptions &options,
+                                      const RealizeMeshTask &task,
+                                      const OrderedAttributes &ordered_attributes,
+                                      RealizedMeshOutput &output)
+{
+  execute_realize_mesh_task(options,
+                            task,
+                            ordered_attributes,
+                            output.attribute_writers,
+                            output.positions,
+                            output.edges,
+                            output.face_offsets,
+                            output.corner_verts,
+                            output.corner_edges,
+                            output.vertex_ids.span,
+                            output.material_indices.span);
+}
+
+/** Tag modified attributes and add the topology hints that are known from the input meshes. */
+static void finish_realized_mesh(const AllMeshesInfo &all_meshes_info, RealizedMeshOutput &output)
+{
+  for (GSpanAttributeWriter &dst_attribute : output.attribute_writers) {
+    dst_attribute.finish();
+  }
+  output.vertex_ids.finish();
+  output.material_indices.finish();
+
+  if (all_meshes_info.no_loose_edges_hint) {
+    output.mesh->tag_loose_edges_none();
+  }
+  if (all_meshes_info.no_loose_verts_hint) {
+    output.mesh->tag_loose_verts_none();
+  }
+  if (all_meshes_info.no_overlapping_hint) {
+    output.mesh->tag_overlapping_none();
+  }
+}
+
+static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
+                                       const AllMeshesInfo &all_meshes_info,
+                                       const Span<RealizeMeshTask> tasks,
+                                       const OrderedAttributes &ordered_attributes,
+                                       const VectorSet<Material *> &ordered_materials,
+                                       bke::GeometrySet &r_realized_geometry)
+{
+  if (tasks.is_empty()) {
+    return;
+  }
+
+  if (tasks.size() == 1) {
+    const RealizeMeshTask &task = tasks.first();
+    Mesh *new_mesh = BKE_mesh_copy_for_eval(*task.mesh_info->mesh);
+    if (!skip_transform(task.transform)) {
+      transform_positions(task.transform, new_mesh->vert_positions_for_write());
+      new_mesh->tag_positions_changed();
+    }
+    add_instance_attributes_to_single_geometry(
+        ordered_attributes, task.attribute_fallbacks, new_mesh->attributes_for_write());
+    r_realized_geometry.replace_mesh(new_mesh);
+    return;
+  }
+
+  const RealizeMeshTask &last_task = tasks.last();
+  const Mesh &last_mesh = *last_task.mesh_info->mesh;
+  MeshElementStartIndices sizes;
+  sizes.vertex = last_task.start_indices.vertex + last_mesh.verts_num;
+  sizes.edge = last_task.start_indices.edge + last_mesh.edges_num;
+  sizes.loop = last_task.start_indices.loop + last_mesh.corners_num;
+  sizes.face = last_task.start_indices.face + last_mesh.faces_num;
+
+  RealizedMeshOutput output = create_realized_mesh(all_meshes_info,
+                                                   ordered_attributes,
+                                                   ordered_materials,
+                                                   *tasks.first().mesh_info->mesh,
+                                                   sizes,
+                                                   r_realized_geometry);
+
   /* Actually execute all tasks. */
   threading::parallel_for(tasks.index_range(), 100, [&](const IndexRange task_range) {
     for (const int task_index : task_range) {
-      const RealizeMeshTask &task = tasks[task_index];
-      execute_realize_mesh_task(options,
-                                task,
-                                ordered_attributes,
-                                dst_attribute_writers,
-                                dst_positions,
-                                dst_edges,
-                                dst_face_offsets,
-                                dst_corner_verts,
-                                dst_corner_edges,
-                                vertex_ids.span,
-                                material_indices.span);
+      execute_realize_mesh_task(options, tasks[task_index], ordered_attributes, output);
     }
   });
 
-  /* Tag modified attributes. */
-  for (GSpanAttributeWriter &dst_attribute : dst_attribute_writers) {
-    dst_attribute.finish();
+  finish_realized_mesh(all_meshes_info, output);
+}
+
+/**
+ * Faster version of realizing all instances for the common case where every top-level instance
+ * references a mesh, e.g. when meshes are instanced on points. Like
+ * #realize_pointcloud_instances_directly, the start indices of all instances are accumulated from
+ * the referenced mesh sizes and the output is filled from the instances directly, in parallel
+ * chunks, instead of gathering a #RealizeMeshTask for every instance first.
+ *
+ * \param reference_geometries: The geometry of every instance reference, which contains nothing
+ * but meshes.
+ * \return None if the generic code path should be used instead.
+ */
+static std::optional<bke::GeometrySet> realize_mesh_instances_directly(
+    const bke::GeometrySet &geometry_set,
+    const Span<bke::GeometrySet> reference_geometries,
+    const RealizeInstancesOptions &options,
+    const VariedDepthOptions &varied_depth_option)
+{
+  const Instances &instances = *geometry_set.get_instances();
+  const Span<InstanceReference> references = instances.references();
+  Array<const Mesh *> mesh_by_handle(references.size());
+  for (const int handle : references.index_range()) {
+    const Mesh *mesh = reference_geometries[handle].get_mesh();
+    mesh_by_handle[handle] = mesh && mesh->verts_num > 0 ? mesh : nullptr;
   }
-  vertex_ids.finish();
-  material_indices.finish();
 
-  if (all_meshes_info.no_loose_edges_hint) {
-    dst_mesh->tag_loose_edges_none();
+  /* The start indices of every instance, the last element contains the total sizes. */
+  const Span<int> handles = instances.reference_handles();
+  Array<MeshElementStartIndices> start_indices(instances.instances_num() + 1);
+  MeshElementStartIndices offsets;
+  int realized_instances_num = 0;
+  int first_instance = -1;
+  for (const int i : handles.index_range()) {
+    start_indices[i] = offsets;
+    const Mesh *mesh = mesh_by_handle[handles[i]];
+    if (mesh == nullptr) {
+      continue;
+    }
+    offsets.vertex += mesh->verts_num;
+    offsets.edge += mesh->edges_num;
+    offsets.face += mesh->faces_num;
+    offsets.loop += mesh->corners_num;
+    realized_instances_num++;
+    if (first_instance == -1) {
+      first_instance = i;
+    }
   }
-  if (all_meshes_info.no_loose_verts_hint) {
-    dst_mesh->tag_loose_verts_none();
+  start_indices.last() = offsets;
+  if (realized_instances_num < 2) {
+    /* The generic code path can share the data of a single mesh. */
+    return std::nullopt;
   }
-  if (all_meshes_info.no_overlapping_hint) {
-    dst_mesh->tag_overlapping_none();
+
+  const AllMeshesInfo all_meshes_info = preprocess_meshes(
+      geometry_set, options, varied_depth_option);
+  const OrderedAttributes &ordered_attributes = all_meshes_info.attributes;
+  Array<const MeshRealizeInfo *> info_by_handle(references.size(), nullptr);
+  for (const int handle : references.index_range()) {
+    const int mesh_index = all_meshes_info.order.index_of_try(mesh_by_handle[handle]);
+    if (mesh_index != -1) {
+      info_by_handle[handle] = &all_meshes_info.realize_info[mesh_index];
+    }
+  }
+
+  Vector<std::unique_ptr<GArray<>>> temporary_arrays;
+  const Vector<std::pair<int, GSpan>> attributes_to_override = prepare_attribute_fallbacks(
+      instances, ordered_attributes, temporary_arrays);
+
+  const bool create_id_attribute = all_meshes_info.create_id_attribute;
+  Span<int> stored_instance_ids;
+  if (create_id_attribute) {
+    bke::AttributeReader ids = instances.attributes().lookup<int>("id");
+    if (ids) {
+      stored_instance_ids = ids.varray.get_internal_span();
+    }
   }
+
+  bke::GeometrySet new_geometry_set;
+  RealizedMeshOutput output = create_realized_mesh(all_meshes_info,
+                                                   ordered_attributes,
+                                                   all_meshes_info.materials,
+                                                   *mesh_by_handle[handles[first_instance]],
+                                                   start_indices.last(),
+                                                   new_geometry_set);
+
+  const Span<float4x4> transforms = instances.transforms();
+  const int64_t approximate_used_bytes_num = int64_t(start_indices.last().vertex) * 32;
+  threading::memory_bandwidth_bound_task(approximate_used_bytes_num, [&]() {
+    threading::parallel_for(handles.index_range(), 100, [&](const IndexRange instances_range) {
+      /* The task is only reused for all instances in the chunk, so that the attribute fallbacks
+       * don't have to be allocated for every instance. */
+      RealizeMeshTask task{{}, nullptr, float4x4::identity(), ordered_attributes.size()};
+      for (const int i : instances_range) {
+        task.mesh_info = info_by_handle[handles[i]];
+        if (task.mesh_info == nullptr) {
+          continue;
+        }
+        task.start_indices = start_indices[i];
+        task.transform = transforms[i];
+        for (const std::pair<int, GSpan> &pair : attributes_to_override) {
+          task.attribute_fallbacks.array[pair.first] = pair.second[i];
+        }
+        if (create_id_attribute) {
+          const uint32_t local_instance_id = stored_instance_ids.is_empty() ?
+                                                 uint32_t(i) :
+                                                 uint32_t(stored_instance_ids[i]);
+          task.id = noise::hash(0, local_instance_id);
+        }
+        execute_realize_mesh_task(options, task, ordered_attributes, output);
+      }
+    });
+  });
+
+  finish_realized_mesh(all_meshes_info, output);
+  return new_geometry_set;
 }
 
 /** \} */
@@ -2282,6 +2583,45 @@ static void propagate_instances_to_keep(const bke::GeometrySet &geometry_set,
   new_instances_components.replace(new_instances.release(), bke::GeometryOwnershipType::Owned);
 }
 
+/**
+ * Use a faster code path when all top-level instances are realized and every instance reference
+ * only contains geometry of the same type, and when that type is supported by such a code path.
+ */
+static std::optional<bke::GeometrySet> realize_instances_directly(
+    const bke::GeometrySet &geometry_set,
+    const RealizeInstancesOptions &options,
+    const VariedDepthOptions &varied_depth_option)
+{
+  if (geometry_set.get_components().size() != 1) {
+    return std::nullopt;
+  }
+  const Instances &instances = *geometry_set.get_instances();
+  if (varied_depth_option.selection.size() != instances.instances_num()) {
+    return std::nullopt;
+  }
+  const Span<InstanceReference> references = instances.references();
+  Array<bke::GeometrySet> reference_geometries(references.size());
+  std::optional<bke::GeometryComponent::Type> type;
+  for (const int handle : references.index_range()) {
+    references[handle].to_geometry_set(reference_geometries[handle]);
+    for (const bke::GeometryComponent *component : reference_geometries[handle].get_components()) {
+      if (type.has_value() && component->type() != *type) {
+        return std::nullopt;
+      }
+      type = component->type();
+    }
+  }
+  if (type == bke::GeometryComponent::Type::PointCloud) {
+    return realize_pointcloud_instances_directly(
+        geometry_set, reference_geometries, options, varied_depth_option);
+  }
+  if (type == bke::GeometryComponent::Type::Mesh) {
+    return realize_mesh_instances_directly(
+        geometry_set, reference_geometries, options, varied_depth_option);
+  }
+  return std::nullopt;
+}
+
 bke::GeometrySet realize_instances(bke::GeometrySet geometry_set,
                                    const RealizeInstancesOptions &options)
 {
@@ -2319,6 +2659,12 @@ bke::GeometrySet realize_instances(bke::GeometrySet geometry_set,
     remove_id_attribute_from_instances(geometry_set);
   }
 
+  if (std::optional<bke::GeometrySet> realized_geometry = realize_instances_directly(
+          geometry_set, options, varied_depth_option))
+  {
+    return std::move(*realized_geometry);
+  }
+
   AllPointCloudsInfo all_pointclouds_info = preprocess_pointclouds(
       geometry_set, options, varied_depth_option);
   AllMeshesInfo all_meshes_info = preprocess_meshes(geometry_set, options, varied_depth_option);
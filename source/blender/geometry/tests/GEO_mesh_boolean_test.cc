@@ -0,0 +1,199 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "BKE_attribute.hh"
+#include "BKE_idtype.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.hh"
+
+#include "BLI_math_matrix.hh"
+
+#include "GEO_mesh_boolean.hh"
+#include "GEO_mesh_primitive_cuboid.hh"
+#include "GEO_mesh_primitive_grid.hh"
+#include "GEO_mesh_primitive_uv_sphere.hh"
+
+#include "../intern/mesh_boolean_manifold.hh"
+
+#include "testing/testing.h"
+
+#ifdef WITH_GMP
+
+namespace blender::geometry::tests {
+
+class MeshBooleanTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+static double mesh_volume(const Mesh &mesh)
+{
+  const Span<float3> positions = mesh.vert_positions();
+  const Span<int> corner_verts = mesh.corner_verts();
+  double volume = 0.0;
+  for (const int3 &tri : mesh.corner_tris()) {
+    const double3 a(positions[corner_verts[tri[0]]]);
+    const double3 b(positions[corner_verts[tri[1]]]);
+    const double3 c(positions[corner_verts[tri[2]]]);
+    volume += math::dot(a, math::cross(b, c)) / 6.0;
+  }
+  return volume;
+}
+
+static bool mesh_is_closed_manifold(const Mesh &mesh)
+{
+  const Span<int2> edges = mesh.edges();
+  const Span<int> corner_verts = mesh.corner_verts();
+  const Span<int> corner_edges = mesh.corner_edges();
+  Array<int2> edge_uses(edges.size(), int2(0));
+  for (const int corner : corner_verts.index_range()) {
+    const int edge = corner_edges[corner];
+    edge_uses[edge][edges[edge][0] == corner_verts[corner] ? 0 : 1]++;
+  }
+  return std::all_of(edge_uses.begin(), edge_uses.end(), [](const int2 &uses) {
+    return uses == int2(1, 1);
+  });
+}
+
+static Mesh *calc_boolean(const Span<const Mesh *> meshes,
+                          const Span<float4x4> transforms,
+                          const boolean::Operation operation,
+                          const boolean::Solver solver,
+                          Vector<int> *r_intersecting_edges = nullptr)
+{
+  boolean::BooleanOpParameters params;
+  params.boolean_mode = operation;
+  return boolean::mesh_boolean(
+      meshes, transforms, float4x4::identity(), {}, params, solver, r_intersecting_edges);
+}
+
+/**
+ * Compare the result of the manifold solver with the result of the exact solver. The manifold
+ * solver is called directly, so that it can't fall back to the exact solver.
+ */
+static void expect_same_as_exact_solver(const Span<const Mesh *> meshes,
+                                        const Span<float4x4> transforms,
+                                        const boolean::Operation operation)
+{
+  Vector<int> intersecting_edges;
+  Mesh *result = boolean::mesh_boolean_manifold(
+      meshes, transforms, float4x4::identity(), {}, operation, &intersecting_edges);
+  ASSERT_NE(result, nullptr);
+  Mesh *expected = calc_boolean(meshes, transforms, operation, boolean::Solver::MeshArr);
+  ASSERT_NE(expected, nullptr);
+  EXPECT_TRUE(mesh_is_closed_manifold(*result));
+  EXPECT_NEAR(mesh_volume(*result), mesh_volume(*expected), 1e-4);
+  EXPECT_FALSE(intersecting_edges.is_empty());
+  for (const int edge : intersecting_edges) {
+    EXPECT_TRUE(result->edges().index_range().contains(edge));
+  }
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, expected);
+}
+
+TEST_F(MeshBooleanTest, ManifoldCubeSphere)
+{
+  Mesh *cube = create_cuboid_mesh(float3(2.0f), 2, 2, 2);
+  Mesh *sphere = create_uv_sphere_mesh(1.0f, 32, 16, std::nullopt);
+  const Array<const Mesh *> meshes = {cube, sphere};
+  const Array<float4x4> transforms = {float4x4::identity(),
+                                      math::from_location<float4x4>(float3(0.7f, 0.4f, 0.2f))};
+  for (const boolean::Operation operation :
+       {boolean::Operation::Union, boolean::Operation::Intersect, boolean::Operation::Difference})
+  {
+    expect_same_as_exact_solver(meshes, transforms, operation);
+  }
+  BKE_id_free(nullptr, cube);
+  BKE_id_free(nullptr, sphere);
+}
+
+TEST_F(MeshBooleanTest, ManifoldManyCutters)
+{
+  Mesh *cube = create_cuboid_mesh(float3(2.0f), 4, 4, 4);
+  Mesh *cutter = create_uv_sphere_mesh(0.3f, 12, 6, std::nullopt);
+  Vector<const Mesh *> meshes = {cube};
+  Vector<float4x4> transforms = {float4x4::identity()};
+  for (const int i : IndexRange(20)) {
+    const float angle = float(i) * 0.7f;
+    meshes.append(cutter);
+    transforms.append(math::from_location<float4x4>(
+        float3(std::cos(angle), std::sin(angle), float(i) / 10.0f - 1.0f)));
+  }
+  expect_same_as_exact_solver(meshes, transforms, boolean::Operation::Difference);
+  BKE_id_free(nullptr, cube);
+  BKE_id_free(nullptr, cutter);
+}
+
+TEST_F(MeshBooleanTest, ManifoldAlignedCubes)
+{
+  /* Offset along two axes only, so that the faces on both sides of the X axis are coplanar and
+   * the edges of those faces cross each other. Both are resolved by the symbolic perturbation. */
+  Mesh *cube = create_cuboid_mesh(float3(2.0f), 2, 2, 2);
+  const Array<const Mesh *> meshes = {cube, cube};
+  const Array<float4x4> transforms = {
+      float4x4::identity(), math::from_location<float4x4>(float3(0.0f, 0.5f, 0.5f))};
+  expect_same_as_exact_solver(meshes, transforms, boolean::Operation::Union);
+  expect_same_as_exact_solver(meshes, transforms, boolean::Operation::Difference);
+  BKE_id_free(nullptr, cube);
+}
+
+TEST_F(MeshBooleanTest, ManifoldAttributes)
+{
+  Mesh *cube = create_cuboid_mesh(float3(2.0f), 2, 2, 2, "uv_map");
+  Mesh *sphere = create_uv_sphere_mesh(1.0f, 16, 8, "uv_map");
+  const Array<const Mesh *> meshes = {cube, sphere};
+  const Array<float4x4> transforms = {float4x4::identity(),
+                                      math::from_location<float4x4>(float3(0.8f, 0.3f, 0.1f))};
+  Mesh *result = calc_boolean(
+      meshes, transforms, boolean::Operation::Difference, boolean::Solver::Manifold);
+  ASSERT_NE(result, nullptr);
+  const bke::AttributeAccessor attributes = result->attributes();
+  const VArraySpan<float2> uv_map = *attributes.lookup<float2>("uv_map", bke::AttrDomain::Corner);
+  ASSERT_FALSE(uv_map.is_empty());
+  for (const float2 &uv : uv_map) {
+    EXPECT_GE(uv.x, -1e-4f);
+    EXPECT_LE(uv.x, 1.0f + 1e-4f);
+    EXPECT_GE(uv.y, -1e-4f);
+    EXPECT_LE(uv.y, 1.0f + 1e-4f);
+  }
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, cube);
+  BKE_id_free(nullptr, sphere);
+}
+
+TEST_F(MeshBooleanTest, ManifoldFallbackForOpenMesh)
+{
+  /* The exact solver is used for meshes that aren't closed. */
+  Mesh *cube = create_cuboid_mesh(float3(2.0f), 2, 2, 2);
+  Mesh *grid = create_grid_mesh(4, 4, 3.0f, 3.0f, std::nullopt);
+  const Array<const Mesh *> meshes = {cube, grid};
+  EXPECT_EQ(boolean::mesh_boolean_manifold(
+                meshes, {}, float4x4::identity(), {}, boolean::Operation::Union, nullptr),
+            nullptr);
+  Mesh *result = calc_boolean(meshes, {}, boolean::Operation::Union, boolean::Solver::Manifold);
+  Mesh *expected = calc_boolean(meshes, {}, boolean::Operation::Union, boolean::Solver::MeshArr);
+  ASSERT_NE(result, nullptr);
+  ASSERT_NE(expected, nullptr);
+  ASSERT_EQ(result->verts_num, expected->verts_num);
+  ASSERT_EQ(result->faces_num, expected->faces_num);
+  ASSERT_EQ(result->corners_num, expected->corners_num);
+  EXPECT_EQ(result->edges_num, expected->edges_num);
+  EXPECT_EQ_ARRAY(
+      expected->vert_positions().data(), result->vert_positions().data(), result->verts_num);
+  EXPECT_EQ_ARRAY(
+      expected->face_offsets().data(), result->face_offsets().data(), result->faces_num + 1);
+  EXPECT_EQ_ARRAY(
+      expected->corner_verts().data(), result->corner_verts().data(), result->corners_num);
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, expected);
+  BKE_id_free(nullptr, cube);
+  BKE_id_free(nullptr, grid);
+}
+
+}  // namespace blender::geometry::tests
+
+#endif
@@ -0,0 +1,270 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BKE_attribute.hh"
+#include "BKE_idtype.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.hh"
+
+#include "BLI_rand.hh"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "GEO_mesh_merge_by_distance.hh"
+#include "GEO_mesh_primitive_grid.hh"
+
+namespace blender::geometry::tests {
+
+class MeshMergeByDistanceTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+/** A grid with randomly moved vertices, so that some of them form chains of close vertices. */
+static Mesh *create_jittered_grid(const int verts_num, const float jitter)
+{
+  Mesh *mesh = create_grid_mesh(verts_num, verts_num, 1.0f, 1.0f, std::nullopt);
+  const float spacing = 1.0f / (verts_num - 1);
+  RandomNumberGenerator rng(0);
+  for (float3 &position : mesh->vert_positions_for_write()) {
+    position.x += (rng.get_float() - 0.5f) * jitter * spacing;
+    position.y += (rng.get_float() - 0.5f) * jitter * spacing;
+  }
+  return mesh;
+}
+
+/** Two copies of a grid on top of each other, with every vertex close to its copy. */
+static Mesh *create_doubled_grid(const int verts_num, const float offset)
+{
+  Mesh *grid = create_grid_mesh(verts_num, verts_num, 1.0f, 1.0f, std::nullopt);
+  Mesh *mesh = BKE_mesh_new_nomain(
+      grid->verts_num * 2, 0, grid->faces_num * 2, grid->corners_num * 2);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  MutableSpan<int> face_offsets = mesh->face_offsets_for_write();
+  MutableSpan<int> corner_verts = mesh->corner_verts_for_write();
+  for (const int copy : IndexRange(2)) {
+    for (const int i : grid->vert_positions().index_range()) {
+      positions[copy * grid->verts_num + i] = grid->vert_positions()[i] + float3(copy * offset);
+    }
+    for (const int i : grid->face_offsets().index_range().drop_back(1)) {
+      face_offsets[copy * grid->faces_num + i] = grid->face_offsets()[i] +
+                                                 copy * grid->corners_num;
+    }
+    for (const int i : grid->corner_verts().index_range()) {
+      corner_verts[copy * grid->corners_num + i] = grid->corner_verts()[i] +
+                                                   copy * grid->verts_num;
+    }
+  }
+  bke::mesh_calc_edges(*mesh, false, false);
+  BKE_id_free(nullptr, grid);
+  return mesh;
+}
+
+static Mesh *merge_clusters(const Mesh &mesh, const float merge_distance)
+{
+  const std::optional<Mesh *> result = mesh_merge_by_distance_clusters(
+      mesh, IndexMask(mesh.verts_num), merge_distance);
+  EXPECT_TRUE(result.has_value());
+  return result.value_or(nullptr);
+}
+
+static Mesh *merge_clusters_with_threads(const Mesh &mesh,
+                                         const float merge_distance,
+                                         const int threads_num)
+{
+  BLI_system_num_threads_override_set(threads_num);
+  BLI_task_scheduler_init();
+  Mesh *result = merge_clusters(mesh, merge_distance);
+  BLI_task_scheduler_exit();
+  BLI_system_num_threads_override_set(0);
+  return result;
+}
+
+static void expect_same_meshes(const Mesh &expected, const Mesh &actual)
+{
+  ASSERT_EQ(expected.verts_num, actual.verts_num);
+  ASSERT_EQ(expected.edges_num, actual.edges_num);
+  ASSERT_EQ(expected.faces_num, actual.faces_num);
+  ASSERT_EQ(expected.corners_num, actual.corners_num);
+  EXPECT_EQ_ARRAY(expected.vert_positions().data(),
+                  actual.vert_positions().data(),
+                  expected.verts_num);
+  EXPECT_EQ_ARRAY(expected.edges().data(), actual.edges().data(), expected.edges_num);
+  EXPECT_EQ_ARRAY(
+      expected.face_offsets().data(), actual.face_offsets().data(), expected.faces_num + 1);
+  EXPECT_EQ_ARRAY(
+      expected.corner_verts().data(), actual.corner_verts().data(), expected.corners_num);
+  EXPECT_EQ_ARRAY(
+      expected.corner_edges().data(), actual.corner_edges().data(), expected.corners_num);
+}
+
+TEST_F(MeshMergeByDistanceTest, ClustersMergeChains)
+{
+  /* Every vertex is only close to its direct neighbors in the chain. */
+  const int chain_num = 10;
+  Mesh *mesh = BKE_mesh_new_nomain(chain_num + 1, 0, 0, 0);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  for (const int i : IndexRange(chain_num)) {
+    positions[i] = float3(i * 0.9f, 0.0f, 0.0f);
+  }
+  positions.last() = float3(100.0f, 0.0f, 0.0f);
+
+  Mesh *result = merge_clusters(*mesh, 1.0f);
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(result->verts_num, 2);
+  EXPECT_NEAR(result->vert_positions()[0].x, 0.9f * (chain_num - 1) / 2.0f, 1e-5f);
+  EXPECT_EQ(result->vert_positions()[1], float3(100.0f, 0.0f, 0.0f));
+
+  /* Merging all vertices only merges direct neighbors of the chain into each other. */
+  const std::optional<Mesh *> result_all = mesh_merge_by_distance_all(
+      *mesh, IndexMask(mesh->verts_num), 1.0f);
+  ASSERT_TRUE(result_all.has_value());
+  EXPECT_GT((*result_all)->verts_num, 2);
+
+  BKE_id_free(nullptr, *result_all);
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshMergeByDistanceTest, ClustersDenseRegion)
+{
+  /* All vertices are in a region much smaller than the merge distance. */
+  Mesh *mesh = BKE_mesh_new_nomain(10000, 0, 0, 0);
+  RandomNumberGenerator rng(0);
+  for (float3 &position : mesh->vert_positions_for_write()) {
+    position = float3(rng.get_float(), rng.get_float(), rng.get_float()) * 0.001f;
+  }
+  Mesh *result = merge_clusters(*mesh, 1.0f);
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(result->verts_num, 1);
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshMergeByDistanceTest, ClustersIndependentOfThreads)
+{
+  const int verts_num = 200;
+  Mesh *mesh = create_jittered_grid(verts_num, 0.8f);
+  const float merge_distance = 0.5f / (verts_num - 1);
+
+  Mesh *result_single = merge_clusters_with_threads(*mesh, merge_distance, 1);
+  ASSERT_NE(result_single, nullptr);
+  EXPECT_LT(result_single->verts_num, mesh->verts_num);
+  for ([[maybe_unused]] const int i : IndexRange(3)) {
+    Mesh *result = merge_clusters_with_threads(
+        *mesh, merge_distance, std::max(BLI_system_thread_count(), 4));
+    ASSERT_NE(result, nullptr);
+    expect_same_meshes(*result_single, *result);
+    BKE_id_free(nullptr, result);
+  }
+
+  BKE_id_free(nullptr, result_single);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshMergeByDistanceTest, ClustersSameAsAllForSeparateClusters)
+{
+  /* The clusters are pairs of vertices that are far away from other vertices, so merging all
+   * vertices finds the same clusters. */
+  const int verts_num = 50;
+  const float spacing = 1.0f / (verts_num - 1);
+  Mesh *mesh = create_doubled_grid(verts_num, 0.01f * spacing);
+  const float merge_distance = 0.1f * spacing;
+
+  Mesh *result = merge_clusters(*mesh, merge_distance);
+  const std::optional<Mesh *> expected = mesh_merge_by_distance_all(
+      *mesh, IndexMask(mesh->verts_num), merge_distance);
+  ASSERT_NE(result, nullptr);
+  ASSERT_TRUE(expected.has_value());
+  EXPECT_EQ(result->verts_num, verts_num * verts_num);
+  EXPECT_EQ(result->faces_num, (verts_num - 1) * (verts_num - 1));
+  expect_same_meshes(**expected, *result);
+
+  BKE_id_free(nullptr, *expected);
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+/**
+ * Three groups of vertices on a line, connected by edges. The first vertices of the groups are
+ * stored first, and every vertex has a different value in the "value" attribute.
+ */
+static Mesh *create_vertex_groups_mesh()
+{
+  Mesh *mesh = BKE_mesh_new_nomain(6, 5, 0, 0);
+  mesh->vert_positions_for_write().copy_from({float3(0.0f, 0.0f, 0.0f),
+                                              float3(5.0f, 0.0f, 0.0f),
+                                              float3(0.001f, 0.0f, 0.0f),
+                                              float3(5.001f, 0.0f, 0.0f),
+                                              float3(0.002f, 0.0f, 0.0f),
+                                              float3(10.0f, 0.0f, 0.0f)});
+  mesh->edges_for_write().copy_from(
+      {int2(0, 2), int2(2, 4), int2(1, 3), int2(4, 5), int2(1, 5)});
+  bke::MutableAttributeAccessor attributes = mesh->attributes_for_write();
+  attributes.add<float>("value",
+                        bke::AttrDomain::Point,
+                        bke::AttributeInitVArray(VArray<float>::ForContainer(
+                            Array<float>{1.0f, 10.0f, 2.0f, 20.0f, 3.0f, 100.0f})));
+  return mesh;
+}
+
+/**
+ * Merged vertices keep the position of their first vertex in the result, and their data is mixed.
+ * This is the same for the existing modes as before the clusters mode was added.
+ */
+static void expect_merged_vertex_groups(const Mesh &result)
+{
+  ASSERT_EQ(result.verts_num, 3);
+  ASSERT_EQ(result.edges_num, 2);
+  const Span<float3> positions = result.vert_positions();
+  EXPECT_NEAR(positions[0].x, 0.001f, 1e-6f);
+  EXPECT_NEAR(positions[1].x, 5.0005f, 1e-6f);
+  EXPECT_EQ(positions[2].x, 10.0f);
+  const VArraySpan<float> values = *result.attributes().lookup<float>("value");
+  EXPECT_NEAR(values[0], 2.0f, 1e-6f);
+  EXPECT_NEAR(values[1], 15.0f, 1e-6f);
+  EXPECT_EQ(values[2], 100.0f);
+  const std::array<int2, 2> expected_edges = {int2(0, 2), int2(1, 2)};
+  EXPECT_EQ_ARRAY(expected_edges.data(), result.edges().data(), expected_edges.size());
+}
+
+TEST_F(MeshMergeByDistanceTest, AllMergesVertexGroups)
+{
+  Mesh *mesh = create_vertex_groups_mesh();
+  const std::optional<Mesh *> result = mesh_merge_by_distance_all(
+      *mesh, IndexMask(mesh->verts_num), 0.01f);
+  ASSERT_TRUE(result.has_value());
+  expect_merged_vertex_groups(**result);
+  BKE_id_free(nullptr, *result);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshMergeByDistanceTest, ConnectedMergesVertexGroups)
+{
+  Mesh *mesh = create_vertex_groups_mesh();
+  const Array<bool> selection(mesh->verts_num, true);
+  const std::optional<Mesh *> result = mesh_merge_by_distance_connected(
+      *mesh, selection, 0.01f, false);
+  ASSERT_TRUE(result.has_value());
+  expect_merged_vertex_groups(**result);
+  BKE_id_free(nullptr, *result);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshMergeByDistanceTest, ClustersMergeVertexGroups)
+{
+  Mesh *mesh = create_vertex_groups_mesh();
+  Mesh *result = merge_clusters(*mesh, 0.01f);
+  ASSERT_NE(result, nullptr);
+  expect_merged_vertex_groups(*result);
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::geometry::tests
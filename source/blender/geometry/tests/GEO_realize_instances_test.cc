@@ -0,0 +1,269 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BKE_attribute.hh"
+#include "BKE_geometry_set.hh"
+#include "BKE_idtype.hh"
+#include "BKE_instances.hh"
+#include "BKE_mesh.hh"
+#include "BKE_pointcloud.hh"
+
+#include "BLI_math_matrix.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_pointcloud_types.h"
+
+#include "GEO_mesh_primitive_grid.hh"
+#include "GEO_realize_instances.hh"
+
+namespace blender::geometry::tests {
+
+using bke::AttrDomain;
+using bke::GeometrySet;
+
+class RealizeInstancesTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+static PointCloud *create_pointcloud(const int points_num,
+                                     const float offset,
+                                     const bool use_ids,
+                                     const StringRef attribute_name)
+{
+  PointCloud *pointcloud = BKE_pointcloud_new_nomain(points_num);
+  bke::MutableAttributeAccessor attributes = pointcloud->attributes_for_write();
+  MutableSpan<float3> positions = pointcloud->positions_for_write();
+  for (const int i : positions.index_range()) {
+    positions[i] = float3(offset + i, 0.5f * i, 0.0f);
+  }
+  if (use_ids) {
+    bke::SpanAttributeWriter<int> ids = attributes.lookup_or_add_for_write_only_span<int>(
+        "id", AttrDomain::Point);
+    for (const int i : ids.span.index_range()) {
+      ids.span[i] = 100 + i;
+    }
+    ids.finish();
+  }
+  bke::SpanAttributeWriter<float> values = attributes.lookup_or_add_for_write_only_span<float>(
+      attribute_name, AttrDomain::Point);
+  for (const int i : values.span.index_range()) {
+    values.span[i] = offset * 10.0f + i;
+  }
+  values.finish();
+  return pointcloud;
+}
+
+static void add_instance_attributes(bke::Instances &instances, const bool use_instance_ids)
+{
+  bke::MutableAttributeAccessor attributes = instances.attributes_for_write();
+  bke::SpanAttributeWriter<float> instance_values =
+      attributes.lookup_or_add_for_write_only_span<float>("instance_value",
+                                                          AttrDomain::Instance);
+  for (const int i : instance_values.span.index_range()) {
+    instance_values.span[i] = -float(i);
+  }
+  instance_values.finish();
+  if (use_instance_ids) {
+    bke::SpanAttributeWriter<int> ids = attributes.lookup_or_add_for_write_only_span<int>(
+        "id", AttrDomain::Instance);
+    for (const int i : ids.span.index_range()) {
+      ids.span[i] = 1000 + i * 7;
+    }
+    ids.finish();
+  }
+}
+
+/**
+ * Instance two different geometries alternately, and an empty one once. The geometries have
+ * different attributes, so that the instance attributes and missing attributes have to be
+ * propagated to the realized geometry.
+ */
+static bke::Instances *create_instances(GeometrySet geometry_a,
+                                        GeometrySet geometry_b,
+                                        GeometrySet empty_geometry,
+                                        const bool use_instance_ids)
+{
+  bke::Instances *instances = new bke::Instances();
+  const int handle_a = instances->add_reference(std::move(geometry_a));
+  const int handle_b = instances->add_reference(std::move(geometry_b));
+  const int empty_handle = instances->add_reference(std::move(empty_geometry));
+  for (const int i : IndexRange(7)) {
+    const int handle = i == 3 ? empty_handle : (i % 2 == 0 ? handle_a : handle_b);
+    instances->add_instance(handle, math::from_location<float4x4>(float3(0.0f, 0.0f, i)));
+  }
+  add_instance_attributes(*instances, use_instance_ids);
+  return instances;
+}
+
+static bke::Instances *create_pointcloud_instances(const bool use_instance_ids)
+{
+  return create_instances(GeometrySet::from_pointcloud(create_pointcloud(3, 1.0f, true, "a")),
+                          GeometrySet::from_pointcloud(create_pointcloud(2, 2.0f, false, "b")),
+                          GeometrySet::from_pointcloud(BKE_pointcloud_new_nomain(0)),
+                          use_instance_ids);
+}
+
+static void expect_same_attributes(const bke::AttributeAccessor expected_attributes,
+                                   const bke::AttributeAccessor actual_attributes)
+{
+  EXPECT_EQ(expected_attributes.all_ids(), actual_attributes.all_ids());
+  for (const StringRef name : expected_attributes.all_ids()) {
+    const bke::GAttributeReader expected_attribute = expected_attributes.lookup(name);
+    const bke::GAttributeReader actual_attribute = actual_attributes.lookup(name);
+    ASSERT_TRUE(actual_attribute);
+    EXPECT_EQ(expected_attribute.domain, actual_attribute.domain);
+    const CPPType &type = expected_attribute.varray.type();
+    ASSERT_EQ(type, actual_attribute.varray.type());
+    const GVArraySpan expected_values(*expected_attribute);
+    const GVArraySpan actual_values(*actual_attribute);
+    for (const int i : IndexRange(expected_values.size())) {
+      EXPECT_TRUE(type.is_equal(expected_values[i], actual_values[i]))
+          << "Attribute \"" << name << "\" differs at element " << i;
+    }
+  }
+}
+
+static void expect_same_pointclouds(const PointCloud &expected, const PointCloud &actual)
+{
+  ASSERT_EQ(expected.totpoint, actual.totpoint);
+  expect_same_attributes(expected.attributes(), actual.attributes());
+}
+
+static void expect_same_meshes(const Mesh &expected, const Mesh &actual)
+{
+  ASSERT_EQ(expected.verts_num, actual.verts_num);
+  ASSERT_EQ(expected.edges_num, actual.edges_num);
+  ASSERT_EQ(expected.faces_num, actual.faces_num);
+  ASSERT_EQ(expected.corners_num, actual.corners_num);
+  EXPECT_EQ(expected.face_offsets(), actual.face_offsets());
+  expect_same_attributes(expected.attributes(), actual.attributes());
+}
+
+/**
+ * Realizing only point cloud instances uses a separate code path. Compare it with the generic code
+ * path, which is used when there is a realized point cloud next to the instances.
+ */
+static void test_pointcloud_instances(const RealizeInstancesOptions &options,
+                                      const bool use_instance_ids)
+{
+  const GeometrySet pointcloud_instances = GeometrySet::from_instances(
+      create_pointcloud_instances(use_instance_ids));
+  GeometrySet mixed_geometry = GeometrySet::from_instances(
+      create_pointcloud_instances(use_instance_ids));
+  mixed_geometry.replace_pointcloud(BKE_pointcloud_new_nomain(0));
+
+  const GeometrySet result = realize_instances(pointcloud_instances, options);
+  const GeometrySet expected = realize_instances(mixed_geometry, options);
+  ASSERT_FALSE(result.has_instances());
+  ASSERT_NE(result.get_pointcloud(), nullptr);
+  ASSERT_NE(expected.get_pointcloud(), nullptr);
+  EXPECT_EQ(result.get_pointcloud()->totpoint, 3 * 4 + 2 * 2);
+  EXPECT_TRUE(result.get_pointcloud()->attributes().contains("id"));
+  expect_same_pointclouds(*expected.get_pointcloud(), *result.get_pointcloud());
+}
+
+TEST_F(RealizeInstancesTest, PointCloudInstancesSameAsGeneric)
+{
+  RealizeInstancesOptions options;
+  test_pointcloud_instances(options, false);
+  test_pointcloud_instances(options, true);
+}
+
+TEST_F(RealizeInstancesTest, PointCloudInstancesKeepOriginalIds)
+{
+  RealizeInstancesOptions options;
+  options.keep_original_ids = true;
+  test_pointcloud_instances(options, false);
+  test_pointcloud_instances(options, true);
+}
+
+TEST_F(RealizeInstancesTest, PointCloudInstancesWithoutInstanceAttributes)
+{
+  RealizeInstancesOptions options;
+  options.realize_instance_attributes = false;
+  test_pointcloud_instances(options, true);
+}
+
+static Mesh *create_mesh(const int verts_num_x,
+                         const bool use_ids,
+                         const StringRef attribute_name,
+                         const AttrDomain domain)
+{
+  Mesh *mesh = create_grid_mesh(verts_num_x, 2, 1.0f, 1.0f, "uv_map");
+  bke::MutableAttributeAccessor attributes = mesh->attributes_for_write();
+  if (use_ids) {
+    bke::SpanAttributeWriter<int> ids = attributes.lookup_or_add_for_write_only_span<int>(
+        "id", AttrDomain::Point);
+    for (const int i : ids.span.index_range()) {
+      ids.span[i] = 100 + i;
+    }
+    ids.finish();
+  }
+  bke::SpanAttributeWriter<float> values = attributes.lookup_or_add_for_write_only_span<float>(
+      attribute_name, domain);
+  for (const int i : values.span.index_range()) {
+    values.span[i] = verts_num_x * 10.0f + i;
+  }
+  values.finish();
+  return mesh;
+}
+
+/**
+ * Realizing only mesh instances uses a separate code path as well. Compare it with the generic
+ * code path, which is used when there is a realized mesh next to the instances.
+ */
+static void test_mesh_instances(const RealizeInstancesOptions &options,
+                                const bool use_instance_ids)
+{
+  const auto create_mesh_instances = [&]() {
+    return create_instances(
+        GeometrySet::from_mesh(create_mesh(3, true, "a", AttrDomain::Point)),
+        GeometrySet::from_mesh(create_mesh(2, false, "b", AttrDomain::Face)),
+        GeometrySet::from_mesh(BKE_mesh_new_nomain(0, 0, 0, 0)),
+        use_instance_ids);
+  };
+  const GeometrySet mesh_instances = GeometrySet::from_instances(create_mesh_instances());
+  GeometrySet mixed_geometry = GeometrySet::from_instances(create_mesh_instances());
+  mixed_geometry.replace_mesh(BKE_mesh_new_nomain(0, 0, 0, 0));
+
+  const GeometrySet result = realize_instances(mesh_instances, options);
+  const GeometrySet expected = realize_instances(mixed_geometry, options);
+  ASSERT_FALSE(result.has_instances());
+  ASSERT_NE(result.get_mesh(), nullptr);
+  ASSERT_NE(expected.get_mesh(), nullptr);
+  EXPECT_EQ(result.get_mesh()->verts_num, 6 * 4 + 4 * 2);
+  EXPECT_EQ(result.get_mesh()->faces_num, 2 * 4 + 1 * 2);
+  EXPECT_TRUE(result.get_mesh()->attributes().contains("id"));
+  expect_same_meshes(*expected.get_mesh(), *result.get_mesh());
+}
+
+TEST_F(RealizeInstancesTest, MeshInstancesSameAsGeneric)
+{
+  RealizeInstancesOptions options;
+  test_mesh_instances(options, false);
+  test_mesh_instances(options, true);
+}
+
+TEST_F(RealizeInstancesTest, MeshInstancesKeepOriginalIds)
+{
+  RealizeInstancesOptions options;
+  options.keep_original_ids = true;
+  test_mesh_instances(options, false);
+  test_mesh_instances(options, true);
+}
+
+TEST_F(RealizeInstancesTest, MeshInstancesWithoutInstanceAttributes)
+{
+  RealizeInstancesOptions options;
+  options.realize_instance_attributes = false;
+  test_mesh_instances(options, true);
+}
+
+}  // namespace blender::geometry::tests
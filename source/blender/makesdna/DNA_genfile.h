@@ -92,6 +92,9 @@ struct DNA_ReconstructInfo;
 /**
  * Pre-process information about how structs in \a newsdna can be reconstructed from structs in
  * \a oldsdna. This information is then used to speedup #DNA_struct_reconstruct.
+ *
+ * Every struct gets a flat list of steps (bulk copies and batched casts), with small nested
+ * structs inlined, which are applied to whole arrays of structs at once.
  */
 struct DNA_ReconstructInfo *DNA_reconstruct_info_create(const struct SDNA *oldsdna,
                                                         const struct SDNA *newsdna,
@@ -2495,6 +2495,8 @@ typedef enum NodesModifierPanelFlag {
 typedef enum NodesModifierBakeFlag {
   NODES_MODIFIER_BAKE_CUSTOM_SIMULATION_FRAME_RANGE = 1 << 0,
   NODES_MODIFIER_BAKE_CUSTOM_PATH = 1 << 1,
+  /** Compress large arrays in the baked data. */
+  NODES_MODIFIER_BAKE_COMPRESS = 1 << 2,
 } NodesModifierBakeFlag;
 
 typedef enum NodesModifierBakeTarget {
@@ -18,6 +18,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <type_traits>
 
 #include <fmt/format.h>
 
@@ -767,166 +768,164 @@ const char *DNA_struct_get_compareflags(const SDNA *oldsdna, const SDNA *newsdna
 }
 
 /**
- * Converts a value of one primitive type to another.
+ * Converts a single value of one primitive type to another.
+ *
+ * Integer types are converted through a 64 bit integer, floating point values are truncated.
+ * Floating point types are converted through a double, `char` and `uchar` values are
+ * normalized to the [0, 1] range.
+ */
+template<typename OldT, typename NewT> static NewT cast_primitive_value(const OldT value)
+{
+  if constexpr (std::is_floating_point_v<NewT>) {
+    double value_f = double(value);
+    if constexpr (std::is_same_v<OldT, char> || std::is_same_v<OldT, uchar>) {
+      value_f /= 255.0;
+    }
+    return NewT(value_f);
+  }
+  else if constexpr (std::is_floating_point_v<OldT>) {
+    /* `int64_t` range stored in a `uint64_t`. */
+    return NewT(uint64_t(int64_t(value)));
+  }
+  else {
+    /* Intentionally overflow signed values into an unsigned type.
+     * Casting back to a signed value preserves the sign (when the new value is signed). */
+    return NewT(uint64_t(value));
+  }
+}
+
+/**
+ * Converts the same array member in a number of consecutive structs. The type specific loop is
+ * free of branches, so that the compiler can vectorize it.
+ */
+template<typename OldT, typename NewT>
+static void cast_primitive_array(const int blocks,
+                                 const int array_len,
+                                 const char *old_data,
+                                 const int old_stride,
+                                 char *new_data,
+                                 const int new_stride)
+{
+  for (int block = 0; block < blocks; block++) {
+    const OldT *old_values = reinterpret_cast<const OldT *>(old_data +
+                                                            int64_t(block) * old_stride);
+    NewT *new_values = reinterpret_cast<NewT *>(new_data + int64_t(block) * new_stride);
+    for (int a = 0; a < array_len; a++) {
+      new_values[a] = cast_primitive_value<OldT, NewT>(old_values[a]);
+    }
+  }
+}
+
+/** Calls  fn with a default constructed value of the C++ type matching  type. */
+template<typename Fn>
+static void primitive_type_dispatch(const eSDNA_Type type, const Fn &fn)
+{
+  switch (type) {
+    case SDNA_TYPE_CHAR:
+      fn(char());
+      break;
+    case SDNA_TYPE_UCHAR:
+      fn(uchar());
+      break;
+    case SDNA_TYPE_SHORT:
+      fn(short());
+      break;
+    case SDNA_TYPE_USHORT:
+      fn(ushort());
+      break;
+    case SDNA_TYPE_INT:
+      fn(int());
+      break;
+    case SDNA_TYPE_FLOAT:
+      fn(float());
+      break;
+    case SDNA_TYPE_DOUBLE:
+      fn(double());
+      break;
+    case SDNA_TYPE_INT64:
+      fn(int64_t());
+      break;
+    case SDNA_TYPE_UINT64:
+      fn(uint64_t());
+      break;
+    case SDNA_TYPE_INT8:
+      fn(int8_t());
+      break;
+    case SDNA_TYPE_RAW_DATA:
+      BLI_assert_msg(false, "Conversion of SDNA_TYPE_RAW_DATA is not supported");
+      break;
+  }
+}
+
+/**
+ * Converts values of one primitive type to another.
  *
  * \note there is no optimization for the case where \a otype and \a ctype are the same:
  * assumption is that caller will handle this case.
  *
  * \param old_type: Type to convert from.
  * \param new_type: Type to convert to.
- * \param array_len: Number of elements to convert.
- * \param old_data: Buffer containing the old values.
- * \param new_data: Buffer the converted values will be written to.
+ * \param blocks: Number of structs the member is converted in.
+ * \param array_len: Number of elements to convert in each struct.
+ * \param old_data: Buffer containing the old values of the first struct.
+ * \param old_stride: Distance in bytes between the old values of consecutive structs.
+ * \param new_data: Buffer the converted values of the first struct will be written to.
+ * \param new_stride: Distance in bytes between the new values of consecutive structs.
  */
 static void cast_primitive_type(const eSDNA_Type old_type,
                                 const eSDNA_Type new_type,
+                                const int blocks,
                                 const int array_len,
                                 const char *old_data,
-                                char *new_data)
-{
-  /* define lengths */
-  const int oldlen = DNA_elem_type_size(old_type);
-  const int curlen = DNA_elem_type_size(new_type);
-
-  double old_value_f = 0.0;
-  /* Intentionally overflow signed values into an unsigned type.
-   * Casting back to a signed value preserves the sign (when the new value is signed). */
-  uint64_t old_value_i = 0;
-
-  for (int a = 0; a < array_len; a++) {
-    switch (old_type) {
-      case SDNA_TYPE_CHAR: {
-        const char value = *old_data;
-        old_value_i = value;
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_UCHAR: {
-        const uchar value = *reinterpret_cast<const uchar *>(old_data);
-        old_value_i = value;
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_SHORT: {
-        const short value = *reinterpret_cast<const short *>(old_data);
-        old_value_i = value;
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_USHORT: {
-        const ushort value = *reinterpret_cast<const ushort *>(old_data);
-        old_value_i = value;
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_INT: {
-        const int value = *reinterpret_cast<const int *>(old_data);
-        old_value_i = value;
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_FLOAT: {
-        const float value = *reinterpret_cast<const float *>(old_data);
-        /* `int64_t` range stored in a `uint64_t`. */
-        old_value_i = uint64_t(int64_t(value));
-        old_value_f = value;
-        break;
-      }
-      case SDNA_TYPE_DOUBLE: {
-        const double value = *reinterpret_cast<const double *>(old_data);
-        /* `int64_t` range stored in a `uint64_t`. */
-        old_value_i = uint64_t(int64_t(value));
-        old_value_f = value;
-        break;
-      }
-      case SDNA_TYPE_INT64: {
-        const int64_t value = *reinterpret_cast<const int64_t *>(old_data);
-        old_value_i = uint64_t(value);
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_UINT64: {
-        const uint64_t value = *reinterpret_cast<const uint64_t *>(old_data);
-        old_value_i = value;
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_INT8: {
-        const int8_t value = *reinterpret_cast<const int8_t *>(old_data);
-        old_value_i = uint64_t(value);
-        old_value_f = double(value);
-        break;
-      }
-      case SDNA_TYPE_RAW_DATA:
-        BLI_assert_msg(false, "Conversion from SDNA_TYPE_RAW_DATA is not supported");
-        break;
-    }
-
-    switch (new_type) {
-      case SDNA_TYPE_CHAR:
-        *new_data = char(old_value_i);
-        break;
-      case SDNA_TYPE_UCHAR:
-        *reinterpret_cast<uchar *>(new_data) = uchar(old_value_i);
-        break;
-      case SDNA_TYPE_SHORT:
-        *reinterpret_cast<short *>(new_data) = short(old_value_i);
-        break;
-      case SDNA_TYPE_USHORT:
-        *reinterpret_cast<ushort *>(new_data) = ushort(old_value_i);
-        break;
-      case SDNA_TYPE_INT:
-        *reinterpret_cast<int *>(new_data) = int(old_value_i);
-        break;
-      case SDNA_TYPE_FLOAT:
-        if (old_type < 2) {
-          old_value_f /= 255.0;
-        }
-        *reinterpret_cast<float *>(new_data) = old_value_f;
-        break;
-      case SDNA_TYPE_DOUBLE:
-        if (old_type < 2) {
-          old_value_f /= 255.0;
-        }
-        *reinterpret_cast<double *>(new_data) = old_value_f;
-        break;
-      case SDNA_TYPE_INT64:
-        *reinterpret_cast<int64_t *>(new_data) = int64_t(old_value_i);
-        break;
-      case SDNA_TYPE_UINT64:
-        *reinterpret_cast<uint64_t *>(new_data) = old_value_i;
-        break;
-      case SDNA_TYPE_INT8:
-        *reinterpret_cast<int8_t *>(new_data) = int8_t(old_value_i);
-        break;
-      case SDNA_TYPE_RAW_DATA:
-        BLI_assert_msg(false, "Conversion to SDNA_TYPE_RAW_DATA is not supported");
-        break;
-    }
-
-    old_data += oldlen;
-    new_data += curlen;
-  }
+                                const int old_stride,
+                                char *new_data,
+                                const int new_stride)
+{
+  /* Resolve the types once, instead of for every element. */
+  primitive_type_dispatch(old_type, [&](auto old_dummy) {
+    primitive_type_dispatch(new_type, [&](auto new_dummy) {
+      using OldT = decltype(old_dummy);
+      using NewT = decltype(new_dummy);
+      cast_primitive_array<OldT, NewT>(
+          blocks, array_len, old_data, old_stride, new_data, new_stride);
+    });
+  });
 }
 
-static void cast_pointer_32_to_64(const int array_len,
-                                  const uint32_t *old_data,
-                                  uint64_t *new_data)
+static void cast_pointer_32_to_64(const int blocks,
+                                  const int array_len,
+                                  const char *old_data,
+                                  const int old_stride,
+                                  char *new_data,
+                                  const int new_stride)
 {
-  for (int a = 0; a < array_len; a++) {
-    new_data[a] = old_data[a];
+  for (int block = 0; block < blocks; block++) {
+    const uint32_t *old_values = reinterpret_cast<const uint32_t *>(
+        old_data + int64_t(block) * old_stride);
+    uint64_t *new_values = reinterpret_cast<uint64_t *>(new_data + int64_t(block) * new_stride);
+    for (int a = 0; a < array_len; a++) {
+      new_values[a] = old_values[a];
+    }
   }
 }
 
-static void cast_pointer_64_to_32(const int array_len,
-                                  const uint64_t *old_data,
-                                  uint32_t *new_data)
+static void cast_pointer_64_to_32(const int blocks,
+                                  const int array_len,
+                                  const char *old_data,
+                                  const int old_stride,
+                                  char *new_data,
+                                  const int new_stride)
 {
   /* WARNING: 32-bit Blender trying to load file saved by 64-bit Blender,
    * pointers may lose uniqueness on truncation! (Hopefully this won't
    * happen unless/until we ever get to multi-gigabyte .blend files...) */
-  for (int a = 0; a < array_len; a++) {
-    new_data[a] = old_data[a] >> 3;
+  for (int block = 0; block < blocks; block++) {
+    const uint64_t *old_values = reinterpret_cast<const uint64_t *>(
+        old_data + int64_t(block) * old_stride);
+    uint32_t *new_values = reinterpret_cast<uint32_t *>(new_data + int64_t(block) * new_stride);
+    for (int a = 0; a < array_len; a++) {
+      new_values[a] = old_values[a] >> 3;
+    }
   }
 }
 
@@ -1224,6 +1223,12 @@ struct DNA_ReconstructInfo {
   ReconstructStep **steps;
 };
 
+/**
+ * Blocks of a struct array are reconstructed in chunks of about this size (counting both the old
+ * and new data), so that the data of a chunk stays in the cache while all steps are applied to it.
+ */
+#define RECONSTRUCT_CHUNK_SIZE_IN_BYTES (1 << 15)
+
 static void reconstruct_structs(const DNA_ReconstructInfo *reconstruct_info,
                                 const int blocks,
                                 const int old_struct_index,
@@ -1232,18 +1237,22 @@ static void reconstruct_structs(const DNA_ReconstructInfo *reconstruct_info,
                                 char *new_blocks);
 
 /**
- * Converts the contents of an entire struct from oldsdna to newsdna format.
+ * Applies the reconstruct steps of a struct to a number of consecutive structs. Every step is
+ * applied to all blocks before moving to the next step, so that each step only has to be
+ * decoded once and runs as a tight loop over the blocks.
  *
- * \param reconstruct_info: Preprocessed reconstruct information generated by
- * #DNA_reconstruct_info_create.
- * \param new_struct_nr: Index in `newsdna->structs` of the struct that is being reconstructed.
- * \param old_block: Memory buffer containing the old struct.
- * \param new_block: Where to put converted struct contents.
+ * \param old_blocks: Memory buffer containing the old structs.
+ * \param old_stride: Size of an old struct in bytes.
+ * \param new_blocks: Where to put converted struct contents.
+ * \param new_stride: Size of a new struct in bytes.
  */
-static void reconstruct_struct(const DNA_ReconstructInfo *reconstruct_info,
-                               const int new_struct_index,
-                               const char *old_block,
-                               char *new_block)
+static void reconstruct_struct_blocks(const DNA_ReconstructInfo *reconstruct_info,
+                                      const int new_struct_index,
+                                      const int blocks,
+                                      const char *old_blocks,
+                                      const int old_stride,
+                                      char *new_blocks,
+                                      const int new_stride)
 {
   const ReconstructStep *steps = reconstruct_info->steps[new_struct_index];
   const int step_count = reconstruct_info->step_counts[new_struct_index];
@@ -1252,35 +1261,61 @@ static void reconstruct_struct(const DNA_ReconstructInfo *reconstruct_info,
   for (int a = 0; a < step_count; a++) {
     const ReconstructStep *step = &steps[a];
     switch (step->type) {
-      case RECONSTRUCT_STEP_MEMCPY:
-        memcpy(new_block + step->data.memcpy.new_offset,
-               old_block + step->data.memcpy.old_offset,
-               step->data.memcpy.size);
+      case RECONSTRUCT_STEP_MEMCPY: {
+        const int size = step->data.memcpy.size;
+        const char *old_data = old_blocks + step->data.memcpy.old_offset;
+        char *new_data = new_blocks + step->data.memcpy.new_offset;
+        if (size == old_stride && size == new_stride) {
+          /* The step covers the whole struct, copy all blocks at once. */
+          memcpy(new_data, old_data, size_t(size) * size_t(blocks));
+          break;
+        }
+        for (int block = 0; block < blocks; block++) {
+          memcpy(new_data + int64_t(block) * new_stride,
+                 old_data + int64_t(block) * old_stride,
+                 size);
+        }
         break;
+      }
       case RECONSTRUCT_STEP_CAST_PRIMITIVE:
         cast_primitive_type(step->data.cast_primitive.old_type,
                             step->data.cast_primitive.new_type,
+                            blocks,
                             step->data.cast_primitive.array_len,
-                            old_block + step->data.cast_primitive.old_offset,
-                            new_block + step->data.cast_primitive.new_offset);
+                            old_blocks + step->data.cast_primitive.old_offset,
+                            old_stride,
+                            new_blocks + step->data.cast_primitive.new_offset,
+                            new_stride);
         break;
       case RECONSTRUCT_STEP_CAST_POINTER_TO_32:
-        cast_pointer_64_to_32(step->data.cast_pointer.array_len,
-                              (const uint64_t *)(old_block + step->data.cast_pointer.old_offset),
-                              (uint32_t *)(new_block + step->data.cast_pointer.new_offset));
+        cast_pointer_64_to_32(blocks,
+                              step->data.cast_pointer.array_len,
+                              old_blocks + step->data.cast_pointer.old_offset,
+                              old_stride,
+                              new_blocks + step->data.cast_pointer.new_offset,
+                              new_stride);
         break;
       case RECONSTRUCT_STEP_CAST_POINTER_TO_64:
-        cast_pointer_32_to_64(step->data.cast_pointer.array_len,
-                              (const uint32_t *)(old_block + step->data.cast_pointer.old_offset),
-                              (uint64_t *)(new_block + step->data.cast_pointer.new_offset));
+        cast_pointer_32_to_64(blocks,
+                              step->data.cast_pointer.array_len,
+                              old_blocks + step->data.cast_pointer.old_offset,
+                              old_stride,
+                              new_blocks + step->data.cast_pointer.new_offset,
+                              new_stride);
         break;
       case RECONSTRUCT_STEP_SUBSTRUCT:
-        reconstruct_structs(reconstruct_info,
-                            step->data.substruct.array_len,
-                            step->data.substruct.old_struct_index,
-                            step->data.substruct.new_struct_index,
-                            old_block + step->data.substruct.old_offset,
-                            new_block + step->data.substruct.new_offset);
+        /* Only nested arrays that are too large to be inlined end up here,
+         * see #flatten_reconstruct_steps. */
+        for (int block = 0; block < blocks; block++) {
+          reconstruct_structs(reconstruct_info,
+                              step->data.substruct.array_len,
+                              step->data.substruct.old_struct_index,
+                              step->data.substruct.new_struct_index,
+                              old_blocks + int64_t(block) * old_stride +
+                                  step->data.substruct.old_offset,
+                              new_blocks + int64_t(block) * new_stride +
+                                  step->data.substruct.new_offset);
+        }
         break;
       case RECONSTRUCT_STEP_INIT_ZERO:
         /* Do nothing, because the memory block are zeroed (from #MEM_callocN).
@@ -1306,10 +1341,18 @@ static void reconstruct_structs(const DNA_ReconstructInfo *reconstruct_info,
   const int old_block_size = reconstruct_info->oldsdna->types_size[old_struct->type_index];
   const int new_block_size = reconstruct_info->newsdna->types_size[new_struct->type_index];
 
-  for (int a = 0; a < blocks; a++) {
-    const char *old_block = old_blocks + a * old_block_size;
-    char *new_block = new_blocks + a * new_block_size;
-    reconstruct_struct(reconstruct_info, new_struct_index, old_block, new_block);
+  const int chunk_size = std::max(
+      1, RECONSTRUCT_CHUNK_SIZE_IN_BYTES / std::max(1, old_block_size + new_block_size));
+
+  for (int chunk_start = 0; chunk_start < blocks; chunk_start += chunk_size) {
+    const int chunk_blocks = std::min(chunk_size, blocks - chunk_start);
+    reconstruct_struct_blocks(reconstruct_info,
+                              new_struct_index,
+                              chunk_blocks,
+                              old_blocks + int64_t(chunk_start) * old_block_size,
+                              old_block_size,
+                              new_blocks + int64_t(chunk_start) * new_block_size,
+                              new_block_size);
   }
 }
 
@@ -1610,11 +1653,52 @@ static int compress_reconstruct_steps(ReconstructStep *steps, const int old_step
         new_step_count++;
         break;
       case RECONSTRUCT_STEP_CAST_PRIMITIVE:
+        if (new_step_count > 0) {
+          /* Merge consecutive casts between the same types, which are common once nested
+           * structs are inlined (e.g. arrays of vectors). */
+          ReconstructStep *prev_step = &steps[new_step_count - 1];
+          if (prev_step->type == RECONSTRUCT_STEP_CAST_PRIMITIVE &&
+              prev_step->data.cast_primitive.old_type == step->data.cast_primitive.old_type &&
+              prev_step->data.cast_primitive.new_type == step->data.cast_primitive.new_type)
+          {
+            const int old_size = DNA_elem_type_size(step->data.cast_primitive.old_type);
+            const int new_size = DNA_elem_type_size(step->data.cast_primitive.new_type);
+            const int array_len = prev_step->data.cast_primitive.array_len;
+            if (prev_step->data.cast_primitive.old_offset + array_len * old_size ==
+                    step->data.cast_primitive.old_offset &&
+                prev_step->data.cast_primitive.new_offset + array_len * new_size ==
+                    step->data.cast_primitive.new_offset)
+            {
+              prev_step->data.cast_primitive.array_len += step->data.cast_primitive.array_len;
+              break;
+            }
+          }
+        }
+        steps[new_step_count] = *step;
+        new_step_count++;
+        break;
       case RECONSTRUCT_STEP_CAST_POINTER_TO_32:
       case RECONSTRUCT_STEP_CAST_POINTER_TO_64:
+        if (new_step_count > 0) {
+          ReconstructStep *prev_step = &steps[new_step_count - 1];
+          if (prev_step->type == step->type) {
+            const int old_size = step->type == RECONSTRUCT_STEP_CAST_POINTER_TO_32 ? 8 : 4;
+            const int new_size = step->type == RECONSTRUCT_STEP_CAST_POINTER_TO_32 ? 4 : 8;
+            const int array_len = prev_step->data.cast_pointer.array_len;
+            if (prev_step->data.cast_pointer.old_offset + array_len * old_size ==
+                    step->data.cast_pointer.old_offset &&
+                prev_step->data.cast_pointer.new_offset + array_len * new_size ==
+                    step->data.cast_pointer.new_offset)
+            {
+              prev_step->data.cast_pointer.array_len += step->data.cast_pointer.array_len;
+              break;
+            }
+          }
+        }
+        steps[new_step_count] = *step;
+        new_step_count++;
+        break;
       case RECONSTRUCT_STEP_SUBSTRUCT:
-        /* These steps are not changed at all for now. It should be possible to merge consecutive
-         * steps of the same type, but it is not really worth it. */
         steps[new_step_count] = *step;
         new_step_count++;
         break;
@@ -1623,6 +1707,127 @@ static int compress_reconstruct_steps(ReconstructStep *steps, const int old_step
   return new_step_count;
 }
 
+/**
+ * Nested struct arrays are inlined into the steps of their parent when this results in at most
+ * this many steps. Larger arrays keep a #RECONSTRUCT_STEP_SUBSTRUCT step.
+ */
+#define RECONSTRUCT_FLATTEN_STEPS_MAX 64
+
+/** Moves a step by the given offsets, used when inlining the steps of a nested struct. */
+static void offset_reconstruct_step(ReconstructStep *step,
+                                    const int old_offset,
+                                    const int new_offset)
+{
+  switch (step->type) {
+    case RECONSTRUCT_STEP_MEMCPY:
+      step->data.memcpy.old_offset += old_offset;
+      step->data.memcpy.new_offset += new_offset;
+      break;
+    case RECONSTRUCT_STEP_CAST_PRIMITIVE:
+      step->data.cast_primitive.old_offset += old_offset;
+      step->data.cast_primitive.new_offset += new_offset;
+      break;
+    case RECONSTRUCT_STEP_CAST_POINTER_TO_32:
+    case RECONSTRUCT_STEP_CAST_POINTER_TO_64:
+      step->data.cast_pointer.old_offset += old_offset;
+      step->data.cast_pointer.new_offset += new_offset;
+      break;
+    case RECONSTRUCT_STEP_SUBSTRUCT:
+      step->data.substruct.old_offset += old_offset;
+      step->data.substruct.new_offset += new_offset;
+      break;
+    case RECONSTRUCT_STEP_INIT_ZERO:
+      break;
+  }
+}
+
+/**
+ * Replaces #RECONSTRUCT_STEP_SUBSTRUCT steps by the (already flattened) steps of the nested
+ * struct, so that most structs are reconstructed with a single flat list of memcpy and cast
+ * steps without any recursion. Afterwards steps are compressed again, which merges copies and
+ * casts across the boundaries of the nested structs.
+ *
+ * \param r_flattened: Per new struct, whether its steps have been flattened already.
+ */
+static void flatten_reconstruct_steps(DNA_ReconstructInfo *reconstruct_info,
+                                      const int new_struct_index,
+                                      bool *r_flattened)
+{
+  if (r_flattened[new_struct_index]) {
+    return;
+  }
+  r_flattened[new_struct_index] = true;
+
+  const SDNA *oldsdna = reconstruct_info->oldsdna;
+  const SDNA *newsdna = reconstruct_info->newsdna;
+  ReconstructStep *steps = reconstruct_info->steps[new_struct_index];
+  const int step_count = reconstruct_info->step_counts[new_struct_index];
+
+  /* Flatten nested structs first and count the steps after inlining. */
+  bool has_inlined_steps = false;
+  int flat_step_count = 0;
+  for (int a = 0; a < step_count; a++) {
+    const ReconstructStep *step = &steps[a];
+    if (step->type != RECONSTRUCT_STEP_SUBSTRUCT) {
+      flat_step_count++;
+      continue;
+    }
+    const int sub_struct_index = step->data.substruct.new_struct_index;
+    flatten_reconstruct_steps(reconstruct_info, sub_struct_index, r_flattened);
+    const int inlined_count = step->data.substruct.array_len *
+                              reconstruct_info->step_counts[sub_struct_index];
+    if (inlined_count <= RECONSTRUCT_FLATTEN_STEPS_MAX) {
+      flat_step_count += inlined_count;
+      has_inlined_steps = true;
+    }
+    else {
+      flat_step_count++;
+    }
+  }
+
+  if (!has_inlined_steps) {
+    return;
+  }
+
+  ReconstructStep *flat_steps = static_cast<ReconstructStep *>(
+      MEM_malloc_arrayN(std::max(flat_step_count, 1), sizeof(ReconstructStep), __func__));
+  int flat_step_index = 0;
+  for (int a = 0; a < step_count; a++) {
+    const ReconstructStep *step = &steps[a];
+    if (step->type != RECONSTRUCT_STEP_SUBSTRUCT) {
+      flat_steps[flat_step_index++] = *step;
+      continue;
+    }
+    const int sub_struct_index = step->data.substruct.new_struct_index;
+    const ReconstructStep *sub_steps = reconstruct_info->steps[sub_struct_index];
+    const int sub_step_count = reconstruct_info->step_counts[sub_struct_index];
+    const int array_len = step->data.substruct.array_len;
+    if (array_len * sub_step_count > RECONSTRUCT_FLATTEN_STEPS_MAX) {
+      flat_steps[flat_step_index++] = *step;
+      continue;
+    }
+    const SDNA_Struct *old_sub_struct = oldsdna->structs[step->data.substruct.old_struct_index];
+    const SDNA_Struct *new_sub_struct = newsdna->structs[sub_struct_index];
+    const int old_sub_size = oldsdna->types_size[old_sub_struct->type_index];
+    const int new_sub_size = newsdna->types_size[new_sub_struct->type_index];
+    for (int elem = 0; elem < array_len; elem++) {
+      for (int b = 0; b < sub_step_count; b++) {
+        ReconstructStep *flat_step = &flat_steps[flat_step_index++];
+        *flat_step = sub_steps[b];
+        offset_reconstruct_step(flat_step,
+                                step->data.substruct.old_offset + elem * old_sub_size,
+                                step->data.substruct.new_offset + elem * new_sub_size);
+      }
+    }
+  }
+  BLI_assert(flat_step_index == flat_step_count);
+
+  MEM_freeN(steps);
+  reconstruct_info->steps[new_struct_index] = flat_steps;
+  reconstruct_info->step_counts[new_struct_index] = compress_reconstruct_steps(flat_steps,
+                                                                               flat_step_count);
+}
+
 DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
                                                  const SDNA *newsdna,
                                                  const char *compare_flags)
@@ -1656,17 +1861,30 @@ DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
 
     reconstruct_info->steps[new_struct_index] = steps;
     reconstruct_info->step_counts[new_struct_index] = steps_len;
+  }
+
+  /* Inline nested structs, so that reconstructing a struct rarely needs recursion. */
+  bool *flattened = MEM_cnew_array<bool>(newsdna->structs_num, __func__);
+  for (int new_struct_index = 0; new_struct_index < newsdna->structs_num; new_struct_index++) {
+    if (reconstruct_info->steps[new_struct_index] != nullptr) {
+      flatten_reconstruct_steps(reconstruct_info, new_struct_index, flattened);
+    }
+  }
+  MEM_freeN(flattened);
 
 /* This is useful when debugging the reconstruct steps. */
 #if 0
-    printf("%s: \n", new_struct_name);
+  for (int new_struct_index = 0; new_struct_index < newsdna->structs_num; new_struct_index++) {
+    const ReconstructStep *steps = reconstruct_info->steps[new_struct_index];
+    const int steps_len = reconstruct_info->step_counts[new_struct_index];
+    printf("%s: \n", newsdna->types[newsdna->structs[new_struct_index]->type_index]);
     for (int a = 0; a < steps_len; a++) {
       printf("  ");
       print_reconstruct_step(&steps[a], oldsdna, newsdna);
       printf("\n");
     }
-#endif
   }
+#endif
 
   return reconstruct_info;
 }
@@ -0,0 +1,62 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_genfile.h"
+
+#include "dna_genfile_test_common.hh"
+
+namespace blender::dna::tests {
+
+TEST_F(DNAReconstructTest, CompareFlags)
+{
+  const int vec_index = DNA_struct_find_index_without_alias(oldsdna_, "Vec");
+  const int item_index = DNA_struct_find_index_without_alias(oldsdna_, "Item");
+  EXPECT_EQ(compare_flags_[vec_index], SDNA_CMP_NOT_EQUAL);
+  EXPECT_EQ(compare_flags_[item_index], SDNA_CMP_NOT_EQUAL);
+}
+
+TEST_F(DNAReconstructTest, PrimitiveCasts)
+{
+  const OldValues old_values[2] = {{-2.75f, -7, 0.5, 255, -3}, {1e3f, 1 << 20, -1.25, 0, 100}};
+  const int old_struct_index = DNA_struct_find_index_without_alias(oldsdna_, "Values");
+  NewValues *new_values = static_cast<NewValues *>(
+      DNA_struct_reconstruct(reconstruct_info_, old_struct_index, 2, old_values, __func__));
+  for (const int i : IndexRange(2)) {
+    EXPECT_EQ(new_values[i].f_to_int, int(old_values[i].f_to_int));
+    EXPECT_EQ(new_values[i].i_to_double, double(old_values[i].i_to_double));
+    EXPECT_EQ(new_values[i].d_to_float, float(old_values[i].d_to_float));
+    EXPECT_FLOAT_EQ(new_values[i].u_to_float, float(old_values[i].u_to_float / 255.0));
+    EXPECT_EQ(new_values[i].c_to_short, short(old_values[i].c_to_short));
+  }
+  MEM_freeN(new_values);
+}
+
+TEST_F(DNAReconstructTest, SingleStruct)
+{
+  const std::vector<OldItem> old_items = create_old_items(1);
+  const int old_struct_index = DNA_struct_find_index_without_alias(oldsdna_, "Item");
+  NewItem *new_items = static_cast<NewItem *>(DNA_struct_reconstruct(
+      reconstruct_info_, old_struct_index, 1, old_items.data(), __func__));
+  expect_items_equal(old_items, new_items);
+  MEM_freeN(new_items);
+}
+
+TEST_F(DNAReconstructTest, StructArray)
+{
+  /* Large enough to be reconstructed in multiple chunks. */
+  const std::vector<OldItem> old_items = create_old_items(10007);
+  const int old_struct_index = DNA_struct_find_index_without_alias(oldsdna_, "Item");
+  NewItem *new_items = static_cast<NewItem *>(DNA_struct_reconstruct(
+      reconstruct_info_, old_struct_index, int(old_items.size()), old_items.data(), __func__));
+  expect_items_equal(old_items, new_items);
+  MEM_freeN(new_items);
+}
+
+}  // namespace blender::dna::tests
@@ -0,0 +1,308 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup DNA
+ *
+ * Synthetic old and new SDNA definitions shared by the struct reconstruction tests.
+ */
+
+#include "testing/testing.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_index_range.hh"
+#include "BLI_utildefines.h"
+
+#include "DNA_genfile.h"
+#include "DNA_sdna_types.h"
+
+namespace blender::dna::tests {
+
+/**
+ * Builds encoded SDNA data in the same format as written by `makesdna`, so that struct
+ * reconstruction can be tested with synthetic old and new struct definitions.
+ */
+class SDNABuilder {
+  std::vector<std::string> members_;
+  std::vector<std::pair<std::string, short>> types_;
+  std::vector<std::vector<short>> structs_;
+
+ public:
+  explicit SDNABuilder(const int pointer_size)
+  {
+    /* Must match the order of #eSDNA_Type. */
+    add_type("char", 1);
+    add_type("uchar", 1);
+    add_type("short", 2);
+    add_type("ushort", 2);
+    add_type("int", 4);
+    add_type("long", 4);
+    add_type("ulong", 4);
+    add_type("float", 4);
+    add_type("double", 8);
+    add_type("void", 0);
+    add_type("int64_t", 8);
+    add_type("uint64_t", 8);
+    add_type("int8_t", 1);
+    add_struct("raw_data", 0, {});
+    add_struct("ListBase", pointer_size * 2, {{"void", "*first"}, {"void", "*last"}});
+  }
+
+  short add_type(const std::string &name, const short size)
+  {
+    types_.emplace_back(name, size);
+    return short(types_.size() - 1);
+  }
+
+  void add_struct(const std::string &name,
+                  const short size,
+                  const std::vector<std::pair<std::string, std::string>> &members)
+  {
+    std::vector<short> struct_info;
+    struct_info.push_back(add_type(name, size));
+    struct_info.push_back(short(members.size()));
+    for (const auto &[type_name, member_name] : members) {
+      struct_info.push_back(find_type(type_name));
+      struct_info.push_back(add_member(member_name));
+    }
+    structs_.push_back(std::move(struct_info));
+  }
+
+  std::vector<char> build() const
+  {
+    std::vector<char> data;
+    auto add_id = [&](const char *id) { data.insert(data.end(), id, id + 4); };
+    auto add_int = [&](const int value) {
+      data.insert(data.end(), (const char *)&value, (const char *)&value + sizeof(int));
+    };
+    auto add_short = [&](const short value) {
+      data.insert(data.end(), (const char *)&value, (const char *)&value + sizeof(short));
+    };
+    auto pad_4 = [&]() { data.resize((data.size() + 3) & ~size_t(3), '\0'); };
+
+    add_id("SDNA");
+    add_id("NAME");
+    add_int(int(members_.size()));
+    for (const std::string &name : members_) {
+      data.insert(data.end(), name.c_str(), name.c_str() + name.size() + 1);
+    }
+    pad_4();
+    add_id("TYPE");
+    add_int(int(types_.size()));
+    for (const auto &type : types_) {
+      data.insert(data.end(), type.first.c_str(), type.first.c_str() + type.first.size() + 1);
+    }
+    pad_4();
+    add_id("TLEN");
+    for (const auto &type : types_) {
+      add_short(type.second);
+    }
+    pad_4();
+    add_id("STRC");
+    add_int(int(structs_.size()));
+    for (const std::vector<short> &struct_info : structs_) {
+      for (const short value : struct_info) {
+        add_short(value);
+      }
+    }
+    return data;
+  }
+
+ private:
+  short find_type(const std::string &name) const
+  {
+    for (const int i : IndexRange(types_.size())) {
+      if (types_[i].first == name) {
+        return short(i);
+      }
+    }
+    BLI_assert_unreachable();
+    return -1;
+  }
+
+  short add_member(const std::string &name)
+  {
+    for (const int i : IndexRange(members_.size())) {
+      if (members_[i] == name) {
+        return short(i);
+      }
+    }
+    members_.push_back(name);
+    return short(members_.size() - 1);
+  }
+};
+
+struct OldVec {
+  short x, y, z;
+};
+
+struct OldItem {
+  int id;
+  char flag;
+  char _pad[1];
+  OldVec co;
+  OldVec no[2];
+  uint32_t ptr;
+  float removed;
+};
+BLI_STATIC_ASSERT(sizeof(OldItem) == 32, "Unexpected size")
+
+struct NewVec {
+  float x, y, z;
+};
+
+struct NewItem {
+  int id;
+  float flag;
+  NewVec co;
+  NewVec no[2];
+  char _pad2[4];
+  uint64_t ptr;
+  double added;
+};
+BLI_STATIC_ASSERT(sizeof(NewItem) == 64, "Unexpected size")
+
+struct OldValues {
+  float f_to_int;
+  int i_to_double;
+  double d_to_float;
+  uchar u_to_float;
+  char c_to_short;
+  char _pad[6];
+};
+
+struct NewValues {
+  int f_to_int;
+  float d_to_float;
+  double i_to_double;
+  float u_to_float;
+  short c_to_short;
+  char _pad[2];
+};
+
+class DNAReconstructTest : public testing::Test {
+ protected:
+  std::vector<char> old_data_;
+  std::vector<char> new_data_;
+  SDNA *oldsdna_ = nullptr;
+  SDNA *newsdna_ = nullptr;
+  const char *compare_flags_ = nullptr;
+  DNA_ReconstructInfo *reconstruct_info_ = nullptr;
+
+  void SetUp() override
+  {
+    /* Old files from a 32 bit system, using short vectors. */
+    SDNABuilder old_builder(4);
+    old_builder.add_struct("Vec", 6, {{"short", "x"}, {"short", "y"}, {"short", "z"}});
+    old_builder.add_struct("Item",
+                           32,
+                           {{"int", "id"},
+                            {"char", "flag"},
+                            {"char", "_pad[1]"},
+                            {"Vec", "co"},
+                            {"Vec", "no[2]"},
+                            {"void", "*ptr"},
+                            {"float", "removed"}});
+    old_builder.add_struct("Values",
+                           24,
+                           {{"float", "f_to_int"},
+                            {"int", "i_to_double"},
+                            {"double", "d_to_float"},
+                            {"uchar", "u_to_float"},
+                            {"char", "c_to_short"},
+                            {"char", "_pad[6]"}});
+
+    SDNABuilder new_builder(8);
+    new_builder.add_struct("Vec", 12, {{"float", "x"}, {"float", "y"}, {"float", "z"}});
+    new_builder.add_struct("Item",
+                           64,
+                           {{"int", "id"},
+                            {"float", "flag"},
+                            {"Vec", "co"},
+                            {"Vec", "no[2]"},
+                            {"char", "_pad2[4]"},
+                            {"void", "*ptr"},
+                            {"double", "added"}});
+    new_builder.add_struct("Values",
+                           24,
+                           {{"int", "f_to_int"},
+                            {"float", "d_to_float"},
+                            {"double", "i_to_double"},
+                            {"float", "u_to_float"},
+                            {"short", "c_to_short"},
+                            {"char", "_pad[2]"}});
+
+    old_data_ = old_builder.build();
+    new_data_ = new_builder.build();
+    oldsdna_ = DNA_sdna_from_data(
+        old_data_.data(), int(old_data_.size()), false, false, false, nullptr);
+    newsdna_ = DNA_sdna_from_data(
+        new_data_.data(), int(new_data_.size()), false, false, false, nullptr);
+    ASSERT_NE(oldsdna_, nullptr);
+    ASSERT_NE(newsdna_, nullptr);
+    compare_flags_ = DNA_struct_get_compareflags(oldsdna_, newsdna_);
+    reconstruct_info_ = DNA_reconstruct_info_create(oldsdna_, newsdna_, compare_flags_);
+  }
+
+  void TearDown() override
+  {
+    if (reconstruct_info_) {
+      DNA_reconstruct_info_free(reconstruct_info_);
+    }
+    if (compare_flags_) {
+      MEM_freeN((void *)compare_flags_);
+    }
+    if (oldsdna_) {
+      DNA_sdna_free(oldsdna_);
+    }
+    if (newsdna_) {
+      DNA_sdna_free(newsdna_);
+    }
+  }
+
+  static std::vector<OldItem> create_old_items(const int count)
+  {
+    std::vector<OldItem> items(count);
+    for (const int i : IndexRange(count)) {
+      OldItem &item = items[i];
+      item.id = i;
+      item.flag = char(i % 100);
+      item.co = {short(i), short(-i), short(i / 2)};
+      item.no[0] = {short(i % 7), short(1), short(-2)};
+      item.no[1] = {short(3), short(i % 11), short(-4)};
+      item.ptr = uint32_t(0xF0000000u + i);
+      item.removed = 1.5f;
+    }
+    return items;
+  }
+
+  void expect_items_equal(const std::vector<OldItem> &old_items, const NewItem *new_items)
+  {
+    for (const int i : IndexRange(old_items.size())) {
+      const OldItem &old_item = old_items[i];
+      const NewItem &new_item = new_items[i];
+      EXPECT_EQ(new_item.id, old_item.id);
+      EXPECT_FLOAT_EQ(new_item.flag, float(old_item.flag / 255.0));
+      EXPECT_EQ(new_item.co.x, float(old_item.co.x));
+      EXPECT_EQ(new_item.co.y, float(old_item.co.y));
+      EXPECT_EQ(new_item.co.z, float(old_item.co.z));
+      for (const int j : IndexRange(2)) {
+        EXPECT_EQ(new_item.no[j].x, float(old_item.no[j].x));
+        EXPECT_EQ(new_item.no[j].y, float(old_item.no[j].y));
+        EXPECT_EQ(new_item.no[j].z, float(old_item.no[j].z));
+      }
+      EXPECT_EQ(new_item.ptr, uint64_t(old_item.ptr));
+      EXPECT_EQ(new_item.added, 0.0);
+    }
+  }
+};
+
+}  // namespace blender::dna::tests
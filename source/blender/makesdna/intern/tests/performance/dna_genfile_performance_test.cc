@@ -0,0 +1,32 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_index_range.hh"
+#include "BLI_timeit.hh"
+
+#include "DNA_genfile.h"
+
+#include "dna_genfile_test_common.hh"
+
+namespace blender::dna::tests {
+
+TEST_F(DNAReconstructTest, StructArrayPerformance)
+{
+  const std::vector<OldItem> old_items = create_old_items(1000000);
+  const int old_struct_index = DNA_struct_find_index_without_alias(oldsdna_, "Item");
+  for ([[maybe_unused]] const int i : IndexRange(5)) {
+    SCOPED_TIMER("reconstruct 1M structs");
+    NewItem *new_items = static_cast<NewItem *>(DNA_struct_reconstruct(
+        reconstruct_info_, old_struct_index, int(old_items.size()), old_items.data(), __func__));
+    MEM_freeN(new_items);
+  }
+}
+
+}  // namespace blender::dna::tests
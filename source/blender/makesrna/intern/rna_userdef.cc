@@ -7623,6 +7623,19 @@ static void rna_def_userdef_experimental(BlenderRNA *brna)
       prop, "Shader Node Previews", "Enables previews in the shader node editor");
   RNA_def_property_update(prop, 0, "rna_userdef_ui_update");
 
+  prop = RNA_def_property(srna, "use_mmap_file_data", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(prop,
+                           "Memory-Mapped File Data",
+                           "Reference large data arrays of uncompressed blend-files directly in "
+                           "the memory-mapped file instead of copying them when loading. Other "
+                           "programs must not modify the file while it is open");
+
+  prop = RNA_def_property(srna, "use_undo_compression", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(prop,
+                           "Compress Undo Steps",
+                           "Compress global undo data that has not changed in the last few undo "
+                           "steps, to reduce memory usage of long undo histories");
+
   prop = RNA_def_property(srna, "use_extensions_debug", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_ui_text(
       prop,
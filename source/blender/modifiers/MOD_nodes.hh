@@ -15,6 +15,12 @@ struct NodesModifierBake;
 namespace blender::bke::bake {
 struct ModifierCache;
 }
+namespace blender::fn::lazy_function {
+class GraphExecutorTracer;
+}
+namespace blender::nodes {
+class NodeOutputCache;
+}
 namespace blender::nodes::geo_eval_log {
 class GeoModifierLog;
 }
@@ -42,6 +48,18 @@ struct NodesModifierRuntime {
    * used by the evaluated modifier.
    */
   std::shared_ptr<bke::bake::ModifierCache> cache;
+  /**
+   * Outputs of nodes from the previous evaluation, so that nodes whose inputs did not change don't
+   * have to be executed again. Like the simulation cache, it is shared between the original and
+   * evaluated modifier so that it survives when the evaluated modifier is copied again.
+   */
+  std::shared_ptr<nodes::NodeOutputCache> node_output_cache;
+  /**
+   * Only exists when tracing is enabled with the `BLENDER_GEOMETRY_NODES_TRACE` or
+   * `BLENDER_GEOMETRY_NODES_CRITICAL_PATH` environment variables. It is shared like the caches,
+   * because critical path scheduling uses the node execution times from the previous evaluation.
+   */
+  std::shared_ptr<fn::lazy_function::GraphExecutorTracer> graph_executor_tracer;
 };
 
 void nodes_modifier_data_block_destruct(NodesModifierDataBlock *data_block, bool do_id_user);
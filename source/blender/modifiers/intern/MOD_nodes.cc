@@ -13,8 +13,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_fileops.hh"
 #include "BLI_listbase.h"
 #include "BLI_multi_value_map.hh"
+#include "BLI_path_utils.hh"
 #include "BLI_set.hh"
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
@@ -82,11 +84,14 @@
 #include "ED_undo.hh"
 #include "ED_viewer_path.hh"
 
+#include "FN_lazy_function_graph_executor_tracer.hh"
+
 #include "NOD_geometry.hh"
 #include "NOD_geometry_nodes_dependencies.hh"
 #include "NOD_geometry_nodes_execute.hh"
 #include "NOD_geometry_nodes_gizmos.hh"
 #include "NOD_geometry_nodes_lazy_function.hh"
+#include "NOD_geometry_nodes_memoize.hh"
 #include "NOD_node_declaration.hh"
 #include "NOD_socket_usage_inference.hh"
 
@@ -96,6 +101,23 @@ namespace bake = blender::bke::bake;
 
 namespace blender {
 
+/**
+ * Debug option to find out why the evaluation of node trees does not scale to more threads. When
+ * `BLENDER_GEOMETRY_NODES_TRACE` is set to a directory, the node executions of the latest
+ * evaluation of every modifier are written to a Chrome trace file in it. When
+ * `BLENDER_GEOMETRY_NODES_CRITICAL_PATH` is set, nodes on the longest path of the previous
+ * evaluation are executed first.
+ */
+static std::shared_ptr<fn::lazy_function::GraphExecutorTracer> graph_executor_tracer_new()
+{
+  const bool use_critical_path_scheduling = BLI_getenv("BLENDER_GEOMETRY_NODES_CRITICAL_PATH") !=
+                                            nullptr;
+  if (!use_critical_path_scheduling && !BLI_getenv("BLENDER_GEOMETRY_NODES_TRACE")) {
+    return {};
+  }
+  return std::make_shared<fn::lazy_function::GraphExecutorTracer>(use_critical_path_scheduling);
+}
+
 static void init_data(ModifierData *md)
 {
   NodesModifierData *nmd = (NodesModifierData *)md;
@@ -106,6 +128,8 @@ static void init_data(ModifierData *md)
   MEMCPY_STRUCT_AFTER(nmd, DNA_struct_default_get(NodesModifierData), modifier);
   nmd->runtime = MEM_new<NodesModifierRuntime>(__func__);
   nmd->runtime->cache = std::make_shared<bake::ModifierCache>();
+  nmd->runtime->node_output_cache = std::make_shared<nodes::NodeOutputCache>();
+  nmd->runtime->graph_executor_tracer = graph_executor_tracer_new();
 }
 
 static void find_dependencies_from_settings(const NodesModifierSettings &settings,
@@ -1823,6 +1847,15 @@ static void modifyGeometry(ModifierData *md,
   find_side_effect_nodes(*nmd, *ctx, side_effect_nodes, socket_log_contexts);
   call_data.side_effect_nodes = &side_effect_nodes;
 
+  /* Only the active depsgraph reuses node outputs, other depsgraphs are typically only evaluated
+   * once. */
+  nodes::NodeOutputCache *node_output_cache = nmd->runtime->node_output_cache.get();
+  if (node_output_cache && DEG_is_active(ctx->depsgraph) && !(ctx->flag & MOD_APPLY_TO_ORIGINAL)) {
+    node_output_cache->begin_evaluation(*ctx->depsgraph);
+    call_data.node_output_cache = node_output_cache;
+    call_data.graph_executor_tracer = nmd->runtime->graph_executor_tracer.get();
+  }
+
   bke::ModifierComputeContext modifier_compute_context{nullptr, nmd->modifier.name};
 
   geometry_set = nodes::execute_geometry_nodes_on_geometry(tree,
@@ -1831,6 +1864,21 @@ static void modifyGeometry(ModifierData *md,
                                                            call_data,
                                                            std::move(geometry_set));
 
+  if (call_data.node_output_cache) {
+    call_data.node_output_cache->end_evaluation();
+  }
+  if (fn::lazy_function::GraphExecutorTracer *tracer = call_data.graph_executor_tracer) {
+    if (const char *trace_dir = BLI_getenv("BLENDER_GEOMETRY_NODES_TRACE")) {
+      const std::string filename = fmt::format(
+          "{}_{}.json", BKE_id_name(ctx->object->id), nmd->modifier.name);
+      char filepath[FILE_MAX];
+      BLI_path_join(filepath, sizeof(filepath), trace_dir, filename.c_str());
+      fstream stream{filepath, std::ios::out};
+      tracer->export_chrome_trace(stream);
+    }
+    tracer->finish_evaluation();
+  }
+
   if (logging_enabled(ctx)) {
     nmd_orig->runtime->eval_log = std::move(eval_log);
   }
@@ -2683,6 +2731,8 @@ static void blend_read(BlendDataReader *reader, ModifierData *md)
 
   nmd->runtime = MEM_new<NodesModifierRuntime>(__func__);
   nmd->runtime->cache = std::make_shared<bake::ModifierCache>();
+  nmd->runtime->node_output_cache = std::make_shared<nodes::NodeOutputCache>();
+  nmd->runtime->graph_executor_tracer = graph_executor_tracer_new();
 }
 
 static void copy_data(const ModifierData *md, ModifierData *target, const int flag)
@@ -2741,11 +2791,15 @@ static void copy_data(const ModifierData *md, ModifierData *target, const int fl
   if (flag & LIB_ID_COPY_SET_COPIED_ON_WRITE) {
     /* Share the simulation cache between the original and evaluated modifier. */
     tnmd->runtime->cache = nmd->runtime->cache;
+    tnmd->runtime->node_output_cache = nmd->runtime->node_output_cache;
+    tnmd->runtime->graph_executor_tracer = nmd->runtime->graph_executor_tracer;
     /* Keep bake path in the evaluated modifier. */
     tnmd->bake_directory = nmd->bake_directory ? BLI_strdup(nmd->bake_directory) : nullptr;
   }
   else {
     tnmd->runtime->cache = std::make_shared<bake::ModifierCache>();
+    tnmd->runtime->node_output_cache = std::make_shared<nodes::NodeOutputCache>();
+    tnmd->runtime->graph_executor_tracer = graph_executor_tracer_new();
     /* Clear the bake path when duplicating. */
     tnmd->bake_directory = nullptr;
   }
@@ -82,6 +82,9 @@ static void free_runtime_data(void *runtime_data_v)
   if (runtime_data->subdiv_gpu != nullptr) {
     blender::bke::subdiv::free(runtime_data->subdiv_gpu);
   }
+  if (runtime_data->mesh_cache != nullptr) {
+    blender::bke::subdiv::to_mesh_cache_free(runtime_data->mesh_cache);
+  }
   MEM_freeN(runtime_data);
 }
 
@@ -132,7 +135,8 @@ static void subdiv_mesh_settings_init(blender::bke::subdiv::ToMeshSettings *sett
 static Mesh *subdiv_as_mesh(SubsurfModifierData *smd,
                             const ModifierEvalContext *ctx,
                             Mesh *mesh,
-                            blender::bke::subdiv::Subdiv *subdiv)
+                            blender::bke::subdiv::Subdiv *subdiv,
+                            SubsurfRuntimeData *runtime_data)
 {
   Mesh *result = mesh;
   blender::bke::subdiv::ToMeshSettings mesh_settings;
@@ -140,7 +144,16 @@ static Mesh *subdiv_as_mesh(SubsurfModifierData *smd,
   if (mesh_settings.resolution < 3) {
     return result;
   }
-  result = blender::bke::subdiv::subdiv_to_mesh(subdiv, &mesh_settings, mesh);
+  /* Applying the modifier is a one time operation, don't keep the result alive for that. */
+  if (ctx->flag & MOD_APPLY_TO_ORIGINAL) {
+    result = blender::bke::subdiv::subdiv_to_mesh(subdiv, &mesh_settings, mesh);
+    return result;
+  }
+  if (runtime_data->mesh_cache == nullptr) {
+    runtime_data->mesh_cache = blender::bke::subdiv::to_mesh_cache_new();
+  }
+  result = blender::bke::subdiv::subdiv_to_mesh(
+      subdiv, &mesh_settings, mesh, *runtime_data->mesh_cache);
   return result;
 }
 
@@ -246,7 +259,7 @@ static Mesh *modify_mesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh
   /* TODO(sergey): Decide whether we ever want to use CCG for subsurf,
    * maybe when it is a last modifier in the stack? */
   if (true) {
-    result = subdiv_as_mesh(smd, ctx, mesh, subdiv);
+    result = subdiv_as_mesh(smd, ctx, mesh, subdiv, runtime_data);
   }
   else {
     result = subdiv_as_ccg(smd, ctx, mesh, subdiv);
@@ -45,6 +45,8 @@ using lf::LazyFunction;
 using mf::MultiFunction;
 using ReferenceSetIndex = int;
 
+class NodeOutputCache;
+
 /** The structs in here describe the different possible behaviors of a simulation input node. */
 namespace sim_input {
 
@@ -240,6 +242,16 @@ struct GeoNodesCallData {
    * If this is null, all socket values will be logged.
    */
   const Set<ComputeContextHash> *socket_log_contexts = nullptr;
+  /**
+   * Optional cache of node outputs from the previous evaluation. If this is null, all nodes are
+   * executed.
+   */
+  NodeOutputCache *node_output_cache = nullptr;
+  /**
+   * Optional tracer that records the node executions of all lazy-function graphs, to find out why
+   * the evaluation does not scale to more threads.
+   */
+  lf::GraphExecutorTracer *graph_executor_tracer = nullptr;
 
   /**
    * Data from the modifier that is being evaluated.
@@ -276,6 +288,7 @@ struct GeoNodesLFUserData : public lf::UserData {
   bool log_socket_values = true;
 
   destruct_ptr<lf::LocalUserData> get_local(LinearAllocator<> &allocator) override;
+  lf::GraphExecutorTracer *graph_executor_tracer() override;
 };
 
 struct GeoNodesLFLocalUserData : public lf::LocalUserData {
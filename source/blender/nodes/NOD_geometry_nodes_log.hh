@@ -234,6 +234,13 @@ class GeoTreeLogger {
   struct EvaluatedGizmoNode {
     int32_t node_id;
   };
+  struct NodeMemoization {
+    int32_t node_id;
+    /** True if the outputs were reused from the previous evaluation. */
+    bool is_hit;
+    /** Memory used by the outputs that are kept for the next evaluation. */
+    int64_t memory_bytes;
+  };
 
   linear_allocator::ChunkedList<WarningWithNode> node_warnings;
   linear_allocator::ChunkedList<SocketValueLog, 16> input_socket_values;
@@ -244,6 +251,8 @@ class GeoTreeLogger {
   linear_allocator::ChunkedList<DebugMessage> debug_messages;
   /** Keeps track of which gizmo nodes have been tracked by this evaluation. */
   linear_allocator::ChunkedList<EvaluatedGizmoNode> evaluated_gizmo_nodes;
+  /** Keeps track of which nodes used outputs from the #NodeOutputCache. */
+  linear_allocator::ChunkedList<NodeMemoization> node_memoizations;
 
   GeoTreeLogger();
   ~GeoTreeLogger();
@@ -266,6 +275,14 @@ class GeoNodeLog {
   VectorSet<NodeWarning> warnings;
   /** Time spent in this node. */
   std::chrono::nanoseconds execution_time{0};
+  /**
+   * How often the outputs of this node were reused from the previous evaluation and how often
+   * they had to be computed.
+   */
+  int memoization_hits = 0;
+  int memoization_misses = 0;
+  /** Memory used by the outputs of this node that are kept for the next evaluation. */
+  int64_t memoized_bytes = 0;
   /** Maps from socket indices to their values. */
   Map<int, ValueLog *> input_values_;
   Map<int, ValueLog *> output_values_;
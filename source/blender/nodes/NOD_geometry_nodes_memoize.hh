@@ -0,0 +1,124 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup nodes
+ *
+ * Memoization of geometry node outputs across evaluations. When e.g. only a single input of a
+ * node tree is animated, most nodes get the same inputs as in the previous frame. The outputs of
+ * expensive nodes are reused from the previous evaluation, so that they are only executed again
+ * when they depend on the changed input.
+ *
+ * A stored output geometry is shared with the nodes using it, so nodes that modify it have to
+ * copy it first. Outputs are therefore only stored once a node got the same inputs in two
+ * evaluations in a row. The outputs of nodes whose inputs change in every evaluation are never
+ * stored and can still be modified in place.
+ *
+ * Inputs are compared by value when that is cheap. Geometries are compared by their components
+ * and fields by their field nodes, because comparing the data itself would often be as expensive
+ * as executing the node again. This still works well, because a node whose outputs are reused
+ * outputs the exact same geometry and fields as before, so that the nodes depending on it can be
+ * skipped as well. Objects are compared by their depsgraph update counters.
+ */
+
+#include <mutex>
+
+#include "BLI_compute_context.hh"
+#include "BLI_function_ref.hh"
+#include "BLI_map.hh"
+
+#include "FN_lazy_function.hh"
+
+struct bNode;
+struct Depsgraph;
+
+namespace blender::nodes {
+
+/**
+ * Stores the outputs of nodes from the previous evaluation of a node tree. It is owned by the
+ * modifier and is used by all node groups that are evaluated by it.
+ */
+class NodeOutputCache : NonCopyable, NonMovable {
+ public:
+  struct Entry;
+
+ private:
+  struct NodeKey {
+    ComputeContextHash context_hash;
+    int32_t node_id;
+
+    uint64_t hash() const
+    {
+      return get_default_hash(context_hash, node_id);
+    }
+
+    BLI_STRUCT_EQUALITY_OPERATORS_2(NodeKey, context_hash, node_id)
+  };
+
+  struct StoredEntry {
+    std::shared_ptr<const Entry> entry;
+    /** Index of the last evaluation that used the entry. */
+    uint64_t last_used_evaluation;
+  };
+
+  std::mutex mutex_;
+  Map<NodeKey, StoredEntry> entries_;
+  /** Update counters of objects are only meaningful within a single depsgraph. */
+  const Depsgraph *depsgraph_ = nullptr;
+  /** Detects when a new depsgraph has been allocated at the address of a freed one. */
+  uint64_t depsgraph_update_count_ = 0;
+  uint64_t evaluation_ = 0;
+
+ public:
+  NodeOutputCache();
+  ~NodeOutputCache();
+
+  /**
+   * Has to be called before every evaluation that uses the cache. The cache is cleared when it is
+   * used with a different depsgraph than before.
+   */
+  void begin_evaluation(const Depsgraph &depsgraph);
+  /**
+   * Remove the outputs of nodes that have not been executed in the latest evaluation, so that the
+   * cache does not keep data alive that is not used anymore.
+   */
+  void end_evaluation();
+
+  /** Find the outputs that were stored for the node in the given compute context. */
+  std::shared_ptr<const Entry> lookup(const ComputeContextHash &context_hash, int32_t node_id);
+  /** Replace the stored outputs of the node in the given compute context. */
+  void add(const ComputeContextHash &context_hash,
+           int32_t node_id,
+           std::shared_ptr<const Entry> entry);
+};
+
+/**
+ * Get a new identifier for a lazy-function that executes a node. Stored outputs are only reused
+ * by the same lazy-function, because they depend on node settings that are not passed in as
+ * inputs. The lazy-function graph is rebuilt whenever those settings change.
+ */
+uint64_t memoized_node_function_id_new();
+
+/**
+ * True if the outputs of the node are stored for the next evaluation. Only nodes that are much
+ * more expensive to execute than copying their outputs opt into this. Their outputs also have to
+ * depend only on their inputs and settings.
+ */
+bool node_supports_memoization(const bNode &node);
+
+/**
+ * Execute a geometry node, unless its inputs are the same as in the previous evaluation and its
+ * outputs were stored then. In that case, the outputs, warnings and used attributes are copied
+ * from the #NodeOutputCache of the evaluation instead. \a execute_fn is always called when the
+ * evaluation does not have a cache or the node does not support memoization.
+ */
+void execute_node_with_memoization(const bNode &node,
+                                   uint64_t function_id,
+                                   lf::Params &params,
+                                   const lf::Context &context,
+                                   FunctionRef<void(lf::Params &params)> execute_fn);
+
+}  // namespace blender::nodes
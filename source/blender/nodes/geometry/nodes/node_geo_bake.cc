@@ -824,6 +824,8 @@ void draw_common_bake_settings(bContext *C, BakeDrawContext &ctx, uiLayout *layo
                 ICON_NONE,
                 placeholder_path);
   }
+  uiItemR(
+      settings_col, &ctx.bake_rna, "use_compression", UI_ITEM_NONE, IFACE_("Compress"), ICON_NONE);
   {
     uiLayout *col = uiLayoutColumn(settings_col, true);
     uiItemR(col,
@@ -57,7 +57,9 @@ static void node_declare(NodeDeclarationBuilder &b)
     const auto operation = geometry::boolean::Operation(node->custom1);
     const auto solver = geometry::boolean::Solver(node->custom2);
 
-    output_edges.available(solver == geometry::boolean::Solver::MeshArr);
+    output_edges.available(ELEM(solver,
+                                geometry::boolean::Solver::MeshArr,
+                                geometry::boolean::Solver::Manifold));
 
     switch (operation) {
       case geometry::boolean::Operation::Intersect:
@@ -173,7 +175,7 @@ static void node_geo_exec(GeoNodeExecParams params)
   }
 
   AttributeOutputs attribute_outputs;
-  if (solver == geometry::boolean::Solver::MeshArr) {
+  if (ELEM(solver, geometry::boolean::Solver::MeshArr, geometry::boolean::Solver::Manifold)) {
     attribute_outputs.intersecting_edges_id = params.get_output_anonymous_attribute_id_if_needed(
         "Intersecting Edges");
   }
@@ -266,6 +268,12 @@ static void node_rna(StructRNA *srna)
        0,
        "Float",
        "Simple solver for the best performance, without support for overlapping geometry"},
+      {int(geometry::boolean::Solver::Manifold),
+       "MANIFOLD",
+       0,
+       "Manifold",
+       "Exact solver that is faster for many closed manifold meshes. Other meshes are processed "
+       "with the Exact solver"},
       {0, nullptr, 0, nullptr, nullptr},
   };
 
@@ -91,6 +91,23 @@ static std::optional<Mesh *> mesh_merge_by_distance_all(const Mesh &mesh,
   return geometry::mesh_merge_by_distance_all(mesh, selection, merge_distance);
 }
 
+static std::optional<Mesh *> mesh_merge_by_distance_clusters(const Mesh &mesh,
+                                                             const float merge_distance,
+                                                             const Field<bool> &selection_field)
+{
+  const bke::MeshFieldContext context{mesh, AttrDomain::Point};
+  FieldEvaluator evaluator{context, mesh.verts_num};
+  evaluator.add(selection_field);
+  evaluator.evaluate();
+
+  const IndexMask selection = evaluator.get_evaluated_as_mask(0);
+  if (selection.is_empty()) {
+    return std::nullopt;
+  }
+
+  return geometry::mesh_merge_by_distance_clusters(mesh, selection, merge_distance);
+}
+
 static void node_geo_exec(GeoNodeExecParams params)
 {
   const NodeGeometryMergeByDistance &storage = node_storage(params.node());
@@ -115,6 +132,9 @@ static void node_geo_exec(GeoNodeExecParams params)
         case GEO_NODE_MERGE_BY_DISTANCE_MODE_ALL:
           result = mesh_merge_by_distance_all(*mesh, merge_distance, selection);
           break;
+        case GEO_NODE_MERGE_BY_DISTANCE_MODE_CLUSTERS:
+          result = mesh_merge_by_distance_clusters(*mesh, merge_distance, selection);
+          break;
         case GEO_NODE_MERGE_BY_DISTANCE_MODE_CONNECTED:
           result = mesh_merge_by_distance_connected(*mesh, merge_distance, selection);
           break;
@@ -143,6 +163,12 @@ static void node_rna(StructRNA *srna)
        0,
        "Connected",
        "Only merge mesh vertices along existing edges. This method can be much faster"},
+      {GEO_NODE_MERGE_BY_DISTANCE_MODE_CLUSTERS,
+       "CLUSTERS",
+       0,
+       "Clusters",
+       "Merge all chains of close selected points into one point, whether or not they are "
+       "connected. This method is computed in parallel and can be much faster for large meshes"},
       {0, nullptr, 0, nullptr, nullptr},
   };
 
@@ -105,22 +105,18 @@ static void raycast_to_mesh(const IndexMask &mask,
     return;
   }
 
-  mask.foreach_index([&](const int i) {
-    const float ray_length = ray_lengths[i];
-    const float3 ray_origin = ray_origins[i];
-    const float3 ray_direction = ray_directions[i];
-
-    BVHTreeRayHit hit;
-    hit.index = -1;
-    hit.dist = ray_length;
-    if (BLI_bvhtree_ray_cast(tree_data.tree,
-                             ray_origin,
-                             ray_direction,
-                             0.0f,
-                             &hit,
-                             tree_data.raycast_callback,
-                             &tree_data) != -1)
-    {
+  const VArraySpan<float3> origins = ray_origins;
+  const VArraySpan<float3> directions = ray_directions;
+  Array<BVHTreeRayHit> hits(mask.min_array_size());
+  mask.foreach_index(GrainSize(4096), [&](const int i) {
+    hits[i].index = -1;
+    hits[i].dist = ray_lengths[i];
+  });
+  bke::bvhtree_ray_cast_batch(tree_data, mask, origins, directions, 0.0f, hits);
+
+  mask.foreach_index(GrainSize(4096), [&](const int i) {
+    const BVHTreeRayHit &hit = hits[i];
+    if (hit.index != -1) {
       if (!r_hit.is_empty()) {
         r_hit[i] = hit.index >= 0;
       }
@@ -152,7 +148,7 @@ static void raycast_to_mesh(const IndexMask &mask,
         r_hit_normals[i] = float3(0.0f, 0.0f, 0.0f);
       }
       if (!r_hit_distances.is_empty()) {
-        r_hit_distances[i] = ray_length;
+        r_hit_distances[i] = ray_lengths[i];
       }
     }
   });
@@ -22,6 +22,7 @@
 
 #include "NOD_geometry_exec.hh"
 #include "NOD_geometry_nodes_lazy_function.hh"
+#include "NOD_geometry_nodes_memoize.hh"
 #include "NOD_multi_function.hh"
 #include "NOD_node_declaration.hh"
 
@@ -139,13 +140,16 @@ class LazyFunctionForGeometryNode : public LazyFunction {
    * does not have to execute.
    */
   Vector<bool> is_attribute_output_bsocket_;
+  /** Identifies the outputs of this function in the #NodeOutputCache. */
+  uint64_t memoization_id_;
 
  public:
   LazyFunctionForGeometryNode(const bNode &node,
                               GeometryNodesLazyFunctionGraphInfo &own_lf_graph_info)
       : node_(node),
         own_lf_graph_info_(own_lf_graph_info),
-        is_attribute_output_bsocket_(node.output_sockets().size(), false)
+        is_attribute_output_bsocket_(node.output_sockets().size(), false),
+        memoization_id_(memoized_node_function_id_new())
   {
     BLI_assert(node.typeinfo->geometry_node_execute != nullptr);
     debug_name_ = node.name;
@@ -246,15 +250,18 @@ class LazyFunctionForGeometryNode : public LazyFunction {
       return this->anonymous_attribute_name_for_output(*user_data, i);
     };
 
-    GeoNodeExecParams geo_params{
-        node_,
-        params,
-        context,
-        own_lf_graph_info_.mapping.lf_input_index_for_output_bsocket_usage,
-        own_lf_graph_info_.mapping.lf_input_index_for_reference_set_for_output,
-        get_anonymous_attribute_name};
-
-    node_.typeinfo->geometry_node_execute(geo_params);
+    execute_node_with_memoization(
+        node_, memoization_id_, params, context, [&](lf::Params &exec_params) {
+          GeoNodeExecParams geo_params{
+              node_,
+              exec_params,
+              context,
+              own_lf_graph_info_.mapping.lf_input_index_for_output_bsocket_usage,
+              own_lf_graph_info_.mapping.lf_input_index_for_reference_set_for_output,
+              get_anonymous_attribute_name};
+
+          node_.typeinfo->geometry_node_execute(geo_params);
+        });
   }
 
   std::string input_name(const int index) const override
@@ -4074,6 +4081,11 @@ destruct_ptr<lf::LocalUserData> GeoNodesLFUserData::get_local(LinearAllocator<>
   return allocator.construct<GeoNodesLFLocalUserData>(*this);
 }
 
+lf::GraphExecutorTracer *GeoNodesLFUserData::graph_executor_tracer()
+{
+  return call_data->graph_executor_tracer;
+}
+
 void GeoNodesLFLocalUserData::ensure_tree_logger(const GeoNodesLFUserData &user_data) const
 {
   if (geo_eval_log::GeoModifierLog *log = user_data.call_data->eval_log) {
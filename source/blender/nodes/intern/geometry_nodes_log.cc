@@ -353,6 +353,16 @@ void GeoTreeLog::ensure_execution_times()
       const std::chrono::nanoseconds duration = timings.end - timings.start;
       this->nodes.lookup_or_add_default_as(timings.node_id).execution_time += duration;
     }
+    for (const GeoTreeLogger::NodeMemoization &memoization : tree_logger->node_memoizations) {
+      GeoNodeLog &node_log = this->nodes.lookup_or_add_default_as(memoization.node_id);
+      if (memoization.is_hit) {
+        node_log.memoization_hits++;
+      }
+      else {
+        node_log.memoization_misses++;
+      }
+      node_log.memoized_bytes += memoization.memory_bytes;
+    }
     this->execution_time += tree_logger->execution_time;
   }
   reduced_execution_times_ = true;
@@ -0,0 +1,574 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup nodes
+ */
+
+#include <atomic>
+
+#include "BLI_implicit_sharing_ptr.hh"
+#include "BLI_linear_allocator.hh"
+#include "BLI_memory_counter.hh"
+#include "BLI_string_ref.hh"
+
+#include "BKE_compute_contexts.hh"
+#include "BKE_geometry_nodes_reference_set.hh"
+#include "BKE_geometry_set.hh"
+#include "BKE_node_socket_value.hh"
+#include "BKE_object_types.hh"
+
+#include "DNA_node_types.h"
+#include "DNA_object_types.h"
+
+#include "DEG_depsgraph.hh"
+
+#include "NOD_geometry_nodes_lazy_function.hh"
+#include "NOD_geometry_nodes_memoize.hh"
+
+namespace blender::nodes {
+
+using bke::GeometryComponent;
+using bke::GeometryNodesReferenceSet;
+using bke::GeometrySet;
+using bke::SocketValueVariant;
+
+/**
+ * A component of a geometry input. The weak user makes sure that the component is not freed, so
+ * that its address can't be reused by a new component. The version detects in-place changes.
+ */
+struct MemoizedComponent {
+  WeakImplicitSharingPtr component;
+  int64_t version;
+};
+
+/**
+ * Identifies an input value of a node. Values are copied, except for geometries which are only
+ * identified by their components. Holding a strong reference to them would force nodes to copy
+ * the geometry before they can modify it.
+ */
+struct MemoizedInput {
+  /** Copy of the value, or null for geometries. */
+  GMutablePointer value;
+  Vector<MemoizedComponent, 4> components;
+  std::string geometry_name;
+  /** Depsgraph update counters of an object input. */
+  std::array<uint64_t, 3> object_updates = {0, 0, 0};
+};
+
+struct NodeOutputCache::Entry {
+  uint64_t function_id = 0;
+  /** Counter of the last transform update of the self object, if the node has object inputs. */
+  uint64_t self_object_transform_update = 0;
+  Vector<MemoizedInput> inputs;
+  /**
+   * Outputs are only stored when the node got the same inputs in the previous evaluation. Storing
+   * them adds a user to output geometries, so that the nodes modifying them have to copy them
+   * first. That should not happen for nodes whose inputs change in every evaluation anyway.
+   */
+  bool stores_outputs = false;
+  /** Computed outputs, empty when the node did not compute an output. */
+  Array<GMutablePointer> outputs;
+  /** Logged data is only available when logging was enabled when the node was executed. */
+  bool has_logs = false;
+  Vector<geo_eval_log::NodeWarning> warnings;
+  Vector<std::pair<std::string, geo_eval_log::NamedAttributeUsage>> used_named_attributes;
+  int64_t memory_bytes = 0;
+  LinearAllocator<> allocator;
+
+  ~Entry()
+  {
+    for (MemoizedInput &input : this->inputs) {
+      if (input.value.get()) {
+        input.value.destruct();
+      }
+    }
+    for (GMutablePointer &value : this->outputs) {
+      if (value.get()) {
+        value.destruct();
+      }
+    }
+  }
+};
+
+NodeOutputCache::NodeOutputCache() = default;
+NodeOutputCache::~NodeOutputCache() = default;
+
+void NodeOutputCache::begin_evaluation(const Depsgraph &depsgraph)
+{
+  std::lock_guard lock{mutex_};
+  const uint64_t update_count = DEG_get_update_count(&depsgraph);
+  if (depsgraph_ != &depsgraph || update_count < depsgraph_update_count_) {
+    entries_.clear();
+    depsgraph_ = &depsgraph;
+  }
+  depsgraph_update_count_ = update_count;
+  evaluation_++;
+}
+
+void NodeOutputCache::end_evaluation()
+{
+  std::lock_guard lock{mutex_};
+  entries_.remove_if([&](const auto &item) {
+    return item.value.last_used_evaluation != evaluation_;
+  });
+}
+
+std::shared_ptr<const NodeOutputCache::Entry> NodeOutputCache::lookup(
+    const ComputeContextHash &context_hash, const int32_t node_id)
+{
+  std::lock_guard lock{mutex_};
+  StoredEntry *stored = entries_.lookup_ptr({context_hash, node_id});
+  if (stored == nullptr) {
+    return {};
+  }
+  stored->last_used_evaluation = evaluation_;
+  return stored->entry;
+}
+
+void NodeOutputCache::add(const ComputeContextHash &context_hash,
+                          const int32_t node_id,
+                          std::shared_ptr<const Entry> entry)
+{
+  std::shared_ptr<const Entry> old_entry;
+  {
+    std::lock_guard lock{mutex_};
+    StoredEntry &stored = entries_.lookup_or_add({context_hash, node_id}, {});
+    /* Free the previous entry outside of the lock. */
+    old_entry = std::move(stored.entry);
+    stored.entry = std::move(entry);
+    stored.last_used_evaluation = evaluation_;
+  }
+}
+
+uint64_t memoized_node_function_id_new()
+{
+  static std::atomic<uint64_t> next_id = 1;
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool node_supports_memoization(const bNode &node)
+{
+  static const Set<StringRef> memoized_idnames = {
+      "GeometryNodeConvexHull",
+      "GeometryNodeCurveToMesh",
+      "GeometryNodeDistributePointsOnFaces",
+      "GeometryNodeDualMesh",
+      "GeometryNodeMergeByDistance",
+      "GeometryNodeMeshBoolean",
+      "GeometryNodeMeshToVolume",
+      "GeometryNodePointsToVolume",
+      "GeometryNodeSubdivideMesh",
+      "GeometryNodeSubdivisionSurface",
+      "GeometryNodeVolumeToMesh",
+  };
+  return memoized_idnames.contains(node.idname);
+}
+
+/**
+ * Zones are evaluated many times with different compute contexts. Storing the outputs of every
+ * iteration would use too much memory.
+ */
+static bool is_in_zone_iteration(const ComputeContext &compute_context)
+{
+  for (const ComputeContext *context = &compute_context; context; context = context->parent()) {
+    if (dynamic_cast<const bke::RepeatZoneComputeContext *>(context) ||
+        dynamic_cast<const bke::ForeachGeometryElementZoneComputeContext *>(context))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool socket_value_supported(const SocketValueVariant &value)
+{
+  if (value.is_volume_grid()) {
+    return false;
+  }
+  if (value.is_single()) {
+    return value.get_single_ptr().type()->is_equality_comparable();
+  }
+  return true;
+}
+
+static bool input_type_supported(const CPPType &type, const void *value)
+{
+  if (type.is<SocketValueVariant>()) {
+    return socket_value_supported(*static_cast<const SocketValueVariant *>(value));
+  }
+  /* Other data-blocks like collections and images can change without the node being notified. */
+  return type.is_any<GeometrySet, GeometryNodesReferenceSet, Object *, Material *, bool>();
+}
+
+static bool socket_values_equal(const SocketValueVariant &a, const SocketValueVariant &b)
+{
+  if (a.is_single() != b.is_single()) {
+    return false;
+  }
+  if (a.is_single()) {
+    const GPointer a_value = a.get_single_ptr();
+    const GPointer b_value = b.get_single_ptr();
+    return a_value.type() == b_value.type() &&
+           a_value.type()->is_equal(a_value.get(), b_value.get());
+  }
+  /* Fields are compared by their field nodes, which are kept alive by the stored copy. */
+  return a.get<fn::GField>() == b.get<fn::GField>();
+}
+
+static bool reference_sets_equal(const GeometryNodesReferenceSet &a,
+                                 const GeometryNodesReferenceSet &b)
+{
+  if (a.names == b.names) {
+    return true;
+  }
+  if (!a.names || !b.names) {
+    return false;
+  }
+  return *a.names == *b.names;
+}
+
+static std::array<uint64_t, 3> object_update_counters(const Object *object)
+{
+  if (object == nullptr) {
+    return {0, 0, 0};
+  }
+  const bke::ObjectRuntime &runtime = *object->runtime;
+  return {
+      runtime.last_update_transform, runtime.last_update_geometry, runtime.last_update_shading};
+}
+
+static bool input_matches(const MemoizedInput &stored, const CPPType &type, const void *value)
+{
+  if (type.is<GeometrySet>()) {
+    const GeometrySet &geometry = *static_cast<const GeometrySet *>(value);
+    const Vector<const GeometryComponent *> components = geometry.get_components();
+    if (components.size() != stored.components.size()) {
+      return false;
+    }
+    for (const int i : components.index_range()) {
+      const MemoizedComponent &stored_component = stored.components[i];
+      if (stored_component.component.get() != components[i] ||
+          stored_component.version != components[i]->version())
+      {
+        return false;
+      }
+    }
+    return stored.geometry_name == geometry.name;
+  }
+  if (stored.value.type() != &type) {
+    return false;
+  }
+  if (type.is<SocketValueVariant>()) {
+    return socket_values_equal(*static_cast<const SocketValueVariant *>(stored.value.get()),
+                               *static_cast<const SocketValueVariant *>(value));
+  }
+  if (type.is<GeometryNodesReferenceSet>()) {
+    return reference_sets_equal(
+        *static_cast<const GeometryNodesReferenceSet *>(stored.value.get()),
+        *static_cast<const GeometryNodesReferenceSet *>(value));
+  }
+  if (type.is<Object *>()) {
+    const Object *object = *static_cast<const Object *const *>(value);
+    if (stored.object_updates != object_update_counters(object)) {
+      return false;
+    }
+  }
+  return type.is_equal(stored.value.get(), value);
+}
+
+static MemoizedInput memoize_input(const CPPType &type,
+                                   const void *value,
+                                   LinearAllocator<> &allocator)
+{
+  MemoizedInput input;
+  if (type.is<GeometrySet>()) {
+    const GeometrySet &geometry = *static_cast<const GeometrySet *>(value);
+    for (const GeometryComponent *component : geometry.get_components()) {
+      component->add_weak_user();
+      input.components.append({WeakImplicitSharingPtr(component), component->version()});
+    }
+    input.geometry_name = geometry.name;
+    return input;
+  }
+  void *buffer = allocator.allocate(type.size(), type.alignment());
+  type.copy_construct(value, buffer);
+  input.value = {type, buffer};
+  if (type.is<Object *>()) {
+    input.object_updates = object_update_counters(*static_cast<const Object *const *>(value));
+  }
+  return input;
+}
+
+static void count_output_memory(const CPPType &type,
+                                const void *value,
+                                MemoryCounter &memory)
+{
+  if (type.is<GeometrySet>()) {
+    static_cast<const GeometrySet *>(value)->count_memory(memory);
+    return;
+  }
+  memory.add(type.size());
+  if (type.is<SocketValueVariant>()) {
+    const SocketValueVariant &value_variant = *static_cast<const SocketValueVariant *>(value);
+    if (value_variant.is_single()) {
+      const GPointer single = value_variant.get_single_ptr();
+      if (single.type()->is<std::string>()) {
+        memory.add(static_cast<const std::string *>(single.get())->size());
+      }
+    }
+  }
+}
+
+/**
+ * Forwards all accesses to the parameters of the actual evaluation, but also copies the computed
+ * outputs into the cache entry.
+ */
+class MemoizingParams : public lf::Params {
+ private:
+  lf::Params &params_;
+  NodeOutputCache::Entry &entry_;
+
+ public:
+  MemoizingParams(lf::Params &params, NodeOutputCache::Entry &entry)
+      : lf::Params(params.fn_, false), params_(params), entry_(entry)
+  {
+  }
+
+ private:
+  void *try_get_input_data_ptr_impl(const int index) const override
+  {
+    return params_.try_get_input_data_ptr(index);
+  }
+
+  void *try_get_input_data_ptr_or_request_impl(const int index) override
+  {
+    return params_.try_get_input_data_ptr_or_request(index);
+  }
+
+  void *get_output_data_ptr_impl(const int index) override
+  {
+    return params_.get_output_data_ptr(index);
+  }
+
+  void output_set_impl(const int index) override
+  {
+    const CPPType &type = *fn_.outputs()[index].type;
+    void *value = params_.get_output_data_ptr(index);
+    void *buffer = entry_.allocator.allocate(type.size(), type.alignment());
+    type.copy_construct(value, buffer);
+    entry_.outputs[index] = {type, buffer};
+    params_.output_set(index);
+  }
+
+  bool output_was_set_impl(const int index) const override
+  {
+    return params_.output_was_set(index);
+  }
+
+  lf::ValueUsage get_output_usage_impl(const int index) const override
+  {
+    return params_.get_output_usage(index);
+  }
+
+  void set_input_unused_impl(const int index) override
+  {
+    params_.set_input_unused(index);
+  }
+
+  bool try_enable_multi_threading_impl() override
+  {
+    return params_.try_enable_multi_threading();
+  }
+};
+
+static void log_memoization(geo_eval_log::GeoTreeLogger *tree_logger,
+                            const bNode &node,
+                            const bool is_hit,
+                            const int64_t memory_bytes)
+{
+  if (tree_logger) {
+    tree_logger->node_memoizations.append(*tree_logger->allocator,
+                                          {node.identifier, is_hit, memory_bytes});
+  }
+}
+
+/** Check if the node got the same inputs when the entry was created. */
+static bool entry_inputs_match(const NodeOutputCache::Entry &entry,
+                               const uint64_t function_id,
+                               const uint64_t self_object_transform_update,
+                               const lf::Params &params)
+{
+  const LazyFunction &fn = params.fn_;
+  if (entry.function_id != function_id) {
+    return false;
+  }
+  if (entry.self_object_transform_update != self_object_transform_update) {
+    return false;
+  }
+  for (const int i : fn.inputs().index_range()) {
+    const CPPType &type = *fn.inputs()[i].type;
+    if (!input_matches(entry.inputs[i], type, params.try_get_input_data_ptr(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Check if the entry stores all outputs that are requested in the current evaluation. */
+static bool entry_outputs_available(const NodeOutputCache::Entry &entry,
+                                    const bool logging_enabled,
+                                    const lf::Params &params)
+{
+  const LazyFunction &fn = params.fn_;
+  if (!entry.stores_outputs) {
+    return false;
+  }
+  if (logging_enabled && !entry.has_logs) {
+    return false;
+  }
+  for (const int i : fn.outputs().index_range()) {
+    if (!entry.outputs[i].get() && params.get_output_usage(i) == lf::ValueUsage::Used &&
+        !params.output_was_set(i))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void use_entry(const NodeOutputCache::Entry &entry,
+                      const bNode &node,
+                      lf::Params &params,
+                      geo_eval_log::GeoTreeLogger *tree_logger)
+{
+  const LazyFunction &fn = params.fn_;
+  for (const int i : fn.outputs().index_range()) {
+    if (!entry.outputs[i].get() || params.output_was_set(i) ||
+        params.get_output_usage(i) == lf::ValueUsage::Unused)
+    {
+      continue;
+    }
+    const GMutablePointer value = entry.outputs[i];
+    value.type()->copy_construct(value.get(), params.get_output_data_ptr(i));
+    params.output_set(i);
+  }
+  if (tree_logger) {
+    for (const geo_eval_log::NodeWarning &warning : entry.warnings) {
+      tree_logger->node_warnings.append(
+          *tree_logger->allocator,
+          {node.identifier,
+           {warning.type, tree_logger->allocator->copy_string(warning.message)}});
+    }
+    for (const auto &[name, usage] : entry.used_named_attributes) {
+      tree_logger->used_named_attributes.append(
+          *tree_logger->allocator,
+          {node.identifier, tree_logger->allocator->copy_string(name), usage});
+    }
+  }
+}
+
+void execute_node_with_memoization(const bNode &node,
+                                   const uint64_t function_id,
+                                   lf::Params &params,
+                                   const lf::Context &context,
+                                   const FunctionRef<void(lf::Params &params)> execute_fn)
+{
+  const auto &user_data = *static_cast<GeoNodesLFUserData *>(context.user_data);
+  NodeOutputCache *cache = user_data.call_data->node_output_cache;
+  if (cache == nullptr || !node_supports_memoization(node) ||
+      is_in_zone_iteration(*user_data.compute_context))
+  {
+    execute_fn(params);
+    return;
+  }
+
+  const LazyFunction &fn = params.fn_;
+  bool has_object_input = false;
+  for (const int i : fn.inputs().index_range()) {
+    const CPPType &type = *fn.inputs()[i].type;
+    if (!input_type_supported(type, params.try_get_input_data_ptr(i))) {
+      execute_fn(params);
+      return;
+    }
+    has_object_input |= type.is<Object *>();
+  }
+
+  /* Object inputs may be used relative to the transform of the self object. */
+  const Object *self_object = user_data.call_data->self_object();
+  const uint64_t self_object_transform_update =
+      (has_object_input && self_object) ? self_object->runtime->last_update_transform : 0;
+
+  auto &local_user_data = *static_cast<GeoNodesLFLocalUserData *>(context.local_user_data);
+  geo_eval_log::GeoTreeLogger *tree_logger = local_user_data.try_get_tree_logger(user_data);
+  const ComputeContextHash &context_hash = user_data.compute_context->hash();
+
+  bool inputs_unchanged = false;
+  if (const std::shared_ptr<const NodeOutputCache::Entry> entry = cache->lookup(context_hash,
+                                                                                 node.identifier))
+  {
+    if (entry_inputs_match(*entry, function_id, self_object_transform_update, params)) {
+      if (entry_outputs_available(*entry, tree_logger != nullptr, params)) {
+        use_entry(*entry, node, params, tree_logger);
+        log_memoization(tree_logger, node, true, entry->memory_bytes);
+        return;
+      }
+      inputs_unchanged = true;
+    }
+  }
+
+  auto entry = std::make_shared<NodeOutputCache::Entry>();
+  entry->function_id = function_id;
+  entry->self_object_transform_update = self_object_transform_update;
+  entry->stores_outputs = inputs_unchanged;
+  entry->outputs.reinitialize(fn.outputs().size());
+  for (const int i : fn.inputs().index_range()) {
+    const CPPType &type = *fn.inputs()[i].type;
+    entry->inputs.append(
+        memoize_input(type, params.try_get_input_data_ptr(i), entry->allocator));
+  }
+
+  if (!entry->stores_outputs) {
+    /* Only remember the inputs, so that the outputs are stored when they are the same in the next
+     * evaluation. The outputs stay owned by the nodes using them. */
+    execute_fn(params);
+    log_memoization(tree_logger, node, false, 0);
+    cache->add(context_hash, node.identifier, std::move(entry));
+    return;
+  }
+
+  MemoizingParams memoizing_params{params, *entry};
+  execute_fn(memoizing_params);
+
+  if (tree_logger) {
+    entry->has_logs = true;
+    for (const geo_eval_log::GeoTreeLogger::WarningWithNode &warning : tree_logger->node_warnings)
+    {
+      if (warning.node_id == node.identifier) {
+        entry->warnings.append(warning.warning);
+      }
+    }
+    for (const geo_eval_log::GeoTreeLogger::AttributeUsageWithNode &usage :
+         tree_logger->used_named_attributes)
+    {
+      if (usage.node_id == node.identifier) {
+        entry->used_named_attributes.append({usage.attribute_name, usage.usage});
+      }
+    }
+  }
+
+  memory_counter::MemoryCount memory;
+  MemoryCounter memory_counter{memory};
+  for (const GMutablePointer &value : entry->outputs) {
+    if (value.get()) {
+      count_output_memory(*value.type(), value.get(), memory_counter);
+    }
+  }
+  entry->memory_bytes = memory.total_bytes;
+
+  log_memoization(tree_logger, node, false, entry->memory_bytes);
+  cache->add(context_hash, node.identifier, std::move(entry));
+}
+
+}  // namespace blender::nodes
@@ -7,6 +7,7 @@
 
 #include "BKE_texture.h"
 
+#include "BLI_array_utils.hh"
 #include "BLI_noise.hh"
 
 #include "NOD_multi_function.hh"
@@ -340,6 +341,20 @@ class NoiseFunction : public mf::MultiFunction {
       }
       case 3: {
         const VArray<float3> &vector = params.readonly_single_input<float3>(0, "Vector");
+        if (type_ == SHD_NOISE_FBM && scale.is_single() && detail.is_single() &&
+            roughness.is_single() && lacunarity.is_single() && distortion.is_single())
+        {
+          this->call_fbm_3d_batched(mask,
+                                    vector,
+                                    scale.get_internal_single(),
+                                    detail.get_internal_single(),
+                                    roughness.get_internal_single(),
+                                    lacunarity.get_internal_single(),
+                                    distortion.get_internal_single(),
+                                    r_factor,
+                                    r_color);
+          break;
+        }
         if (compute_factor) {
           mask.foreach_index([&](const int64_t i) {
             const float3 position = vector[i] * scale[i];
@@ -416,6 +431,66 @@ class NoiseFunction : public mf::MultiFunction {
     }
   }
 
+  /**
+   * Evaluate 3D fBM noise with the batched noise functions, which use SIMD instructions. This is
+   * only possible when all parameters except the vector are the same for every element, which is
+   * the common case when e.g. displacing a mesh.
+   */
+  void call_fbm_3d_batched(const IndexMask &mask,
+                           const VArray<float3> &vector,
+                           const float scale,
+                           const float detail,
+                           const float roughness,
+                           const float lacunarity,
+                           const float distortion,
+                           MutableSpan<float> r_factor,
+                           MutableSpan<ColorGeometry4f> r_color) const
+  {
+    constexpr int64_t batch_size = 256;
+    std::array<float3, batch_size> positions_buffer;
+    std::array<float, batch_size> factors_buffer;
+    std::array<float3, batch_size> colors_buffer;
+
+    for (int64_t start = 0; start < mask.size(); start += batch_size) {
+      const IndexMask batch = mask.slice(start, std::min(batch_size, mask.size() - start));
+      const MutableSpan<float3> positions(positions_buffer.data(), batch.size());
+      vector.materialize_compressed(batch, positions);
+      for (float3 &position : positions) {
+        position *= scale;
+      }
+      if (!r_factor.is_empty()) {
+        const MutableSpan<float> factors(factors_buffer.data(), batch.size());
+        noise::perlin_fractal_distorted(positions,
+                                        math::clamp(detail, 0.0f, 15.0f),
+                                        math::max(roughness, 0.0f),
+                                        lacunarity,
+                                        0.0f,
+                                        0.0f,
+                                        distortion,
+                                        type_,
+                                        normalize_,
+                                        factors);
+        array_utils::scatter(factors.as_span(), batch, r_factor);
+      }
+      if (!r_color.is_empty()) {
+        const MutableSpan<float3> colors(colors_buffer.data(), batch.size());
+        noise::perlin_float3_fractal_distorted(positions,
+                                               math::clamp(detail, 0.0f, 15.0f),
+                                               math::max(roughness, 0.0f),
+                                               lacunarity,
+                                               0.0f,
+                                               0.0f,
+                                               distortion,
+                                               type_,
+                                               normalize_,
+                                               colors);
+        batch.foreach_index([&](const int64_t i, const int64_t pos) {
+          r_color[i] = ColorGeometry4f(colors[pos][0], colors[pos][1], colors[pos][2], 1.0f);
+        });
+      }
+    }
+  }
+
   ExecutionHints get_execution_hints() const override
   {
     ExecutionHints hints;
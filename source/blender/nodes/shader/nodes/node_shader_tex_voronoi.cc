@@ -447,6 +447,25 @@ class VoronoiMetricFunction : public mf::MultiFunction {
         break;
       }
       case 3: {
+        if (feature_ == SHD_VORONOI_F1 && metric_ != SHD_VORONOI_MINKOWSKI && scale.is_single() &&
+            detail.is_single() && roughness.is_single() && lacunarity.is_single() &&
+            randomness.is_single())
+        {
+          params.scale = scale.get_internal_single();
+          params.detail = detail.get_internal_single();
+          params.roughness = roughness.get_internal_single();
+          params.lacunarity = lacunarity.get_internal_single();
+          params.smoothness = 0.0f;
+          params.exponent = 0.0f;
+          params.randomness = std::min(std::max(randomness.get_internal_single(), 0.0f), 1.0f);
+          params.max_distance = noise::voronoi_distance(float3{0.0f, 0.0f, 0.0f},
+                                                        float3(0.5f + 0.5f * params.randomness,
+                                                               0.5f + 0.5f * params.randomness,
+                                                               0.5f + 0.5f * params.randomness),
+                                                        params);
+          this->call_f1_3d_batched(mask, vector, params, r_distance, r_color, r_position);
+          break;
+        }
         mask.foreach_index([&](const int64_t i) {
           params.scale = scale[i];
           params.detail = detail[i];
@@ -523,6 +542,46 @@ class VoronoiMetricFunction : public mf::MultiFunction {
     }
   }
 
+  /**
+   * Evaluate 3D F1 Voronoi noise with the batched noise functions, which use SIMD instructions.
+   * This is only possible when all parameters except the vector are the same for every element,
+   * which is the common case when e.g. displacing a mesh.
+   */
+  void call_f1_3d_batched(const IndexMask &mask,
+                          const VArray<float3> &vector,
+                          const noise::VoronoiParams &params,
+                          MutableSpan<float> r_distance,
+                          MutableSpan<ColorGeometry4f> r_color,
+                          MutableSpan<float3> r_position) const
+  {
+    constexpr int64_t batch_size = 256;
+    std::array<float3, batch_size> coords_buffer;
+    std::array<noise::VoronoiOutput, batch_size> outputs_buffer;
+
+    for (int64_t start = 0; start < mask.size(); start += batch_size) {
+      const IndexMask batch = mask.slice(start, std::min(batch_size, mask.size() - start));
+      const MutableSpan<float3> coords(coords_buffer.data(), batch.size());
+      const MutableSpan<noise::VoronoiOutput> outputs(outputs_buffer.data(), batch.size());
+      vector.materialize_compressed(batch, coords);
+      for (float3 &coord : coords) {
+        coord *= params.scale;
+      }
+      noise::fractal_voronoi_x_fx(params, coords, outputs);
+      batch.foreach_index([&](const int64_t i, const int64_t pos) {
+        const noise::VoronoiOutput &output = outputs[pos];
+        if (!r_distance.is_empty()) {
+          r_distance[i] = output.distance;
+        }
+        if (!r_color.is_empty()) {
+          r_color[i] = ColorGeometry4f(output.color.x, output.color.y, output.color.z, 1.0f);
+        }
+        if (!r_position.is_empty()) {
+          r_position[i] = float3{output.position.x, output.position.y, output.position.z};
+        }
+      });
+    }
+  }
+
   ExecutionHints get_execution_hints() const override
   {
     return voronoi_execution_hints;
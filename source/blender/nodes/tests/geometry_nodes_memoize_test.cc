@@ -0,0 +1,197 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <array>
+
+#include "testing/testing.h"
+
+#include "BLI_memory_utils.hh"
+#include "BLI_string.h"
+
+#include "BKE_compute_contexts.hh"
+#include "BKE_geometry_set.hh"
+#include "BKE_idtype.hh"
+#include "BKE_main.hh"
+#include "BKE_pointcloud.hh"
+
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.hh"
+
+#include "FN_lazy_function_execute.hh"
+
+#include "NOD_geometry_nodes_lazy_function.hh"
+#include "NOD_geometry_nodes_memoize.hh"
+
+namespace blender::nodes::tests {
+
+using bke::GeometryComponent;
+using bke::GeometrySet;
+
+/** Has the signature of a node with a single geometry input and output. */
+class LazyFunctionForGeometryNode : public LazyFunction {
+ public:
+  LazyFunctionForGeometryNode()
+  {
+    debug_name_ = "Geometry Node";
+    inputs_.append_as("Geometry", CPPType::get<GeometrySet>());
+    outputs_.append_as("Geometry", CPPType::get<GeometrySet>());
+  }
+
+  void execute_impl(lf::Params & /*params*/, const lf::Context & /*context*/) const override
+  {
+    BLI_assert_unreachable();
+  }
+};
+
+class GeometryNodesMemoizeTest : public testing::Test {
+ protected:
+  Scene scene = {};
+  Main *bmain = nullptr;
+  Depsgraph *depsgraph = nullptr;
+  NodeOutputCache cache;
+  bNode node = {};
+  LazyFunctionForGeometryNode fn;
+  uint64_t function_id = memoized_node_function_id_new();
+  /** Number of times the node has actually been executed. */
+  int executions = 0;
+
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    DEG_register_node_types();
+    ViewLayer *view_layer = static_cast<ViewLayer *>(scene.view_layers.first);
+    depsgraph = DEG_graph_new(bmain, &scene, view_layer, DAG_EVAL_VIEWPORT);
+
+    STRNCPY(node.idname, "GeometryNodeMeshBoolean");
+    node.identifier = 1;
+  }
+
+  void TearDown() override
+  {
+    DEG_graph_free(depsgraph);
+    DEG_free_node_types();
+    BKE_main_free(bmain);
+  }
+
+  /**
+   * Evaluate the node with the cache like the evaluation of a node tree would. When it is
+   * executed, it outputs a new point cloud.
+   */
+  GeometrySet evaluate(GeometrySet &input)
+  {
+    cache.begin_evaluation(*depsgraph);
+
+    GeoNodesCallData call_data;
+    call_data.node_output_cache = &cache;
+    bke::ModifierComputeContext compute_context{nullptr, "Test"};
+    GeoNodesLFUserData user_data;
+    user_data.call_data = &call_data;
+    user_data.compute_context = &compute_context;
+    GeoNodesLFLocalUserData local_user_data{user_data};
+    lf::Context context{nullptr, &user_data, &local_user_data};
+
+    TypedBuffer<GeometrySet> output;
+    const std::array<GMutablePointer, 1> inputs = {GMutablePointer(&input)};
+    const std::array<GMutablePointer, 1> outputs = {GMutablePointer(output.ptr())};
+    std::array<std::optional<lf::ValueUsage>, 1> input_usages;
+    const std::array<lf::ValueUsage, 1> output_usages = {lf::ValueUsage::Used};
+    std::array<bool, 1> set_outputs = {false};
+    lf::BasicParams params{fn, inputs, outputs, input_usages, output_usages, set_outputs};
+
+    execute_node_with_memoization(
+        node, function_id, params, context, [&](lf::Params &exec_params) {
+          executions++;
+          exec_params.set_output(0, GeometrySet::from_pointcloud(BKE_pointcloud_new_nomain(4)));
+        });
+    EXPECT_TRUE(set_outputs[0]);
+
+    cache.end_evaluation();
+    GeometrySet result = std::move(*output.ptr());
+    std::destroy_at(output.ptr());
+    return result;
+  }
+};
+
+static GeometrySet create_input()
+{
+  return GeometrySet::from_pointcloud(BKE_pointcloud_new_nomain(2));
+}
+
+TEST_F(GeometryNodesMemoizeTest, CacheHit)
+{
+  GeometrySet input = create_input();
+  /* The outputs are stored once the node got the same inputs twice. */
+  this->evaluate(input);
+  const GeometrySet stored = this->evaluate(input);
+  EXPECT_EQ(executions, 2);
+
+  const GeometrySet reused = this->evaluate(input);
+  EXPECT_EQ(executions, 2);
+  EXPECT_EQ(reused.get_pointcloud(), stored.get_pointcloud());
+
+  this->evaluate(input);
+  EXPECT_EQ(executions, 2);
+}
+
+TEST_F(GeometryNodesMemoizeTest, InvalidateOnInputChange)
+{
+  GeometrySet input = create_input();
+  this->evaluate(input);
+  this->evaluate(input);
+  this->evaluate(input);
+  EXPECT_EQ(executions, 2);
+
+  /* Changing the input geometry in place is detected. */
+  input.get_pointcloud_for_write();
+  const GeometrySet changed = this->evaluate(input);
+  EXPECT_EQ(executions, 3);
+
+  /* A different input geometry, that may even have the same data. */
+  GeometrySet other_input = create_input();
+  const GeometrySet other = this->evaluate(other_input);
+  EXPECT_EQ(executions, 4);
+  EXPECT_NE(other.get_pointcloud(), changed.get_pointcloud());
+
+  /* An empty input. */
+  GeometrySet empty_input;
+  this->evaluate(empty_input);
+  EXPECT_EQ(executions, 5);
+
+  /* A different node function, e.g. after a node setting changed. */
+  function_id = memoized_node_function_id_new();
+  this->evaluate(empty_input);
+  EXPECT_EQ(executions, 6);
+}
+
+TEST_F(GeometryNodesMemoizeTest, NoCopyForcedWhenInputsChange)
+{
+  for ([[maybe_unused]] const int i : IndexRange(4)) {
+    GeometrySet input = create_input();
+    const GeometrySet output = this->evaluate(input);
+    /* The cache must not hold a reference to the output that the next node could modify. */
+    EXPECT_TRUE(output.get_component(GeometryComponent::Type::PointCloud)->is_mutable());
+  }
+  EXPECT_EQ(executions, 4);
+}
+
+TEST_F(GeometryNodesMemoizeTest, UnsupportedNodeIsExecuted)
+{
+  STRNCPY(node.idname, "GeometryNodeSetPosition");
+  GeometrySet input = create_input();
+  for ([[maybe_unused]] const int i : IndexRange(3)) {
+    const GeometrySet output = this->evaluate(input);
+    EXPECT_TRUE(output.get_component(GeometryComponent::Type::PointCloud)->is_mutable());
+  }
+  EXPECT_EQ(executions, 3);
+}
+
+}  // namespace blender::nodes::tests
@@ -980,6 +980,20 @@ static void file_read_reports_finalize(BlendFileReadReport *bf_reports)
             duration_lib_override_recursive_resync_minutes,
             duration_lib_override_recursive_resync_seconds);
 
+  if (G.debug & G_DEBUG_IO) {
+    /* More detailed timing of the reading phases, accumulated over the file and its libraries. */
+    CLOG_INFO(&LOG,
+              0,
+              " * Reading data-blocks: %.3fs, read data callbacks: %.3fs",
+              bf_reports->duration.read_data,
+              bf_reports->duration.read_data_callbacks);
+    CLOG_INFO(&LOG,
+              0,
+              " * Linking ID pointers: %.3fs, versioning: %.3fs",
+              bf_reports->duration.lib_link,
+              bf_reports->duration.versioning);
+  }
+
   if (bf_reports->resynced_lib_overrides_libraries_count != 0) {
     for (LinkNode *node_lib = bf_reports->resynced_lib_overrides_libraries; node_lib != nullptr;
          node_lib = node_lib->next)
@@ -52,6 +52,7 @@
 
 #include "BKE_anim_data.hh"
 #include "BKE_brush.hh"
+#include "BKE_bvhutils.hh"
 #include "BKE_colortools.hh"
 #include "BKE_context.hh"
 #include "BKE_global.hh"
@@ -3791,6 +3792,7 @@ static void WM_OT_redraw_timer(wmOperatorType *ot)
 static int memory_statistics_exec(bContext * /*C*/, wmOperator * /*op*/)
 {
   MEM_printmemlist_stats();
+  blender::bke::bvhtree_cache_stats_print();
   return OPERATOR_FINISHED;
 }
 
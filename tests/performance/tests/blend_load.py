@@ -5,38 +5,64 @@
 import api
 
 
-def _run(filepath):
+def _run(args):
     import bpy
+    import os
+    import tempfile
     import time
 
-    # Load once to ensure it's cached by OS
-    bpy.ops.wm.open_mainfile(filepath=filepath)
-    bpy.ops.wm.read_homefile(use_empty=True, use_factory_startup=True)
+    filepath = args['filepath']
+    compress = args['compress']
 
-    # Measure loading the second time
-    start_time = time.time()
-    bpy.ops.wm.open_mainfile(filepath=filepath)
-    elapsed_time = time.time() - start_time
+    with tempfile.TemporaryDirectory() as tempdir:
+        if compress is not None:
+            # Re-save the file so that compressed and uncompressed loading can be compared on the
+            # same data, independent of how the test file itself was saved.
+            bpy.ops.wm.open_mainfile(filepath=filepath)
+            filepath = os.path.join(tempdir, os.path.basename(filepath))
+            bpy.ops.wm.save_as_mainfile(filepath=filepath, compress=compress, copy=True)
+
+        # Load once to ensure it's cached by OS
+        bpy.ops.wm.open_mainfile(filepath=filepath)
+        bpy.ops.wm.read_homefile(use_empty=True, use_factory_startup=True)
+
+        # Measure loading the second time
+        start_time = time.time()
+        bpy.ops.wm.open_mainfile(filepath=filepath)
+        elapsed_time = time.time() - start_time
+
+        # Release the file before the temporary directory is removed.
+        bpy.ops.wm.read_homefile(use_empty=True, use_factory_startup=True)
 
     result = {'time': elapsed_time}
     return result
 
 
 class BlendLoadTest(api.Test):
-    def __init__(self, filepath):
+    def __init__(self, filepath, compress=None):
         self.filepath = filepath
+        self.compress = compress
 
     def name(self):
-        return self.filepath.stem
+        if self.compress is None:
+            return self.filepath.stem
+        return f"{self.filepath.stem}_{'compressed' if self.compress else 'uncompressed'}"
 
     def category(self):
         return "blend_load"
 
     def run(self, env, device_id):
-        result, _ = env.run_in_blender(_run, str(self.filepath))
+        args = {
+            'filepath': str(self.filepath),
+            'compress': self.compress,
+        }
+        result, _ = env.run_in_blender(_run, args)
         return result
 
 
 def generate(env):
     filepaths = env.find_blend_files('*/*')
-    return [BlendLoadTest(filepath) for filepath in filepaths]
+    tests = [BlendLoadTest(filepath) for filepath in filepaths]
+    # Compare loading the same data with and without compression.
+    tests += [BlendLoadTest(filepath, compress) for filepath in filepaths for compress in (False, True)]
+    return tests
@@ -16,6 +16,7 @@ def _run(args):
     scene.render.filepath = args['render_filepath']
     scene.render.image_settings.file_format = 'PNG'
     scene.cycles.device = 'CPU' if device_type == 'CPU' else 'GPU'
+    scene.cycles.debug_use_cpu_wavefront = args['use_cpu_wavefront']
 
     if scene.cycles.use_adaptive_sampling:
         # Render samples specified in file, no other way to measure
@@ -52,17 +53,21 @@ def _run(args):
 
 
 class CyclesTest(api.Test):
-    def __init__(self, filepath):
+    def __init__(self, filepath, use_cpu_wavefront=False):
         self.filepath = filepath
+        self.use_cpu_wavefront = use_cpu_wavefront
 
     def name(self):
+        if self.use_cpu_wavefront:
+            return self.filepath.stem + "_wavefront"
         return self.filepath.stem
 
     def category(self):
         return "cycles"
 
     def use_device(self):
-        return True
+        # The wavefront mode only exists for the CPU.
+        return not self.use_cpu_wavefront
 
     def run(self, env, device_id):
         tokens = device_id.split('_')
@@ -70,6 +75,7 @@ class CyclesTest(api.Test):
         device_index = int(tokens[1]) if len(tokens) > 1 else 0
         args = {'device_type': device_type,
                 'device_index': device_index,
+                'use_cpu_wavefront': self.use_cpu_wavefront,
                 'render_filepath': str(env.log_file.parent / (env.log_file.stem + '.png'))}
 
         _, lines = env.run_in_blender(_run, args, ['--debug-cycles', '--verbose', '2', self.filepath])
@@ -109,4 +115,6 @@ class CyclesTest(api.Test):
 
 def generate(env):
     filepaths = env.find_blend_files('cycles/*')
-    return [CyclesTest(filepath) for filepath in filepaths]
+    tests = [CyclesTest(filepath) for filepath in filepaths]
+    tests += [CyclesTest(filepath, use_cpu_wavefront=True) for filepath in filepaths]
+    return tests
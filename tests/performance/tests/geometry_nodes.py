@@ -5,7 +5,7 @@
 import api
 
 
-def _run(args):
+def _measure_evaluation():
     import bpy
     import time
 
@@ -42,6 +42,46 @@ def _run(args):
     return result
 
 
+def _run(args):
+    return _measure_evaluation()
+
+
+def _run_field_chain(args):
+    # Offset the vertices of a large grid by a long chain of vector math nodes. This mostly
+    # measures the evaluation of fields, independent of any particular geometry operation.
+    import bpy
+
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    grid_size = args['grid_size']
+    bpy.ops.mesh.primitive_grid_add(x_subdivisions=grid_size, y_subdivisions=grid_size)
+    ob = bpy.context.active_object
+
+    tree = bpy.data.node_groups.new("Field Chain", 'GeometryNodeTree')
+    tree.interface.new_socket("Geometry", in_out='INPUT', socket_type='NodeSocketGeometry')
+    tree.interface.new_socket("Geometry", in_out='OUTPUT', socket_type='NodeSocketGeometry')
+    group_input = tree.nodes.new('NodeGroupInput')
+    group_output = tree.nodes.new('NodeGroupOutput')
+    set_position = tree.nodes.new('GeometryNodeSetPosition')
+
+    value = tree.nodes.new('GeometryNodeInputPosition').outputs[0]
+    operations = ('MULTIPLY', 'ADD', 'SINE')
+    for i in range(args['num_nodes']):
+        math = tree.nodes.new('ShaderNodeVectorMath')
+        math.operation = operations[i % len(operations)]
+        math.inputs[1].default_value = (0.5, 0.25, 0.125)
+        tree.links.new(value, math.inputs[0])
+        value = math.outputs[0]
+
+    tree.links.new(group_input.outputs[0], set_position.inputs['Geometry'])
+    tree.links.new(value, set_position.inputs['Offset'])
+    tree.links.new(set_position.outputs[0], group_output.inputs[0])
+
+    modifier = ob.modifiers.new("Field Chain", 'NODES')
+    modifier.node_group = tree
+
+    return _measure_evaluation()
+
+
 class GeometryNodesTest(api.Test):
     def __init__(self, filepath):
         self.filepath = filepath
@@ -60,6 +100,27 @@ class GeometryNodesTest(api.Test):
         return result
 
 
+class GeometryNodesFieldChainTest(api.Test):
+    def __init__(self, num_nodes, grid_size):
+        self.num_nodes = num_nodes
+        self.grid_size = grid_size
+
+    def name(self):
+        return f"field_chain_{self.num_nodes}_nodes_{self.grid_size}x{self.grid_size}"
+
+    def category(self):
+        return "geometry_nodes"
+
+    def run(self, env, device_id):
+        args = {'num_nodes': self.num_nodes, 'grid_size': self.grid_size}
+
+        result, _ = env.run_in_blender(_run_field_chain, args)
+
+        return result
+
+
 def generate(env):
     filepaths = env.find_blend_files('geometry_nodes/*')
-    return [GeometryNodesTest(filepath) for filepath in filepaths]
+    tests = [GeometryNodesTest(filepath) for filepath in filepaths]
+    tests += [GeometryNodesFieldChainTest(num_nodes, 1000) for num_nodes in (10, 100)]
+    return tests